@@ -0,0 +1,611 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Batch conversion of point files to models, without a running Slicer and without a MRML scene.
+// Each input file (markups fcsv, markups json or vtp, whose points are used) is converted to a model
+// using the parameters of a MarkupsToModel node, and the model is written to the output directory,
+// with the same name as the input. The files are processed in parallel, each thread only keeps the
+// point set and model it is working on in memory, and each model is written as soon as it is generated.
+// Point coordinates are used in the coordinate system of the input file, the model is written in the same system.
+//
+// Usage: MarkupsToModelBatch --output-directory dir [--preset file] [--set Name=value]... [--threads N]
+//          [--output-extension vtp|vtk] [--skip-existing] [--manifest file]... [input file or directory]...
+//
+// The preset is either a scene file (the attributes of its first MarkupsToModel node are used)
+// or a text file that only contains the attributes, in the same format as in the scene file, for example:
+//   ModelType="curve" InterpolationType="kochanekSpline" TubeRadius="0.5" CleanMarkups="true"
+// The parameters specified by --set override the preset.
+// The manifest is a text file that lists one input file or directory per line, relative paths are relative
+// to the manifest. Empty lines and lines starting with # are ignored.
+
+// MarkupsToModel includes
+#include "vtkMRMLMarkupsToModelNode.h"
+#include "vtkSlicerMarkupsToModelLogic.h"
+#include "vtkSlicerMarkupsToModelUpdateStatistics.h"
+
+// vtk includes
+#include <vtkMutexLock.h>
+#include <vtkPointSet.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataWriter.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkXMLPolyDataReader.h>
+#include <vtkXMLPolyDataWriter.h>
+
+// vtksys includes
+#include <vtksys/Directory.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// std includes
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// constants within this file
+static const char* BATCH_OUTPUT_EXTENSION_DEFAULT = "vtp";
+static const char BATCH_FCSV_COMMENT_CHARACTER = '#';
+static const char BATCH_MANIFEST_COMMENT_CHARACTER = '#';
+
+//------------------------------------------------------------------------------
+// An input file and the model file it is converted to
+struct BatchJob
+{
+  std::string InputFileName;
+  std::string OutputFileName;
+};
+
+//------------------------------------------------------------------------------
+static void PrintUsage( const char* programName )
+{
+  std::cerr << "Usage: " << programName << " --output-directory dir [--preset file] [--set Name=value]... [--threads N]" << std::endl;
+  std::cerr << "         [--output-extension vtp|vtk] [--skip-existing] [--manifest file]... [input file or directory]..." << std::endl;
+  std::cerr << "Inputs are markups fcsv files, markups json files or vtp files. Directories are searched for these files (not recursively)." << std::endl;
+}
+
+//------------------------------------------------------------------------------
+// Returns the lowercase file extension that identifies the input type, without the dot ("fcsv", "json", "vtp"),
+// or an empty string if the file type is not supported.
+static std::string GetInputFileType( const std::string& fileName )
+{
+  std::string extension = vtksys::SystemTools::LowerCase( vtksys::SystemTools::GetFilenameLastExtension( fileName ) );
+  if ( extension == ".fcsv" || extension == ".json" || extension == ".vtp" )
+  {
+    return extension.substr( 1 );
+  }
+  return "";
+}
+
+//------------------------------------------------------------------------------
+// Returns the name of the model for an input file: the input file name without the extensions that
+// identify the input type (both extensions of .mrk.json files).
+static std::string GetModelName( const std::string& fileName )
+{
+  std::string name = vtksys::SystemTools::GetFilenameWithoutLastExtension( fileName );
+  std::string markupsExtension = ".mrk";
+  if ( name.size() > markupsExtension.size()
+    && vtksys::SystemTools::LowerCase( name.substr( name.size() - markupsExtension.size() ) ) == markupsExtension )
+  {
+    name = name.substr( 0, name.size() - markupsExtension.size() );
+  }
+  return name;
+}
+
+//------------------------------------------------------------------------------
+// Adds the supported files of a directory in alphabetical order, or the file itself.
+static bool AddInput( const std::string& path, std::vector< std::string >& inputFileNames )
+{
+  if ( !vtksys::SystemTools::FileExists( path.c_str() ) )
+  {
+    std::cerr << "Input " << path << " does not exist" << std::endl;
+    return false;
+  }
+  if ( !vtksys::SystemTools::FileIsDirectory( path ) )
+  {
+    inputFileNames.push_back( path );
+    return true;
+  }
+  vtksys::Directory directory;
+  if ( !directory.Load( path ) )
+  {
+    std::cerr << "Failed to read directory " << path << std::endl;
+    return false;
+  }
+  std::vector< std::string > directoryFileNames;
+  for ( unsigned long i = 0; i < directory.GetNumberOfFiles(); i++ )
+  {
+    std::string fileName = path + "/" + directory.GetFile( i );
+    if ( !GetInputFileType( fileName ).empty() && !vtksys::SystemTools::FileIsDirectory( fileName ) )
+    {
+      directoryFileNames.push_back( fileName );
+    }
+  }
+  std::sort( directoryFileNames.begin(), directoryFileNames.end() );
+  inputFileNames.insert( inputFileNames.end(), directoryFileNames.begin(), directoryFileNames.end() );
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Adds the inputs listed in a manifest file.
+static bool AddManifestInputs( const std::string& manifestFileName, std::vector< std::string >& inputFileNames )
+{
+  std::ifstream manifestFile( manifestFileName.c_str() );
+  if ( !manifestFile.is_open() )
+  {
+    std::cerr << "Failed to open manifest " << manifestFileName << std::endl;
+    return false;
+  }
+  std::string manifestDirectory = vtksys::SystemTools::GetFilenamePath( vtksys::SystemTools::CollapseFullPath( manifestFileName ) );
+  bool success = true;
+  std::string line;
+  while ( std::getline( manifestFile, line ) )
+  {
+    line = vtksys::SystemTools::TrimWhitespace( line );
+    if ( line.empty() || line[ 0 ] == BATCH_MANIFEST_COMMENT_CHARACTER )
+    {
+      continue;
+    }
+    if ( !AddInput( vtksys::SystemTools::CollapseFullPath( line, manifestDirectory ), inputFileNames ) )
+    {
+      success = false;
+    }
+  }
+  return success;
+}
+
+//------------------------------------------------------------------------------
+// Parses the Name="value" attributes of the text into names and values.
+// If the text contains a MarkupsToModel element then only its attributes are parsed.
+static bool ParseAttributes( const std::string& text, const std::string& tagName,
+  std::vector< std::string >& attributeNames, std::vector< std::string >& attributeValues )
+{
+  std::string::size_type position = 0;
+  std::string::size_type end = text.size();
+  std::string elementStart = "<" + tagName;
+  std::string::size_type elementPosition = text.find( elementStart + " " );
+  if ( elementPosition != std::string::npos )
+  {
+    position = elementPosition + elementStart.size();
+    end = text.find( '>', position );
+    if ( end == std::string::npos )
+    {
+      return false;
+    }
+  }
+  while ( position < end )
+  {
+    std::string::size_type equalPosition = text.find( '=', position );
+    if ( equalPosition == std::string::npos || equalPosition >= end )
+    {
+      break;
+    }
+    std::string name = vtksys::SystemTools::TrimWhitespace( text.substr( position, equalPosition - position ) );
+    std::string::size_type valueStart = text.find( '"', equalPosition );
+    if ( valueStart == std::string::npos || valueStart >= end )
+    {
+      return false;
+    }
+    std::string::size_type valueEnd = text.find( '"', valueStart + 1 );
+    if ( valueEnd == std::string::npos || valueEnd >= end || name.empty() )
+    {
+      return false;
+    }
+    attributeNames.push_back( name );
+    attributeValues.push_back( text.substr( valueStart + 1, valueEnd - valueStart - 1 ) );
+    position = valueEnd + 1;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Sets the parameters of the node from attributes, the same way as when it is read from a scene file.
+static void SetNodeAttributes( vtkMRMLMarkupsToModelNode* markupsToModelNode,
+  const std::vector< std::string >& attributeNames, const std::vector< std::string >& attributeValues )
+{
+  std::vector< const char* > atts;
+  for ( size_t i = 0; i < attributeNames.size(); i++ )
+  {
+    // there is no scene, the referenced nodes could not be resolved
+    if ( attributeNames[ i ] == "references" )
+    {
+      continue;
+    }
+    atts.push_back( attributeNames[ i ].c_str() );
+    atts.push_back( attributeValues[ i ].c_str() );
+  }
+  atts.push_back( NULL );
+  markupsToModelNode->ReadXMLAttributes( &( atts[ 0 ] ) );
+}
+
+//------------------------------------------------------------------------------
+// Reads the control points of a markups fcsv file. The columns after the id are the x, y, z coordinates.
+static bool ReadFcsvPoints( const std::string& fileName, vtkPoints* points )
+{
+  std::ifstream file( fileName.c_str() );
+  if ( !file.is_open() )
+  {
+    return false;
+  }
+  std::string line;
+  while ( std::getline( file, line ) )
+  {
+    if ( line.empty() || line[ 0 ] == BATCH_FCSV_COMMENT_CHARACTER )
+    {
+      continue;
+    }
+    std::string::size_type firstComma = line.find( ',' );
+    if ( firstComma == std::string::npos )
+    {
+      continue;
+    }
+    const char* text = line.c_str() + firstComma + 1;
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    for ( int i = 0; i < 3; i++ )
+    {
+      char* numberEnd = NULL;
+      point[ i ] = strtod( text, &numberEnd );
+      if ( numberEnd == text || ( i < 2 && *numberEnd != ',' ) )
+      {
+        return false;
+      }
+      text = numberEnd + 1;
+    }
+    points->InsertNextPoint( point );
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Reads the control points of a markups json file: the "position" arrays of its control points.
+// Only the positions are needed, so the file is not parsed completely.
+static bool ReadJsonPoints( const std::string& fileName, vtkPoints* points )
+{
+  std::ifstream file( fileName.c_str() );
+  if ( !file.is_open() )
+  {
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  std::string text = buffer.str();
+
+  std::string key = "\"position\"";
+  std::string::size_type position = text.find( key );
+  while ( position != std::string::npos )
+  {
+    std::string::size_type arrayStart = text.find_first_not_of( " \t\r\n:", position + key.size() );
+    if ( arrayStart == std::string::npos || text[ arrayStart ] != '[' )
+    {
+      return false;
+    }
+    const char* numberText = text.c_str() + arrayStart + 1;
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    for ( int i = 0; i < 3; i++ )
+    {
+      char* numberEnd = NULL;
+      point[ i ] = strtod( numberText, &numberEnd );
+      if ( numberEnd == numberText )
+      {
+        return false;
+      }
+      numberText = numberEnd;
+      while ( *numberText == ',' || isspace( static_cast< unsigned char >( *numberText ) ) )
+      {
+        numberText++;
+      }
+    }
+    points->InsertNextPoint( point );
+    position = text.find( key, position + key.size() );
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Reads the points of a vtp file, the same way as the points of an input model node are used.
+static bool ReadVtpPoints( const std::string& fileName, vtkPoints* points )
+{
+  vtkSmartPointer< vtkXMLPolyDataReader > reader = vtkSmartPointer< vtkXMLPolyDataReader >::New();
+  if ( !reader->CanReadFile( fileName.c_str() ) )
+  {
+    return false;
+  }
+  reader->SetFileName( fileName.c_str() );
+  reader->Update();
+  vtkPolyData* polyData = reader->GetOutput();
+  if ( polyData == NULL || polyData->GetPoints() == NULL )
+  {
+    return false;
+  }
+  points->DeepCopy( polyData->GetPoints() );
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static bool WriteModel( const std::string& fileName, vtkPolyData* polyData )
+{
+  if ( vtksys::SystemTools::LowerCase( vtksys::SystemTools::GetFilenameLastExtension( fileName ) ) == ".vtk" )
+  {
+    vtkSmartPointer< vtkPolyDataWriter > writer = vtkSmartPointer< vtkPolyDataWriter >::New();
+    writer->SetFileName( fileName.c_str() );
+    writer->SetFileTypeToBinary();
+    writer->SetInputData( polyData );
+    return writer->Write() != 0;
+  }
+  vtkSmartPointer< vtkXMLPolyDataWriter > writer = vtkSmartPointer< vtkXMLPolyDataWriter >::New();
+  writer->SetFileName( fileName.c_str() );
+  writer->SetInputData( polyData );
+  return writer->Write() != 0;
+}
+
+//------------------------------------------------------------------------------
+// Converts a range of jobs, for vtkSMPTools::For.
+// The parameter node is shared by the threads, GenerateOutputPolyData only reads its parameters.
+class BatchJobsFunctor
+{
+public:
+  BatchJobsFunctor( const std::vector< BatchJob >& jobs, vtkMRMLMarkupsToModelNode* parameters, bool skipExisting )
+    : Jobs( jobs )
+    , Parameters( parameters )
+    , SkipExisting( skipExisting )
+    , NumberOfFailedJobs( 0 )
+    , NumberOfSkippedJobs( 0 )
+  {
+    this->OutputLock = vtkSmartPointer< vtkMutexLock >::New();
+  }
+
+  void operator()( vtkIdType firstJobIndex, vtkIdType endJobIndex )
+  {
+    for ( vtkIdType jobIndex = firstJobIndex; jobIndex < endJobIndex; jobIndex++ )
+    {
+      this->RunJob( this->Jobs[ jobIndex ] );
+    }
+  }
+
+  int GetNumberOfFailedJobs() const { return this->NumberOfFailedJobs; }
+  int GetNumberOfSkippedJobs() const { return this->NumberOfSkippedJobs; }
+
+private:
+  void RunJob( const BatchJob& job )
+  {
+    if ( this->SkipExisting && vtksys::SystemTools::FileExists( job.OutputFileName.c_str() ) )
+    {
+      this->Report( job, "skipped (output exists)", false, true );
+      return;
+    }
+
+    // all data of the job is released when it is done, so the memory use only depends on the number of threads
+    vtkSmartPointer< vtkSlicerMarkupsToModelUpdateStatistics > statistics = vtkSmartPointer< vtkSlicerMarkupsToModelUpdateStatistics >::New();
+    double stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+    vtkSmartPointer< vtkPoints > controlPoints = vtkSmartPointer< vtkPoints >::New();
+    std::string inputFileType = GetInputFileType( job.InputFileName );
+    bool pointsRead = false;
+    if ( inputFileType == "fcsv" )
+    {
+      pointsRead = ReadFcsvPoints( job.InputFileName, controlPoints );
+    }
+    else if ( inputFileType == "json" )
+    {
+      pointsRead = ReadJsonPoints( job.InputFileName, controlPoints );
+    }
+    else if ( inputFileType == "vtp" )
+    {
+      pointsRead = ReadVtpPoints( job.InputFileName, controlPoints );
+    }
+    if ( !pointsRead )
+    {
+      this->Report( job, "failed to read points", true, false );
+      return;
+    }
+    statistics->AddPointsStage( "reading", stageStartTime, controlPoints );
+
+    vtkSmartPointer< vtkPolyData > outputPolyData = vtkSmartPointer< vtkPolyData >::New();
+    if ( !vtkSlicerMarkupsToModelLogic::GenerateOutputPolyData( controlPoints, this->Parameters, outputPolyData, statistics ) )
+    {
+      this->Report( job, "failed to generate model", true, false );
+      return;
+    }
+
+    stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+    if ( !WriteModel( job.OutputFileName, outputPolyData ) )
+    {
+      this->Report( job, "failed to write model", true, false );
+      return;
+    }
+    statistics->AddPolyDataStage( "writing", stageStartTime, outputPolyData );
+
+    std::stringstream message;
+    message << controlPoints->GetNumberOfPoints() << " points, " << statistics->GetTotalDuration() << " s";
+    this->Report( job, message.str(), false, false );
+  }
+
+  void Report( const BatchJob& job, const std::string& message, bool failed, bool skipped )
+  {
+    this->OutputLock->Lock();
+    if ( failed )
+    {
+      this->NumberOfFailedJobs++;
+      std::cerr << job.InputFileName << ": " << message << std::endl;
+    }
+    else
+    {
+      if ( skipped )
+      {
+        this->NumberOfSkippedJobs++;
+      }
+      std::cout << job.InputFileName << " -> " << job.OutputFileName << ": " << message << std::endl;
+    }
+    this->OutputLock->Unlock();
+  }
+
+  const std::vector< BatchJob >& Jobs;
+  vtkMRMLMarkupsToModelNode* Parameters;
+  bool SkipExisting;
+  // protected by OutputLock
+  int NumberOfFailedJobs;
+  int NumberOfSkippedJobs;
+  vtkSmartPointer< vtkMutexLock > OutputLock;
+};
+
+//------------------------------------------------------------------------------
+int main( int argc, char* argv[] )
+{
+  std::string outputDirectory;
+  std::string presetFileName;
+  std::string outputExtension = BATCH_OUTPUT_EXTENSION_DEFAULT;
+  std::vector< std::string > parameterOverrides;
+  std::vector< std::string > inputFileNames;
+  int numberOfThreads = 0; // default of vtkSMPTools, typically the number of cores
+  bool skipExisting = false;
+  bool inputsValid = true;
+  for ( int i = 1; i < argc; i++ )
+  {
+    if ( strcmp( argv[ i ], "--output-directory" ) == 0 && i + 1 < argc )
+    {
+      outputDirectory = argv[ ++i ];
+    }
+    else if ( strcmp( argv[ i ], "--preset" ) == 0 && i + 1 < argc )
+    {
+      presetFileName = argv[ ++i ];
+    }
+    else if ( strcmp( argv[ i ], "--set" ) == 0 && i + 1 < argc )
+    {
+      parameterOverrides.push_back( argv[ ++i ] );
+    }
+    else if ( strcmp( argv[ i ], "--threads" ) == 0 && i + 1 < argc )
+    {
+      numberOfThreads = std::max( 0, atoi( argv[ ++i ] ) );
+    }
+    else if ( strcmp( argv[ i ], "--output-extension" ) == 0 && i + 1 < argc )
+    {
+      outputExtension = vtksys::SystemTools::LowerCase( argv[ ++i ] );
+    }
+    else if ( strcmp( argv[ i ], "--skip-existing" ) == 0 )
+    {
+      skipExisting = true;
+    }
+    else if ( strcmp( argv[ i ], "--manifest" ) == 0 && i + 1 < argc )
+    {
+      inputsValid = AddManifestInputs( argv[ ++i ], inputFileNames ) && inputsValid;
+    }
+    else if ( argv[ i ][ 0 ] != '-' )
+    {
+      inputsValid = AddInput( argv[ i ], inputFileNames ) && inputsValid;
+    }
+    else
+    {
+      PrintUsage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+  }
+  if ( outputDirectory.empty() || ( outputExtension != "vtp" && outputExtension != "vtk" ) )
+  {
+    PrintUsage( argv[ 0 ] );
+    return EXIT_FAILURE;
+  }
+  if ( !inputsValid )
+  {
+    return EXIT_FAILURE;
+  }
+
+  // parameters
+  std::vector< std::string > attributeNames;
+  std::vector< std::string > attributeValues;
+  vtkSmartPointer< vtkMRMLMarkupsToModelNode > parameters = vtkSmartPointer< vtkMRMLMarkupsToModelNode >::New();
+  if ( !presetFileName.empty() )
+  {
+    std::ifstream presetFile( presetFileName.c_str() );
+    if ( !presetFile.is_open() )
+    {
+      std::cerr << "Failed to open preset " << presetFileName << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::stringstream preset;
+    preset << presetFile.rdbuf();
+    if ( !ParseAttributes( preset.str(), parameters->GetNodeTagName(), attributeNames, attributeValues ) )
+    {
+      std::cerr << "Failed to parse preset " << presetFileName << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  for ( size_t i = 0; i < parameterOverrides.size(); i++ )
+  {
+    std::string::size_type equalPosition = parameterOverrides[ i ].find( '=' );
+    if ( equalPosition == std::string::npos || equalPosition == 0 )
+    {
+      std::cerr << "Invalid parameter " << parameterOverrides[ i ] << ", expected Name=value" << std::endl;
+      return EXIT_FAILURE;
+    }
+    // attributes are read in order, so the overrides are applied after the preset
+    attributeNames.push_back( parameterOverrides[ i ].substr( 0, equalPosition ) );
+    attributeValues.push_back( parameterOverrides[ i ].substr( equalPosition + 1 ) );
+  }
+  SetNodeAttributes( parameters, attributeNames, attributeValues );
+
+  // jobs, the models are named after the inputs
+  if ( !vtksys::SystemTools::MakeDirectory( outputDirectory.c_str() ) )
+  {
+    std::cerr << "Failed to create output directory " << outputDirectory << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::vector< BatchJob > jobs;
+  std::set< std::string > outputFileNames;
+  for ( size_t i = 0; i < inputFileNames.size(); i++ )
+  {
+    if ( GetInputFileType( inputFileNames[ i ] ).empty() )
+    {
+      std::cerr << "Input " << inputFileNames[ i ] << " is not a fcsv, json or vtp file" << std::endl;
+      return EXIT_FAILURE;
+    }
+    BatchJob job;
+    job.InputFileName = inputFileNames[ i ];
+    std::string modelName = GetModelName( inputFileNames[ i ] );
+    job.OutputFileName = outputDirectory + "/" + modelName + "." + outputExtension;
+    // inputs with the same name in different directories
+    for ( int duplicateIndex = 1; outputFileNames.count( job.OutputFileName ) > 0; duplicateIndex++ )
+    {
+      std::stringstream outputFileName;
+      outputFileName << outputDirectory << "/" << modelName << "_" << duplicateIndex << "." << outputExtension;
+      job.OutputFileName = outputFileName.str();
+    }
+    outputFileNames.insert( job.OutputFileName );
+    jobs.push_back( job );
+  }
+  if ( jobs.empty() )
+  {
+    std::cerr << "No input files" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // one job at a time per thread
+  vtkSMPTools::Initialize( numberOfThreads );
+  BatchJobsFunctor runJobs( jobs, parameters, skipExisting );
+  vtkSMPTools::For( 0, static_cast< vtkIdType >( jobs.size() ), 1, runJobs );
+
+  int numberOfFailedJobs = runJobs.GetNumberOfFailedJobs();
+  std::cout << jobs.size() - numberOfFailedJobs - runJobs.GetNumberOfSkippedJobs() << " models written, "
+    << runJobs.GetNumberOfSkippedJobs() << " skipped, " << numberOfFailedJobs << " failed" << std::endl;
+  return numberOfFailedJobs == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
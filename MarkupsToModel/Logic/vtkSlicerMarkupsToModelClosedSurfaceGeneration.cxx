@@ -1,28 +1,86 @@
 #include "vtkSlicerMarkupsToModelClosedSurfaceGeneration.h"
+#include "vtkSlicerMarkupsToModelConvexHullFilter.h"
+#include "vtkSlicerMarkupsToModelIncrementalSurface.h"
+#include "vtkSlicerMarkupsToModelPointProcessing.h"
+#include "vtkSlicerMarkupsToModelScratchBuffers.h"
+#include "vtkSlicerMarkupsToModelSubdivisionFilter.h"
+#include "vtkSlicerMarkupsToModelUpdateStatistics.h"
 
 #include "vtkMRMLModelNode.h"
 #include "vtkMRMLMarkupsFiducialNode.h"
 
-#include <vtkButterflySubdivisionFilter.h>
+#include <vtkCellArray.h>
 #include <vtkCleanPolyData.h>
 #include <vtkCubeSource.h>
 #include <vtkDataSetSurfaceFilter.h>
 #include <vtkDelaunay3D.h>
+#include <vtkDoubleArray.h>
+#include <vtkFieldData.h>
+#include <vtkFlyingEdges3D.h>
 #include <vtkGlyph3D.h>
-#include <vtkLinearSubdivisionFilter.h>
 #include <vtkLineSource.h>
+#include <vtkMath.h>
+#include <vtkMutexLock.h>
 #include <vtkNew.h>
-#include <vtkOBBTree.h>
 #include <vtkPolyDataNormals.h>
 #include <vtkRegularPolygonSource.h>
-#include <vtkTransform.h>
-#include <vtkTransformFilter.h>
+#include <vtkSurfaceReconstructionFilter.h>
+#include <vtkTrivialProducer.h>
 #include <vtkUnstructuredGrid.h>
 
+// std includes
+#include <algorithm>
+#include <cmath>
+
 //------------------------------------------------------------------------------
 // constants within this file
 static const double COMPARE_TO_ZERO_TOLERANCE = 0.0001;
 static const double MINIMUM_SURFACE_EXTRUSION_AMOUNT = 0.01; // if a surface is flat/linear, give it at least this much depth
+static const int IMPLICIT_SURFACE_MINIMUM_NUMBER_OF_POINTS = 20; // fewer points do not describe the surface well enough for fitting
+static const int BUTTERFLY_NUMBER_OF_SUBDIVISIONS_DEFAULT = 3;
+static const char* SURFACE_VOLUME_ARRAY_NAME = "Volume";
+static const char* SURFACE_AREA_ARRAY_NAME = "SurfaceArea";
+
+//------------------------------------------------------------------------------
+// Add the signed volume of the tetrahedron between the triangle and the origin, and the area of the triangle
+static void AddTriangleMeasures(const double point0[3], const double point1[3], const double point2[3], double& volume, double& area)
+{
+  double cross[3];
+  vtkMath::Cross(point1, point2, cross);
+  volume += vtkMath::Dot(point0, cross) / 6.0;
+  double edge1[3] = { point1[0] - point0[0], point1[1] - point0[1], point1[2] - point0[2] };
+  double edge2[3] = { point2[0] - point0[0], point2[1] - point0[1], point2[2] - point0[2] };
+  vtkMath::Cross(edge1, edge2, cross);
+  area += 0.5 * vtkMath::Norm(cross);
+}
+
+//------------------------------------------------------------------------------
+static double GetSurfaceMeasure(vtkPolyData* surfacePolyData, const char* arrayName)
+{
+  if (surfacePolyData == NULL || surfacePolyData->GetFieldData() == NULL)
+  {
+    return 0.0;
+  }
+  vtkDataArray* measureArray = surfacePolyData->GetFieldData()->GetArray(arrayName);
+  if (measureArray == NULL || measureArray->GetNumberOfTuples() == 0)
+  {
+    return 0.0;
+  }
+  return measureArray->GetTuple1(0);
+}
+
+//------------------------------------------------------------------------------
+static void StoreSurfaceMeasures(vtkPolyData* surfacePolyData, double volume, double area)
+{
+  vtkSmartPointer< vtkDoubleArray > volumeArray = vtkSmartPointer< vtkDoubleArray >::New();
+  volumeArray->SetName(SURFACE_VOLUME_ARRAY_NAME);
+  volumeArray->InsertNextValue(volume);
+  surfacePolyData->GetFieldData()->AddArray(volumeArray);
+  vtkSmartPointer< vtkDoubleArray > areaArray = vtkSmartPointer< vtkDoubleArray >::New();
+  areaArray->SetName(SURFACE_AREA_ARRAY_NAME);
+  areaArray->InsertNextValue(area);
+  surfacePolyData->GetFieldData()->AddArray(areaArray);
+}
 
 //------------------------------------------------------------------------------
 vtkStandardNewMacro( vtkSlicerMarkupsToModelClosedSurfaceGeneration );
@@ -30,6 +88,82 @@ vtkStandardNewMacro( vtkSlicerMarkupsToModelClosedSurfaceGeneration );
 //------------------------------------------------------------------------------
 vtkSlicerMarkupsToModelClosedSurfaceGeneration::vtkSlicerMarkupsToModelClosedSurfaceGeneration()
 {
+  this->DecimationSpacing = 0.0;
+  this->DecimationTargetNumberOfPoints = 0;
+  this->NumberOfSubdivisions = BUTTERFLY_NUMBER_OF_SUBDIVISIONS_DEFAULT;
+  this->SinglePrecisionOutput = false;
+  this->IncrementalDelaunay = false;
+  this->AbortUpdate = false;
+  this->AbortUpdateMutex = vtkSmartPointer< vtkMutexLock >::New();
+  this->PointArrangementOfInput = POINT_ARRANGEMENT_SINGULAR;
+  this->InputPoints = vtkSmartPointer< vtkPoints >::New();
+  this->DecimatedInputPoints = vtkSmartPointer< vtkPoints >::New();
+  this->SinglePrecisionInputPoints = vtkSmartPointer< vtkPoints >::New();
+  this->SinglePrecisionInputPoints->SetDataTypeToFloat();
+  this->InputDecimationSpacing = 0.0;
+  this->InputDecimationTargetNumberOfPoints = 0;
+  this->InputSinglePrecisionOutput = false;
+  // the connectivity of the input points is reused between updates, to keep its memory
+  this->InputCellArray = vtkSmartPointer< vtkCellArray >::New();
+  this->InputPolyData = vtkSmartPointer< vtkPolyData >::New();
+  this->InputProducer = vtkSmartPointer< vtkTrivialProducer >::New();
+  this->InputProducer->SetOutput(this->InputPolyData);
+  this->BoundingAxesToRasTransformMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  this->SmallestBoundingExtentRanges[0] = 0.0;
+  this->SmallestBoundingExtentRanges[1] = 0.0;
+  this->SmallestBoundingExtentRanges[2] = 0.0;
+
+  // sources that give depth to singular, linear and planar point sets
+  this->CubeSource = vtkSmartPointer< vtkCubeSource >::New();
+  this->SquareSource = vtkSmartPointer< vtkRegularPolygonSource >::New();
+  this->SquareSource->SetCenter(0.0, 0.0, 0.0);
+  this->SquareSource->SetNumberOfSides(4);
+  this->LineSource = vtkSmartPointer< vtkLineSource >::New();
+  this->Glyph = vtkSmartPointer< vtkGlyph3D >::New();
+  this->Glyph->SetInputConnection(this->InputProducer->GetOutputPort());
+
+  this->Delaunay = vtkSmartPointer< vtkDelaunay3D >::New();
+  this->Delaunay->AlphaTrisOff();
+  this->Delaunay->AlphaLinesOff();
+  this->Delaunay->AlphaVertsOff();
+  this->SurfaceFilter = vtkSmartPointer< vtkDataSetSurfaceFilter >::New();
+  this->SurfaceFilter->SetInputConnection(this->Delaunay->GetOutputPort());
+  this->IncrementalSurface = vtkSmartPointer< vtkSlicerMarkupsToModelIncrementalSurface >::New();
+  this->IncrementalSurfaceInputTime = 0;
+  this->IncrementalSurfacePolyData = vtkSmartPointer< vtkPolyData >::New();
+  this->IncrementalSurfaceProducer = vtkSmartPointer< vtkTrivialProducer >::New();
+  this->IncrementalSurfaceProducer->SetOutput(this->IncrementalSurfacePolyData);
+  this->IncrementalSubdividedPolyData = vtkSmartPointer< vtkPolyData >::New();
+  this->IncrementalNumberOfSubdivisions = -1;
+  this->IncrementalButterflyScheme = false;
+  this->InputConvexHull = vtkSmartPointer< vtkSlicerMarkupsToModelConvexHullFilter >::New();
+  // implicit surface: signed distance function estimated from the local tangent planes of the points,
+  // contoured at zero. Only used for non-planar points, so no extrusion is needed.
+  this->SurfaceReconstruction = vtkSmartPointer< vtkSurfaceReconstructionFilter >::New();
+  this->SurfaceReconstruction->SetInputConnection(this->InputProducer->GetOutputPort());
+  this->SurfaceContour = vtkSmartPointer< vtkFlyingEdges3D >::New();
+  this->SurfaceContour->SetInputConnection(this->SurfaceReconstruction->GetOutputPort());
+  this->SurfaceContour->SetValue(0, 0.0);
+  this->SurfaceContour->ComputeNormalsOff();
+  this->SurfaceContour->ComputeGradientsOff();
+  this->SurfaceContour->ComputeScalarsOff();
+
+  // the input of the orientation filter is the output of the selected surface generation method.
+  // The triangles are oriented consistently before subdivision, which keeps the orientation,
+  // so that the normals can be computed together with the subdivision.
+  this->Orientation = vtkSmartPointer< vtkPolyDataNormals >::New();
+  this->Orientation->ComputePointNormalsOff();
+  this->Orientation->ComputeCellNormalsOn(); // the filter does not process the triangles if it computes no normals at all
+  this->Orientation->SplittingOff();
+  this->Orientation->ConsistencyOn();
+  this->Subdivision = vtkSmartPointer< vtkSlicerMarkupsToModelSubdivisionFilter >::New();
+  this->Subdivision->SetInputConnection(this->Orientation->GetOutputPort());
+  this->ConvexHull = vtkSmartPointer< vtkSlicerMarkupsToModelConvexHullFilter >::New();
+  this->ConvexHull->SetInputConnection(this->Subdivision->GetOutputPort());
+
+  // normals of the outputs that are not computed by the subdivision filter
+  this->Normals = vtkSmartPointer< vtkPolyDataNormals >::New();
+  this->Normals->SetFeatureAngle(100); // TODO: This needs some justification, or set as an input parameter
 }
 
 //------------------------------------------------------------------------------
@@ -37,9 +171,75 @@ vtkSlicerMarkupsToModelClosedSurfaceGeneration::~vtkSlicerMarkupsToModelClosedSu
 {
 }
 
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelClosedSurfaceGeneration::SetScratchBuffers(vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers)
+{
+  if (this->ScratchBuffers.GetPointer() == scratchBuffers)
+  {
+    return;
+  }
+  this->ScratchBuffers = scratchBuffers;
+  this->Modified();
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelScratchBuffers* vtkSlicerMarkupsToModelClosedSurfaceGeneration::GetScratchBuffers()
+{
+  return this->ScratchBuffers;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelClosedSurfaceGeneration::SetAbortUpdate(bool abortUpdate)
+{
+  this->AbortUpdateMutex->Lock();
+  this->AbortUpdate = abortUpdate;
+  this->AbortUpdateMutex->Unlock();
+  if (!abortUpdate)
+  {
+    return;
+  }
+  // the filters reset their flag when they start executing, the ones that have not started yet are skipped by CheckAbortUpdate
+  vtkAlgorithm* filters[] = { this->Glyph, this->Delaunay, this->SurfaceFilter, this->InputConvexHull, this->SurfaceReconstruction,
+    this->SurfaceContour, this->Orientation, this->Subdivision, this->ConvexHull, this->Normals };
+  for (unsigned int i = 0; i < sizeof(filters) / sizeof(filters[0]); i++)
+  {
+    filters[i]->SetAbortExecute(1);
+  }
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelClosedSurfaceGeneration::GetAbortUpdate()
+{
+  this->AbortUpdateMutex->Lock();
+  bool abortUpdate = this->AbortUpdate;
+  this->AbortUpdateMutex->Unlock();
+  return abortUpdate;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelClosedSurfaceGeneration::CheckAbortUpdate()
+{
+  if (!this->GetAbortUpdate())
+  {
+    return false;
+  }
+  this->InputPoints->Reset();
+  this->InputPoints->Modified();
+  return true;
+}
+
 //------------------------------------------------------------------------------
 bool vtkSlicerMarkupsToModelClosedSurfaceGeneration::GenerateClosedSurfaceModel(vtkPoints* inputPoints, vtkPolyData* outputPolyData,
-  double delaunayAlpha, bool smoothing, bool forceConvex)
+  double delaunayAlpha, bool smoothing, bool forceConvex, int surfaceGenerationMethod, vtkSlicerMarkupsToModelUpdateStatistics* statistics)
+{
+  vtkSmartPointer< vtkSlicerMarkupsToModelClosedSurfaceGeneration > closedSurfaceGenerator = vtkSmartPointer< vtkSlicerMarkupsToModelClosedSurfaceGeneration >::New();
+  return closedSurfaceGenerator->UpdateClosedSurfaceModel(inputPoints, outputPolyData, delaunayAlpha, smoothing, forceConvex,
+    surfaceGenerationMethod, statistics);
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelClosedSurfaceGeneration::UpdateClosedSurfaceModel(vtkPoints* inputPoints, vtkPolyData* outputPolyData,
+  double delaunayAlpha, bool smoothing, bool forceConvex, int surfaceGenerationMethod, vtkSlicerMarkupsToModelUpdateStatistics* statistics)
 {  
   if (inputPoints == NULL)
   {
@@ -60,110 +260,151 @@ bool vtkSlicerMarkupsToModelClosedSurfaceGeneration::GenerateClosedSurfaceModel(
     return true;
   }
 
-  vtkSmartPointer< vtkCellArray > inputCellArray = vtkSmartPointer< vtkCellArray >::New();
-  inputCellArray->InsertNextCell(numberOfPoints);
-  for (int i = 0; i < numberOfPoints; i++)
+  if (this->CheckAbortUpdate())
   {
-    inputCellArray->InsertCellPoint(i);
+    return false;
   }
+  double stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
 
-  vtkSmartPointer< vtkPolyData > inputPolyData = vtkSmartPointer< vtkPolyData >::New();
-  inputPolyData->SetLines(inputCellArray);
-  inputPolyData->SetPoints(inputPoints);
-
-  vtkSmartPointer< vtkDelaunay3D > delaunay = vtkSmartPointer< vtkDelaunay3D >::New();
-  delaunay->SetAlpha(delaunayAlpha);
-  delaunay->AlphaTrisOff();
-  delaunay->AlphaLinesOff();
-  delaunay->AlphaVertsOff();
+  // The input of the pipeline is only modified if the points or their decimation are different from the
+  // previous update, so that filters upstream of a changed parameter are not executed again.
+  bool inputPointsChanged = !this->IsInputPointsEqual(inputPoints);
+  if (inputPointsChanged)
+  {
+    this->InputPoints->DeepCopy(inputPoints);
 
-  vtkSmartPointer< vtkMatrix4x4 > boundingAxesToRasTransformMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
-  ComputeTransformMatrixFromBoundingAxes(inputPoints, boundingAxesToRasTransformMatrix);
+    // the arrangement of all points is used, so that decimation cannot change it
+    this->PointArrangementOfInput = ComputeBoundingAxesAndPointArrangement(this->InputPoints,
+      this->BoundingAxesToRasTransformMatrix, this->SmallestBoundingExtentRanges);
+    if (this->PointArrangementOfInput == POINT_ARRANGEMENT_SINGULAR && numberOfPoints > 1)
+    {
+      vtkGenericWarningMacro( "There is more than one input point, but they form a singularity. " <<
+                              "Giving depth of " << MINIMUM_SURFACE_EXTRUSION_AMOUNT << "." );
+    }
+  }
+  PointArrangement pointArrangement = this->PointArrangementOfInput;
 
-  vtkSmartPointer< vtkMatrix4x4 > rasToBoundingAxesTransformMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
-  vtkMatrix4x4::Invert(boundingAxesToRasTransformMatrix, rasToBoundingAxesTransformMatrix);
+  if (inputPointsChanged || this->InputDecimationSpacing != this->DecimationSpacing
+    || this->InputDecimationTargetNumberOfPoints != this->DecimationTargetNumberOfPoints
+    || this->InputSinglePrecisionOutput != this->SinglePrecisionOutput)
+  {
+    this->InputDecimationSpacing = this->DecimationSpacing;
+    this->InputDecimationTargetNumberOfPoints = this->DecimationTargetNumberOfPoints;
+    this->InputSinglePrecisionOutput = this->SinglePrecisionOutput;
+    double decimationVoxelSize = this->DecimationSpacing;
+    if (decimationVoxelSize <= 0.0)
+    {
+      decimationVoxelSize = vtkSlicerMarkupsToModelPointProcessing::ComputeDecimationVoxelSize(this->InputPoints, this->DecimationTargetNumberOfPoints,
+        this->ScratchBuffers);
+    }
+    vtkPoints* pipelinePoints = this->InputPoints;
+    if (decimationVoxelSize > 0.0)
+    {
+      this->DecimatedInputPoints->DeepCopy(this->InputPoints);
+      vtkSlicerMarkupsToModelPointProcessing::DecimatePoints(this->DecimatedInputPoints, decimationVoxelSize, this->ScratchBuffers);
+      pipelinePoints = this->DecimatedInputPoints;
+    }
+    if (this->SinglePrecisionOutput && pipelinePoints->GetDataType() != VTK_FLOAT)
+    {
+      // the filters keep the precision of their input, so the whole pipeline produces single precision points
+      this->SinglePrecisionInputPoints->GetData()->DeepCopy(pipelinePoints->GetData());
+      this->SinglePrecisionInputPoints->Modified();
+      pipelinePoints = this->SinglePrecisionInputPoints;
+    }
 
-  double smallestBoundingExtentRanges[3] = { 0.0, 0.0, 0.0 }; // temporary values
-  ComputeTransformedExtentRanges(inputPoints, rasToBoundingAxesTransformMatrix, smallestBoundingExtentRanges);
+    vtkIdType numberOfPipelinePoints = pipelinePoints->GetNumberOfPoints();
+    this->InputCellArray->Reset();
+    this->InputCellArray->InsertNextCell(numberOfPipelinePoints);
+    for (vtkIdType i = 0; i < numberOfPipelinePoints; i++)
+    {
+      this->InputCellArray->InsertCellPoint(i);
+    }
+    this->InputCellArray->Modified();
+    this->InputPolyData->SetLines(this->InputCellArray);
+    // the cell array is the same object as before, the cells of the poly data are rebuilt from its new contents when needed
+    this->InputPolyData->DeleteCells();
+    this->InputPolyData->SetPoints(pipelinePoints);
+    this->InputPolyData->Modified();
+  }
+  vtkIdType numberOfPipelinePoints = this->InputPolyData->GetNumberOfPoints();
 
-  PointArrangement pointArrangement = ComputePointArrangement(smallestBoundingExtentRanges);
+  if (surfaceGenerationMethod < 0 || surfaceGenerationMethod >= vtkMRMLMarkupsToModelNode::SurfaceGenerationMethod_Last)
+  {
+    vtkGenericWarningMacro("Unsupported surface generation method: " << surfaceGenerationMethod << ". Using Delaunay.");
+    surfaceGenerationMethod = vtkMRMLMarkupsToModelNode::DelaunaySurface;
+  }
+  if (surfaceGenerationMethod == vtkMRMLMarkupsToModelNode::ImplicitSurface
+    && (pointArrangement != POINT_ARRANGEMENT_NONPLANAR || numberOfPipelinePoints < IMPLICIT_SURFACE_MINIMUM_NUMBER_OF_POINTS))
+  {
+    // the tangent planes cannot be estimated, a surface around the extruded points is generated instead
+    surfaceGenerationMethod = vtkMRMLMarkupsToModelNode::DelaunaySurface;
+  }
 
+  // points that the surface is generated around, extruded if they do not span a volume
+  vtkAlgorithmOutput* surfaceInputPort = NULL;
   switch (pointArrangement)
   {
     case POINT_ARRANGEMENT_SINGULAR:
     {
-      vtkSmartPointer<vtkCubeSource> cubeSource = vtkSmartPointer<vtkCubeSource>::New();
       // there is only one point, we cannot compute extent or extrusion from this.
       double extrusionMagnitude = MINIMUM_SURFACE_EXTRUSION_AMOUNT;
-      if ( numberOfPoints > 1 )
-      {
-        vtkGenericWarningMacro( "There is more than one input point, but they form a singularity. " <<
-                                "Giving depth of " << MINIMUM_SURFACE_EXTRUSION_AMOUNT << "." );
-      }
-      cubeSource->SetBounds(-extrusionMagnitude, extrusionMagnitude,
+      this->CubeSource->SetBounds(-extrusionMagnitude, extrusionMagnitude,
         -extrusionMagnitude, extrusionMagnitude,
         -extrusionMagnitude, extrusionMagnitude);
 
-      vtkSmartPointer<vtkGlyph3D> glyph = vtkSmartPointer<vtkGlyph3D>::New();
-      glyph->SetSourceConnection(cubeSource->GetOutputPort());
-      glyph->SetInputData(inputPolyData);
-      glyph->Update();
+      this->Glyph->SetSourceConnection(this->CubeSource->GetOutputPort());
+      this->Glyph->SetOutputPointsPrecision(this->SinglePrecisionOutput ? vtkAlgorithm::SINGLE_PRECISION : vtkAlgorithm::DEFAULT_PRECISION);
+      this->Glyph->Update();
 
-      delaunay->SetInputConnection(glyph->GetOutputPort());
+      surfaceInputPort = this->Glyph->GetOutputPort();
 
       break;
     }
     case POINT_ARRANGEMENT_LINEAR:
     {
       // draw a "square" around the line (make it a rectangular prism)
-      vtkSmartPointer<vtkRegularPolygonSource> squareSource = vtkSmartPointer<vtkRegularPolygonSource>::New();
-      squareSource->SetCenter(0.0, 0.0, 0.0);
-      double extrusionMagnitude = ComputeSurfaceExtrusionAmount(smallestBoundingExtentRanges); // need to give some depth
-      squareSource->SetRadius(extrusionMagnitude);
-      squareSource->SetNumberOfSides(4);
+      double extrusionMagnitude = ComputeSurfaceExtrusionAmount(this->SmallestBoundingExtentRanges); // need to give some depth
+      this->SquareSource->SetRadius(extrusionMagnitude);
       double lineAxis[3] = { 0.0, 0.0, 0.0 }; // temporary values
       const int LINE_AXIS_INDEX = 0; // The largest (and only meaningful) axis is in the 0th column
       // the bounding axes are stored in the columns of transformFromBoundingAxes
-      GetNthColumnInMatrix(boundingAxesToRasTransformMatrix, LINE_AXIS_INDEX, lineAxis);
-      squareSource->SetNormal(lineAxis);
+      GetNthColumnInMatrix(this->BoundingAxesToRasTransformMatrix, LINE_AXIS_INDEX, lineAxis);
+      this->SquareSource->SetNormal(lineAxis);
 
-      vtkSmartPointer<vtkGlyph3D> glyph = vtkSmartPointer<vtkGlyph3D>::New();
-      glyph->SetSourceConnection(squareSource->GetOutputPort());
-      glyph->SetInputData(inputPolyData);
-      glyph->Update();
+      this->Glyph->SetSourceConnection(this->SquareSource->GetOutputPort());
+      this->Glyph->SetOutputPointsPrecision(this->SinglePrecisionOutput ? vtkAlgorithm::SINGLE_PRECISION : vtkAlgorithm::DEFAULT_PRECISION);
+      this->Glyph->Update();
 
-      delaunay->SetInputConnection(glyph->GetOutputPort());
+      surfaceInputPort = this->Glyph->GetOutputPort();
 
       break;
     }
     case POINT_ARRANGEMENT_PLANAR:
     {
       // extrude additional points on either side of the plane
-      vtkSmartPointer<vtkLineSource> lineSource = vtkSmartPointer<vtkLineSource>::New();
       double planeNormal[3] = { 0.0, 0.0, 0.0 }; // temporary values
       const int PLANE_NORMAL_INDEX = 2; // The plane normal has the smallest variation, and is stored in the last column
       // the bounding axes are stored in the columns of transformFromBoundingAxes
-      GetNthColumnInMatrix(boundingAxesToRasTransformMatrix, PLANE_NORMAL_INDEX, planeNormal);
-      double extrusionMagnitude = ComputeSurfaceExtrusionAmount(smallestBoundingExtentRanges); // need to give some depth
+      GetNthColumnInMatrix(this->BoundingAxesToRasTransformMatrix, PLANE_NORMAL_INDEX, planeNormal);
+      double extrusionMagnitude = ComputeSurfaceExtrusionAmount(this->SmallestBoundingExtentRanges); // need to give some depth
       double point1[3] = { planeNormal[0], planeNormal[1], planeNormal[2] };
       vtkMath::MultiplyScalar(point1, extrusionMagnitude);
-      lineSource->SetPoint1(point1);
+      this->LineSource->SetPoint1(point1);
       double point2[3] = { planeNormal[0], planeNormal[1], planeNormal[2] };
       vtkMath::MultiplyScalar(point2, -extrusionMagnitude);
-      lineSource->SetPoint2(point2);
+      this->LineSource->SetPoint2(point2);
 
-      vtkSmartPointer<vtkGlyph3D> glyph = vtkSmartPointer<vtkGlyph3D>::New();
-      glyph->SetSourceConnection(lineSource->GetOutputPort());
-      glyph->SetInputData(inputPolyData);
-      glyph->Update();
+      this->Glyph->SetSourceConnection(this->LineSource->GetOutputPort());
+      this->Glyph->SetOutputPointsPrecision(this->SinglePrecisionOutput ? vtkAlgorithm::SINGLE_PRECISION : vtkAlgorithm::DEFAULT_PRECISION);
+      this->Glyph->Update();
 
-      delaunay->SetInputConnection(glyph->GetOutputPort());
+      surfaceInputPort = this->Glyph->GetOutputPort();
 
       break;
     }
     case POINT_ARRANGEMENT_NONPLANAR:
     {
-      delaunay->SetInputData(inputPolyData);
+      surfaceInputPort = this->InputProducer->GetOutputPort();
       break;
     }
     default: // unsupported or invalid
@@ -173,57 +414,319 @@ bool vtkSlicerMarkupsToModelClosedSurfaceGeneration::GenerateClosedSurfaceModel(
     }
   }
 
-  vtkSmartPointer< vtkDataSetSurfaceFilter > surfaceFilter = vtkSmartPointer< vtkDataSetSurfaceFilter >::New();
-  surfaceFilter->SetInputConnection(delaunay->GetOutputPort());
-  surfaceFilter->Update();
+  if (this->CheckAbortUpdate())
+  {
+    return false;
+  }
+  if (statistics != NULL)
+  {
+    // point arrangement analysis, decimation and extrusion of degenerate point sets
+    statistics->AddStage("point arrangement", stageStartTime, numberOfPipelinePoints, 0, 0);
+    stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+  }
+
+  // The boundary of the Delaunay tetrahedralization without alpha filtering is the convex hull of the points,
+  // which the incremental surface updates locally
+  bool incrementalSurface = (this->IncrementalDelaunay && surfaceGenerationMethod == vtkMRMLMarkupsToModelNode::DelaunaySurface
+    && delaunayAlpha <= 0.0 && pointArrangement == POINT_ARRANGEMENT_NONPLANAR);
+  if (!this->IncrementalDelaunay)
+  {
+    this->IncrementalSurface->Reset();
+    this->IncrementalSurfaceInputTime = 0;
+  }
+  else if (incrementalSurface && this->IncrementalSurfaceInputTime != this->InputPolyData->GetMTime())
+  {
+    if (this->IncrementalSurface->UpdatePoints(this->InputPolyData->GetPoints()))
+    {
+      this->IncrementalSurfaceInputTime = this->InputPolyData->GetMTime();
+      this->IncrementalSurface->GetSurface(this->IncrementalSurfacePolyData);
+    }
+    else
+    {
+      // the points are too close to a plane for the tolerance of the hull
+      this->IncrementalSurfaceInputTime = 0;
+      incrementalSurface = false;
+    }
+  }
 
-  vtkSmartPointer<vtkPolyDataNormals> normals = vtkSmartPointer<vtkPolyDataNormals>::New();
-  normals->SetFeatureAngle(100); // TODO: This needs some justification, or set as an input parameter
+  vtkAlgorithmOutput* surfaceOutputPort = NULL;
+  switch (surfaceGenerationMethod)
+  {
+    case vtkMRMLMarkupsToModelNode::ConvexHullSurface:
+    {
+      this->InputConvexHull->SetInputConnection(surfaceInputPort);
+      this->InputConvexHull->Update();
+      if (statistics != NULL)
+      {
+        statistics->AddPolyDataStage("quickhull", stageStartTime, this->InputConvexHull->GetOutput());
+        stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+      }
+      surfaceOutputPort = this->InputConvexHull->GetOutputPort();
+      break;
+    }
+    case vtkMRMLMarkupsToModelNode::ImplicitSurface:
+    {
+      this->SurfaceContour->Update();
+      if (statistics != NULL)
+      {
+        statistics->AddPolyDataStage("implicit surface", stageStartTime, this->SurfaceContour->GetOutput());
+        stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+      }
+      surfaceOutputPort = this->SurfaceContour->GetOutputPort();
+      break;
+    }
+    default:
+    {
+      if (incrementalSurface)
+      {
+        if (statistics != NULL)
+        {
+          statistics->AddPolyDataStage("incremental delaunay", stageStartTime, this->IncrementalSurfacePolyData);
+          stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+        }
+        surfaceOutputPort = this->IncrementalSurfaceProducer->GetOutputPort();
+        break;
+      }
+      this->Delaunay->SetAlpha(delaunayAlpha);
+      this->Delaunay->SetOutputPointsPrecision(this->SinglePrecisionOutput ? vtkAlgorithm::SINGLE_PRECISION : vtkAlgorithm::DEFAULT_PRECISION);
+      this->Delaunay->SetInputConnection(surfaceInputPort);
+      this->SurfaceFilter->Update();
+      if (statistics != NULL)
+      {
+        statistics->AddPolyDataStage("delaunay", stageStartTime, this->SurfaceFilter->GetOutput());
+        stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+      }
+      surfaceOutputPort = this->SurfaceFilter->GetOutputPort();
+      break;
+    }
+  }
 
-  if (smoothing && pointArrangement == POINT_ARRANGEMENT_NONPLANAR)
+  if (this->CheckAbortUpdate())
+  {
+    return false;
+  }
+  vtkPolyData* surfacePolyData = NULL;
+  if (surfaceGenerationMethod == vtkMRMLMarkupsToModelNode::ImplicitSurface)
+  {
+    // the contour is already finely triangulated and smooth, subdivision would only make it larger.
+    // The orientation of the contour triangles depends on the sign convention of the distance function.
+    this->Normals->SetInputConnection(surfaceOutputPort);
+    this->Normals->AutoOrientNormalsOn();
+    this->Normals->Update();
+    surfacePolyData = this->Normals->GetOutput();
+  }
+  else
   {
-    vtkSmartPointer< vtkButterflySubdivisionFilter > subdivisionFilter = vtkSmartPointer< vtkButterflySubdivisionFilter >::New();
-    subdivisionFilter->SetInputConnection(surfaceFilter->GetOutputPort());
-    subdivisionFilter->SetNumberOfSubdivisions(3);
-    subdivisionFilter->Update();
-    if (forceConvex)
+    // degenerate point sets are extruded into boxes, butterfly subdivision would only round their corners
+    bool butterflyScheme = (smoothing && pointArrangement == POINT_ARRANGEMENT_NONPLANAR);
+    bool convexHullOfSubdivision = (butterflyScheme && forceConvex);
+    int numberOfSubdivisions = (butterflyScheme ? this->NumberOfSubdivisions : 1);
+    if (incrementalSurface && !convexHullOfSubdivision)
     {
-      vtkSmartPointer< vtkDelaunay3D > convexHull = vtkSmartPointer< vtkDelaunay3D >::New();
-      convexHull->SetInputConnection(subdivisionFilter->GetOutputPort());
-      convexHull->Update();
-      vtkSmartPointer< vtkDataSetSurfaceFilter > surfaceFilter = vtkSmartPointer< vtkDataSetSurfaceFilter >::New();
-      surfaceFilter->SetInputData(convexHull->GetOutput());
-      surfaceFilter->Update();
-      normals->SetInputConnection(surfaceFilter->GetOutputPort());
+      // the hull is already oriented, and only the patches around the changed points are subdivided again
+      if (this->IncrementalSubdividedPolyData->GetMTime() < this->IncrementalSurfacePolyData->GetMTime()
+        || this->IncrementalNumberOfSubdivisions != numberOfSubdivisions || this->IncrementalButterflyScheme != butterflyScheme)
+      {
+        this->IncrementalSurface->GetSubdividedSurface(this->IncrementalSubdividedPolyData, numberOfSubdivisions, butterflyScheme);
+        this->IncrementalNumberOfSubdivisions = numberOfSubdivisions;
+        this->IncrementalButterflyScheme = butterflyScheme;
+      }
+      surfacePolyData = this->IncrementalSubdividedPolyData;
     }
     else
     {
-      normals->SetInputConnection(subdivisionFilter->GetOutputPort());
+      this->Orientation->SetInputConnection(surfaceOutputPort);
+      this->Subdivision->SetButterflyScheme(butterflyScheme);
+      this->Subdivision->SetNumberOfSubdivisions(numberOfSubdivisions);
+      // the convex hull is a new triangulation, its normals are computed separately
+      this->Subdivision->SetComputePointNormals(!convexHullOfSubdivision);
+      this->Subdivision->Update();
+      surfacePolyData = this->Subdivision->GetOutput();
+      if (convexHullOfSubdivision)
+      {
+        if (this->CheckAbortUpdate())
+        {
+          return false;
+        }
+        if (statistics != NULL)
+        {
+          statistics->AddPolyDataStage("subdivision", stageStartTime, surfacePolyData);
+          stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+        }
+        this->ConvexHull->Update();
+        if (statistics != NULL)
+        {
+          statistics->AddPolyDataStage("convex hull", stageStartTime, this->ConvexHull->GetOutput());
+          stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+        }
+        if (this->CheckAbortUpdate())
+        {
+          return false;
+        }
+        this->Normals->SetInputConnection(this->ConvexHull->GetOutputPort());
+        this->Normals->AutoOrientNormalsOff();
+        this->Normals->Update();
+        surfacePolyData = this->Normals->GetOutput();
+      }
     }
   }
+
+  if (this->CheckAbortUpdate())
+  {
+    return false;
+  }
+  // The normals and subdivision filters and the incremental surface allocate new arrays whenever they are executed,
+  // they never modify the arrays of their previous output, therefore they can be shared with the output instead of copied.
+  outputPolyData->ShallowCopy(surfacePolyData);
+  // the field data of the output is not shared with the filter output, only its arrays
+  if (surfacePolyData == this->Subdivision->GetOutput())
+  {
+    // summed by the subdivision filter from the triangle normals
+    StoreSurfaceMeasures(outputPolyData, this->Subdivision->GetSurfaceVolume(), this->Subdivision->GetSurfaceArea());
+  }
   else
   {
-    vtkNew<vtkLinearSubdivisionFilter> linearSubdivision;
-    linearSubdivision->SetInputConnection(surfaceFilter->GetOutputPort());
-    normals->SetInputConnection(linearSubdivision->GetOutputPort());
+    vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeSurfaceMeasures(outputPolyData);
+  }
+  if (statistics != NULL)
+  {
+    // the normals are computed together with the subdivision, except for the implicit surface and the convex hull
+    bool normalsOnly = (surfacePolyData == this->Normals->GetOutput());
+    statistics->AddPolyDataStage(normalsOnly ? "normals" : "subdivision and normals", stageStartTime, outputPolyData);
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeSurfaceMeasures(vtkPolyData* surfacePolyData)
+{
+  if (surfacePolyData == NULL)
+  {
+    vtkGenericWarningMacro("Surface poly data is null. No surface measures computed.");
+    return;
   }
-  normals->Update();
 
-  outputPolyData->DeepCopy(normals->GetOutput());
+  double volume = 0.0;
+  double area = 0.0;
+  vtkPoints* surfacePoints = surfacePolyData->GetPoints();
+  if (surfacePoints != NULL && surfacePoints->GetNumberOfPoints() > 0)
+  {
+    // the tetrahedra have a common vertex at the first point instead of the origin,
+    // so that the rounding errors do not depend on the distance of the surface from the origin
+    double origin[3];
+    surfacePoints->GetPoint(0, origin);
+    double cellPoints[3][3];
+    vtkIdType numberOfCellPoints = 0;
+    vtkIdType* cellPointIds = NULL;
+
+    // polygons are split into triangle fans
+    vtkCellArray* polys = surfacePolyData->GetPolys();
+    for (polys->InitTraversal(); polys->GetNextCell(numberOfCellPoints, cellPointIds); )
+    {
+      for (vtkIdType j = 0; j < numberOfCellPoints; j++)
+      {
+        double* cellPoint = cellPoints[j < 2 ? j : 2];
+        surfacePoints->GetPoint(cellPointIds[j], cellPoint);
+        vtkMath::Subtract(cellPoint, origin, cellPoint);
+        if (j >= 2)
+        {
+          AddTriangleMeasures(cellPoints[0], cellPoints[1], cellPoints[2], volume, area);
+          std::copy(cellPoints[2], cellPoints[2] + 3, cellPoints[1]);
+        }
+      }
+    }
+
+    // every second triangle of a strip has reversed vertex order
+    vtkCellArray* strips = surfacePolyData->GetStrips();
+    for (strips->InitTraversal(); strips->GetNextCell(numberOfCellPoints, cellPointIds); )
+    {
+      for (vtkIdType j = 0; j < numberOfCellPoints; j++)
+      {
+        double* cellPoint = cellPoints[j % 3];
+        surfacePoints->GetPoint(cellPointIds[j], cellPoint);
+        vtkMath::Subtract(cellPoint, origin, cellPoint);
+        if (j < 2)
+        {
+          continue;
+        }
+        const double* point0 = cellPoints[(j - 2) % 3];
+        const double* point1 = cellPoints[(j - 1) % 3];
+        if (j % 2 == 1)
+        {
+          std::swap(point0, point1);
+        }
+        AddTriangleMeasures(point0, point1, cellPoint, volume, area);
+      }
+    }
+  }
+
+  StoreSurfaceMeasures(surfacePolyData, volume, area);
+}
+
+//------------------------------------------------------------------------------
+double vtkSlicerMarkupsToModelClosedSurfaceGeneration::GetSurfaceVolume(vtkPolyData* surfacePolyData)
+{
+  return GetSurfaceMeasure(surfacePolyData, SURFACE_VOLUME_ARRAY_NAME);
+}
+
+//------------------------------------------------------------------------------
+double vtkSlicerMarkupsToModelClosedSurfaceGeneration::GetSurfaceArea(vtkPolyData* surfacePolyData)
+{
+  return GetSurfaceMeasure(surfacePolyData, SURFACE_AREA_ARRAY_NAME);
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelClosedSurfaceGeneration::IsInputPointsEqual(vtkPoints* points)
+{
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  if (this->InputPolyData->GetPoints() == NULL || this->InputPoints->GetNumberOfPoints() != numberOfPoints)
+  {
+    return false;
+  }
+  for (vtkIdType i = 0; i < numberOfPoints; i++)
+  {
+    double previousPoint[3] = { 0.0, 0.0, 0.0 };
+    this->InputPoints->GetPoint(i, previousPoint);
+    double currentPoint[3] = { 0.0, 0.0, 0.0 };
+    points->GetPoint(i, currentPoint);
+    if (previousPoint[0] != currentPoint[0] || previousPoint[1] != currentPoint[1] || previousPoint[2] != currentPoint[2])
+    {
+      return false;
+    }
+  }
   return true;
 }
 
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelClosedSurfaceGeneration::PointArrangement vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeBoundingAxesAndPointArrangement(
+  vtkPoints* points, vtkMatrix4x4* boundingAxesToRasTransformMatrix, double smallestBoundingExtentRanges[3])
+{
+  if (points == NULL || boundingAxesToRasTransformMatrix == NULL || smallestBoundingExtentRanges == NULL)
+  {
+    vtkGenericWarningMacro("Invalid inputs. Returning singularity result.");
+    return POINT_ARRANGEMENT_SINGULAR;
+  }
+
+  ComputeTransformMatrixFromBoundingAxes(points, boundingAxesToRasTransformMatrix);
+
+  vtkSmartPointer< vtkMatrix4x4 > rasToBoundingAxesTransformMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  vtkMatrix4x4::Invert(boundingAxesToRasTransformMatrix, rasToBoundingAxesTransformMatrix);
+
+  ComputeTransformedExtentRanges(points, rasToBoundingAxesTransformMatrix, smallestBoundingExtentRanges);
+
+  return ComputePointArrangement(smallestBoundingExtentRanges);
+}
+
 //------------------------------------------------------------------------------
 // Compute the principal axes of the point cloud. The x axis represents the axis
 // with maximum variation, and the z axis has minimum variation.
-// This function is currently implemented using the vtkOBBTree object.
-// There are two limitations with this approach:
-// 1. vtkOBBTree may have a performance impact
-// 2. The axes returned are based on variation of coordinates, not the range
-//    (so the return result is not necessarily intuitive, variation != length).
-// Neither of these limitations will prevent the overall logic from functioning
-// correctly, but it is worth keeping in mind, and worth changing should a need 
-// arise
+// The axes are the eigenvectors of the covariance matrix of the points, the same
+// axes that vtkOBBTree::ComputeOBB computes, but without building any tree and
+// using a closed form eigen solver instead of Jacobi iterations.
+// The axes returned are based on variation of coordinates, not the range
+// (so the return result is not necessarily intuitive, variation != length).
+// This will not prevent the overall logic from functioning correctly,
+// but it is worth keeping in mind, and worth changing should a need arise
 void vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeTransformMatrixFromBoundingAxes(vtkPoints* points, vtkMatrix4x4* boundingAxesToRasTransformMatrix)
 {
   if (points == NULL)
@@ -241,19 +744,36 @@ void vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeTransformMatrixFromB
   // the output matrix should start as identity, so no translation etc.
   boundingAxesToRasTransformMatrix->Identity();
 
-  // Compute the plane using the smallest bounding box that can have arbitrary axes
-  vtkSmartPointer<vtkOBBTree> obbTree = vtkSmartPointer<vtkOBBTree>::New();
-  double cornerOBBOrigin[3] = { 0.0, 0.0, 0.0 }; // unused
-  double variationMaximumOBBAxis[3] = { 0.0, 0.0, 0.0 };
-  double variationMediumOBBAxis[3] = { 0.0, 0.0, 0.0 };
-  double variationMinimumOBBAxis[3] = { 0.0, 0.0, 0.0 };
-  double relativeAxisSizes[3] = { 0.0, 0.0, 0.0 }; // unused, the values represented herein are unclear
-  obbTree->ComputeOBB(points, cornerOBBOrigin, variationMaximumOBBAxis, variationMediumOBBAxis, variationMinimumOBBAxis, relativeAxisSizes);
+  if (points->GetNumberOfPoints() == 0)
+  {
+    return;
+  }
+
+  double covarianceMatrix[3][3] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+  ComputeCovarianceMatrix(points, covarianceMatrix);
+
+  double eigenvalues[3] = { 0.0, 0.0, 0.0 }; // unused, only the order of the eigenvectors matters
+  double eigenvectors[3][3] = { { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+  ComputeSymmetricEigenvectors(covarianceMatrix, eigenvalues, eigenvectors);
+
+  // the variation axes are the eigenvectors scaled by the range of the points along them,
+  // similarly to vtkOBBTree::ComputeOBB
+  double variationRanges[3] = { 0.0, 0.0, 0.0 };
+  ComputeProjectedExtentRanges(points, eigenvectors, variationRanges);
+  double variationMaximumAxis[3] = { 0.0, 0.0, 0.0 };
+  double variationMediumAxis[3] = { 0.0, 0.0, 0.0 };
+  double variationMinimumAxis[3] = { 0.0, 0.0, 0.0 };
+  for (int i = 0; i < 3; i++)
+  {
+    variationMaximumAxis[i] = eigenvectors[0][i] * variationRanges[0];
+    variationMediumAxis[i] = eigenvectors[1][i] * variationRanges[1];
+    variationMinimumAxis[i] = eigenvectors[2][i] * variationRanges[2];
+  }
 
   // now to store the desired results in the appropriate axis of the output matrix.
   // must check each axis to make sure it was actually computed (non-zero)
   // do the maxmimum variation axis
-  if (vtkMath::Norm(variationMaximumOBBAxis) < COMPARE_TO_ZERO_TOLERANCE)
+  if (vtkMath::Norm(variationMaximumAxis) < COMPARE_TO_ZERO_TOLERANCE)
   {
     // there is no variation in the points whatsoever.
     // i.e. all points are in a single position.
@@ -261,29 +781,311 @@ void vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeTransformMatrixFromB
     boundingAxesToRasTransformMatrix->Identity();
     return;
   }
-  vtkMath::Normalize(variationMaximumOBBAxis);
-  SetNthColumnInMatrix(boundingAxesToRasTransformMatrix, 0, variationMaximumOBBAxis);
+  vtkMath::Normalize(variationMaximumAxis);
+  SetNthColumnInMatrix(boundingAxesToRasTransformMatrix, 0, variationMaximumAxis);
 
   // do the medium variation axis
-  if (vtkMath::Norm(variationMediumOBBAxis) < COMPARE_TO_ZERO_TOLERANCE)
+  if (vtkMath::Norm(variationMediumAxis) < COMPARE_TO_ZERO_TOLERANCE)
   {
     // the points are colinear along only the maximum axis
     // any two perpendicular orthonormal vectors will do for the remaining axes.
     double thetaAngle = 0.0; // this can be arbitrary
-    vtkMath::Perpendiculars(variationMaximumOBBAxis, variationMediumOBBAxis, variationMinimumOBBAxis, thetaAngle);
+    vtkMath::Perpendiculars(variationMaximumAxis, variationMediumAxis, variationMinimumAxis, thetaAngle);
   }
-  vtkMath::Normalize(variationMediumOBBAxis);
-  SetNthColumnInMatrix(boundingAxesToRasTransformMatrix, 1, variationMediumOBBAxis);
+  vtkMath::Normalize(variationMediumAxis);
+  SetNthColumnInMatrix(boundingAxesToRasTransformMatrix, 1, variationMediumAxis);
 
   // do the minimum variation axis
-  if (vtkMath::Norm(variationMinimumOBBAxis) < COMPARE_TO_ZERO_TOLERANCE)
+  if (vtkMath::Norm(variationMinimumAxis) < COMPARE_TO_ZERO_TOLERANCE)
   {
     // all points lie exactly on a plane.
     // the remaining perpendicular vector found using cross product.
-    vtkMath::Cross(variationMaximumOBBAxis, variationMediumOBBAxis, variationMinimumOBBAxis);
+    vtkMath::Cross(variationMaximumAxis, variationMediumAxis, variationMinimumAxis);
+  }
+  vtkMath::Normalize(variationMinimumAxis);
+  SetNthColumnInMatrix(boundingAxesToRasTransformMatrix, 2, variationMinimumAxis);
+}
+
+//------------------------------------------------------------------------------
+// Single pass over the points. The coordinates are accumulated relative to the first point,
+// which avoids the loss of precision of the sum of squares when the points are far from the origin.
+void vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeCovarianceMatrix(vtkPoints* points, double outputCovarianceMatrix[3][3])
+{
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  double referencePoint[3] = { 0.0, 0.0, 0.0 };
+  points->GetPoint(0, referencePoint);
+
+  double sum[3] = { 0.0, 0.0, 0.0 };
+  double sumOfProducts[3][3] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+  for (vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
+  {
+    double point[3] = { 0.0, 0.0, 0.0 };
+    points->GetPoint(pointIndex, point);
+    double x = point[0] - referencePoint[0];
+    double y = point[1] - referencePoint[1];
+    double z = point[2] - referencePoint[2];
+    sum[0] += x;
+    sum[1] += y;
+    sum[2] += z;
+    sumOfProducts[0][0] += x * x;
+    sumOfProducts[0][1] += x * y;
+    sumOfProducts[0][2] += x * z;
+    sumOfProducts[1][1] += y * y;
+    sumOfProducts[1][2] += y * z;
+    sumOfProducts[2][2] += z * z;
+  }
+
+  for (int row = 0; row < 3; row++)
+  {
+    for (int column = row; column < 3; column++)
+    {
+      double covariance = (sumOfProducts[row][column] - sum[row] * sum[column] / numberOfPoints) / numberOfPoints;
+      outputCovarianceMatrix[row][column] = covariance;
+      outputCovarianceMatrix[column][row] = covariance;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Closed form eigenvalues of the symmetric 3x3 matrix (trigonometric solution of the characteristic cubic),
+// the eigenvectors are computed from cross products of the rows of (matrix - eigenvalue*I).
+// The eigenvector of the best separated eigenvalue is computed first, the second one is solved in its
+// orthogonal complement, so that repeated eigenvalues still give an orthonormal set of vectors.
+void vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeSymmetricEigenvectors(const double matrix[3][3],
+  double outputEigenvalues[3], double outputEigenvectors[3][3])
+{
+  // scale the matrix to avoid overflow and underflow
+  double maximumAbsoluteElement = 0.0;
+  for (int row = 0; row < 3; row++)
+  {
+    for (int column = 0; column < 3; column++)
+    {
+      maximumAbsoluteElement = std::max(maximumAbsoluteElement, std::fabs(matrix[row][column]));
+    }
+  }
+
+  // the standard axes are used if the eigenvectors are arbitrary
+  for (int row = 0; row < 3; row++)
+  {
+    outputEigenvalues[row] = 0.0;
+    for (int column = 0; column < 3; column++)
+    {
+      outputEigenvectors[row][column] = (row == column ? 1.0 : 0.0);
+    }
+  }
+  if (maximumAbsoluteElement == 0.0)
+  {
+    return;
+  }
+
+  double scaledMatrix[3][3] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+  for (int row = 0; row < 3; row++)
+  {
+    for (int column = 0; column < 3; column++)
+    {
+      scaledMatrix[row][column] = matrix[row][column] / maximumAbsoluteElement;
+    }
+  }
+
+  double trace = scaledMatrix[0][0] + scaledMatrix[1][1] + scaledMatrix[2][2];
+  double q = trace / 3.0;
+  double offDiagonalSquared = scaledMatrix[0][1] * scaledMatrix[0][1] + scaledMatrix[0][2] * scaledMatrix[0][2] + scaledMatrix[1][2] * scaledMatrix[1][2];
+  double diagonalDeviationSquared = (scaledMatrix[0][0] - q) * (scaledMatrix[0][0] - q)
+    + (scaledMatrix[1][1] - q) * (scaledMatrix[1][1] - q) + (scaledMatrix[2][2] - q) * (scaledMatrix[2][2] - q);
+  double p = sqrt((diagonalDeviationSquared + 2.0 * offDiagonalSquared) / 6.0);
+  if (p == 0.0)
+  {
+    // multiple of the identity, all eigenvalues are the same
+    for (int i = 0; i < 3; i++)
+    {
+      outputEigenvalues[i] = q * maximumAbsoluteElement;
+    }
+    return;
+  }
+
+  // B = (A - q*I) / p, its eigenvalues are 2*cos(phi + 2*k*pi/3)
+  double b[3][3] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+  for (int row = 0; row < 3; row++)
+  {
+    for (int column = 0; column < 3; column++)
+    {
+      b[row][column] = (scaledMatrix[row][column] - (row == column ? q : 0.0)) / p;
+    }
+  }
+  double halfDeterminant = 0.5 * vtkMath::Determinant3x3(b[0], b[1], b[2]);
+  halfDeterminant = std::max(-1.0, std::min(1.0, halfDeterminant));
+  double phi = acos(halfDeterminant) / 3.0;
+  double eigenvalues[3] = { 0.0, 0.0, 0.0 }; // descending order
+  eigenvalues[0] = q + 2.0 * p * cos(phi);
+  eigenvalues[2] = q + 2.0 * p * cos(phi + 2.0 * vtkMath::Pi() / 3.0);
+  eigenvalues[1] = trace - eigenvalues[0] - eigenvalues[2];
+
+  double eigenvectors[3][3] = { { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+  if (eigenvalues[0] - eigenvalues[1] >= eigenvalues[1] - eigenvalues[2])
+  {
+    ComputeEigenvectorOfSimpleEigenvalue(scaledMatrix, eigenvalues[0], eigenvectors[0]);
+    ComputeEigenvectorInOrthogonalComplement(scaledMatrix, eigenvectors[0], eigenvalues[1], eigenvectors[1]);
+    vtkMath::Cross(eigenvectors[0], eigenvectors[1], eigenvectors[2]);
+  }
+  else
+  {
+    ComputeEigenvectorOfSimpleEigenvalue(scaledMatrix, eigenvalues[2], eigenvectors[2]);
+    ComputeEigenvectorInOrthogonalComplement(scaledMatrix, eigenvectors[2], eigenvalues[1], eigenvectors[1]);
+    vtkMath::Cross(eigenvectors[1], eigenvectors[2], eigenvectors[0]);
+  }
+
+  for (int row = 0; row < 3; row++)
+  {
+    outputEigenvalues[row] = eigenvalues[row] * maximumAbsoluteElement;
+    for (int column = 0; column < 3; column++)
+    {
+      outputEigenvectors[row][column] = eigenvectors[row][column];
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// The eigenvalue has multiplicity 1, so (matrix - eigenvalue*I) has rank 2 and the eigenvector
+// is perpendicular to its rows. The cross product of the most independent pair of rows is used.
+void vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeEigenvectorOfSimpleEigenvalue(const double matrix[3][3],
+  double eigenvalue, double outputEigenvector[3])
+{
+  double rows[3][3] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+  for (int row = 0; row < 3; row++)
+  {
+    for (int column = 0; column < 3; column++)
+    {
+      rows[row][column] = matrix[row][column] - (row == column ? eigenvalue : 0.0);
+    }
+  }
+
+  double crossProducts[3][3] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+  vtkMath::Cross(rows[0], rows[1], crossProducts[0]);
+  vtkMath::Cross(rows[0], rows[2], crossProducts[1]);
+  vtkMath::Cross(rows[1], rows[2], crossProducts[2]);
+  int largestIndex = 0;
+  double largestSquaredNorm = 0.0;
+  for (int i = 0; i < 3; i++)
+  {
+    double squaredNorm = vtkMath::Dot(crossProducts[i], crossProducts[i]);
+    if (squaredNorm > largestSquaredNorm)
+    {
+      largestSquaredNorm = squaredNorm;
+      largestIndex = i;
+    }
+  }
+
+  if (largestSquaredNorm == 0.0)
+  {
+    // the rows are all zero, any vector is an eigenvector
+    outputEigenvector[0] = 1.0;
+    outputEigenvector[1] = 0.0;
+    outputEigenvector[2] = 0.0;
+    return;
+  }
+  double norm = sqrt(largestSquaredNorm);
+  for (int i = 0; i < 3; i++)
+  {
+    outputEigenvector[i] = crossProducts[largestIndex][i] / norm;
+  }
+}
+
+//------------------------------------------------------------------------------
+// The eigenvector is searched in the plane perpendicular to the known eigenvector, by solving
+// the 2x2 problem of the matrix restricted to that plane. This remains stable when the eigenvalue
+// is repeated (then any vector of the plane is returned).
+void vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeEigenvectorInOrthogonalComplement(const double matrix[3][3],
+  const double knownEigenvector[3], double eigenvalue, double outputEigenvector[3])
+{
+  double u[3] = { 0.0, 0.0, 0.0 };
+  double v[3] = { 0.0, 0.0, 0.0 };
+  double thetaAngle = 0.0; // this can be arbitrary
+  vtkMath::Perpendiculars(knownEigenvector, u, v, thetaAngle);
+
+  double matrixU[3] = { 0.0, 0.0, 0.0 };
+  double matrixV[3] = { 0.0, 0.0, 0.0 };
+  for (int row = 0; row < 3; row++)
+  {
+    matrixU[row] = vtkMath::Dot(matrix[row], u);
+    matrixV[row] = vtkMath::Dot(matrix[row], v);
+  }
+  // (restricted matrix - eigenvalue*I), it is singular
+  double m00 = vtkMath::Dot(u, matrixU) - eigenvalue;
+  double m01 = vtkMath::Dot(u, matrixV);
+  double m11 = vtkMath::Dot(v, matrixV) - eigenvalue;
+
+  double absoluteM00 = std::fabs(m00);
+  double absoluteM01 = std::fabs(m01);
+  double absoluteM11 = std::fabs(m11);
+  // coefficients of u and v in the null vector of the 2x2 matrix
+  double coefficientU = 1.0;
+  double coefficientV = 0.0;
+  if (absoluteM00 >= absoluteM11)
+  {
+    if (std::max(absoluteM00, absoluteM01) > 0.0)
+    {
+      // null vector of the row (m00, m01)
+      if (absoluteM00 >= absoluteM01)
+      {
+        double ratio = m01 / m00;
+        coefficientV = -1.0 / sqrt(1.0 + ratio * ratio);
+        coefficientU = -ratio * coefficientV;
+      }
+      else
+      {
+        double ratio = m00 / m01;
+        coefficientU = 1.0 / sqrt(1.0 + ratio * ratio);
+        coefficientV = -ratio * coefficientU;
+      }
+    }
+  }
+  else
+  {
+    // null vector of the row (m01, m11)
+    if (absoluteM11 >= absoluteM01)
+    {
+      double ratio = m01 / m11;
+      coefficientU = 1.0 / sqrt(1.0 + ratio * ratio);
+      coefficientV = -ratio * coefficientU;
+    }
+    else
+    {
+      double ratio = m11 / m01;
+      coefficientV = 1.0 / sqrt(1.0 + ratio * ratio);
+      coefficientU = -ratio * coefficientV;
+    }
+  }
+
+  for (int i = 0; i < 3; i++)
+  {
+    outputEigenvector[i] = coefficientU * u[i] + coefficientV * v[i];
+  }
+}
+
+//------------------------------------------------------------------------------
+// Single pass over the points, the projected points are not stored.
+// The range along an axis does not depend on the translation, so only the directions are needed.
+void vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeProjectedExtentRanges(vtkPoints* points, const double axes[3][3], double outputExtentRanges[3])
+{
+  double minimumProjections[3] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, VTK_DOUBLE_MAX };
+  double maximumProjections[3] = { VTK_DOUBLE_MIN, VTK_DOUBLE_MIN, VTK_DOUBLE_MIN };
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  for (vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
+  {
+    double point[3] = { 0.0, 0.0, 0.0 };
+    points->GetPoint(pointIndex, point);
+    for (int i = 0; i < 3; i++)
+    {
+      double projection = axes[i][0] * point[0] + axes[i][1] * point[1] + axes[i][2] * point[2];
+      minimumProjections[i] = std::min(minimumProjections[i], projection);
+      maximumProjections[i] = std::max(maximumProjections[i], projection);
+    }
+  }
+
+  for (int i = 0; i < 3; i++)
+  {
+    outputExtentRanges[i] = (numberOfPoints > 0 ? maximumProjections[i] - minimumProjections[i] : 0.0);
   }
-  vtkMath::Normalize(variationMinimumOBBAxis);
-  SetNthColumnInMatrix(boundingAxesToRasTransformMatrix, 2, variationMinimumOBBAxis);
 }
 
 //------------------------------------------------------------------------------
@@ -360,31 +1162,17 @@ void vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeTransformedExtentRan
     return;
   }
 
-  vtkSmartPointer< vtkTransform > transform = vtkSmartPointer< vtkTransform >::New();
-  transform->SetMatrix(transformMatrix);
-  transform->Update();
-
-  // can't transform points directly, so need to store in a container
-  vtkSmartPointer< vtkPolyData > polyDataWithPoints = vtkSmartPointer< vtkPolyData >::New();
-  polyDataWithPoints->SetPoints(points);
-
-  vtkSmartPointer< vtkTransformFilter > transformFilter = vtkSmartPointer< vtkTransformFilter >::New();
-  transformFilter->SetTransform(transform);
-  transformFilter->SetInputData(polyDataWithPoints);
-  transformFilter->Update();
-
-  // the extent can be extracted from the output points object (poly data bounds does not work)
-  vtkPoints* transformedPoints = transformFilter->GetPolyDataOutput()->GetPoints();
-  transformedPoints->ComputeBounds();
-  double* extents = transformedPoints->GetBounds(); // { xmin, xmax, ymin, ymax, zmin, zmax }
-
-  for (int i = 0; i < 3; i++)
+  // the matrix is affine (rotation to the bounding axes), the ranges are computed from the
+  // projections of the points to its rows, without transforming the points
+  double axes[3][3] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+  for (int row = 0; row < 3; row++)
   {
-    double axisIMin = extents[2 * i];
-    double axisIMax = extents[2 * i + 1];
-    double axisIRange = axisIMax - axisIMin;
-    outputExtentRanges[i] = axisIRange;
+    for (int column = 0; column < 3; column++)
+    {
+      axes[row][column] = transformMatrix->GetElement(row, column);
+    }
   }
+  ComputeProjectedExtentRanges(points, axes, outputExtentRanges);
 }
 
 //------------------------------------------------------------------------------
@@ -467,4 +1255,10 @@ void vtkSlicerMarkupsToModelClosedSurfaceGeneration::GetNthColumnInMatrix(vtkMat
 void vtkSlicerMarkupsToModelClosedSurfaceGeneration::PrintSelf( ostream &os, vtkIndent indent )
 {
   Superclass::PrintSelf( os, indent );
+  os << indent << "DecimationSpacing: " << this->DecimationSpacing << std::endl;
+  os << indent << "DecimationTargetNumberOfPoints: " << this->DecimationTargetNumberOfPoints << std::endl;
+  os << indent << "NumberOfSubdivisions: " << this->NumberOfSubdivisions << std::endl;
+  os << indent << "SinglePrecisionOutput: " << (this->SinglePrecisionOutput ? "true" : "false") << std::endl;
+  os << indent << "IncrementalDelaunay: " << (this->IncrementalDelaunay ? "true" : "false") << std::endl;
+  os << indent << "AbortUpdate: " << (this->AbortUpdate ? "true" : "false") << std::endl;
 }
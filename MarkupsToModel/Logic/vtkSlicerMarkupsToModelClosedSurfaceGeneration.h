@@ -7,9 +7,28 @@
 #include <vtkMatrix4x4.h>
 #include <vtkPoints.h>
 #include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
 
 #include "vtkSlicerMarkupsToModelModuleLogicExport.h"
 
+class vtkCellArray;
+class vtkCubeSource;
+class vtkDataSetSurfaceFilter;
+class vtkDelaunay3D;
+class vtkFlyingEdges3D;
+class vtkGlyph3D;
+class vtkLineSource;
+class vtkMutexLock;
+class vtkPolyDataNormals;
+class vtkRegularPolygonSource;
+class vtkSlicerMarkupsToModelConvexHullFilter;
+class vtkSlicerMarkupsToModelIncrementalSurface;
+class vtkSlicerMarkupsToModelScratchBuffers;
+class vtkSlicerMarkupsToModelSubdivisionFilter;
+class vtkSlicerMarkupsToModelUpdateStatistics;
+class vtkSurfaceReconstructionFilter;
+class vtkTrivialProducer;
+
 class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelClosedSurfaceGeneration : public vtkObject
 {
   public:
@@ -27,14 +46,151 @@ class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelClose
       POINT_ARRANGEMENT_LAST // do not set to this type, insert valid types above this line
     };
 
-    // Generates the closed surface from the points using vtkDelaunay3D.
-    static bool GenerateClosedSurfaceModel( vtkPoints* points, vtkPolyData* outputPolyData, double delaunayAlpha, bool smoothing, bool forceConvex );
+    // Generates the closed surface from the points using the specified vtkMRMLMarkupsToModelNode::SurfaceGenerationMethodType.
+    // delaunayAlpha is only used by the Delaunay method, smoothing and forceConvex are not used by the implicit surface method.
+    // The implicit surface method falls back to Delaunay if the points are not spread out in 3D or there are too few of them.
+    // If statistics is specified then the time and output size of each filter is recorded in it.
+    static bool GenerateClosedSurfaceModel( vtkPoints* points, vtkPolyData* outputPolyData, double delaunayAlpha, bool smoothing, bool forceConvex,
+      int surfaceGenerationMethod = vtkMRMLMarkupsToModelNode::DelaunaySurface, vtkSlicerMarkupsToModelUpdateStatistics* statistics = NULL );
+
+    // Same as GenerateClosedSurfaceModel, but the filters are kept between calls. Only the filters
+    // that are affected by the changed points or parameters are executed again.
+    // The points are decimated as specified by DecimationSpacing and DecimationTargetNumberOfPoints
+    // after their arrangement is determined, so decimation does not change how the surface is generated.
+    // The output shares its arrays with the internal filter output, they must not be modified in place.
+    // The enclosed volume and the area of the surface are summed by the subdivision filter together with the normals,
+    // only the surfaces that are not produced by that filter are measured in a separate pass (see ComputeSurfaceMeasures).
+    bool UpdateClosedSurfaceModel( vtkPoints* points, vtkPolyData* outputPolyData, double delaunayAlpha, bool smoothing, bool forceConvex,
+      int surfaceGenerationMethod = vtkMRMLMarkupsToModelNode::DelaunaySurface, vtkSlicerMarkupsToModelUpdateStatistics* statistics = NULL );
+
+    // Compute the principal axes of the points (columns of boundingAxesToRasTransformMatrix), the range of the
+    // points along them in decreasing order, and the arrangement of the points that these ranges describe.
+    static PointArrangement ComputeBoundingAxesAndPointArrangement( vtkPoints* points, vtkMatrix4x4* boundingAxesToRasTransformMatrix,
+      double smallestBoundingExtentRanges[ 3 ] );
+
+    // Find out what kind of arrangment the points are in (see PointArrangementEnum above).
+    // If the arrangement is planar, stores the normal of the best fit plane in planeNormal.
+    // If the arrangement is linear, stores the axis of the best fit line in lineAxis.
+    static PointArrangement ComputePointArrangement( const double smallestBoundingExtentRanges[ 3 ] );
+
+    // Compute the volume enclosed by the surface and the area of the surface in a single pass over its polygons and
+    // triangle strips, and store them in the "Volume" and "SurfaceArea" field data arrays of surfacePolyData.
+    // The volume is the sum of the signed volumes of the tetrahedra between the triangles and a common point,
+    // which is only the enclosed volume if the surface is closed and its triangles are oriented consistently.
+    static void ComputeSurfaceMeasures( vtkPolyData* surfacePolyData );
+
+    // Get the volume and the area that are stored in a model by ComputeSurfaceMeasures. Return 0 if the model does not contain them.
+    static double GetSurfaceVolume( vtkPolyData* surfacePolyData );
+    static double GetSurfaceArea( vtkPolyData* surfacePolyData );
+
+    // Voxel size of the decimation of the input points in UpdateClosedSurfaceModel (in mm). If 0 then the voxel
+    // size is computed from DecimationTargetNumberOfPoints.
+    vtkGetMacro( DecimationSpacing, double );
+    vtkSetMacro( DecimationSpacing, double );
+    // Approximate maximum number of points after decimation. If 0 (and DecimationSpacing is 0) then the points are not decimated.
+    vtkGetMacro( DecimationTargetNumberOfPoints, int );
+    vtkSetMacro( DecimationTargetNumberOfPoints, int );
+    // Number of butterfly subdivisions of the surface when smoothing is enabled in UpdateClosedSurfaceModel.
+    // Each subdivision quadruples the number of triangles. Default is 3.
+    vtkGetMacro( NumberOfSubdivisions, int );
+    vtkSetMacro( NumberOfSubdivisions, int );
+    // If enabled then the points are converted to single precision when they enter the pipeline, so that
+    // all filters produce single precision points (the normals are always single precision).
+    // This halves the memory size of the points of large surfaces. Otherwise the precision of the input points is kept.
+    vtkGetMacro( SinglePrecisionOutput, bool );
+    vtkSetMacro( SinglePrecisionOutput, bool );
+    vtkBooleanMacro( SinglePrecisionOutput, bool );
+    // If enabled then the Delaunay surface is updated locally when points are added, moved or removed, instead of
+    // tetrahedralizing all points again, and only the part of the subdivided surface around the changes is subdivided again.
+    // Only used if the Delaunay alpha is 0 (the surface is the convex hull of the points) and the points are not on a plane
+    // or line, otherwise vtkDelaunay3D is used. The convex hull of the smoothed surface (forceConvex) is computed from
+    // the whole surface. Default is off.
+    vtkGetMacro( IncrementalDelaunay, bool );
+    vtkSetMacro( IncrementalDelaunay, bool );
+    vtkBooleanMacro( IncrementalDelaunay, bool );
+    // Buffers that the temporary arrays of the point processing (decimation) are allocated from. If not set then
+    // the arrays are allocated in each update. The buffers must not be used by another thread during the update.
+    void SetScratchBuffers( vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers );
+    vtkSlicerMarkupsToModelScratchBuffers* GetScratchBuffers();
+    // Stop the update that is running in another thread as soon as possible: the filter that is executing is aborted
+    // (vtkAlgorithm::SetAbortExecute), the remaining filters are not executed and UpdateClosedSurfaceModel returns false
+    // without modifying the output. Updates are aborted until this is set to false again, so that a request that arrives
+    // before the update starts is not lost. Can be called from any thread.
+    void SetAbortUpdate( bool abortUpdate );
+    bool GetAbortUpdate();
 
   protected:
     vtkSlicerMarkupsToModelClosedSurfaceGeneration();
     ~vtkSlicerMarkupsToModelClosedSurfaceGeneration();
 
+    double DecimationSpacing;
+    int DecimationTargetNumberOfPoints;
+    int NumberOfSubdivisions;
+    bool SinglePrecisionOutput;
+    bool IncrementalDelaunay;
+    vtkSmartPointer< vtkSlicerMarkupsToModelScratchBuffers > ScratchBuffers;
+    bool AbortUpdate;
+    vtkSmartPointer< vtkMutexLock > AbortUpdateMutex;
+
+    // input of the pipeline: copy of the points of the previous update, and the decimation that was applied to them
+    vtkSmartPointer< vtkPoints > InputPoints;
+    vtkSmartPointer< vtkPoints > DecimatedInputPoints;
+    vtkSmartPointer< vtkPoints > SinglePrecisionInputPoints;
+    double InputDecimationSpacing;
+    int InputDecimationTargetNumberOfPoints;
+    bool InputSinglePrecisionOutput;
+    vtkSmartPointer< vtkCellArray > InputCellArray;
+    vtkSmartPointer< vtkPolyData > InputPolyData;
+    vtkSmartPointer< vtkTrivialProducer > InputProducer;
+    // analysis of the input points
+    PointArrangement PointArrangementOfInput;
+    vtkSmartPointer< vtkMatrix4x4 > BoundingAxesToRasTransformMatrix;
+    double SmallestBoundingExtentRanges[ 3 ];
+
+    // filters
+    vtkSmartPointer< vtkCubeSource > CubeSource;
+    vtkSmartPointer< vtkRegularPolygonSource > SquareSource;
+    vtkSmartPointer< vtkLineSource > LineSource;
+    vtkSmartPointer< vtkGlyph3D > Glyph;
+    vtkSmartPointer< vtkDelaunay3D > Delaunay;
+    vtkSmartPointer< vtkDataSetSurfaceFilter > SurfaceFilter;
+    // incremental Delaunay surface, the modified time of the input that it was last updated with, and its outputs
+    vtkSmartPointer< vtkSlicerMarkupsToModelIncrementalSurface > IncrementalSurface;
+    vtkMTimeType IncrementalSurfaceInputTime;
+    vtkSmartPointer< vtkPolyData > IncrementalSurfacePolyData;
+    vtkSmartPointer< vtkTrivialProducer > IncrementalSurfaceProducer;
+    vtkSmartPointer< vtkPolyData > IncrementalSubdividedPolyData;
+    int IncrementalNumberOfSubdivisions;
+    bool IncrementalButterflyScheme;
+    vtkSmartPointer< vtkSlicerMarkupsToModelConvexHullFilter > InputConvexHull;
+    vtkSmartPointer< vtkSurfaceReconstructionFilter > SurfaceReconstruction;
+    vtkSmartPointer< vtkFlyingEdges3D > SurfaceContour;
+    vtkSmartPointer< vtkPolyDataNormals > Orientation;
+    vtkSmartPointer< vtkSlicerMarkupsToModelSubdivisionFilter > Subdivision;
+    vtkSmartPointer< vtkSlicerMarkupsToModelConvexHullFilter > ConvexHull;
+    vtkSmartPointer< vtkPolyDataNormals > Normals;
+
   private:
+    // Returns true if the points are the same as the input of the previous update
+    bool IsInputPointsEqual( vtkPoints* points );
+
+    // Returns true if the update is aborted. The filters may have incomplete outputs then,
+    // so the input is cleared to make the next update execute all of them again.
+    bool CheckAbortUpdate();
+
+    // Compute the eigenvectors of the symmetric matrix in closed form. The eigenvectors are
+    // stored in the rows of outputEigenvectors, sorted by decreasing eigenvalue.
+    static void ComputeSymmetricEigenvectors( const double matrix[ 3 ][ 3 ], double outputEigenvalues[ 3 ], double outputEigenvectors[ 3 ][ 3 ] );
+    static void ComputeEigenvectorOfSimpleEigenvalue( const double matrix[ 3 ][ 3 ], double eigenvalue, double outputEigenvector[ 3 ] );
+    static void ComputeEigenvectorInOrthogonalComplement( const double matrix[ 3 ][ 3 ], const double knownEigenvector[ 3 ],
+      double eigenvalue, double outputEigenvector[ 3 ] );
+
+    // Compute the covariance matrix of the points. There must be at least one point.
+    static void ComputeCovarianceMatrix( vtkPoints* points, double outputCovarianceMatrix[ 3 ][ 3 ] );
+
+    // Compute the range of the projections of the points to each axis (rows of axes)
+    static void ComputeProjectedExtentRanges( vtkPoints* points, const double axes[ 3 ][ 3 ], double outputExtentRanges[ 3 ] );
+
     // Compute the best fit plane through the points, as well as the major and minor axes which describe variation in points.
     static void ComputeTransformMatrixFromBoundingAxes( vtkPoints* points, vtkMatrix4x4* transformFromBoundingAxes );
 
@@ -44,11 +200,6 @@ class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelClose
     // Compute the amount to extrude surfaces when closed surface is linear or planar.
     static double ComputeSurfaceExtrusionAmount( const double extents[ 3 ] );
 
-    // Find out what kind of arrangment the points are in (see PointArrangementEnum above).
-    // If the arrangement is planar, stores the normal of the best fit plane in planeNormal.
-    // If the arrangement is linear, stores the axis of the best fit line in lineAxis.
-    static PointArrangement ComputePointArrangement( const double smallestBoundingExtentRanges[ 3 ] );
-
     // helper utility functions
     static void SetNthColumnInMatrix( vtkMatrix4x4* matrix, int n, const double axis[ 3 ] );
     static void GetNthColumnInMatrix( vtkMatrix4x4* matrix, int n, double outputAxis[ 3 ] );
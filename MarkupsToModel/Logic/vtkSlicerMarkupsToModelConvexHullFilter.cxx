@@ -0,0 +1,551 @@
+#include "vtkSlicerMarkupsToModelConvexHullFilter.h"
+
+// vtk includes
+#include <vtkCellArray.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+// std includes
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// constants within this file
+// the distance tolerance is this multiple of the rounding error of the coordinates (same as in the quickhull paper)
+static const double CONVEX_HULL_TOLERANCE_MULTIPLIER = 3.0;
+
+//------------------------------------------------------------------------------
+// Quickhull algorithm (Barber, Dobkin, Huhdanpaa: The quickhull algorithm for convex hulls, 1996).
+// A tetrahedron of extreme points is created first, then each face is repeatedly extended
+// with the point farthest above it, until no point remains outside of the hull.
+class ConvexHullBuilder
+{
+public:
+  ConvexHullBuilder( const std::vector< double >& coordinates, vtkAlgorithm* abortingAlgorithm )
+    : Coordinates( coordinates )
+    , AbortingAlgorithm( abortingAlgorithm )
+    , NumberOfPoints( static_cast< vtkIdType >( coordinates.size() / 3 ) )
+    , Tolerance( 0.0 )
+    , CurrentVisit( 0 )
+  {
+  }
+
+  // Returns false if the points are degenerate (less than 4 points, or all of them on a plane) or the computation is aborted
+  bool Build()
+  {
+    if ( this->NumberOfPoints < 4 )
+    {
+      return false;
+    }
+    this->ComputeTolerance();
+    if ( !this->CreateInitialTetrahedron() )
+    {
+      return false;
+    }
+
+    while ( !this->FacesWithOutsidePoints.empty() )
+    {
+      if ( this->AbortingAlgorithm != NULL && this->AbortingAlgorithm->GetAbortExecute() )
+      {
+        return false;
+      }
+      int faceIndex = this->FacesWithOutsidePoints.back();
+      this->FacesWithOutsidePoints.pop_back();
+      Face& face = this->Faces[ faceIndex ];
+      if ( face.Removed || face.OutsidePoints.empty() )
+      {
+        continue;
+      }
+      vtkIdType eyePoint = face.OutsidePoints[ 0 ];
+      double eyeDistance = this->GetDistance( face, eyePoint );
+      for ( size_t i = 1; i < face.OutsidePoints.size(); i++ )
+      {
+        double distance = this->GetDistance( face, face.OutsidePoints[ i ] );
+        if ( distance > eyeDistance )
+        {
+          eyeDistance = distance;
+          eyePoint = face.OutsidePoints[ i ];
+        }
+      }
+      this->AddPoint( faceIndex, eyePoint );
+    }
+    return true;
+  }
+
+  // Vertices of the triangles of the hull, 3 indices per triangle
+  void GetTriangles( std::vector< vtkIdType >& triangleVertices ) const
+  {
+    triangleVertices.clear();
+    for ( size_t faceIndex = 0; faceIndex < this->Faces.size(); faceIndex++ )
+    {
+      const Face& face = this->Faces[ faceIndex ];
+      if ( !face.Removed )
+      {
+        triangleVertices.push_back( face.Vertices[ 0 ] );
+        triangleVertices.push_back( face.Vertices[ 1 ] );
+        triangleVertices.push_back( face.Vertices[ 2 ] );
+      }
+    }
+  }
+
+private:
+  // Triangle of the hull, the vertices are in counter-clockwise order when viewed from outside
+  struct Face
+  {
+    Face()
+      : Offset( 0.0 )
+      , Removed( false )
+      , Visit( 0 )
+      , Visible( false )
+    {
+      Vertices[ 0 ] = Vertices[ 1 ] = Vertices[ 2 ] = 0;
+      Normal[ 0 ] = Normal[ 1 ] = Normal[ 2 ] = 0.0;
+    }
+
+    vtkIdType Vertices[ 3 ];
+    double Normal[ 3 ]; // unit normal, pointing outwards
+    double Offset; // signed distance of a point from the face plane is dot(Normal, point) - Offset
+    std::vector< vtkIdType > OutsidePoints; // points that are above this face and not assigned to other faces
+    bool Removed;
+    // visibility from the current eye point, valid if Visit is the current visit
+    unsigned int Visit;
+    bool Visible;
+  };
+
+  typedef std::pair< vtkIdType, vtkIdType > Edge;
+
+  const double* GetPoint( vtkIdType pointIndex ) const
+  {
+    return &( this->Coordinates[ 3 * pointIndex ] );
+  }
+
+  double GetDistance( const Face& face, vtkIdType pointIndex ) const
+  {
+    const double* point = this->GetPoint( pointIndex );
+    return face.Normal[ 0 ] * point[ 0 ] + face.Normal[ 1 ] * point[ 1 ] + face.Normal[ 2 ] * point[ 2 ] - face.Offset;
+  }
+
+  // The tolerance is proportional to the magnitude of the coordinates, distances below it are
+  // considered to be rounding errors
+  void ComputeTolerance()
+  {
+    double maximumAbsoluteCoordinates[ 3 ] = { 0.0, 0.0, 0.0 };
+    for ( vtkIdType pointIndex = 0; pointIndex < this->NumberOfPoints; pointIndex++ )
+    {
+      const double* point = this->GetPoint( pointIndex );
+      for ( int i = 0; i < 3; i++ )
+      {
+        maximumAbsoluteCoordinates[ i ] = std::max( maximumAbsoluteCoordinates[ i ], std::fabs( point[ i ] ) );
+      }
+    }
+    this->Tolerance = CONVEX_HULL_TOLERANCE_MULTIPLIER * DBL_EPSILON
+      * ( maximumAbsoluteCoordinates[ 0 ] + maximumAbsoluteCoordinates[ 1 ] + maximumAbsoluteCoordinates[ 2 ] );
+  }
+
+  bool CreateInitialTetrahedron()
+  {
+    // the two extreme points along the axis of the largest spread
+    vtkIdType minimumPoints[ 3 ] = { 0, 0, 0 };
+    vtkIdType maximumPoints[ 3 ] = { 0, 0, 0 };
+    for ( vtkIdType pointIndex = 1; pointIndex < this->NumberOfPoints; pointIndex++ )
+    {
+      const double* point = this->GetPoint( pointIndex );
+      for ( int i = 0; i < 3; i++ )
+      {
+        if ( point[ i ] < this->GetPoint( minimumPoints[ i ] )[ i ] )
+        {
+          minimumPoints[ i ] = pointIndex;
+        }
+        if ( point[ i ] > this->GetPoint( maximumPoints[ i ] )[ i ] )
+        {
+          maximumPoints[ i ] = pointIndex;
+        }
+      }
+    }
+    int largestSpreadAxis = 0;
+    double largestSpread = -1.0;
+    for ( int i = 0; i < 3; i++ )
+    {
+      double spread = this->GetPoint( maximumPoints[ i ] )[ i ] - this->GetPoint( minimumPoints[ i ] )[ i ];
+      if ( spread > largestSpread )
+      {
+        largestSpread = spread;
+        largestSpreadAxis = i;
+      }
+    }
+    if ( largestSpread <= this->Tolerance )
+    {
+      return false;
+    }
+    vtkIdType vertices[ 4 ] = { minimumPoints[ largestSpreadAxis ], maximumPoints[ largestSpreadAxis ], 0, 0 };
+
+    // the point farthest from the line of the first two
+    const double* linePoint = this->GetPoint( vertices[ 0 ] );
+    double lineDirection[ 3 ] = { 0.0, 0.0, 0.0 };
+    Subtract( this->GetPoint( vertices[ 1 ] ), linePoint, lineDirection );
+    double largestSquaredDistance = -1.0;
+    for ( vtkIdType pointIndex = 0; pointIndex < this->NumberOfPoints; pointIndex++ )
+    {
+      double pointVector[ 3 ] = { 0.0, 0.0, 0.0 };
+      Subtract( this->GetPoint( pointIndex ), linePoint, pointVector );
+      double crossProduct[ 3 ] = { 0.0, 0.0, 0.0 };
+      Cross( lineDirection, pointVector, crossProduct );
+      double squaredDistance = Dot( crossProduct, crossProduct ); // scaled by the squared line length
+      if ( squaredDistance > largestSquaredDistance )
+      {
+        largestSquaredDistance = squaredDistance;
+        vertices[ 2 ] = pointIndex;
+      }
+    }
+    if ( std::sqrt( largestSquaredDistance ) <= this->Tolerance * std::sqrt( Dot( lineDirection, lineDirection ) ) )
+    {
+      return false;
+    }
+
+    // the point farthest from the plane of the first three
+    double planeNormal[ 3 ] = { 0.0, 0.0, 0.0 };
+    double secondVector[ 3 ] = { 0.0, 0.0, 0.0 };
+    Subtract( this->GetPoint( vertices[ 2 ] ), linePoint, secondVector );
+    Cross( lineDirection, secondVector, planeNormal );
+    Normalize( planeNormal );
+    double planeOffset = Dot( planeNormal, linePoint );
+    double largestDistance = -1.0;
+    for ( vtkIdType pointIndex = 0; pointIndex < this->NumberOfPoints; pointIndex++ )
+    {
+      double distance = std::fabs( Dot( planeNormal, this->GetPoint( pointIndex ) ) - planeOffset );
+      if ( distance > largestDistance )
+      {
+        largestDistance = distance;
+        vertices[ 3 ] = pointIndex;
+      }
+    }
+    if ( largestDistance <= this->Tolerance )
+    {
+      return false;
+    }
+
+    // faces of the tetrahedron, oriented so that the remaining vertex is below them
+    const int faceVertexIndices[ 4 ][ 3 ] = { { 0, 1, 2 }, { 0, 3, 1 }, { 1, 3, 2 }, { 2, 3, 0 } };
+    const int oppositeVertexIndices[ 4 ] = { 3, 2, 0, 1 };
+    int faceIndices[ 4 ] = { 0, 0, 0, 0 };
+    bool flip = false;
+    for ( int i = 0; i < 4; i++ )
+    {
+      Face face;
+      face.Vertices[ 0 ] = vertices[ faceVertexIndices[ i ][ 0 ] ];
+      face.Vertices[ 1 ] = vertices[ faceVertexIndices[ i ][ 1 ] ];
+      face.Vertices[ 2 ] = vertices[ faceVertexIndices[ i ][ 2 ] ];
+      this->ComputeFacePlane( face );
+      if ( i == 0 )
+      {
+        // all faces have the same orientation, the first one determines if they need to be flipped
+        flip = ( this->GetDistance( face, vertices[ oppositeVertexIndices[ i ] ] ) > 0.0 );
+      }
+      if ( flip )
+      {
+        std::swap( face.Vertices[ 1 ], face.Vertices[ 2 ] );
+        this->ComputeFacePlane( face );
+      }
+      faceIndices[ i ] = this->AddFace( face );
+    }
+
+    // assign the remaining points to the face that they are farthest above
+    for ( vtkIdType pointIndex = 0; pointIndex < this->NumberOfPoints; pointIndex++ )
+    {
+      if ( pointIndex == vertices[ 0 ] || pointIndex == vertices[ 1 ] || pointIndex == vertices[ 2 ] || pointIndex == vertices[ 3 ] )
+      {
+        continue;
+      }
+      int farthestFaceIndex = -1;
+      double farthestDistance = this->Tolerance;
+      for ( int i = 0; i < 4; i++ )
+      {
+        double distance = this->GetDistance( this->Faces[ faceIndices[ i ] ], pointIndex );
+        if ( distance > farthestDistance )
+        {
+          farthestDistance = distance;
+          farthestFaceIndex = faceIndices[ i ];
+        }
+      }
+      if ( farthestFaceIndex >= 0 )
+      {
+        this->Faces[ farthestFaceIndex ].OutsidePoints.push_back( pointIndex );
+      }
+    }
+    for ( int i = 0; i < 4; i++ )
+    {
+      if ( !this->Faces[ faceIndices[ i ] ].OutsidePoints.empty() )
+      {
+        this->FacesWithOutsidePoints.push_back( faceIndices[ i ] );
+      }
+    }
+    return true;
+  }
+
+  void ComputeFacePlane( Face& face ) const
+  {
+    const double* point0 = this->GetPoint( face.Vertices[ 0 ] );
+    double edge1[ 3 ] = { 0.0, 0.0, 0.0 };
+    double edge2[ 3 ] = { 0.0, 0.0, 0.0 };
+    Subtract( this->GetPoint( face.Vertices[ 1 ] ), point0, edge1 );
+    Subtract( this->GetPoint( face.Vertices[ 2 ] ), point0, edge2 );
+    Cross( edge1, edge2, face.Normal );
+    // a degenerate face gets a zero normal, no point is considered to be above it
+    Normalize( face.Normal );
+    face.Offset = Dot( face.Normal, point0 );
+  }
+
+  int AddFace( const Face& face )
+  {
+    int faceIndex = static_cast< int >( this->Faces.size() );
+    this->Faces.push_back( face );
+    for ( int i = 0; i < 3; i++ )
+    {
+      this->EdgeToFace[ Edge( face.Vertices[ i ], face.Vertices[ ( i + 1 ) % 3 ] ) ] = faceIndex;
+    }
+    return faceIndex;
+  }
+
+  void RemoveFace( int faceIndex )
+  {
+    Face& face = this->Faces[ faceIndex ];
+    face.Removed = true;
+    for ( int i = 0; i < 3; i++ )
+    {
+      this->EdgeToFace.erase( Edge( face.Vertices[ i ], face.Vertices[ ( i + 1 ) % 3 ] ) );
+    }
+  }
+
+  // Replace the faces that are visible from the eye point by a cone of faces from the horizon to the eye point
+  void AddPoint( int startFaceIndex, vtkIdType eyePoint )
+  {
+    // find the connected set of visible faces, and the horizon edges on their boundary
+    std::vector< int > visibleFaceIndices;
+    std::vector< Edge > horizonEdges;
+    std::vector< int > faceIndicesToVisit( 1, startFaceIndex );
+    this->CurrentVisit++;
+    this->Faces[ startFaceIndex ].Visit = this->CurrentVisit;
+    this->Faces[ startFaceIndex ].Visible = true;
+    while ( !faceIndicesToVisit.empty() )
+    {
+      int faceIndex = faceIndicesToVisit.back();
+      faceIndicesToVisit.pop_back();
+      visibleFaceIndices.push_back( faceIndex );
+      const Face& face = this->Faces[ faceIndex ];
+      for ( int i = 0; i < 3; i++ )
+      {
+        Edge edge( face.Vertices[ i ], face.Vertices[ ( i + 1 ) % 3 ] );
+        std::map< Edge, int >::const_iterator neighborIt = this->EdgeToFace.find( Edge( edge.second, edge.first ) );
+        if ( neighborIt == this->EdgeToFace.end() )
+        {
+          // cannot happen in a closed hull, handle it as a horizon edge anyway
+          horizonEdges.push_back( edge );
+          continue;
+        }
+        Face& neighborFace = this->Faces[ neighborIt->second ];
+        if ( neighborFace.Visit != this->CurrentVisit )
+        {
+          neighborFace.Visit = this->CurrentVisit;
+          neighborFace.Visible = ( this->GetDistance( neighborFace, eyePoint ) > this->Tolerance );
+          if ( neighborFace.Visible )
+          {
+            faceIndicesToVisit.push_back( neighborIt->second );
+          }
+        }
+        if ( !neighborFace.Visible )
+        {
+          horizonEdges.push_back( edge );
+        }
+      }
+    }
+
+    // points of the removed faces need to be reassigned
+    std::vector< vtkIdType > orphanPoints;
+    for ( size_t i = 0; i < visibleFaceIndices.size(); i++ )
+    {
+      std::vector< vtkIdType >& outsidePoints = this->Faces[ visibleFaceIndices[ i ] ].OutsidePoints;
+      for ( size_t j = 0; j < outsidePoints.size(); j++ )
+      {
+        if ( outsidePoints[ j ] != eyePoint )
+        {
+          orphanPoints.push_back( outsidePoints[ j ] );
+        }
+      }
+      std::vector< vtkIdType >().swap( outsidePoints );
+      this->RemoveFace( visibleFaceIndices[ i ] );
+    }
+
+    std::vector< int > newFaceIndices;
+    for ( size_t i = 0; i < horizonEdges.size(); i++ )
+    {
+      Face face;
+      face.Vertices[ 0 ] = horizonEdges[ i ].first;
+      face.Vertices[ 1 ] = horizonEdges[ i ].second;
+      face.Vertices[ 2 ] = eyePoint;
+      this->ComputeFacePlane( face );
+      newFaceIndices.push_back( this->AddFace( face ) );
+    }
+
+    // points that are not above any of the new faces are inside the hull
+    for ( size_t i = 0; i < orphanPoints.size(); i++ )
+    {
+      for ( size_t j = 0; j < newFaceIndices.size(); j++ )
+      {
+        Face& face = this->Faces[ newFaceIndices[ j ] ];
+        if ( this->GetDistance( face, orphanPoints[ i ] ) > this->Tolerance )
+        {
+          face.OutsidePoints.push_back( orphanPoints[ i ] );
+          break;
+        }
+      }
+    }
+    for ( size_t j = 0; j < newFaceIndices.size(); j++ )
+    {
+      if ( !this->Faces[ newFaceIndices[ j ] ].OutsidePoints.empty() )
+      {
+        this->FacesWithOutsidePoints.push_back( newFaceIndices[ j ] );
+      }
+    }
+  }
+
+  static void Subtract( const double a[ 3 ], const double b[ 3 ], double output[ 3 ] )
+  {
+    output[ 0 ] = a[ 0 ] - b[ 0 ];
+    output[ 1 ] = a[ 1 ] - b[ 1 ];
+    output[ 2 ] = a[ 2 ] - b[ 2 ];
+  }
+
+  static double Dot( const double a[ 3 ], const double b[ 3 ] )
+  {
+    return a[ 0 ] * b[ 0 ] + a[ 1 ] * b[ 1 ] + a[ 2 ] * b[ 2 ];
+  }
+
+  static void Cross( const double a[ 3 ], const double b[ 3 ], double output[ 3 ] )
+  {
+    output[ 0 ] = a[ 1 ] * b[ 2 ] - a[ 2 ] * b[ 1 ];
+    output[ 1 ] = a[ 2 ] * b[ 0 ] - a[ 0 ] * b[ 2 ];
+    output[ 2 ] = a[ 0 ] * b[ 1 ] - a[ 1 ] * b[ 0 ];
+  }
+
+  static void Normalize( double vector[ 3 ] )
+  {
+    double norm = std::sqrt( Dot( vector, vector ) );
+    if ( norm > 0.0 )
+    {
+      vector[ 0 ] /= norm;
+      vector[ 1 ] /= norm;
+      vector[ 2 ] /= norm;
+    }
+  }
+
+  const std::vector< double >& Coordinates;
+  // the computation stops when the AbortExecute flag of this algorithm is set, if it is specified
+  vtkAlgorithm* AbortingAlgorithm;
+  vtkIdType NumberOfPoints;
+  double Tolerance;
+  unsigned int CurrentVisit;
+  std::vector< Face > Faces;
+  // face that contains the directed edge
+  std::map< Edge, int > EdgeToFace;
+  // faces that may have outside points, processed in last in first out order
+  std::vector< int > FacesWithOutsidePoints;
+};
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro( vtkSlicerMarkupsToModelConvexHullFilter );
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelConvexHullFilter::vtkSlicerMarkupsToModelConvexHullFilter()
+{
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelConvexHullFilter::~vtkSlicerMarkupsToModelConvexHullFilter()
+{
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelConvexHullFilter::RequestData( vtkInformation* vtkNotUsed( request ),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector )
+{
+  vtkPolyData* input = vtkPolyData::GetData( inputVector[ 0 ] );
+  vtkPolyData* output = vtkPolyData::GetData( outputVector );
+  if ( input == NULL || output == NULL )
+  {
+    vtkErrorMacro( "Input or output is missing. No convex hull computed." );
+    return 0;
+  }
+
+  if ( !ComputeConvexHull( input->GetPoints(), output, this ) && !this->GetAbortExecute() )
+  {
+    vtkWarningMacro( "Convex hull cannot be computed, there are less than 4 points or all points are on a plane." );
+  }
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelConvexHullFilter::ComputeConvexHull( vtkPoints* points, vtkPolyData* outputPolyData, vtkAlgorithm* abortingAlgorithm )
+{
+  if ( outputPolyData == NULL )
+  {
+    vtkGenericWarningMacro( "Output poly data is null. No convex hull computed." );
+    return false;
+  }
+  outputPolyData->Initialize();
+  if ( points == NULL )
+  {
+    return false;
+  }
+
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  std::vector< double > coordinates( 3 * numberOfPoints );
+  for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+  {
+    points->GetPoint( pointIndex, &( coordinates[ 3 * pointIndex ] ) );
+  }
+
+  ConvexHullBuilder builder( coordinates, abortingAlgorithm );
+  if ( !builder.Build() )
+  {
+    return false;
+  }
+  std::vector< vtkIdType > triangleVertices;
+  builder.GetTriangles( triangleVertices );
+
+  // only the vertices of the hull are kept in the output
+  std::vector< vtkIdType > inputToOutputPointIndices( numberOfPoints, -1 );
+  vtkSmartPointer< vtkPoints > outputPoints = vtkSmartPointer< vtkPoints >::New();
+  outputPoints->SetDataType( points->GetDataType() );
+  vtkSmartPointer< vtkCellArray > outputTriangles = vtkSmartPointer< vtkCellArray >::New();
+  outputTriangles->Allocate( outputTriangles->EstimateSize( triangleVertices.size() / 3, 3 ) );
+  for ( size_t i = 0; i < triangleVertices.size(); i += 3 )
+  {
+    outputTriangles->InsertNextCell( 3 );
+    for ( int j = 0; j < 3; j++ )
+    {
+      vtkIdType& outputPointIndex = inputToOutputPointIndices[ triangleVertices[ i + j ] ];
+      if ( outputPointIndex < 0 )
+      {
+        outputPointIndex = outputPoints->InsertNextPoint( &( coordinates[ 3 * triangleVertices[ i + j ] ] ) );
+      }
+      outputTriangles->InsertCellPoint( outputPointIndex );
+    }
+  }
+  outputPolyData->SetPoints( outputPoints );
+  outputPolyData->SetPolys( outputTriangles );
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelConvexHullFilter::PrintSelf( ostream &os, vtkIndent indent )
+{
+  Superclass::PrintSelf( os, indent );
+}
@@ -0,0 +1,41 @@
+#ifndef __vtkSlicerMarkupsToModelConvexHullFilter_h
+#define __vtkSlicerMarkupsToModelConvexHullFilter_h
+
+// vtk includes
+#include <vtkPolyDataAlgorithm.h>
+
+#include "vtkSlicerMarkupsToModelModuleLogicExport.h"
+
+// Computes the triangulated convex hull of the points of the input using the quickhull algorithm.
+// Only the points of the input are used, its cells are ignored. The output only contains the points
+// that are vertices of the hull, and its triangles are oriented so that their normals point outwards.
+// The points must not all lie on a plane, otherwise the output is empty.
+// The computation time is O(n log n) for typical point sets, in contrast to the tetrahedralization
+// of the whole point set that vtkDelaunay3D uses for computing a convex hull.
+class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelConvexHullFilter : public vtkPolyDataAlgorithm
+{
+  public:
+    // standard vtk object methods
+    vtkTypeMacro( vtkSlicerMarkupsToModelConvexHullFilter, vtkPolyDataAlgorithm );
+    void PrintSelf( ostream& os, vtkIndent indent ) VTK_OVERRIDE;
+    static vtkSlicerMarkupsToModelConvexHullFilter *New();
+
+    // Compute the convex hull of the points. Returns false if the hull could not be computed
+    // (less than 4 points, or all points are on a plane), in this case the output is empty.
+    // If abortingAlgorithm is specified then the computation stops when its AbortExecute flag is set,
+    // and false is returned.
+    static bool ComputeConvexHull( vtkPoints* points, vtkPolyData* outputPolyData, vtkAlgorithm* abortingAlgorithm = NULL );
+
+  protected:
+    vtkSlicerMarkupsToModelConvexHullFilter();
+    ~vtkSlicerMarkupsToModelConvexHullFilter();
+
+    int RequestData( vtkInformation* request, vtkInformationVector** inputVector, vtkInformationVector* outputVector ) VTK_OVERRIDE;
+
+  private:
+    // not used
+    vtkSlicerMarkupsToModelConvexHullFilter ( const vtkSlicerMarkupsToModelConvexHullFilter& ) VTK_DELETE_FUNCTION;
+    void operator= ( const vtkSlicerMarkupsToModelConvexHullFilter& ) VTK_DELETE_FUNCTION;
+};
+
+#endif
@@ -1,4 +1,6 @@
 #include "vtkSlicerMarkupsToModelCurveGeneration.h"
+#include "vtkSlicerMarkupsToModelScratchBuffers.h"
+#include "vtkSlicerMarkupsToModelTubeGeneration.h"
 
 // slicer includes
 #include "vtkMRMLMarkupsFiducialNode.h"
@@ -7,12 +9,21 @@
 // vtk includes
 #include <vtkCleanPolyData.h>
 #include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdList.h>
+#include <vtkMath.h>
 #include <vtkNew.h>
 #include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
 #include <vtkSphereSource.h>
 #include <vtkSplineFilter.h>
-#include <vtkTubeFilter.h>
+#include <vtkStaticPointLocator.h>
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
 
 //------------------------------------------------------------------------------
 // constant default values defined here due to VS2013 compile issue C2864
@@ -20,18 +31,380 @@ const bool vtkSlicerMarkupsToModelCurveGeneration::TUBE_LOOP_DEFAULT = false;
 const double vtkSlicerMarkupsToModelCurveGeneration::TUBE_RADIUS_DEFAULT = 1.0;
 const int vtkSlicerMarkupsToModelCurveGeneration::TUBE_NUMBER_OF_SIDES_DEFAULT = 8;
 const int vtkSlicerMarkupsToModelCurveGeneration::TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS_DEFAULT = 5;
+const double vtkSlicerMarkupsToModelCurveGeneration::TUBE_SAMPLING_TOLERANCE_DEFAULT = 0.0;
 const int vtkSlicerMarkupsToModelCurveGeneration::POLYNOMIAL_ORDER_DEFAULT = 3;
+const int vtkSlicerMarkupsToModelCurveGeneration::POLYNOMIAL_ORDER_MAXIMUM = 20;
 const double vtkSlicerMarkupsToModelCurveGeneration::KOCHANEK_BIAS_DEFAULT = 0.0;
 const double vtkSlicerMarkupsToModelCurveGeneration::KOCHANEK_CONTINUITY_DEFAULT = 0.0;
 const double vtkSlicerMarkupsToModelCurveGeneration::KOCHANEK_TENSION_DEFAULT = 0.0;
 const double vtkSlicerMarkupsToModelCurveGeneration::KOCHANEK_ENDS_COPY_NEAREST_DERIVATIVE_DEFAULT = 0.0;
 
+//------------------------------------------------------------------------------
+// constants for incremental update
+// The Cardinal spline is fitted globally, but the influence of a control point decays by roughly
+// a factor of 0.27 per segment, so segments farther than this are not recomputed.
+static const int CARDINAL_SPLINE_INCREMENTAL_INFLUENCE_SEGMENTS = 4;
+// number of additional control points on each side used for fitting the local Cardinal spline
+static const int CARDINAL_SPLINE_INCREMENTAL_MARGIN = 4;
+// a Kochanek spline segment depends on the two control points it connects and one more on each side
+static const int KOCHANEK_SPLINE_INCREMENTAL_INFLUENCE_SEGMENTS = 1;
+static const int KOCHANEK_SPLINE_INCREMENTAL_MARGIN = 1;
+// if more than this fraction of the control points moved then regenerate the whole curve
+static const double INCREMENTAL_UPDATE_MAXIMUM_CHANGED_FRACTION = 0.25;
+// Streaming update: old control points are removed when the number of points to remove reaches this fraction
+// of the retention limit (or of the retained points), then the model is regenerated from the remaining points.
+// Removing points in batches keeps the amortized cost per appended point constant.
+static const double STREAMING_RETENTION_BATCH_FRACTION = 0.25;
+// Streaming update: number of most recent control points that are compared to the input, for detecting
+// modifications other than appending. These are the points that the recomputed segments depend on.
+static const int STREAMING_CHECKED_CONTROL_POINTS = CARDINAL_SPLINE_INCREMENTAL_INFLUENCE_SEGMENTS + CARDINAL_SPLINE_INCREMENTAL_MARGIN + 2;
+
+//------------------------------------------------------------------------------
+// Points for temporary use, taken from the scratch buffers if they are specified
+static vtkSmartPointer< vtkPoints > GetTemporaryPoints(vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers)
+{
+  if (scratchBuffers != NULL)
+  {
+    return scratchBuffers->GetPoints();
+  }
+  return vtkSmartPointer< vtkPoints >::New();
+}
+
+//------------------------------------------------------------------------------
+// number of nearest neighbors each point is connected to in the graph that the minimum spanning tree is computed from
+static const int MINIMUM_SPANNING_TREE_NUMBER_OF_NEIGHBORS = 10;
+// maximum number of points in the leaves of the k-d tree that connects the components of the minimum spanning forest
+static const int MINIMUM_SPANNING_FOREST_LEAF_SIZE = 8;
+
+//------------------------------------------------------------------------------
+// constants for polynomial fitting
+// A basis function is left out of the fit (reducing the order of the polynomial) if the part of it that is not
+// a linear combination of the lower order basis functions at the point parameters is smaller than this fraction
+// (in squared norm). This happens for example if there are fewer distinct point parameters than coefficients.
+static const double POLYNOMIAL_FIT_RELATIVE_PIVOT_TOLERANCE = 1e-10;
+
+//------------------------------------------------------------------------------
+// constants for adaptive sampling
+// an interval is not subdivided more than this many times (at most 2^depth samples per segment)
+static const int ADAPTIVE_SAMPLING_MAXIMUM_DEPTH = 8;
+// Intervals are subdivided at least this many times. Sampling the deviation only at a few points of
+// a long interval could miss a bend, for example a symmetric S shape that crosses its chord in the middle.
+static const int ADAPTIVE_SAMPLING_MINIMUM_DEPTH = 1;
+
+//------------------------------------------------------------------------------
+static int PositiveModulo(int value, int divisor)
+{
+  int remainder = value % divisor;
+  return ( remainder < 0 ) ? remainder + divisor : remainder;
+}
+
+//------------------------------------------------------------------------------
+// Each spline segment (between two consecutive integer parameter values) is a cubic polynomial.
+// The power basis coefficients of the segment, in terms of the local parameter u in [0,1], are
+// recovered from 4 evaluations of the spline, so the interval search of vtkSpline::Evaluate
+// is done only 4 times per segment instead of once per sample.
+static void ComputeSplineSegmentCoefficients(vtkSpline* spline, double segmentParameter, double coefficients[4])
+{
+  double f0 = spline->Evaluate(segmentParameter);
+  double f1 = spline->Evaluate(segmentParameter + 1.0 / 3.0);
+  double f2 = spline->Evaluate(segmentParameter + 2.0 / 3.0);
+  double f3 = spline->Evaluate(segmentParameter + 1.0);
+  // forward differences with step 1/3
+  double difference1 = f1 - f0;
+  double difference2 = f2 - 2.0 * f1 + f0;
+  double difference3 = f3 - 3.0 * f2 + 3.0 * f1 - f0;
+  coefficients[0] = f0;
+  coefficients[1] = 3.0 * (difference1 - difference2 / 2.0 + difference3 / 3.0);
+  coefficients[2] = 9.0 * (difference2 - difference3) / 2.0;
+  coefficients[3] = 27.0 * difference3 / 6.0;
+}
+
+//------------------------------------------------------------------------------
+// Evaluate the segment polynomials at the sample parameters and write the points
+// into the raw (x,y,z interleaved) buffer of the output points
+template< class T >
+static void EvaluateSplineSegmentSamples(const double* coefficientsX, const double* coefficientsY, const double* coefficientsZ,
+  int numberOfSegments, const double* sampleParameters, int samplesPerSegment, T* outputPoints)
+{
+  for (int segment = 0; segment < numberOfSegments; segment++)
+  {
+    const double* cx = coefficientsX + 4 * segment;
+    const double* cy = coefficientsY + 4 * segment;
+    const double* cz = coefficientsZ + 4 * segment;
+    T* segmentPoints = outputPoints + 3 * segment * samplesPerSegment;
+    for (int i = 0; i < samplesPerSegment; i++)
+    {
+      double u = sampleParameters[i];
+      segmentPoints[3 * i] = static_cast< T >(((cx[3] * u + cx[2]) * u + cx[1]) * u + cx[0]);
+      segmentPoints[3 * i + 1] = static_cast< T >(((cy[3] * u + cy[2]) * u + cy[1]) * u + cy[0]);
+      segmentPoints[3 * i + 2] = static_cast< T >(((cz[3] * u + cz[2]) * u + cz[1]) * u + cz[0]);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Sample numberOfSegments consecutive spline segments, starting at firstSegmentParameter, with samplesPerSegment
+// points per segment (the end point of the segments is not included). The points are written into curvePoints
+// starting at firstCurvePointIndex. The temporary arrays are allocated from scratchBuffers if it is specified.
+static void EvaluateSplineSegments(vtkSpline* splineX, vtkSpline* splineY, vtkSpline* splineZ,
+  double firstSegmentParameter, int numberOfSegments, int samplesPerSegment, vtkPoints* curvePoints, vtkIdType firstCurvePointIndex,
+  vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers = NULL)
+{
+  if (numberOfSegments <= 0 || samplesPerSegment <= 0)
+  {
+    return;
+  }
+  vtkIdType numberOfSamples = static_cast< vtkIdType >(numberOfSegments) * samplesPerSegment;
+  if (firstCurvePointIndex < 0 || firstCurvePointIndex + numberOfSamples > curvePoints->GetNumberOfPoints())
+  {
+    vtkGenericWarningMacro("Curve points are not allocated for the spline samples. No curve points generated.");
+    return;
+  }
+
+  // coefficients are stored separately for each coordinate, 4 for each segment, followed by the sample parameters
+  vtkSlicerMarkupsToModelScratchBuffers::Scope scratchScope(scratchBuffers);
+  size_t numberOfValues = 3 * 4 * numberOfSegments + samplesPerSegment;
+  std::vector< double > values;
+  double* coefficientsX = NULL;
+  if (scratchBuffers != NULL)
+  {
+    coefficientsX = scratchBuffers->Allocate< double >(numberOfValues);
+  }
+  else
+  {
+    values.resize(numberOfValues);
+    coefficientsX = &(values[0]);
+  }
+  double* coefficientsY = coefficientsX + 4 * numberOfSegments;
+  double* coefficientsZ = coefficientsY + 4 * numberOfSegments;
+  for (int segment = 0; segment < numberOfSegments; segment++)
+  {
+    double segmentParameter = firstSegmentParameter + segment;
+    ComputeSplineSegmentCoefficients(splineX, segmentParameter, coefficientsX + 4 * segment);
+    ComputeSplineSegmentCoefficients(splineY, segmentParameter, coefficientsY + 4 * segment);
+    ComputeSplineSegmentCoefficients(splineZ, segmentParameter, coefficientsZ + 4 * segment);
+  }
+
+  double* sampleParameters = coefficientsZ + 4 * numberOfSegments;
+  for (int i = 0; i < samplesPerSegment; i++)
+  {
+    sampleParameters[i] = i / (double)samplesPerSegment;
+  }
+
+  vtkDataArray* pointsArray = curvePoints->GetData();
+  vtkFloatArray* floatPointsArray = vtkFloatArray::SafeDownCast(pointsArray);
+  vtkDoubleArray* doublePointsArray = vtkDoubleArray::SafeDownCast(pointsArray);
+  if (floatPointsArray != NULL)
+  {
+    EvaluateSplineSegmentSamples(coefficientsX, coefficientsY, coefficientsZ, numberOfSegments, sampleParameters, samplesPerSegment,
+      floatPointsArray->GetPointer(3 * firstCurvePointIndex));
+  }
+  else if (doublePointsArray != NULL)
+  {
+    EvaluateSplineSegmentSamples(coefficientsX, coefficientsY, coefficientsZ, numberOfSegments, sampleParameters, samplesPerSegment,
+      doublePointsArray->GetPointer(3 * firstCurvePointIndex));
+  }
+  else
+  {
+    std::vector< double > samples(3 * numberOfSamples);
+    EvaluateSplineSegmentSamples(coefficientsX, coefficientsY, coefficientsZ, numberOfSegments, sampleParameters, samplesPerSegment, &(samples[0]));
+    for (vtkIdType i = 0; i < numberOfSamples; i++)
+    {
+      curvePoints->SetPoint(firstCurvePointIndex + i, &(samples[3 * i]));
+    }
+  }
+  curvePoints->Modified();
+}
+
+//------------------------------------------------------------------------------
+// Cubic polynomial of a spline segment in power basis, in terms of the local parameter u in [0,1]
+struct CubicSegmentCurve
+{
+  const double* CoefficientsX;
+  const double* CoefficientsY;
+  const double* CoefficientsZ;
+  void Evaluate(double u, double point[3]) const
+  {
+    point[0] = ((CoefficientsX[3] * u + CoefficientsX[2]) * u + CoefficientsX[1]) * u + CoefficientsX[0];
+    point[1] = ((CoefficientsY[3] * u + CoefficientsY[2]) * u + CoefficientsY[1]) * u + CoefficientsY[0];
+    point[2] = ((CoefficientsZ[3] * u + CoefficientsZ[2]) * u + CoefficientsZ[1]) * u + CoefficientsZ[0];
+  }
+};
+
+//------------------------------------------------------------------------------
+// Evaluate the shifted Chebyshev polynomials T*_0 ... T*_(numberOfTerms-1) at t in [0,1]
+static void EvaluateShiftedChebyshevBasis(double t, int numberOfTerms, double* basisValues)
+{
+  double x = 2.0 * t - 1.0;
+  basisValues[0] = 1.0;
+  if (numberOfTerms > 1)
+  {
+    basisValues[1] = x;
+  }
+  for (int k = 2; k < numberOfTerms; k++)
+  {
+    basisValues[k] = 2.0 * x * basisValues[k - 1] - basisValues[k - 2];
+  }
+}
+
+//------------------------------------------------------------------------------
+// Polynomial curve in shifted Chebyshev basis on [0,1], the coefficients of x, y, z are interleaved for each term.
+// Evaluated by the Clenshaw recurrence.
+struct ShiftedChebyshevPolynomialCurve
+{
+  const double* Coefficients;
+  int NumberOfCoefficients;
+  void Evaluate(double t, double point[3]) const
+  {
+    double x = 2.0 * t - 1.0;
+    for (int d = 0; d < 3; d++)
+    {
+      double b1 = 0.0;
+      double b2 = 0.0;
+      for (int c = NumberOfCoefficients - 1; c >= 1; c--)
+      {
+        double b0 = 2.0 * x * b1 - b2 + Coefficients[c * 3 + d];
+        b2 = b1;
+        b1 = b0;
+      }
+      point[d] = x * b1 - b2 + Coefficients[d];
+    }
+  }
+};
+
+//------------------------------------------------------------------------------
+// Interval of the curve parameter during adaptive sampling, with the curve points at its ends
+struct AdaptiveSamplingInterval
+{
+  double StartParameter;
+  double EndParameter;
+  double StartPoint[3];
+  double EndPoint[3];
+  int Depth;
+};
+
+//------------------------------------------------------------------------------
+static double ComputeDistanceToChord(const double point[3], const double chordStart[3], const double chordEnd[3])
+{
+  double chord[3] = { chordEnd[0] - chordStart[0], chordEnd[1] - chordStart[1], chordEnd[2] - chordStart[2] };
+  double relativePoint[3] = { point[0] - chordStart[0], point[1] - chordStart[1], point[2] - chordStart[2] };
+  double chordLengthSquared = vtkMath::Dot(chord, chord);
+  double t = 0.0;
+  if (chordLengthSquared > 0.0)
+  {
+    t = std::min(std::max(vtkMath::Dot(relativePoint, chord) / chordLengthSquared, 0.0), 1.0);
+  }
+  double difference[3] = { relativePoint[0] - t * chord[0], relativePoint[1] - t * chord[1], relativePoint[2] - t * chord[2] };
+  return vtkMath::Norm(difference);
+}
+
+//------------------------------------------------------------------------------
+// Sample the curve between startParameter (included) and endParameter (not included) by recursive bisection,
+// until the curve deviates less than tolerance from the chord of each interval. The deviation is checked at
+// the quarter points of the interval. The samples are appended to curvePoints in order of increasing parameter.
+template< class CurveType >
+static void SampleCurveAdaptively(const CurveType& curve, double startParameter, double endParameter, double tolerance, vtkPoints* curvePoints)
+{
+  // intervals are processed depth first, the first half of an interval is on the top of the stack
+  std::vector< AdaptiveSamplingInterval > intervalStack;
+  AdaptiveSamplingInterval wholeInterval;
+  wholeInterval.StartParameter = startParameter;
+  wholeInterval.EndParameter = endParameter;
+  curve.Evaluate(startParameter, wholeInterval.StartPoint);
+  curve.Evaluate(endParameter, wholeInterval.EndPoint);
+  wholeInterval.Depth = 0;
+  intervalStack.push_back(wholeInterval);
+  while (!intervalStack.empty())
+  {
+    AdaptiveSamplingInterval interval = intervalStack.back();
+    intervalStack.pop_back();
+
+    double middleParameter = 0.5 * (interval.StartParameter + interval.EndParameter);
+    double middlePoint[3] = { 0.0, 0.0, 0.0 };
+    curve.Evaluate(middleParameter, middlePoint);
+    bool subdivide = (interval.Depth < ADAPTIVE_SAMPLING_MINIMUM_DEPTH);
+    if (!subdivide && interval.Depth < ADAPTIVE_SAMPLING_MAXIMUM_DEPTH)
+    {
+      double quarterPoint[3] = { 0.0, 0.0, 0.0 };
+      curve.Evaluate(0.5 * (interval.StartParameter + middleParameter), quarterPoint);
+      double threeQuarterPoint[3] = { 0.0, 0.0, 0.0 };
+      curve.Evaluate(0.5 * (middleParameter + interval.EndParameter), threeQuarterPoint);
+      subdivide = (ComputeDistanceToChord(middlePoint, interval.StartPoint, interval.EndPoint) > tolerance
+        || ComputeDistanceToChord(quarterPoint, interval.StartPoint, interval.EndPoint) > tolerance
+        || ComputeDistanceToChord(threeQuarterPoint, interval.StartPoint, interval.EndPoint) > tolerance);
+    }
+    if (!subdivide)
+    {
+      curvePoints->InsertNextPoint(interval.StartPoint);
+      continue;
+    }
+
+    AdaptiveSamplingInterval secondHalf = interval;
+    secondHalf.StartParameter = middleParameter;
+    std::copy(middlePoint, middlePoint + 3, secondHalf.StartPoint);
+    secondHalf.Depth = interval.Depth + 1;
+    AdaptiveSamplingInterval firstHalf = interval;
+    firstHalf.EndParameter = middleParameter;
+    std::copy(middlePoint, middlePoint + 3, firstHalf.EndPoint);
+    firstHalf.Depth = interval.Depth + 1;
+    intervalStack.push_back(secondHalf);
+    intervalStack.push_back(firstHalf);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Adaptively sample numberOfSegments consecutive spline segments, starting at parameter 0
+// (the end point of the segments is not included). The points are appended to curvePoints.
+static void SampleSplineSegmentsAdaptively(vtkSpline* splineX, vtkSpline* splineY, vtkSpline* splineZ,
+  int numberOfSegments, double tolerance, vtkPoints* curvePoints)
+{
+  double coefficientsX[4] = { 0.0, 0.0, 0.0, 0.0 };
+  double coefficientsY[4] = { 0.0, 0.0, 0.0, 0.0 };
+  double coefficientsZ[4] = { 0.0, 0.0, 0.0, 0.0 };
+  CubicSegmentCurve segmentCurve;
+  segmentCurve.CoefficientsX = coefficientsX;
+  segmentCurve.CoefficientsY = coefficientsY;
+  segmentCurve.CoefficientsZ = coefficientsZ;
+  for (int segment = 0; segment < numberOfSegments; segment++)
+  {
+    ComputeSplineSegmentCoefficients(splineX, segment, coefficientsX);
+    ComputeSplineSegmentCoefficients(splineY, segment, coefficientsY);
+    ComputeSplineSegmentCoefficients(splineZ, segment, coefficientsZ);
+    SampleCurveAdaptively(segmentCurve, 0.0, 1.0, tolerance, curvePoints);
+  }
+}
+
 //------------------------------------------------------------------------------
 vtkStandardNewMacro( vtkSlicerMarkupsToModelCurveGeneration );
 
 //------------------------------------------------------------------------------
 vtkSlicerMarkupsToModelCurveGeneration::vtkSlicerMarkupsToModelCurveGeneration()
 {
+  this->IncrementalOutputMTime = 0;
+  this->IncrementalInterpolationType = vtkMRMLMarkupsToModelNode::Linear;
+  this->IncrementalTubeRadius = TUBE_RADIUS_DEFAULT;
+  this->IncrementalTubeNumberOfSides = TUBE_NUMBER_OF_SIDES_DEFAULT;
+  this->IncrementalTubeSegmentsBetweenControlPoints = TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS_DEFAULT;
+  this->IncrementalTubeLoop = TUBE_LOOP_DEFAULT;
+  this->IncrementalKochanekBias = KOCHANEK_BIAS_DEFAULT;
+  this->IncrementalKochanekContinuity = KOCHANEK_CONTINUITY_DEFAULT;
+  this->IncrementalKochanekTension = KOCHANEK_TENSION_DEFAULT;
+  this->IncrementalKochanekEndsCopyNearestDerivatives = false;
+
+  this->StreamingNumberOfInputPoints = 0;
+  this->StreamingLastInputPoint[0] = 0.0;
+  this->StreamingLastInputPoint[1] = 0.0;
+  this->StreamingLastInputPoint[2] = 0.0;
+  this->StreamingOutputMTime = 0;
+  this->StreamingInterpolationType = vtkMRMLMarkupsToModelNode::Linear;
+  this->StreamingTubeRadius = TUBE_RADIUS_DEFAULT;
+  this->StreamingTubeNumberOfSides = TUBE_NUMBER_OF_SIDES_DEFAULT;
+  this->StreamingTubeSegmentsBetweenControlPoints = TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS_DEFAULT;
+  this->StreamingKochanekBias = KOCHANEK_BIAS_DEFAULT;
+  this->StreamingKochanekContinuity = KOCHANEK_CONTINUITY_DEFAULT;
+  this->StreamingKochanekTension = KOCHANEK_TENSION_DEFAULT;
+  this->StreamingKochanekEndsCopyNearestDerivatives = false;
+  this->StreamingMinimumPointDistance = 0.0;
 }
 
 //------------------------------------------------------------------------------
@@ -55,6 +428,18 @@ void vtkSlicerMarkupsToModelCurveGeneration::AllocateCurvePoints(vtkPoints* cont
   }
 }
 
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelCurveGeneration::AddFinalCurvePoints(vtkPoints* curvePoints, const double finalPoint[3], bool tubeLoop)
+{
+  curvePoints->InsertNextPoint(finalPoint);
+  if (tubeLoop)
+  {
+    // the extra point is set by CloseLoop, same as for uniformly sampled curves
+    curvePoints->InsertNextPoint(finalPoint);
+    vtkSlicerMarkupsToModelCurveGeneration::CloseLoop(curvePoints);
+  }
+}
+
 //------------------------------------------------------------------------------
 void vtkSlicerMarkupsToModelCurveGeneration::CloseLoop(vtkPoints* outputPoints)
 {
@@ -181,34 +566,7 @@ void vtkSlicerMarkupsToModelCurveGeneration::GetTubePolyDataFromPoints(vtkPoints
     return;
   }
 
-  int numPoints = pointsToConnect->GetNumberOfPoints();
-
-  vtkSmartPointer< vtkCellArray > lineCellArray = vtkSmartPointer< vtkCellArray >::New();
-  lineCellArray->InsertNextCell(numPoints);
-  for (int i = 0; i < numPoints; i++)
-  {
-    lineCellArray->InsertCellPoint(i);
-  }
-
-  vtkSmartPointer< vtkPolyData > linePolyData = vtkSmartPointer< vtkPolyData >::New();
-  linePolyData->Initialize();
-  linePolyData->SetPoints(pointsToConnect);
-  linePolyData->SetLines(lineCellArray);
-
-  if (tubeRadius > 0.0)
-    {
-    vtkSmartPointer< vtkTubeFilter > tubeSegmentFilter = vtkSmartPointer< vtkTubeFilter >::New();
-    tubeSegmentFilter->SetInputData(linePolyData);
-    tubeSegmentFilter->SetRadius(tubeRadius);
-    tubeSegmentFilter->SetNumberOfSides(tubeNumberOfSides);
-    tubeSegmentFilter->CappingOn();
-    tubeSegmentFilter->Update();
-    outputTube->DeepCopy(tubeSegmentFilter->GetOutput());
-    }
-  else
-    {
-    outputTube->DeepCopy(linePolyData);
-    }
+  vtkSlicerMarkupsToModelTubeGeneration::GenerateTubeModel(pointsToConnect, outputTube, tubeRadius, tubeNumberOfSides);
 }
 
 //------------------------------------------------------------------------------
@@ -239,7 +597,8 @@ void vtkSlicerMarkupsToModelCurveGeneration::GenerateSphereModel(double* point,
 
 //------------------------------------------------------------------------------
 void vtkSlicerMarkupsToModelCurveGeneration::GeneratePiecewiseLinearCurveModel(vtkPoints* controlPoints, vtkPolyData* outputTubePolyData,
-  double tubeRadius, int tubeNumberOfSides, int tubeSegmentsBetweenControlPoints, bool tubeLoop)
+  double tubeRadius, int tubeNumberOfSides, int tubeSegmentsBetweenControlPoints, bool tubeLoop, double tubeSamplingTolerance,
+  vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers)
 {
   if (controlPoints == NULL)
   {
@@ -268,7 +627,14 @@ void vtkSlicerMarkupsToModelCurveGeneration::GeneratePiecewiseLinearCurveModel(v
     return;
   }
 
-  vtkSmartPointer< vtkPoints > curvePoints = vtkSmartPointer< vtkPoints >::New();
+  if (tubeSamplingTolerance > 0.0)
+  {
+    // straight segments do not deviate from their chord
+    tubeSegmentsBetweenControlPoints = 1;
+  }
+
+  vtkSlicerMarkupsToModelScratchBuffers::Scope scratchScope(scratchBuffers);
+  vtkSmartPointer< vtkPoints > curvePoints = GetTemporaryPoints(scratchBuffers);
   vtkSlicerMarkupsToModelCurveGeneration::AllocateCurvePoints(controlPoints, curvePoints, tubeSegmentsBetweenControlPoints, tubeLoop);
 
   // Iterate over the segments to interpolate, add all the "in-between" points
@@ -327,7 +693,8 @@ void vtkSlicerMarkupsToModelCurveGeneration::GeneratePiecewiseLinearCurveModel(v
 
 //------------------------------------------------------------------------------
 void vtkSlicerMarkupsToModelCurveGeneration::GenerateCardinalSplineCurveModel(vtkPoints* controlPoints, vtkPolyData* outputTubePolyData,
-  double tubeRadius, int tubeNumberOfSides, int tubeSegmentsBetweenControlPoints, bool tubeLoop)
+  double tubeRadius, int tubeNumberOfSides, int tubeSegmentsBetweenControlPoints, bool tubeLoop, double tubeSamplingTolerance,
+  vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers)
 {
   if (controlPoints == NULL)
   {
@@ -358,7 +725,7 @@ void vtkSlicerMarkupsToModelCurveGeneration::GenerateCardinalSplineCurveModel(vt
 
   if (numberControlPoints == 2)
   {
-    vtkSlicerMarkupsToModelCurveGeneration::GeneratePiecewiseLinearCurveModel(controlPoints, outputTubePolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop);
+    vtkSlicerMarkupsToModelCurveGeneration::GeneratePiecewiseLinearCurveModel(controlPoints, outputTubePolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop, tubeSamplingTolerance, scratchBuffers);
     return;
   }
 
@@ -368,9 +735,6 @@ void vtkSlicerMarkupsToModelCurveGeneration::GenerateCardinalSplineCurveModel(vt
   vtkSmartPointer< vtkCardinalSpline > splineZ = vtkSmartPointer< vtkCardinalSpline >::New();
   vtkSlicerMarkupsToModelCurveGeneration::SetCardinalSplineParameters(controlPoints, splineX, splineY, splineZ, tubeLoop);
 
-  vtkSmartPointer< vtkPoints > curvePoints = vtkSmartPointer< vtkPoints >::New();
-  vtkSlicerMarkupsToModelCurveGeneration::AllocateCurvePoints(controlPoints, curvePoints, tubeSegmentsBetweenControlPoints, tubeLoop);
-
   // Iterate over the segments to interpolate, add all the "in-between" points
   int numberSegmentsToInterpolate;
   if (tubeLoop)
@@ -381,28 +745,23 @@ void vtkSlicerMarkupsToModelCurveGeneration::GenerateCardinalSplineCurveModel(vt
   {
     numberSegmentsToInterpolate = numberControlPoints - 1;
   }
-  int controlPointIndex = 0;
-  int controlPointIndexNext = 1;
-  while (controlPointIndex < numberSegmentsToInterpolate)
+  int controlPointIndex = numberSegmentsToInterpolate % numberControlPoints; // if the index exceeds the max, bring back to 0
+  double finalPoint[3] = { 0.0, 0.0, 0.0 };
+  controlPoints->GetPoint(controlPointIndex, finalPoint);
+
+  vtkSlicerMarkupsToModelScratchBuffers::Scope scratchScope(scratchBuffers);
+  vtkSmartPointer< vtkPoints > curvePoints = GetTemporaryPoints(scratchBuffers);
+  if (tubeSamplingTolerance > 0.0)
   {
-    // iterate to compute interpolating points
-    for (int i = 0; i < tubeSegmentsBetweenControlPoints; i++)
-    {
-      double interpolationParam = controlPointIndex + i / (double)tubeSegmentsBetweenControlPoints;
-      double curvePoint[3];
-      curvePoint[0] = splineX->Evaluate(interpolationParam);
-      curvePoint[1] = splineY->Evaluate(interpolationParam);
-      curvePoint[2] = splineZ->Evaluate(interpolationParam);
-      int curveIndex = controlPointIndex * tubeSegmentsBetweenControlPoints + i;
-      curvePoints->SetPoint(curveIndex, curvePoint);
-    }
-    controlPointIndex++;
-    controlPointIndexNext++;
+    SampleSplineSegmentsAdaptively(splineX, splineY, splineZ, numberSegmentsToInterpolate, tubeSamplingTolerance, curvePoints);
+    vtkSlicerMarkupsToModelCurveGeneration::AddFinalCurvePoints(curvePoints, finalPoint, tubeLoop);
+    vtkSlicerMarkupsToModelCurveGeneration::GetTubePolyDataFromPoints(curvePoints, outputTubePolyData, tubeRadius, tubeNumberOfSides);
+    return;
   }
+
+  vtkSlicerMarkupsToModelCurveGeneration::AllocateCurvePoints(controlPoints, curvePoints, tubeSegmentsBetweenControlPoints, tubeLoop);
+  EvaluateSplineSegments(splineX, splineY, splineZ, 0.0, numberSegmentsToInterpolate, tubeSegmentsBetweenControlPoints, curvePoints, 0, scratchBuffers);
   // bring it the rest of the way to the final control point
-  controlPointIndex = controlPointIndex % numberControlPoints; // if the index exceeds the max, bring back to 0
-  double finalPoint[3] = { 0.0, 0.0, 0.0 };
-  controlPoints->GetPoint(controlPointIndex, finalPoint);
   int finalIndex = tubeSegmentsBetweenControlPoints * numberSegmentsToInterpolate;
   curvePoints->SetPoint(finalIndex, finalPoint);
 
@@ -418,7 +777,8 @@ void vtkSlicerMarkupsToModelCurveGeneration::GenerateCardinalSplineCurveModel(vt
 //------------------------------------------------------------------------------
 void vtkSlicerMarkupsToModelCurveGeneration::GenerateKochanekSplineCurveModel(vtkPoints* controlPoints, vtkPolyData* outputTubePolyData,
   double tubeRadius, int tubeNumberOfSides, int tubeSegmentsBetweenControlPoints, bool tubeLoop,
-  double kochanekBias, double kochanekContinuity, double kochanekTension, bool kochanekEndsCopyNearestDerivatives)
+  double kochanekBias, double kochanekContinuity, double kochanekTension, bool kochanekEndsCopyNearestDerivatives,
+  double tubeSamplingTolerance, vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers)
 {
   if (controlPoints == NULL)
   {
@@ -449,7 +809,7 @@ void vtkSlicerMarkupsToModelCurveGeneration::GenerateKochanekSplineCurveModel(vt
 
   if (numberControlPoints == 2)
   {
-    GeneratePiecewiseLinearCurveModel(controlPoints, outputTubePolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop);
+    GeneratePiecewiseLinearCurveModel(controlPoints, outputTubePolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop, tubeSamplingTolerance, scratchBuffers);
     return;
   }
 
@@ -460,9 +820,6 @@ void vtkSlicerMarkupsToModelCurveGeneration::GenerateKochanekSplineCurveModel(vt
   vtkSlicerMarkupsToModelCurveGeneration::SetKochanekSplineParameters(controlPoints, splineX, splineY, splineZ, tubeLoop,
     kochanekBias, kochanekContinuity, kochanekTension, kochanekEndsCopyNearestDerivatives);
 
-  vtkSmartPointer< vtkPoints > curvePoints = vtkSmartPointer< vtkPoints >::New();
-  vtkSlicerMarkupsToModelCurveGeneration::AllocateCurvePoints(controlPoints, curvePoints, tubeSegmentsBetweenControlPoints, tubeLoop);
-
   // Iterate over the segments to interpolate, add all the "in-between" points
   int numberSegmentsToInterpolate;
   if (tubeLoop)
@@ -473,28 +830,23 @@ void vtkSlicerMarkupsToModelCurveGeneration::GenerateKochanekSplineCurveModel(vt
   {
     numberSegmentsToInterpolate = numberControlPoints - 1;
   }
-  int controlPointIndex = 0;
-  int controlPointIndexNext = 1;
-  while (controlPointIndex < numberSegmentsToInterpolate)
+  int controlPointIndex = numberSegmentsToInterpolate % numberControlPoints; // if the index exceeds the max, bring back to 0
+  double finalPoint[3] = { 0.0, 0.0, 0.0 };
+  controlPoints->GetPoint(controlPointIndex, finalPoint);
+
+  vtkSlicerMarkupsToModelScratchBuffers::Scope scratchScope(scratchBuffers);
+  vtkSmartPointer< vtkPoints > curvePoints = GetTemporaryPoints(scratchBuffers);
+  if (tubeSamplingTolerance > 0.0)
   {
-    // iterate to compute interpolating points
-    for (int i = 0; i < tubeSegmentsBetweenControlPoints; i++)
-    {
-      double interpolationParam = controlPointIndex + i / (double)tubeSegmentsBetweenControlPoints;
-      double curvePoint[3];
-      curvePoint[0] = splineX->Evaluate(interpolationParam);
-      curvePoint[1] = splineY->Evaluate(interpolationParam);
-      curvePoint[2] = splineZ->Evaluate(interpolationParam);
-      int curveIndex = controlPointIndex * tubeSegmentsBetweenControlPoints + i;
-      curvePoints->SetPoint(curveIndex, curvePoint);
-    }
-    controlPointIndex++;
-    controlPointIndexNext++;
+    SampleSplineSegmentsAdaptively(splineX, splineY, splineZ, numberSegmentsToInterpolate, tubeSamplingTolerance, curvePoints);
+    vtkSlicerMarkupsToModelCurveGeneration::AddFinalCurvePoints(curvePoints, finalPoint, tubeLoop);
+    vtkSlicerMarkupsToModelCurveGeneration::GetTubePolyDataFromPoints(curvePoints, outputTubePolyData, tubeRadius, tubeNumberOfSides);
+    return;
   }
+
+  vtkSlicerMarkupsToModelCurveGeneration::AllocateCurvePoints(controlPoints, curvePoints, tubeSegmentsBetweenControlPoints, tubeLoop);
+  EvaluateSplineSegments(splineX, splineY, splineZ, 0.0, numberSegmentsToInterpolate, tubeSegmentsBetweenControlPoints, curvePoints, 0, scratchBuffers);
   // bring it the rest of the way to the final control point
-  controlPointIndex = controlPointIndex % numberControlPoints; // if the index exceeds the max, bring back to 0
-  double finalPoint[3] = { 0.0, 0.0, 0.0 };
-  controlPoints->GetPoint(controlPointIndex, finalPoint);
   int finalIndex = tubeSegmentsBetweenControlPoints * numberSegmentsToInterpolate;
   curvePoints->SetPoint(finalIndex, finalPoint);
 
@@ -510,7 +862,8 @@ void vtkSlicerMarkupsToModelCurveGeneration::GenerateKochanekSplineCurveModel(vt
 //------------------------------------------------------------------------------
 void vtkSlicerMarkupsToModelCurveGeneration::GeneratePolynomialCurveModel(vtkPoints* points, vtkPolyData* outputTubePolyData,
   double tubeRadius, int tubeNumberOfSides, int tubeSegmentsBetweenControlPoints, bool tubeLoop,
-  int polynomialOrder, vtkDoubleArray* inputPointParameters)
+  int polynomialOrder, vtkDoubleArray* inputPointParameters, double tubeSamplingTolerance,
+  vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers)
 {
   if (points == NULL)
   {
@@ -541,14 +894,22 @@ void vtkSlicerMarkupsToModelCurveGeneration::GeneratePolynomialCurveModel(vtkPoi
 
   if (numPoints == 2)
   {
-    GeneratePiecewiseLinearCurveModel(points, outputTubePolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop );
+    GeneratePiecewiseLinearCurveModel(points, outputTubePolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop, tubeSamplingTolerance, scratchBuffers);
     return;
   }
 
+  vtkSlicerMarkupsToModelScratchBuffers::Scope scratchScope(scratchBuffers);
   vtkSmartPointer<vtkDoubleArray> pointParameters = vtkDoubleArray::SafeDownCast(inputPointParameters);
   if (pointParameters == NULL) // if not defined, create an array based on the raw indices
   {
-    pointParameters = vtkSmartPointer<vtkDoubleArray>::New();
+    if (scratchBuffers != NULL)
+    {
+      pointParameters = scratchBuffers->GetDoubleArray();
+    }
+    else
+    {
+      pointParameters = vtkSmartPointer<vtkDoubleArray>::New();
+    }
     vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromIndices(points, pointParameters);
   }
   else if (pointParameters->GetNumberOfTuples() != numPoints) // check size of point parameters array for consistency
@@ -557,139 +918,145 @@ void vtkSlicerMarkupsToModelCurveGeneration::GeneratePolynomialCurveModel(vtkPoi
     return; // this should not happen at all, so best course of action is to simply return and let the user handle this situation appropriately
   }
 
-  // The system of equations using high-order polynomials is not well-conditioned.
-  // The vtkMath implementation will usually abort with polynomial orders higher than 9.
-  // Since there is also numerical instability, we decide to limit the polynomial order to 6.
-  // If order higher than 6 is needed on a global fit, then another algorithm should be considered anyway.
-  // If at some point we want to add support for higher order polynomials, then here are two options (from Andras):
-  // 1. VNL. While the VNL code is more sophisticated, and I guess also more stable, you would probably need to
-  //    limit the number of samples and normalize data that you pass to the LSQR solver to be able to compute 
-  //    higher-order fits (see for example this page for related discussion:
-  //    http://digital.ni.com/public.nsf/allkb/45C2016C23B3B0298525645F0073B828). 
-  //    See an example how VNL is used in Plus:
-  //    https://app.assembla.com/spaces/plus/subversion/source/HEAD/trunk/PlusLib/src/PlusCommon/PlusMath.cxx#ln111
-  // 2. Mathematica uses different basis functions for polynomial fitting (shifted Chebyshev polynomials) instead 
-  //    of basis functions that are simple powers of a variable to make the fitting more robust (the source code
-  //    is available here: http://library.wolfram.com/infocenter/MathSource/6780/).
-  const int maximumPolynomialOrder = 6;
-  if (polynomialOrder > maximumPolynomialOrder)
+  // The curve is fit in shifted Chebyshev basis, which keeps the least squares problem well-conditioned
+  // for much higher orders than the power basis.
+  if (polynomialOrder > POLYNOMIAL_ORDER_MAXIMUM)
   {
     vtkGenericWarningMacro("Desired polynomial order " << polynomialOrder << " is not supported. "
-      << "Maximum polynomial order is " << maximumPolynomialOrder << ". "
-      << "Will attempt to create polynomial order " << maximumPolynomialOrder << " instead.");
-    polynomialOrder = maximumPolynomialOrder;
+      << "Maximum polynomial order is " << POLYNOMIAL_ORDER_MAXIMUM << ". "
+      << "Will attempt to create polynomial order " << POLYNOMIAL_ORDER_MAXIMUM << " instead.");
+    polynomialOrder = POLYNOMIAL_ORDER_MAXIMUM;
   }
-
-  int numPolynomialCoefficients = polynomialOrder + 1;
-  // special case, if polynomial is underdetermined, change the order of the polynomial
-  std::set<double> uniquePointParameters;
-  for (int i = 0; i < numPoints; i++)
-    uniquePointParameters.insert(pointParameters->GetValue(i));
-  int numUniquePointParameters = uniquePointParameters.size();
-  if (numUniquePointParameters < numPolynomialCoefficients)
+  if (polynomialOrder < 1)
   {
-    // must reduce the order of polynomial according to the amount of information is available
-    numPolynomialCoefficients = numUniquePointParameters;
+    polynomialOrder = 1;
   }
 
-  // independent values (parameter along the curve)
-  int numIndependentValues = numPoints * numPolynomialCoefficients;
-  std::vector<double> independentValues(numIndependentValues); // independent values
-  independentValues.assign(numIndependentValues, 0.0);
-  for (int c = 0; c < numPolynomialCoefficients; c++) // o = degree index
-  {
-    for (int p = 0; p < numPoints; p++) // p = point index
+  const int numDimensions = 3; // this should never be changed from 3
+  double coefficientValues[(POLYNOMIAL_ORDER_MAXIMUM + 1) * numDimensions];
+  // the order of the polynomial is reduced if the point parameters do not determine all the coefficients
+  int numPolynomialCoefficients = vtkSlicerMarkupsToModelCurveGeneration::FitShiftedChebyshevPolynomial(
+    points, pointParameters, polynomialOrder + 1, coefficientValues);
+
+  // Use the values to generate points along the polynomial curve
+  ShiftedChebyshevPolynomialCurve polynomialCurve;
+  polynomialCurve.Coefficients = coefficientValues;
+  polynomialCurve.NumberOfCoefficients = numPolynomialCoefficients;
+  vtkSmartPointer<vtkPoints> smoothedPoints = GetTemporaryPoints(scratchBuffers); // points
+  if (tubeSamplingTolerance > 0.0)
+  {
+    // the curve is sampled in the same number of intervals as the input points, each subdivided as needed
+    int numberOfIntervals = numPoints - 1;
+    for (int i = 0; i < numberOfIntervals; i++)
     {
-      double value = std::pow(pointParameters->GetValue(p), c);
-      independentValues[p * numPolynomialCoefficients + c] = value;
+      SampleCurveAdaptively(polynomialCurve, i / (double)numberOfIntervals, (i + 1) / (double)numberOfIntervals, tubeSamplingTolerance, smoothedPoints);
     }
+    double endPoint[3] = { 0.0, 0.0, 0.0 };
+    polynomialCurve.Evaluate(1.0, endPoint);
+    smoothedPoints->InsertNextPoint(endPoint);
+    vtkSlicerMarkupsToModelTubeGeneration::GenerateTubeModel(smoothedPoints, outputTubePolyData, tubeRadius, tubeNumberOfSides);
+    return;
   }
-  std::vector<double*> independentMatrix(numPoints);
-  independentMatrix.assign(numPoints, NULL);
-  for (int p = 0; p < numPoints; p++)
+  int numPointsOnCurve = (numPoints - 1) * tubeSegmentsBetweenControlPoints + 1;
+  smoothedPoints->SetNumberOfPoints(numPointsOnCurve);
+  for (int p = 0; p < numPointsOnCurve; p++) // p = point index
   {
-    independentMatrix[p] = &(independentValues[p * numPolynomialCoefficients]);
+    double pointMm[3] = { 0.0, 0.0, 0.0 };
+    polynomialCurve.Evaluate(double(p) / (numPointsOnCurve - 1), pointMm);
+    smoothedPoints->SetPoint(p, pointMm);
   }
-  double** independentMatrixPtr = &(independentMatrix[0]);
 
-  // dependent values
-  const int numDimensions = 3; // this should never be changed from 3
-  int numDependentValues = numPoints * numDimensions;
-  std::vector<double> dependentValues(numDependentValues); // dependent values
-  dependentValues.assign(numDependentValues, 0.0);
-  for (int p = 0; p < numPoints; p++) // p = point index
+  // Convert the points to a tube model
+  vtkSlicerMarkupsToModelTubeGeneration::GenerateTubeModel(smoothedPoints, outputTubePolyData, tubeRadius, tubeNumberOfSides);
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelCurveGeneration::FitShiftedChebyshevPolynomial(vtkPoints* points, vtkDoubleArray* pointParameters,
+  int numberOfCoefficients, double* coefficients)
+{
+  const int maximumNumberOfCoefficients = POLYNOMIAL_ORDER_MAXIMUM + 1;
+  const int numDimensions = 3;
+  numberOfCoefficients = std::max(1, std::min(numberOfCoefficients, maximumNumberOfCoefficients));
+
+  // normal equations (upper triangle) and right hand sides, accumulated in a single pass over the points
+  double normalMatrix[maximumNumberOfCoefficients][maximumNumberOfCoefficients];
+  double rightHandSides[maximumNumberOfCoefficients][numDimensions];
+  for (int i = 0; i < numberOfCoefficients; i++)
   {
-    double* currentPoint = points->GetPoint(p);
-    for (int d = 0; d < numDimensions; d++) // d = dimension index
-    {
-      double value = currentPoint[d];
-      dependentValues[p * numDimensions + d] = value;
-    }
+    std::fill(normalMatrix[i], normalMatrix[i] + numberOfCoefficients, 0.0);
+    std::fill(rightHandSides[i], rightHandSides[i] + numDimensions, 0.0);
   }
-  std::vector<double*> dependentMatrix(numPoints);
-  dependentMatrix.assign(numPoints, NULL);
+  double basisValues[maximumNumberOfCoefficients];
+  int numPoints = points->GetNumberOfPoints();
   for (int p = 0; p < numPoints; p++)
   {
-    dependentMatrix[p] = &(dependentValues[p * numDimensions]);
-  }
-  double** dependentMatrixPtr = &(dependentMatrix[0]);
-
-  // solution to least squares
-  int totalNumberCoefficients = numDimensions*numPolynomialCoefficients;
-  std::vector<double> coefficientValues(totalNumberCoefficients);
-  coefficientValues.assign(totalNumberCoefficients, 0.0);
-  std::vector<double*> coefficientMatrix(numPolynomialCoefficients);
-  for (int c = 0; c < numPolynomialCoefficients; c++)
-  {
-    coefficientMatrix[c] = &(coefficientValues[c * numDimensions]);
+    double point[3] = { 0.0, 0.0, 0.0 };
+    points->GetPoint(p, point);
+    EvaluateShiftedChebyshevBasis(pointParameters->GetValue(p), numberOfCoefficients, basisValues);
+    for (int i = 0; i < numberOfCoefficients; i++)
+    {
+      for (int j = i; j < numberOfCoefficients; j++)
+      {
+        normalMatrix[i][j] += basisValues[i] * basisValues[j];
+      }
+      for (int d = 0; d < numDimensions; d++)
+      {
+        rightHandSides[i][d] += basisValues[i] * point[d];
+      }
+    }
   }
-  double** coefficientMatrixPtr = &(coefficientMatrix[0]); // the solution
 
-  // Input the forumulation into SolveLeastSquares
-  vtkMath::SolveLeastSquares(numPoints, independentMatrixPtr, numPolynomialCoefficients, dependentMatrixPtr, numDimensions, coefficientMatrixPtr);
-
-  // Use the values to generate points along the polynomial curve
-  vtkSmartPointer<vtkPoints> smoothedPoints = vtkSmartPointer<vtkPoints>::New(); // points
-  vtkSmartPointer< vtkCellArray > smoothedLines = vtkSmartPointer<  vtkCellArray >::New(); // lines
-  int numPointsOnCurve = (numPoints - 1) * tubeSegmentsBetweenControlPoints + 1;
-  smoothedLines->InsertNextCell(numPointsOnCurve); // one long continuous line
-  for (int p = 0; p < numPointsOnCurve; p++) // p = point index
+  // Cholesky decomposition in place (normal matrix = R^T * R, upper triangle of R is stored).
+  // The decomposition of the leading rows does not depend on the rest, so if a pivot vanishes
+  // the fit is simply restricted to the coefficients before it.
+  int rank = numberOfCoefficients;
+  for (int k = 0; k < numberOfCoefficients; k++)
   {
-    double pointMm[3];
-    for (int d = 0; d < numDimensions; d++)
+    double pivot = normalMatrix[k][k];
+    for (int j = 0; j < k; j++)
     {
-      pointMm[d] = 0.0;
-      for (int c = 0; c < numPolynomialCoefficients; c++)
+      pivot -= normalMatrix[j][k] * normalMatrix[j][k];
+    }
+    if (!(pivot > POLYNOMIAL_FIT_RELATIVE_PIVOT_TOLERANCE * normalMatrix[k][k]))
+    {
+      rank = k;
+      break;
+    }
+    normalMatrix[k][k] = sqrt(pivot);
+    for (int i = k + 1; i < numberOfCoefficients; i++)
+    {
+      double value = normalMatrix[k][i];
+      for (int j = 0; j < k; j++)
       {
-        double coefficient = coefficientValues[c * numDimensions + d];
-        pointMm[d] += coefficient * std::pow((double(p) / (numPointsOnCurve - 1)), c);
+        value -= normalMatrix[j][k] * normalMatrix[j][i];
       }
+      normalMatrix[k][i] = value / normalMatrix[k][k];
     }
-    smoothedPoints->InsertPoint(p, pointMm);
-    smoothedLines->InsertCellPoint(p);
   }
 
-  // Convert the points to a tube model
-  vtkSmartPointer< vtkPolyData >smoothedSegments = vtkSmartPointer< vtkPolyData >::New();
-  smoothedSegments->Initialize();
-  smoothedSegments->SetPoints(smoothedPoints);
-  smoothedSegments->SetLines(smoothedLines);
-
-  if (tubeRadius > 0.0)
+  // solve R^T * y = b, then R * c = y
+  for (int d = 0; d < numDimensions; d++)
+  {
+    for (int i = 0; i < rank; i++)
     {
-    vtkSmartPointer< vtkTubeFilter > tubeFilter = vtkSmartPointer< vtkTubeFilter >::New();
-    tubeFilter->SetInputData(smoothedSegments);
-    tubeFilter->SetRadius(tubeRadius);
-    tubeFilter->SetNumberOfSides(tubeNumberOfSides);
-    tubeFilter->CappingOn();
-    tubeFilter->Update();
-    outputTubePolyData->DeepCopy(tubeFilter->GetOutput());
+      double value = rightHandSides[i][d];
+      for (int j = 0; j < i; j++)
+      {
+        value -= normalMatrix[j][i] * coefficients[j * numDimensions + d];
+      }
+      coefficients[i * numDimensions + d] = value / normalMatrix[i][i];
     }
-  else
+    for (int i = rank - 1; i >= 0; i--)
     {
-    outputTube->DeepCopy(smoothedSegments);
+      double value = coefficients[i * numDimensions + d];
+      for (int j = i + 1; j < rank; j++)
+      {
+        value -= normalMatrix[i][j] * coefficients[j * numDimensions + d];
+      }
+      coefficients[i * numDimensions + d] = value / normalMatrix[i][i];
     }
-
+  }
+  return rank;
 }
 
 //------------------------------------------------------------------------------
@@ -731,40 +1098,619 @@ void vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromIndices(v
 }
 
 //------------------------------------------------------------------------------
-void vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSpanningTree(vtkPoints * points, vtkDoubleArray* pointParameters)
+// Edge of the nearest neighbor graph that the minimum spanning tree is built from
+struct MinimumSpanningTreeEdge
 {
-  if (points == NULL)
+  double Length;
+  int PointIndexA;
+  int PointIndexB;
+
+  bool operator<(const MinimumSpanningTreeEdge& other) const
   {
-    vtkGenericWarningMacro("Input points are null. Returning");
-    return;
+    return this->Length < other.Length;
   }
+};
 
-  if (pointParameters == NULL)
-  {
-    vtkGenericWarningMacro("Output point parameters are null. Returning");
-    return;
+//------------------------------------------------------------------------------
+// Minimum spanning forest that is built edge by edge: the union-find sets of the connected components
+// and the adjacency lists of the tree. The lists are stored in arrays of half-edges (one for each direction
+// of each edge), linked in the order the edges were added.
+struct MinimumSpanningTree
+{
+  int NumberOfPoints;
+  int* SetParents;
+  int* SetRanks;
+  int* FirstHalfEdges; // first half-edge from each point, -1 if none
+  int* LastHalfEdges;
+  int* NextHalfEdges; // next half-edge from the same point, -1 if none
+  int* HalfEdgeTargets;
+  double* HalfEdgeLengths;
+  int NumberOfHalfEdges;
+
+  MinimumSpanningTree(int numberOfPoints, vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers)
+  {
+    this->NumberOfPoints = numberOfPoints;
+    this->SetParents = scratchBuffers->Allocate< int >(numberOfPoints);
+    this->SetRanks = scratchBuffers->Allocate< int >(numberOfPoints);
+    this->FirstHalfEdges = scratchBuffers->Allocate< int >(numberOfPoints);
+    this->LastHalfEdges = scratchBuffers->Allocate< int >(numberOfPoints);
+    for (int i = 0; i < numberOfPoints; i++)
+    {
+      this->SetParents[i] = i;
+      this->SetRanks[i] = 0;
+      this->FirstHalfEdges[i] = -1;
+      this->LastHalfEdges[i] = -1;
+    }
+    // a tree has numberOfPoints - 1 edges
+    int maximumNumberOfHalfEdges = std::max(2 * (numberOfPoints - 1), 0);
+    this->NextHalfEdges = scratchBuffers->Allocate< int >(maximumNumberOfHalfEdges);
+    this->HalfEdgeTargets = scratchBuffers->Allocate< int >(maximumNumberOfHalfEdges);
+    this->HalfEdgeLengths = scratchBuffers->Allocate< double >(maximumNumberOfHalfEdges);
+    this->NumberOfHalfEdges = 0;
   }
 
-  int numPoints = points->GetNumberOfPoints();
-  // redundant error checking, to be safe
-  if (numPoints < 2)
+  void AddHalfEdge(int sourceIndex, int targetIndex, double length)
   {
-    vtkGenericWarningMacro("Not enough points to compute polynomial parameters. Need at least 2 points but " << numPoints << " are provided.");
-    return;
+    int halfEdgeIndex = this->NumberOfHalfEdges++;
+    this->NextHalfEdges[halfEdgeIndex] = -1;
+    this->HalfEdgeTargets[halfEdgeIndex] = targetIndex;
+    this->HalfEdgeLengths[halfEdgeIndex] = length;
+    if (this->LastHalfEdges[sourceIndex] < 0)
+    {
+      this->FirstHalfEdges[sourceIndex] = halfEdgeIndex;
+    }
+    else
+    {
+      this->NextHalfEdges[this->LastHalfEdges[sourceIndex]] = halfEdgeIndex;
+    }
+    this->LastHalfEdges[sourceIndex] = halfEdgeIndex;
   }
+};
 
-  // vtk boost algorithms cannot be used because they are not built with 3D Slicer
-  // so this is a custom implementation of:
-  // 1. constructing an undirected graph as a 2D array
-  // 2. Finding the two vertices that are the farthest apart
+//------------------------------------------------------------------------------
+// Find the representative of the set that contains index (union-find with path compression)
+static int FindSetRoot(int* setParents, int index)
+{
+  int root = index;
+  while (setParents[root] != root)
+  {
+    root = setParents[root];
+  }
+  while (setParents[index] != root)
+  {
+    int nextIndex = setParents[index];
+    setParents[index] = root;
+    index = nextIndex;
+  }
+  return root;
+}
+
+//------------------------------------------------------------------------------
+// Merge the sets that contain indexA and indexB (union by rank).
+// Returns false if they are already in the same set.
+static bool UnionSets(int* setParents, int* setRanks, int indexA, int indexB)
+{
+  int rootA = FindSetRoot(setParents, indexA);
+  int rootB = FindSetRoot(setParents, indexB);
+  if (rootA == rootB)
+  {
+    return false;
+  }
+  if (setRanks[rootA] < setRanks[rootB])
+  {
+    std::swap(rootA, rootB);
+  }
+  setParents[rootB] = rootA;
+  if (setRanks[rootA] == setRanks[rootB])
+  {
+    setRanks[rootA]++;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Add the edge to the tree if it connects two separate components of the forest.
+// Returns true if the edge was added.
+static bool AddMinimumSpanningTreeEdge(const MinimumSpanningTreeEdge& edge, MinimumSpanningTree& tree)
+{
+  if (!UnionSets(tree.SetParents, tree.SetRanks, edge.PointIndexA, edge.PointIndexB))
+  {
+    return false;
+  }
+  tree.AddHalfEdge(edge.PointIndexA, edge.PointIndexB, edge.Length);
+  tree.AddHalfEdge(edge.PointIndexB, edge.PointIndexA, edge.Length);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Node of the k-d tree that is used for connecting the components of a minimum spanning forest.
+// The points of the node are PointIndices[First] ... PointIndices[Last - 1] of the locator.
+struct MinimumSpanningForestNode
+{
+  double Bounds[6];
+  int First;
+  int Last;
+  int LeftChild; // -1 for leaves
+  int RightChild;
+  int Component; // component of all points of the node, -1 if they are in different components
+};
+
+//------------------------------------------------------------------------------
+// Orders point indices by one coordinate, for splitting the k-d tree nodes
+struct MinimumSpanningForestPointComparator
+{
+  const double* Coordinates;
+  int Axis;
+
+  bool operator()(int pointIndexA, int pointIndexB) const
+  {
+    return this->Coordinates[3 * pointIndexA + this->Axis] < this->Coordinates[3 * pointIndexB + this->Axis];
+  }
+};
+
+//------------------------------------------------------------------------------
+// Point locator for finding the closest point of another component of a minimum spanning forest.
+// It is built once for all points. The components are updated in each round of Boruvka's algorithm
+// and stored in the k-d tree nodes as well, so that nodes that only contain points of the same
+// component as the query point are skipped.
+struct MinimumSpanningForestLocator
+{
+  int NumberOfPoints;
+  double* Coordinates; // 3 values for each point
+  int* PointIndices;
+  int* PointComponents; // root of the union-find set of each point
+  MinimumSpanningForestNode* Nodes;
+  int NumberOfNodes;
+  MinimumSpanningTreeEdge* ShortestEdges; // shortest edge from each component, indexed by the root of the component
+
+  MinimumSpanningForestLocator(vtkPoints* points, vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers)
+  {
+    int numPoints = points->GetNumberOfPoints();
+    this->NumberOfPoints = numPoints;
+    this->Coordinates = scratchBuffers->Allocate< double >(3 * numPoints);
+    this->PointIndices = scratchBuffers->Allocate< int >(numPoints);
+    this->PointComponents = scratchBuffers->Allocate< int >(numPoints);
+    this->ShortestEdges = scratchBuffers->Allocate< MinimumSpanningTreeEdge >(numPoints);
+    for (int i = 0; i < numPoints; i++)
+    {
+      points->GetPoint(i, this->Coordinates + 3 * i);
+      this->PointIndices[i] = i;
+    }
+    // leaves have at least half of the leaf size, so there are at most 2 * numPoints / leafSize + 1 leaves
+    this->Nodes = scratchBuffers->Allocate< MinimumSpanningForestNode >(4 * (numPoints / MINIMUM_SPANNING_FOREST_LEAF_SIZE + 1));
+    this->NumberOfNodes = 0;
+    this->BuildNode(0, numPoints);
+  }
+
+  int BuildNode(int first, int last)
+  {
+    int nodeIndex = this->NumberOfNodes++;
+    MinimumSpanningForestNode& node = this->Nodes[nodeIndex];
+    node.First = first;
+    node.Last = last;
+    node.LeftChild = -1;
+    node.RightChild = -1;
+    node.Component = -1;
+    for (int i = first; i < last; i++)
+    {
+      const double* point = this->Coordinates + 3 * this->PointIndices[i];
+      for (int axis = 0; axis < 3; axis++)
+      {
+        node.Bounds[2 * axis] = (i == first) ? point[axis] : std::min(node.Bounds[2 * axis], point[axis]);
+        node.Bounds[2 * axis + 1] = (i == first) ? point[axis] : std::max(node.Bounds[2 * axis + 1], point[axis]);
+      }
+    }
+    if (last - first <= MINIMUM_SPANNING_FOREST_LEAF_SIZE)
+    {
+      return nodeIndex;
+    }
+
+    // split at the median of the longest side
+    MinimumSpanningForestPointComparator comparator;
+    comparator.Coordinates = this->Coordinates;
+    comparator.Axis = 0;
+    for (int axis = 1; axis < 3; axis++)
+    {
+      if (node.Bounds[2 * axis + 1] - node.Bounds[2 * axis] > node.Bounds[2 * comparator.Axis + 1] - node.Bounds[2 * comparator.Axis])
+      {
+        comparator.Axis = axis;
+      }
+    }
+    int middle = (first + last) / 2;
+    std::nth_element(this->PointIndices + first, this->PointIndices + middle, this->PointIndices + last, comparator);
+    // the node array is allocated for the whole tree, so node remains valid
+    node.LeftChild = this->BuildNode(first, middle);
+    node.RightChild = this->BuildNode(middle, last);
+    return nodeIndex;
+  }
+
+  // Update the components of the points and the nodes from the union-find sets of the tree.
+  // Returns the number of components.
+  int UpdateComponents(MinimumSpanningTree& tree)
+  {
+    int numberOfComponents = 0;
+    for (int i = 0; i < this->NumberOfPoints; i++)
+    {
+      this->PointComponents[i] = FindSetRoot(tree.SetParents, i);
+      if (this->PointComponents[i] == i)
+      {
+        numberOfComponents++;
+      }
+    }
+    // children are always after their parent in the node array
+    for (int nodeIndex = this->NumberOfNodes - 1; nodeIndex >= 0; nodeIndex--)
+    {
+      MinimumSpanningForestNode& node = this->Nodes[nodeIndex];
+      if (node.LeftChild < 0)
+      {
+        node.Component = this->PointComponents[this->PointIndices[node.First]];
+        for (int i = node.First + 1; i < node.Last && node.Component >= 0; i++)
+        {
+          if (this->PointComponents[this->PointIndices[i]] != node.Component)
+          {
+            node.Component = -1;
+          }
+        }
+      }
+      else
+      {
+        int leftComponent = this->Nodes[node.LeftChild].Component;
+        node.Component = (leftComponent == this->Nodes[node.RightChild].Component) ? leftComponent : -1;
+      }
+    }
+    return numberOfComponents;
+  }
+
+  static double GetDistance2ToBounds(const double bounds[6], const double point[3])
+  {
+    double distance2 = 0.0;
+    for (int axis = 0; axis < 3; axis++)
+    {
+      double difference = std::max(0.0, std::max(bounds[2 * axis] - point[axis], point[axis] - bounds[2 * axis + 1]));
+      distance2 += difference * difference;
+    }
+    return distance2;
+  }
+
+  // Find the closest point to the given point that is not in the specified component and is closer than
+  // sqrt(closestDistance2). closestDistance2 and closestPointIndex are updated if such a point is found.
+  void FindClosestPointInOtherComponent(int nodeIndex, const double point[3], int component,
+    double& closestDistance2, int& closestPointIndex) const
+  {
+    const MinimumSpanningForestNode& node = this->Nodes[nodeIndex];
+    if (node.Component == component)
+    {
+      return;
+    }
+    if (node.LeftChild < 0)
+    {
+      for (int i = node.First; i < node.Last; i++)
+      {
+        int pointIndex = this->PointIndices[i];
+        if (this->PointComponents[pointIndex] == component)
+        {
+          continue;
+        }
+        double distance2 = vtkMath::Distance2BetweenPoints(point, this->Coordinates + 3 * pointIndex);
+        if (distance2 < closestDistance2)
+        {
+          closestDistance2 = distance2;
+          closestPointIndex = pointIndex;
+        }
+      }
+      return;
+    }
+    // visit the closer child first, so that more of the farther one is pruned
+    int closerChild = node.LeftChild;
+    int fartherChild = node.RightChild;
+    double closerDistance2 = GetDistance2ToBounds(this->Nodes[closerChild].Bounds, point);
+    double fartherDistance2 = GetDistance2ToBounds(this->Nodes[fartherChild].Bounds, point);
+    if (fartherDistance2 < closerDistance2)
+    {
+      std::swap(closerChild, fartherChild);
+      std::swap(closerDistance2, fartherDistance2);
+    }
+    if (closerDistance2 < closestDistance2)
+    {
+      this->FindClosestPointInOtherComponent(closerChild, point, component, closestDistance2, closestPointIndex);
+    }
+    if (fartherDistance2 < closestDistance2)
+    {
+      this->FindClosestPointInOtherComponent(fartherChild, point, component, closestDistance2, closestPointIndex);
+    }
+  }
+};
+
+//------------------------------------------------------------------------------
+// The nearest neighbor graph is not connected if the points form clusters that are farther apart
+// than the neighborhood size. Add the shortest edge between each component and the rest of the points
+// (one round of Boruvka's algorithm). Each point is queried once, only for edges that are shorter than
+// the shortest edge found so far from its component. Returns the number of edges added to the tree.
+static int ConnectMinimumSpanningForest(MinimumSpanningForestLocator& locator, MinimumSpanningTree& tree)
+{
+  if (locator.UpdateComponents(tree) < 2)
+  {
+    return 0;
+  }
+
+  int numPoints = locator.NumberOfPoints;
+  MinimumSpanningTreeEdge* shortestEdges = locator.ShortestEdges;
+  for (int i = 0; i < numPoints; i++)
+  {
+    // lengths are squared until all points are processed
+    shortestEdges[i].Length = VTK_DOUBLE_MAX;
+    shortestEdges[i].PointIndexA = -1;
+    shortestEdges[i].PointIndexB = -1;
+  }
+  for (int i = 0; i < numPoints; i++)
+  {
+    MinimumSpanningTreeEdge& shortestEdge = shortestEdges[locator.PointComponents[i]];
+    int closestPointIndex = -1;
+    locator.FindClosestPointInOtherComponent(0, locator.Coordinates + 3 * i, locator.PointComponents[i],
+      shortestEdge.Length, closestPointIndex);
+    if (closestPointIndex >= 0)
+    {
+      shortestEdge.PointIndexA = i;
+      shortestEdge.PointIndexB = closestPointIndex;
+    }
+  }
+
+  int numberOfAddedEdges = 0;
+  for (int i = 0; i < numPoints; i++)
+  {
+    if (shortestEdges[i].PointIndexA < 0)
+    {
+      continue;
+    }
+    shortestEdges[i].Length = sqrt(shortestEdges[i].Length);
+    if (AddMinimumSpanningTreeEdge(shortestEdges[i], tree))
+    {
+      numberOfAddedEdges++;
+    }
+  }
+  return numberOfAddedEdges;
+}
+
+//------------------------------------------------------------------------------
+// Traverse the tree from startIndex and return the point that is farthest from it along the tree.
+// The (weighted) distance from the start, the parent of each point and the traversal order are stored in the output arrays,
+// which must have space for one value for each point. Points are always visited after their parent.
+// The number of visited points is stored in outputNumberOfVisitedPoints.
+static int FindFarthestTreePoint(const MinimumSpanningTree& tree, int startIndex,
+  int* parents, double* treeDistances, int* visitOrder, int& outputNumberOfVisitedPoints)
+{
+  int numPoints = tree.NumberOfPoints;
+  std::fill(parents, parents + numPoints, -1);
+  std::fill(treeDistances, treeDistances + numPoints, -1.0);
+
+  treeDistances[startIndex] = 0.0;
+  int numberOfVisitedPoints = 0;
+  visitOrder[numberOfVisitedPoints++] = startIndex;
+  for (int i = 0; i < numberOfVisitedPoints; i++)
+  {
+    int currentIndex = visitOrder[i];
+    for (int halfEdgeIndex = tree.FirstHalfEdges[currentIndex]; halfEdgeIndex >= 0; halfEdgeIndex = tree.NextHalfEdges[halfEdgeIndex])
+    {
+      int neighborIndex = tree.HalfEdgeTargets[halfEdgeIndex];
+      if (treeDistances[neighborIndex] >= 0.0)
+      {
+        continue; // already visited
+      }
+      treeDistances[neighborIndex] = treeDistances[currentIndex] + tree.HalfEdgeLengths[halfEdgeIndex];
+      parents[neighborIndex] = currentIndex;
+      visitOrder[numberOfVisitedPoints++] = neighborIndex;
+    }
+  }
+  outputNumberOfVisitedPoints = numberOfVisitedPoints;
+
+  int farthestIndex = startIndex;
+  for (int i = 0; i < numberOfVisitedPoints; i++)
+  {
+    if (treeDistances[visitOrder[i]] > treeDistances[farthestIndex])
+    {
+      farthestIndex = visitOrder[i];
+    }
+  }
+  return farthestIndex;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSpanningTree(vtkPoints * points, vtkDoubleArray* pointParameters,
+  vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers, double* outputTreeLength)
+{
+  if (points == NULL)
+  {
+    vtkGenericWarningMacro("Input points are null. Returning");
+    return;
+  }
+
+  if (pointParameters == NULL)
+  {
+    vtkGenericWarningMacro("Output point parameters are null. Returning");
+    return;
+  }
+
+  int numPoints = points->GetNumberOfPoints();
+  // redundant error checking, to be safe
+  if (numPoints < 2)
+  {
+    vtkGenericWarningMacro("Not enough points to compute polynomial parameters. Need at least 2 points but " << numPoints << " are provided.");
+    return;
+  }
+
+  vtkSmartPointer< vtkSlicerMarkupsToModelScratchBuffers > temporaryScratchBuffers;
+  if (scratchBuffers == NULL)
+  {
+    temporaryScratchBuffers = vtkSmartPointer< vtkSlicerMarkupsToModelScratchBuffers >::New();
+    scratchBuffers = temporaryScratchBuffers;
+  }
+  vtkSlicerMarkupsToModelScratchBuffers::Scope scratchScope(scratchBuffers);
+
+  // The steps are:
+  // 1. construct a sparse graph that connects each point to its nearest neighbors
+  // 2. run Kruskal's algorithm on the graph (and connect the remaining components if the graph was not connected)
+  // 3. find the two ends of the longest path in the tree, using two traversals
+  // 4. based on the distance along that "trunk" path, assign each vertex a polynomial parameter value
+
+  // 1. nearest neighbor graph
+  vtkSmartPointer< vtkPolyData > pointsPolyData = vtkSmartPointer< vtkPolyData >::New();
+  pointsPolyData->SetPoints(points);
+  vtkSmartPointer< vtkStaticPointLocator > pointLocator = vtkSmartPointer< vtkStaticPointLocator >::New();
+  pointLocator->SetDataSet(pointsPolyData);
+  pointLocator->BuildLocator();
+
+  int numberOfNeighbors = std::min(MINIMUM_SPANNING_TREE_NUMBER_OF_NEIGHBORS, numPoints - 1);
+  // the point itself may be missing from its neighbors if it has duplicates, so there can be one more edge per point
+  MinimumSpanningTreeEdge* edges = scratchBuffers->Allocate< MinimumSpanningTreeEdge >(numPoints * (numberOfNeighbors + 1));
+  int numberOfEdges = 0;
+  vtkSmartPointer< vtkIdList > neighborIds = vtkSmartPointer< vtkIdList >::New();
+  for (int u = 0; u < numPoints; u++)
+  {
+    double pointU[3] = { 0.0, 0.0, 0.0 };
+    points->GetPoint(u, pointU);
+    // the point itself is included in the result
+    pointLocator->FindClosestNPoints(numberOfNeighbors + 1, pointU, neighborIds);
+    for (vtkIdType i = 0; i < neighborIds->GetNumberOfIds(); i++)
+    {
+      int v = neighborIds->GetId(i);
+      if (v == u)
+      {
+        continue;
+      }
+      MinimumSpanningTreeEdge edge;
+      edge.Length = sqrt(vtkMath::Distance2BetweenPoints(pointU, points->GetPoint(v)));
+      edge.PointIndexA = u;
+      edge.PointIndexB = v;
+      edges[numberOfEdges++] = edge;
+    }
+  }
+
+  // 2. Kruskal's algorithm
+  std::sort(edges, edges + numberOfEdges);
+  MinimumSpanningTree tree(numPoints, scratchBuffers);
+  int numberOfTreeEdges = 0;
+  for (int i = 0; i < numberOfEdges && numberOfTreeEdges < numPoints - 1; i++)
+  {
+    if (AddMinimumSpanningTreeEdge(edges[i], tree))
+    {
+      numberOfTreeEdges++;
+    }
+  }
+  if (numberOfTreeEdges < numPoints - 1)
+  {
+    MinimumSpanningForestLocator forestLocator(points, scratchBuffers);
+    while (numberOfTreeEdges < numPoints - 1)
+    {
+      int numberOfAddedEdges = ConnectMinimumSpanningForest(forestLocator, tree);
+      if (numberOfAddedEdges == 0)
+      {
+        break; // should never happen
+      }
+      numberOfTreeEdges += numberOfAddedEdges;
+    }
+  }
+  if (outputTreeLength != NULL)
+  {
+    // each edge is stored as two half-edges
+    double treeLength = 0.0;
+    for (int i = 0; i < tree.NumberOfHalfEdges; i++)
+    {
+      treeLength += tree.HalfEdgeLengths[i];
+    }
+    *outputTreeLength = 0.5 * treeLength;
+  }
+
+  // 3. the trunk is the longest path in the tree
+  int* parents = scratchBuffers->Allocate< int >(numPoints);
+  double* treeDistances = scratchBuffers->Allocate< double >(numPoints);
+  int* visitOrder = scratchBuffers->Allocate< int >(numPoints);
+  int numberOfVisitedPoints = 0;
+  int trunkStartIndex = FindFarthestTreePoint(tree, 0, parents, treeDistances, visitOrder, numberOfVisitedPoints);
+  int trunkEndIndex = FindFarthestTreePoint(tree, trunkStartIndex, parents, treeDistances, visitOrder, numberOfVisitedPoints);
+  double trunkLength = treeDistances[trunkEndIndex];
+
+  // check this to prevent a division by zero (in case all points are duplicates)
+  if (trunkLength == 0)
+  {
+    vtkGenericWarningMacro("Minimum spanning tree path has distance zero. No parameters will be assigned. Check inputs (are there duplicate points?).");
+    return;
+  }
+
+  // 4. points along the trunk get their relative distance from the start of the trunk,
+  // points that branch off the trunk get the parameter of the trunk point where their branch starts
+  double* parameters = scratchBuffers->Allocate< double >(numPoints);
+  std::fill(parameters, parameters + numPoints, -1.0);
+  for (int currentIndex = trunkEndIndex; currentIndex != -1; currentIndex = parents[currentIndex])
+  {
+    parameters[currentIndex] = treeDistances[currentIndex] / trunkLength;
+  }
+  // the tree is rooted at the start of the trunk, so parents are always visited before their children
+  for (int i = 0; i < numberOfVisitedPoints; i++)
+  {
+    int currentIndex = visitOrder[i];
+    if (parameters[currentIndex] < 0.0 && parents[currentIndex] >= 0)
+    {
+      parameters[currentIndex] = parameters[parents[currentIndex]];
+    }
+  }
+
+  if (pointParameters->GetNumberOfTuples() > 0)
+  {
+    // this should never happen, but in case it does, output a warning
+    vtkGenericWarningMacro("pointParameters already has contents. Clearing.");
+    pointParameters->Reset();
+  }
+
+  for (int i = 0; i < numPoints; i++)
+  {
+    pointParameters->InsertNextTuple1(std::max(parameters[i], 0.0));
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromDenseMinimumSpanningTree(vtkPoints * points, vtkDoubleArray* pointParameters,
+  vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers, double* outputTreeLength)
+{
+  if (points == NULL)
+  {
+    vtkGenericWarningMacro("Input points are null. Returning");
+    return;
+  }
+
+  if (pointParameters == NULL)
+  {
+    vtkGenericWarningMacro("Output point parameters are null. Returning");
+    return;
+  }
+
+  int numPoints = points->GetNumberOfPoints();
+  // redundant error checking, to be safe
+  if (numPoints < 2)
+  {
+    vtkGenericWarningMacro("Not enough points to compute polynomial parameters. Need at least 2 points but " << numPoints << " are provided.");
+    return;
+  }
+
+  vtkSmartPointer< vtkSlicerMarkupsToModelScratchBuffers > temporaryScratchBuffers;
+  if (scratchBuffers == NULL)
+  {
+    temporaryScratchBuffers = vtkSmartPointer< vtkSlicerMarkupsToModelScratchBuffers >::New();
+    scratchBuffers = temporaryScratchBuffers;
+  }
+  vtkSlicerMarkupsToModelScratchBuffers::Scope scratchScope(scratchBuffers);
+
+  // vtk boost algorithms cannot be used because they are not built with 3D Slicer
+  // so this is a custom implementation of:
+  // 1. constructing an undirected graph as a 2D array
+  // 2. Finding the two vertices that are the farthest apart
   // 3. running prim's algorithm on the graph
   // 4. extract the "trunk" path from the last vertex to the first
   // 5. based on the distance along that path, assign each vertex a polynomial parameter value
 
   // in the following code, two tasks are done:
   // 1. construct an undirected graph
-  std::vector< double > distances(numPoints * numPoints);
-  distances.assign(numPoints * numPoints, 0.0);
+  double* distances = scratchBuffers->Allocate< double >(static_cast< size_t >(numPoints) * numPoints);
+  std::fill(distances, distances + static_cast< size_t >(numPoints) * numPoints, 0.0);
   // 2. find the two farthest-seperated vertices in the distances array
   int treeStartIndex = 0;
   int treeEndIndex = 0;
@@ -781,7 +1727,7 @@ void vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSp
       double distY = (pointU[1] - pointV[1]); double distYsq = distY * distY;
       double distZ = (pointU[2] - pointV[2]); double distZsq = distZ * distZ;
       double dist3D = sqrt(distXsq + distYsq + distZsq);
-      distances[v * numPoints + u] = dist3D;
+      distances[static_cast< size_t >(v) * numPoints + u] = dist3D;
       if (dist3D > maximumDistance)
       {
         maximumDistance = dist3D;
@@ -791,17 +1737,17 @@ void vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSp
     }
   }
   // use the 1D vector as a 2D vector
-  std::vector< double* > graph(numPoints);
+  double** graph = scratchBuffers->Allocate< double* >(numPoints);
   for (int v = 0; v < numPoints; v++)
   {
-    graph[v] = &(distances[v * numPoints]);
+    graph[v] = distances + static_cast< size_t >(v) * numPoints;
   }
 
   // implementation of Prim's algorithm heavily based on:
   // http://www.geeksforgeeks.org/greedy-algorithms-set-5-prims-minimum-spanning-tree-mst-2/
-  std::vector< int > parent(numPoints); // Array to store constructed MST
-  std::vector< double > key(numPoints);   // Key values used to pick minimum weight edge in cut
-  std::vector< bool > mstSet(numPoints);  // To represent set of vertices not yet included in MST
+  int* parent = scratchBuffers->Allocate< int >(numPoints); // Array to store constructed MST
+  double* key = scratchBuffers->Allocate< double >(numPoints);   // Key values used to pick minimum weight edge in cut
+  bool* mstSet = scratchBuffers->Allocate< bool >(numPoints);  // To represent set of vertices not yet included in MST
 
   // Initialize all keys as INFINITE (or at least as close as we can get)
   for (int i = 0; i < numPoints; i++)
@@ -851,20 +1797,32 @@ void vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSp
     }
   }
 
+  if (outputTreeLength != NULL)
+  {
+    // the key of each point is the length of the edge to its parent
+    double treeLength = 0.0;
+    for (int v = 0; v < numPoints; v++)
+    {
+      treeLength += key[v];
+    }
+    *outputTreeLength = treeLength;
+  }
+
   // determine the "trunk" path of the tree, from first index to last index
-  std::vector< int > pathIndices;
+  int* pathIndices = scratchBuffers->Allocate< int >(numPoints);
+  int numberOfPathIndices = 0;
   int currentPathIndex = treeEndIndex;
   while (currentPathIndex != -1)
   {
-    pathIndices.push_back(currentPathIndex);
+    pathIndices[numberOfPathIndices++] = currentPathIndex;
     currentPathIndex = parent[currentPathIndex]; // go up the tree one layer
   }
 
   // find the sum of distances along the trunk path of the tree
   double sumOfDistances = 0.0;
-  for (unsigned int i = 0; i < pathIndices.size() - 1; i++)
+  for (int i = 0; i < numberOfPathIndices - 1; i++)
   {
-    sumOfDistances += graph[i][i + 1];
+    sumOfDistances += graph[pathIndices[i]][pathIndices[i + 1]];
   }
 
   // check this to prevent a division by zero (in case all points are duplicates)
@@ -875,14 +1833,14 @@ void vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSp
   }
 
   // find the parameters along the trunk path of the tree
-  std::vector< double > pathParameters;
+  double* pathParameters = scratchBuffers->Allocate< double >(numberOfPathIndices);
   double currentDistance = 0.0;
-  for (unsigned int i = 0; i < pathIndices.size() - 1; i++)
+  for (int i = 0; i < numberOfPathIndices - 1; i++)
   {
-    pathParameters.push_back(currentDistance / sumOfDistances);
-    currentDistance += graph[i][i + 1];
+    pathParameters[i] = currentDistance / sumOfDistances;
+    currentDistance += graph[pathIndices[i]][pathIndices[i + 1]];
   }
-  pathParameters.push_back(currentDistance / sumOfDistances); // this should be 1.0
+  pathParameters[numberOfPathIndices - 1] = currentDistance / sumOfDistances; // this should be 1.0
 
   // finally assign polynomial parameters to each point, and store in the output array
   if (pointParameters->GetNumberOfTuples() > 0)
@@ -898,7 +1856,7 @@ void vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSp
     int currentIndex = i;
     bool alongPath = false;
     int indexAlongPath = -1;
-    for (unsigned int j = 0; j < pathIndices.size(); j++)
+    for (int j = 0; j < numberOfPathIndices; j++)
     {
       if (pathIndices[j] == currentIndex)
       {
@@ -910,7 +1868,7 @@ void vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSp
     while (!alongPath)
     {
       currentIndex = parent[currentIndex];
-      for (unsigned int j = 0; j < pathIndices.size(); j++)
+      for (int j = 0; j < numberOfPathIndices; j++)
       {
         if (pathIndices[j] == currentIndex)
         {
@@ -924,6 +1882,715 @@ void vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSp
   }
 }
 
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelCurveGeneration::ResetIncrementalState()
+{
+  this->IncrementalControlPoints = NULL;
+  this->IncrementalCurvePoints = NULL;
+  this->IncrementalTubeNormals.clear();
+  this->IncrementalOutputPolyData = NULL;
+  this->IncrementalOutputMTime = 0;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelCurveGeneration::UpdateCurveModelIncrementally(vtkPoints* controlPoints, vtkPolyData* outputTubePolyData,
+  int interpolationType, double tubeRadius, int tubeNumberOfSides, int tubeSegmentsBetweenControlPoints, bool tubeLoop,
+  double kochanekBias, double kochanekContinuity, double kochanekTension, bool kochanekEndsCopyNearestDerivatives)
+{
+  if (controlPoints == NULL)
+  {
+    vtkGenericWarningMacro("Control points are null. No model generated.");
+    return false;
+  }
+
+  if (outputTubePolyData == NULL)
+  {
+    vtkGenericWarningMacro("Output tube poly data is null. No model generated.");
+    return false;
+  }
+
+  if (interpolationType != vtkMRMLMarkupsToModelNode::Linear &&
+    interpolationType != vtkMRMLMarkupsToModelNode::CardinalSpline &&
+    interpolationType != vtkMRMLMarkupsToModelNode::KochanekSpline)
+  {
+    vtkGenericWarningMacro("Incremental update is only supported for linear, Cardinal spline and Kochanek spline curves. No model generated.");
+    this->ResetIncrementalState();
+    return false;
+  }
+
+  // special cases, these are cheap to generate from scratch
+  int numberControlPoints = controlPoints->GetNumberOfPoints();
+  if (numberControlPoints < 3)
+  {
+    this->ResetIncrementalState();
+    if (numberControlPoints == 1)
+    {
+      vtkSlicerMarkupsToModelCurveGeneration::GenerateSphereModel(controlPoints->GetPoint(0), outputTubePolyData, tubeRadius, tubeNumberOfSides);
+    }
+    else if (numberControlPoints == 2)
+    {
+      vtkSlicerMarkupsToModelCurveGeneration::GeneratePiecewiseLinearCurveModel(controlPoints, outputTubePolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop);
+    }
+    return false;
+  }
+
+  if (tubeSegmentsBetweenControlPoints < 1)
+  {
+    tubeSegmentsBetweenControlPoints = 1;
+  }
+  if (tubeNumberOfSides < 3)
+  {
+    tubeNumberOfSides = 3; // same as vtkTubeFilter
+  }
+
+  bool patchOutput = (this->IncrementalControlPoints.GetPointer() != NULL
+    && this->IncrementalControlPoints->GetNumberOfPoints() == numberControlPoints
+    && this->IncrementalOutputPolyData.GetPointer() == outputTubePolyData
+    && this->IncrementalOutputMTime == outputTubePolyData->GetMTime()
+    && this->IncrementalInterpolationType == interpolationType
+    && this->IncrementalTubeRadius == tubeRadius
+    && this->IncrementalTubeNumberOfSides == tubeNumberOfSides
+    && this->IncrementalTubeSegmentsBetweenControlPoints == tubeSegmentsBetweenControlPoints
+    && this->IncrementalTubeLoop == tubeLoop
+    && this->IncrementalKochanekBias == kochanekBias
+    && this->IncrementalKochanekContinuity == kochanekContinuity
+    && this->IncrementalKochanekTension == kochanekTension
+    && this->IncrementalKochanekEndsCopyNearestDerivatives == kochanekEndsCopyNearestDerivatives);
+
+  int numberSegments = tubeLoop ? numberControlPoints : numberControlPoints - 1;
+
+  // find the segments that are affected by the moved control points
+  std::vector< std::pair< int, int > > segmentRanges;
+  if (patchOutput)
+  {
+    std::vector< int > changedControlPointIndices;
+    for (int i = 0; i < numberControlPoints; i++)
+    {
+      double previousPoint[3] = { 0.0, 0.0, 0.0 };
+      this->IncrementalControlPoints->GetPoint(i, previousPoint);
+      double currentPoint[3] = { 0.0, 0.0, 0.0 };
+      controlPoints->GetPoint(i, currentPoint);
+      if (previousPoint[0] != currentPoint[0] || previousPoint[1] != currentPoint[1] || previousPoint[2] != currentPoint[2])
+      {
+        changedControlPointIndices.push_back(i);
+      }
+    }
+    if (changedControlPointIndices.empty())
+    {
+      // nothing to do
+      return true;
+    }
+    int maximumNumberOfChangedControlPoints = std::max(1, (int)(INCREMENTAL_UPDATE_MAXIMUM_CHANGED_FRACTION * numberControlPoints));
+    if ((int)changedControlPointIndices.size() > maximumNumberOfChangedControlPoints)
+    {
+      patchOutput = false;
+    }
+
+    int influenceSegments = 0;
+    if (interpolationType == vtkMRMLMarkupsToModelNode::CardinalSpline)
+    {
+      influenceSegments = CARDINAL_SPLINE_INCREMENTAL_INFLUENCE_SEGMENTS;
+    }
+    else if (interpolationType == vtkMRMLMarkupsToModelNode::KochanekSpline)
+    {
+      influenceSegments = KOCHANEK_SPLINE_INCREMENTAL_INFLUENCE_SEGMENTS;
+    }
+    for (unsigned int i = 0; patchOutput && i < changedControlPointIndices.size(); i++)
+    {
+      // segment k connects control points k and k+1
+      int firstSegment = changedControlPointIndices[i] - 1 - influenceSegments;
+      int lastSegment = changedControlPointIndices[i] + influenceSegments;
+      if (!tubeLoop)
+      {
+        firstSegment = std::max(0, firstSegment);
+        lastSegment = std::min(numberSegments - 1, lastSegment);
+      }
+      if (!segmentRanges.empty() && firstSegment <= segmentRanges.back().second + 1)
+      {
+        segmentRanges.back().second = std::max(segmentRanges.back().second, lastSegment);
+      }
+      else
+      {
+        segmentRanges.push_back(std::make_pair(firstSegment, lastSegment));
+      }
+    }
+    if (patchOutput && tubeLoop)
+    {
+      // merge the last range into the first one if they overlap at the seam of the loop
+      if (segmentRanges.size() > 1 && segmentRanges.back().second + 1 >= segmentRanges.front().first + numberSegments)
+      {
+        segmentRanges.front().first = segmentRanges.back().first - numberSegments;
+        segmentRanges.pop_back();
+      }
+      int numberOfAffectedSegments = 0;
+      for (unsigned int i = 0; i < segmentRanges.size(); i++)
+      {
+        numberOfAffectedSegments += segmentRanges[i].second - segmentRanges[i].first + 1;
+      }
+      if (numberOfAffectedSegments >= numberSegments)
+      {
+        patchOutput = false;
+      }
+    }
+  }
+
+  if (!patchOutput)
+  {
+    // regenerate the whole curve
+    this->IncrementalInterpolationType = interpolationType;
+    this->IncrementalTubeRadius = tubeRadius;
+    this->IncrementalTubeNumberOfSides = tubeNumberOfSides;
+    this->IncrementalTubeSegmentsBetweenControlPoints = tubeSegmentsBetweenControlPoints;
+    this->IncrementalTubeLoop = tubeLoop;
+    this->IncrementalKochanekBias = kochanekBias;
+    this->IncrementalKochanekContinuity = kochanekContinuity;
+    this->IncrementalKochanekTension = kochanekTension;
+    this->IncrementalKochanekEndsCopyNearestDerivatives = kochanekEndsCopyNearestDerivatives;
+
+    this->IncrementalControlPoints = vtkSmartPointer< vtkPoints >::New();
+    this->IncrementalControlPoints->DeepCopy(controlPoints);
+    this->IncrementalCurvePoints = vtkSmartPointer< vtkPoints >::New();
+    vtkSlicerMarkupsToModelCurveGeneration::AllocateCurvePoints(controlPoints, this->IncrementalCurvePoints, tubeSegmentsBetweenControlPoints, tubeLoop);
+    this->ComputeIncrementalCurveSegments(controlPoints, 0, numberSegments - 1);
+
+    vtkIdType numberCurvePoints = this->IncrementalCurvePoints->GetNumberOfPoints();
+    this->IncrementalTubeNormals.assign(3 * numberCurvePoints, 0.0);
+    vtkSlicerMarkupsToModelTubeGeneration::ComputeTubeNormals(this->IncrementalCurvePoints, &(this->IncrementalTubeNormals[0]),
+      0, numberCurvePoints - 1, false);
+
+    vtkSlicerMarkupsToModelTubeGeneration::AllocateTubePolyData(numberCurvePoints, tubeRadius, tubeNumberOfSides, outputTubePolyData);
+    vtkSlicerMarkupsToModelTubeGeneration::UpdateTubeRings(this->IncrementalCurvePoints, &(this->IncrementalTubeNormals[0]),
+      tubeRadius, tubeNumberOfSides, outputTubePolyData, 0, numberCurvePoints - 1);
+    vtkSlicerMarkupsToModelTubeGeneration::UpdateCurveMeasures(this->IncrementalCurvePoints, tubeRadius, tubeNumberOfSides,
+      outputTubePolyData, 0, numberCurvePoints - 1);
+    outputTubePolyData->Modified();
+    this->IncrementalOutputPolyData = outputTubePolyData;
+    this->IncrementalOutputMTime = outputTubePolyData->GetMTime();
+    return false;
+  }
+
+  // recompute the affected segments and collect the modified curve point index ranges
+  int segmentsBetween = tubeSegmentsBetweenControlPoints;
+  vtkIdType numberSegmentCurvePoints = numberSegments * segmentsBetween;
+  vtkIdType numberCurvePoints = this->IncrementalCurvePoints->GetNumberOfPoints();
+  std::vector< std::pair< vtkIdType, vtkIdType > > curvePointRanges;
+  for (unsigned int i = 0; i < segmentRanges.size(); i++)
+  {
+    int firstSegment = segmentRanges[i].first;
+    int lastSegment = segmentRanges[i].second;
+    this->ComputeIncrementalCurveSegments(controlPoints, firstSegment, lastSegment);
+
+    vtkIdType firstCurvePoint = (vtkIdType)firstSegment * segmentsBetween;
+    vtkIdType lastCurvePoint = (vtkIdType)(lastSegment + 1) * segmentsBetween - 1;
+    if (!tubeLoop)
+    {
+      if (lastSegment == numberSegments - 1)
+      {
+        lastCurvePoint = numberSegmentCurvePoints; // final point
+      }
+      curvePointRanges.push_back(std::make_pair(firstCurvePoint, lastCurvePoint));
+      continue;
+    }
+    // ranges of a loop may wrap around
+    bool includesFirstSegment = (firstCurvePoint <= 0);
+    if (firstCurvePoint < 0)
+    {
+      curvePointRanges.push_back(std::make_pair(firstCurvePoint + numberSegmentCurvePoints, numberSegmentCurvePoints - 1));
+      firstCurvePoint = 0;
+    }
+    if (lastCurvePoint >= numberSegmentCurvePoints)
+    {
+      curvePointRanges.push_back(std::make_pair((vtkIdType)0, lastCurvePoint - numberSegmentCurvePoints));
+      lastCurvePoint = numberSegmentCurvePoints - 1;
+      includesFirstSegment = true;
+    }
+    curvePointRanges.push_back(std::make_pair(firstCurvePoint, lastCurvePoint));
+    if (includesFirstSegment)
+    {
+      // the points closing the loop are also modified
+      curvePointRanges.push_back(std::make_pair(numberSegmentCurvePoints, numberCurvePoints - 1));
+    }
+  }
+  std::sort(curvePointRanges.begin(), curvePointRanges.end());
+
+  // the tangents (and so the tube frames) also change at the neighbors of the modified points,
+  // ranges that are closer than that are processed together
+  std::vector< std::pair< vtkIdType, vtkIdType > > ringRanges;
+  for (unsigned int i = 0; i < curvePointRanges.size(); i++)
+  {
+    vtkIdType firstCurvePoint = std::max((vtkIdType)0, curvePointRanges[i].first - 1);
+    vtkIdType lastCurvePoint = std::min(numberCurvePoints - 1, curvePointRanges[i].second + 1);
+    if (!ringRanges.empty() && firstCurvePoint <= ringRanges.back().second + 2)
+    {
+      ringRanges.back().second = std::max(ringRanges.back().second, lastCurvePoint);
+    }
+    else
+    {
+      ringRanges.push_back(std::make_pair(firstCurvePoint, lastCurvePoint));
+    }
+  }
+  for (unsigned int i = 0; i < ringRanges.size(); i++)
+  {
+    vtkSlicerMarkupsToModelTubeGeneration::ComputeTubeNormals(this->IncrementalCurvePoints, &(this->IncrementalTubeNormals[0]),
+      ringRanges[i].first, ringRanges[i].second, true);
+    vtkSlicerMarkupsToModelTubeGeneration::UpdateTubeRings(this->IncrementalCurvePoints, &(this->IncrementalTubeNormals[0]),
+      this->IncrementalTubeRadius, this->IncrementalTubeNumberOfSides, outputTubePolyData, ringRanges[i].first, ringRanges[i].second);
+  }
+  if (!ringRanges.empty())
+  {
+    // the arc length changes from the first modified point to the end of the curve anyway,
+    // so the measures are updated once for all ranges
+    vtkSlicerMarkupsToModelTubeGeneration::UpdateCurveMeasures(this->IncrementalCurvePoints, this->IncrementalTubeRadius,
+      this->IncrementalTubeNumberOfSides, outputTubePolyData, ringRanges.front().first, ringRanges.back().second);
+  }
+
+  this->IncrementalControlPoints->DeepCopy(controlPoints);
+  outputTubePolyData->Modified();
+  this->IncrementalOutputMTime = outputTubePolyData->GetMTime();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelCurveGeneration::ComputeIncrementalCurveSegments(vtkPoints* controlPoints, int firstSegment, int lastSegment)
+{
+  // Segment indices may be out of range for loops, they are wrapped around.
+  // Curve points of the segments are written to IncrementalCurvePoints at the same indices
+  // as the non-incremental generator functions use.
+  int numberControlPoints = controlPoints->GetNumberOfPoints();
+  int numberSegments = this->IncrementalTubeLoop ? numberControlPoints : numberControlPoints - 1;
+  int segmentsBetween = this->IncrementalTubeSegmentsBetweenControlPoints;
+  vtkPoints* curvePoints = this->IncrementalCurvePoints;
+
+  if (this->IncrementalInterpolationType == vtkMRMLMarkupsToModelNode::Linear)
+  {
+    for (int segment = firstSegment; segment <= lastSegment; segment++)
+    {
+      int segmentIndex = PositiveModulo(segment, numberSegments);
+      double controlPointCurrent[3];
+      controlPoints->GetPoint(segmentIndex, controlPointCurrent);
+      double controlPointNext[3];
+      controlPoints->GetPoint((segmentIndex + 1) % numberControlPoints, controlPointNext);
+      for (int i = 0; i < segmentsBetween; i++)
+      {
+        double interpolationParam = i / (double)segmentsBetween;
+        double curvePoint[3];
+        curvePoint[0] = (1.0 - interpolationParam) * controlPointCurrent[0] + interpolationParam * controlPointNext[0];
+        curvePoint[1] = (1.0 - interpolationParam) * controlPointCurrent[1] + interpolationParam * controlPointNext[1];
+        curvePoint[2] = (1.0 - interpolationParam) * controlPointCurrent[2] + interpolationParam * controlPointNext[2];
+        curvePoints->SetPoint(segmentIndex * segmentsBetween + i, curvePoint);
+      }
+    }
+  }
+  else
+  {
+    // Fit a spline only to the control points that influence the requested segments.
+    // If that would include all control points then the spline of the whole curve is used.
+    int margin = (this->IncrementalInterpolationType == vtkMRMLMarkupsToModelNode::KochanekSpline) ?
+      KOCHANEK_SPLINE_INCREMENTAL_MARGIN : CARDINAL_SPLINE_INCREMENTAL_MARGIN;
+    int windowFirst = firstSegment - margin;
+    int windowLast = lastSegment + 1 + margin;
+    bool useWholeCurve = false;
+    if (this->IncrementalTubeLoop)
+    {
+      useWholeCurve = (windowLast - windowFirst + 1 >= numberControlPoints);
+    }
+    else
+    {
+      windowFirst = std::max(0, windowFirst);
+      windowLast = std::min(numberControlPoints - 1, windowLast);
+      useWholeCurve = (windowFirst == 0 && windowLast == numberControlPoints - 1);
+    }
+
+    vtkSmartPointer< vtkPoints > windowPoints = controlPoints;
+    if (useWholeCurve)
+    {
+      windowFirst = 0;
+    }
+    else
+    {
+      windowPoints = vtkSmartPointer< vtkPoints >::New();
+      windowPoints->SetNumberOfPoints(windowLast - windowFirst + 1);
+      for (int i = windowFirst; i <= windowLast; i++)
+      {
+        windowPoints->SetPoint(i - windowFirst, controlPoints->GetPoint(PositiveModulo(i, numberControlPoints)));
+      }
+    }
+    bool closedSpline = useWholeCurve && this->IncrementalTubeLoop;
+
+    vtkSmartPointer< vtkSpline > splineX;
+    vtkSmartPointer< vtkSpline > splineY;
+    vtkSmartPointer< vtkSpline > splineZ;
+    if (this->IncrementalInterpolationType == vtkMRMLMarkupsToModelNode::KochanekSpline)
+    {
+      vtkSmartPointer< vtkKochanekSpline > kochanekSplineX = vtkSmartPointer< vtkKochanekSpline >::New();
+      vtkSmartPointer< vtkKochanekSpline > kochanekSplineY = vtkSmartPointer< vtkKochanekSpline >::New();
+      vtkSmartPointer< vtkKochanekSpline > kochanekSplineZ = vtkSmartPointer< vtkKochanekSpline >::New();
+      vtkSlicerMarkupsToModelCurveGeneration::SetKochanekSplineParameters(windowPoints, kochanekSplineX, kochanekSplineY, kochanekSplineZ, closedSpline,
+        this->IncrementalKochanekBias, this->IncrementalKochanekContinuity, this->IncrementalKochanekTension, this->IncrementalKochanekEndsCopyNearestDerivatives);
+      splineX = kochanekSplineX;
+      splineY = kochanekSplineY;
+      splineZ = kochanekSplineZ;
+    }
+    else
+    {
+      vtkSmartPointer< vtkCardinalSpline > cardinalSplineX = vtkSmartPointer< vtkCardinalSpline >::New();
+      vtkSmartPointer< vtkCardinalSpline > cardinalSplineY = vtkSmartPointer< vtkCardinalSpline >::New();
+      vtkSmartPointer< vtkCardinalSpline > cardinalSplineZ = vtkSmartPointer< vtkCardinalSpline >::New();
+      vtkSlicerMarkupsToModelCurveGeneration::SetCardinalSplineParameters(windowPoints, cardinalSplineX, cardinalSplineY, cardinalSplineZ, closedSpline);
+      splineX = cardinalSplineX;
+      splineY = cardinalSplineY;
+      splineZ = cardinalSplineZ;
+    }
+
+    for (int segment = firstSegment; segment <= lastSegment; segment++)
+    {
+      int segmentIndex = PositiveModulo(segment, numberSegments);
+      double segmentParam = useWholeCurve ? segmentIndex : segment - windowFirst;
+      EvaluateSplineSegments(splineX, splineY, splineZ, segmentParam, 1, segmentsBetween, curvePoints, segmentIndex * segmentsBetween);
+    }
+  }
+
+  // final point and closing of the loop
+  int finalIndex = segmentsBetween * numberSegments;
+  if (this->IncrementalTubeLoop)
+  {
+    int firstSegmentIndex = PositiveModulo(firstSegment, numberSegments);
+    bool includesFirstSegment = (firstSegmentIndex == 0 || firstSegmentIndex + (lastSegment - firstSegment) >= numberSegments);
+    if (includesFirstSegment)
+    {
+      curvePoints->SetPoint(finalIndex, controlPoints->GetPoint(0));
+      vtkSlicerMarkupsToModelCurveGeneration::CloseLoop(curvePoints);
+    }
+  }
+  else if (lastSegment >= numberSegments - 1)
+  {
+    curvePoints->SetPoint(finalIndex, controlPoints->GetPoint(numberControlPoints - 1));
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelCurveGeneration::ResetStreamingState()
+{
+  this->StreamingControlPoints.clear();
+  this->StreamingNumberOfInputPoints = 0;
+  this->StreamingCurvePoints = NULL;
+  this->StreamingTubeNormals.clear();
+  this->StreamingOutputPolyData = NULL;
+  this->StreamingOutputMTime = 0;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelCurveGeneration::UpdateCurveModelStreaming(vtkPoints* controlPoints, vtkPolyData* outputTubePolyData,
+  int interpolationType, double tubeRadius, int tubeNumberOfSides, int tubeSegmentsBetweenControlPoints,
+  double kochanekBias, double kochanekContinuity, double kochanekTension, bool kochanekEndsCopyNearestDerivatives,
+  double minimumPointDistance, int maximumNumberOfPoints, double maximumPointAge, double currentTime)
+{
+  if (controlPoints == NULL)
+  {
+    vtkGenericWarningMacro("Control points are null. No model generated.");
+    return false;
+  }
+
+  if (outputTubePolyData == NULL)
+  {
+    vtkGenericWarningMacro("Output tube poly data is null. No model generated.");
+    return false;
+  }
+
+  if (interpolationType != vtkMRMLMarkupsToModelNode::Linear &&
+    interpolationType != vtkMRMLMarkupsToModelNode::CardinalSpline &&
+    interpolationType != vtkMRMLMarkupsToModelNode::KochanekSpline)
+  {
+    vtkGenericWarningMacro("Streaming update is only supported for linear, Cardinal spline and Kochanek spline curves. No model generated.");
+    this->ResetStreamingState();
+    return false;
+  }
+
+  if (tubeSegmentsBetweenControlPoints < 1)
+  {
+    tubeSegmentsBetweenControlPoints = 1;
+  }
+  if (tubeNumberOfSides < 3)
+  {
+    tubeNumberOfSides = 3; // same as vtkTubeFilter
+  }
+
+  vtkIdType numberInputPoints = controlPoints->GetNumberOfPoints();
+  bool extendOutput = (this->StreamingCurvePoints.GetPointer() != NULL
+    && this->StreamingOutputPolyData.GetPointer() == outputTubePolyData
+    && this->StreamingOutputMTime == outputTubePolyData->GetMTime()
+    && this->StreamingInterpolationType == interpolationType
+    && this->StreamingTubeRadius == tubeRadius
+    && this->StreamingTubeNumberOfSides == tubeNumberOfSides
+    && this->StreamingTubeSegmentsBetweenControlPoints == tubeSegmentsBetweenControlPoints
+    && this->StreamingKochanekBias == kochanekBias
+    && this->StreamingKochanekContinuity == kochanekContinuity
+    && this->StreamingKochanekTension == kochanekTension
+    && this->StreamingKochanekEndsCopyNearestDerivatives == kochanekEndsCopyNearestDerivatives
+    && this->StreamingMinimumPointDistance == minimumPointDistance
+    && numberInputPoints >= this->StreamingNumberOfInputPoints);
+  if (extendOutput && this->StreamingNumberOfInputPoints > 0)
+  {
+    // the previously processed points must be unchanged (only the end of the curve is checked, to keep the cost constant)
+    double inputPoint[3] = { 0.0, 0.0, 0.0 };
+    controlPoints->GetPoint(this->StreamingNumberOfInputPoints - 1, inputPoint);
+    extendOutput = (inputPoint[0] == this->StreamingLastInputPoint[0]
+      && inputPoint[1] == this->StreamingLastInputPoint[1]
+      && inputPoint[2] == this->StreamingLastInputPoint[2]);
+    int numberOfCheckedControlPoints = std::min((int)this->StreamingControlPoints.size(), STREAMING_CHECKED_CONTROL_POINTS);
+    for (int i = 0; extendOutput && i < numberOfCheckedControlPoints; i++)
+    {
+      const StreamingControlPoint& controlPoint = this->StreamingControlPoints[this->StreamingControlPoints.size() - 1 - i];
+      controlPoints->GetPoint(controlPoint.InputIndex, inputPoint);
+      extendOutput = (inputPoint[0] == controlPoint.Position[0]
+        && inputPoint[1] == controlPoint.Position[1]
+        && inputPoint[2] == controlPoint.Position[2]);
+    }
+  }
+
+  if (!extendOutput)
+  {
+    // regenerate the whole curve from the most recent input points
+    this->StreamingInterpolationType = interpolationType;
+    this->StreamingTubeRadius = tubeRadius;
+    this->StreamingTubeNumberOfSides = tubeNumberOfSides;
+    this->StreamingTubeSegmentsBetweenControlPoints = tubeSegmentsBetweenControlPoints;
+    this->StreamingKochanekBias = kochanekBias;
+    this->StreamingKochanekContinuity = kochanekContinuity;
+    this->StreamingKochanekTension = kochanekTension;
+    this->StreamingKochanekEndsCopyNearestDerivatives = kochanekEndsCopyNearestDerivatives;
+    this->StreamingMinimumPointDistance = minimumPointDistance;
+
+    this->StreamingControlPoints.clear();
+    vtkIdType firstInputIndex = 0;
+    if (maximumNumberOfPoints > 0)
+    {
+      firstInputIndex = std::max((vtkIdType)0, numberInputPoints - maximumNumberOfPoints);
+    }
+    this->AppendStreamingControlPoints(controlPoints, firstInputIndex, currentTime);
+    this->StreamingCurvePoints = vtkSmartPointer< vtkPoints >::New();
+    this->StreamingTubeNormals.clear();
+    outputTubePolyData->Initialize();
+    this->UpdateStreamingCurve(outputTubePolyData, 0);
+    this->StreamingOutputPolyData = outputTubePolyData;
+    this->StreamingOutputMTime = outputTubePolyData->GetMTime();
+    return false;
+  }
+
+  int previousNumberControlPoints = (int)this->StreamingControlPoints.size();
+  int numberOfAppendedControlPoints = this->AppendStreamingControlPoints(controlPoints, this->StreamingNumberOfInputPoints, currentTime);
+
+  // remove old control points if a batch of them exceeds the retention limits
+  int numberControlPoints = (int)this->StreamingControlPoints.size();
+  int numberOfControlPointsToRemove = 0;
+  if (maximumNumberOfPoints > 0)
+  {
+    int batchSize = std::max(1, (int)(STREAMING_RETENTION_BATCH_FRACTION * maximumNumberOfPoints));
+    if (numberControlPoints - maximumNumberOfPoints >= batchSize)
+    {
+      numberOfControlPointsToRemove = numberControlPoints - maximumNumberOfPoints;
+    }
+  }
+  if (maximumPointAge > 0.0 && numberControlPoints > 0)
+  {
+    // points are in order of their time
+    double oldestTimeToKeep = currentTime - maximumPointAge;
+    int batchSize = std::max(1, (int)(STREAMING_RETENTION_BATCH_FRACTION * numberControlPoints));
+    if (this->StreamingControlPoints[batchSize - 1].Time < oldestTimeToKeep)
+    {
+      // binary search for the first point that is recent enough
+      int firstPointToKeep = batchSize;
+      int lastPointToCheck = numberControlPoints;
+      while (firstPointToKeep < lastPointToCheck)
+      {
+        int middle = (firstPointToKeep + lastPointToCheck) / 2;
+        if (this->StreamingControlPoints[middle].Time < oldestTimeToKeep)
+        {
+          firstPointToKeep = middle + 1;
+        }
+        else
+        {
+          lastPointToCheck = middle;
+        }
+      }
+      numberOfControlPointsToRemove = std::max(numberOfControlPointsToRemove, firstPointToKeep);
+    }
+  }
+  if (numberOfControlPointsToRemove > 0)
+  {
+    this->StreamingControlPoints.erase(this->StreamingControlPoints.begin(),
+      this->StreamingControlPoints.begin() + numberOfControlPointsToRemove);
+    this->StreamingCurvePoints->Reset();
+    this->StreamingTubeNormals.clear();
+    outputTubePolyData->Initialize();
+    this->UpdateStreamingCurve(outputTubePolyData, 0);
+    this->StreamingOutputMTime = outputTubePolyData->GetMTime();
+    return false;
+  }
+
+  if (numberOfAppendedControlPoints == 0)
+  {
+    // nothing to do
+    return true;
+  }
+
+  // segment k connects control points k and k+1, the new points affect the last segments before them
+  int influenceSegments = 0;
+  if (interpolationType == vtkMRMLMarkupsToModelNode::CardinalSpline)
+  {
+    influenceSegments = CARDINAL_SPLINE_INCREMENTAL_INFLUENCE_SEGMENTS;
+  }
+  else if (interpolationType == vtkMRMLMarkupsToModelNode::KochanekSpline)
+  {
+    influenceSegments = KOCHANEK_SPLINE_INCREMENTAL_INFLUENCE_SEGMENTS;
+  }
+  int firstSegment = std::max(0, previousNumberControlPoints - 1 - influenceSegments);
+  this->UpdateStreamingCurve(outputTubePolyData, firstSegment);
+  this->StreamingOutputMTime = outputTubePolyData->GetMTime();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelCurveGeneration::AppendStreamingControlPoints(vtkPoints* controlPoints, vtkIdType firstInputIndex, double currentTime)
+{
+  int numberOfAppendedControlPoints = 0;
+  double minimumPointDistanceSquared = this->StreamingMinimumPointDistance * this->StreamingMinimumPointDistance;
+  vtkIdType numberInputPoints = controlPoints->GetNumberOfPoints();
+  for (vtkIdType i = firstInputIndex; i < numberInputPoints; i++)
+  {
+    StreamingControlPoint controlPoint;
+    controlPoints->GetPoint(i, controlPoint.Position);
+    if (!this->StreamingControlPoints.empty() && minimumPointDistanceSquared > 0.0
+      && vtkMath::Distance2BetweenPoints(this->StreamingControlPoints.back().Position, controlPoint.Position) < minimumPointDistanceSquared)
+    {
+      continue;
+    }
+    controlPoint.Time = currentTime;
+    controlPoint.InputIndex = i;
+    this->StreamingControlPoints.push_back(controlPoint);
+    numberOfAppendedControlPoints++;
+  }
+  if (numberInputPoints > firstInputIndex)
+  {
+    controlPoints->GetPoint(numberInputPoints - 1, this->StreamingLastInputPoint);
+  }
+  this->StreamingNumberOfInputPoints = numberInputPoints;
+  return numberOfAppendedControlPoints;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelCurveGeneration::UpdateStreamingCurve(vtkPolyData* outputTubePolyData, int firstSegment)
+{
+  int numberControlPoints = (int)this->StreamingControlPoints.size();
+  vtkPoints* curvePoints = this->StreamingCurvePoints;
+  double tubeRadius = this->StreamingTubeRadius;
+  int tubeNumberOfSides = this->StreamingTubeNumberOfSides;
+  if (numberControlPoints < 2)
+  {
+    // no curve yet, same output as the other curve generators
+    outputTubePolyData->Initialize();
+    curvePoints->Reset();
+    this->StreamingTubeNormals.clear();
+    if (numberControlPoints == 1)
+    {
+      vtkSlicerMarkupsToModelCurveGeneration::GenerateSphereModel(this->StreamingControlPoints[0].Position,
+        outputTubePolyData, tubeRadius, tubeNumberOfSides);
+    }
+    return;
+  }
+  if (curvePoints->GetNumberOfPoints() < 2)
+  {
+    // the output does not contain a tube yet (it may contain the sphere of a single point)
+    outputTubePolyData->Initialize();
+    curvePoints->Reset();
+    firstSegment = 0;
+  }
+
+  int segmentsBetween = this->StreamingTubeSegmentsBetweenControlPoints;
+  int numberSegments = numberControlPoints - 1;
+  vtkIdType numberCurvePoints = (vtkIdType)numberSegments * segmentsBetween + 1;
+  for (vtkIdType i = curvePoints->GetNumberOfPoints(); i < numberCurvePoints; i++)
+  {
+    curvePoints->InsertNextPoint(0.0, 0.0, 0.0);
+  }
+  this->StreamingTubeNormals.resize(3 * numberCurvePoints, 0.0);
+
+  if (this->StreamingInterpolationType == vtkMRMLMarkupsToModelNode::Linear)
+  {
+    for (int segment = firstSegment; segment < numberSegments; segment++)
+    {
+      const double* controlPointCurrent = this->StreamingControlPoints[segment].Position;
+      const double* controlPointNext = this->StreamingControlPoints[segment + 1].Position;
+      for (int i = 0; i < segmentsBetween; i++)
+      {
+        double interpolationParam = i / (double)segmentsBetween;
+        double curvePoint[3];
+        curvePoint[0] = (1.0 - interpolationParam) * controlPointCurrent[0] + interpolationParam * controlPointNext[0];
+        curvePoint[1] = (1.0 - interpolationParam) * controlPointCurrent[1] + interpolationParam * controlPointNext[1];
+        curvePoint[2] = (1.0 - interpolationParam) * controlPointCurrent[2] + interpolationParam * controlPointNext[2];
+        curvePoints->SetPoint((vtkIdType)segment * segmentsBetween + i, curvePoint);
+      }
+    }
+  }
+  else
+  {
+    // fit a spline to the window of control points that influence the recomputed segments
+    int margin = (this->StreamingInterpolationType == vtkMRMLMarkupsToModelNode::KochanekSpline) ?
+      KOCHANEK_SPLINE_INCREMENTAL_MARGIN : CARDINAL_SPLINE_INCREMENTAL_MARGIN;
+    int windowFirst = std::max(0, firstSegment - margin);
+    vtkSmartPointer< vtkPoints > windowPoints = vtkSmartPointer< vtkPoints >::New();
+    windowPoints->SetNumberOfPoints(numberControlPoints - windowFirst);
+    for (int i = windowFirst; i < numberControlPoints; i++)
+    {
+      windowPoints->SetPoint(i - windowFirst, this->StreamingControlPoints[i].Position);
+    }
+
+    vtkSmartPointer< vtkSpline > splineX;
+    vtkSmartPointer< vtkSpline > splineY;
+    vtkSmartPointer< vtkSpline > splineZ;
+    if (this->StreamingInterpolationType == vtkMRMLMarkupsToModelNode::KochanekSpline)
+    {
+      vtkSmartPointer< vtkKochanekSpline > kochanekSplineX = vtkSmartPointer< vtkKochanekSpline >::New();
+      vtkSmartPointer< vtkKochanekSpline > kochanekSplineY = vtkSmartPointer< vtkKochanekSpline >::New();
+      vtkSmartPointer< vtkKochanekSpline > kochanekSplineZ = vtkSmartPointer< vtkKochanekSpline >::New();
+      vtkSlicerMarkupsToModelCurveGeneration::SetKochanekSplineParameters(windowPoints, kochanekSplineX, kochanekSplineY, kochanekSplineZ, false,
+        this->StreamingKochanekBias, this->StreamingKochanekContinuity, this->StreamingKochanekTension, this->StreamingKochanekEndsCopyNearestDerivatives);
+      splineX = kochanekSplineX;
+      splineY = kochanekSplineY;
+      splineZ = kochanekSplineZ;
+    }
+    else
+    {
+      vtkSmartPointer< vtkCardinalSpline > cardinalSplineX = vtkSmartPointer< vtkCardinalSpline >::New();
+      vtkSmartPointer< vtkCardinalSpline > cardinalSplineY = vtkSmartPointer< vtkCardinalSpline >::New();
+      vtkSmartPointer< vtkCardinalSpline > cardinalSplineZ = vtkSmartPointer< vtkCardinalSpline >::New();
+      vtkSlicerMarkupsToModelCurveGeneration::SetCardinalSplineParameters(windowPoints, cardinalSplineX, cardinalSplineY, cardinalSplineZ, false);
+      splineX = cardinalSplineX;
+      splineY = cardinalSplineY;
+      splineZ = cardinalSplineZ;
+    }
+    EvaluateSplineSegments(splineX, splineY, splineZ, firstSegment - windowFirst, numberSegments - firstSegment, segmentsBetween,
+      curvePoints, (vtkIdType)firstSegment * segmentsBetween);
+  }
+  // final point
+  curvePoints->SetPoint(numberCurvePoints - 1, this->StreamingControlPoints[numberControlPoints - 1].Position);
+  curvePoints->Modified();
+
+  // the tangent (and so the tube frame) of the curve point before the first recomputed one changes as well
+  vtkIdType firstCurvePoint = std::max((vtkIdType)0, (vtkIdType)firstSegment * segmentsBetween - 1);
+  vtkSlicerMarkupsToModelTubeGeneration::AppendTubeRings(numberCurvePoints, tubeRadius, tubeNumberOfSides, outputTubePolyData);
+  if (tubeRadius > 0.0)
+  {
+    vtkSlicerMarkupsToModelTubeGeneration::ComputeTubeNormals(curvePoints, &(this->StreamingTubeNormals[0]),
+      firstCurvePoint, numberCurvePoints - 1, false);
+  }
+  vtkSlicerMarkupsToModelTubeGeneration::UpdateTubeRings(curvePoints, &(this->StreamingTubeNormals[0]),
+    tubeRadius, tubeNumberOfSides, outputTubePolyData, firstCurvePoint, numberCurvePoints - 1);
+  vtkSlicerMarkupsToModelTubeGeneration::UpdateCurveMeasures(curvePoints, tubeRadius, tubeNumberOfSides,
+    outputTubePolyData, firstCurvePoint, numberCurvePoints - 1);
+  outputTubePolyData->Modified();
+}
+
 //------------------------------------------------------------------------------
 void vtkSlicerMarkupsToModelCurveGeneration::PrintSelf( ostream &os, vtkIndent indent )
 {
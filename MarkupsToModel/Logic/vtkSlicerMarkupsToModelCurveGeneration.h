@@ -8,9 +8,17 @@
 #include <vtkKochanekSpline.h>
 #include <vtkPoints.h>
 #include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
+// std includes
+#include <deque>
+#include <vector>
 
 #include "vtkSlicerMarkupsToModelModuleLogicExport.h"
 
+class vtkSlicerMarkupsToModelScratchBuffers;
+
 class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelCurveGeneration : public vtkObject
 {
   public:
@@ -25,7 +33,9 @@ class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelCurve
     static const double TUBE_RADIUS_DEFAULT;
     static const int TUBE_NUMBER_OF_SIDES_DEFAULT;
     static const int TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS_DEFAULT;
+    static const double TUBE_SAMPLING_TOLERANCE_DEFAULT;
     static const int POLYNOMIAL_ORDER_DEFAULT;
+    static const int POLYNOMIAL_ORDER_MAXIMUM;
     static const double KOCHANEK_BIAS_DEFAULT;
     static const double KOCHANEK_CONTINUITY_DEFAULT;
     static const double KOCHANEK_TENSION_DEFAULT;
@@ -50,11 +60,15 @@ class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelCurve
     //   tubeNumberOfSides - The number of sides of the tube in outputTubePolyData (higher = smoother).
     //   tubeSegmentsBetweenControlPoints - The number of points sampled between each control point (higher = smoother).
     //   tubeLoop - Indicates whether the tube will loop back to the first point or not in outputTubePolyData.
+    //   tubeSamplingTolerance - If positive then the straight segments are not subdivided (they have no deviation from their chord).
+    //   scratchBuffers - Optional memory for the temporary arrays and points, kept between calls (see vtkSlicerMarkupsToModelScratchBuffers).
     static void GeneratePiecewiseLinearCurveModel( vtkPoints* controlPoints, vtkPolyData* outputTubePolyData,
       double tubeRadius=vtkSlicerMarkupsToModelCurveGeneration::TUBE_RADIUS_DEFAULT,
       int tubeNumberOfSides=vtkSlicerMarkupsToModelCurveGeneration::TUBE_NUMBER_OF_SIDES_DEFAULT,
       int tubeSegmentsBetweenControlPoints=vtkSlicerMarkupsToModelCurveGeneration::TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS_DEFAULT,
-      bool tubeLoop=vtkSlicerMarkupsToModelCurveGeneration::TUBE_LOOP_DEFAULT );
+      bool tubeLoop=vtkSlicerMarkupsToModelCurveGeneration::TUBE_LOOP_DEFAULT,
+      double tubeSamplingTolerance=vtkSlicerMarkupsToModelCurveGeneration::TUBE_SAMPLING_TOLERANCE_DEFAULT,
+      vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers=NULL );
 
     // Generates Cardinal Spline curve model.
     //   controlPoints - the curve will pass through each point defined here.
@@ -63,11 +77,16 @@ class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelCurve
     //   tubeNumberOfSides - The number of sides of the tube in outputTubePolyData (higher = smoother).
     //   tubeSegmentsBetweenControlPoints - The number of points sampled between each control point (higher = smoother).
     //   tubeLoop - Indicates whether the tube will loop back to the first point or not in outputTubePolyData.
+    //   tubeSamplingTolerance - If positive then each segment is subdivided until the curve deviates less than this distance (in mm)
+    //     from the chords between the samples, and tubeSegmentsBetweenControlPoints is ignored. If 0 then the segments are sampled uniformly.
+    //   scratchBuffers - Optional memory for the temporary arrays and points, kept between calls (see vtkSlicerMarkupsToModelScratchBuffers).
     static void GenerateCardinalSplineCurveModel( vtkPoints* controlPoints, vtkPolyData* outputTubePolyData,
       double tubeRadius=vtkSlicerMarkupsToModelCurveGeneration::TUBE_RADIUS_DEFAULT, 
       int tubeNumberOfSides=vtkSlicerMarkupsToModelCurveGeneration::TUBE_NUMBER_OF_SIDES_DEFAULT,
       int tubeSegmentsBetweenControlPoints=vtkSlicerMarkupsToModelCurveGeneration::TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS_DEFAULT,
-      bool tubeLoop=vtkSlicerMarkupsToModelCurveGeneration::TUBE_LOOP_DEFAULT );
+      bool tubeLoop=vtkSlicerMarkupsToModelCurveGeneration::TUBE_LOOP_DEFAULT,
+      double tubeSamplingTolerance=vtkSlicerMarkupsToModelCurveGeneration::TUBE_SAMPLING_TOLERANCE_DEFAULT,
+      vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers=NULL );
 
     // Generates Kochanek Spline curve model.
     //   controlPoints - the curve will pass through each point defined here.
@@ -80,6 +99,9 @@ class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelCurve
     //   kochanekContinuity - Alters the bias parameter for the kochanek spline.
     //   kochanekTension - Alters the bias parameter for the kochanek spline.
     //   kochanekEndsCopyNearestDerivative - Copy the curvature on either end of the spline from the nearest point.
+    //   tubeSamplingTolerance - If positive then each segment is subdivided until the curve deviates less than this distance (in mm)
+    //     from the chords between the samples, and tubeSegmentsBetweenControlPoints is ignored. If 0 then the segments are sampled uniformly.
+    //   scratchBuffers - Optional memory for the temporary arrays and points, kept between calls (see vtkSlicerMarkupsToModelScratchBuffers).
     static void GenerateKochanekSplineCurveModel( vtkPoints* controlPoints, vtkPolyData* outputTubePolyData,
       double tubeRadius=vtkSlicerMarkupsToModelCurveGeneration::TUBE_RADIUS_DEFAULT,
       int tubeNumberOfSides=vtkSlicerMarkupsToModelCurveGeneration::TUBE_NUMBER_OF_SIDES_DEFAULT,
@@ -88,7 +110,9 @@ class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelCurve
       double kochanekBias=vtkSlicerMarkupsToModelCurveGeneration::KOCHANEK_BIAS_DEFAULT,
       double kochanekContinuity=vtkSlicerMarkupsToModelCurveGeneration::KOCHANEK_CONTINUITY_DEFAULT,
       double kochanekTension=vtkSlicerMarkupsToModelCurveGeneration::KOCHANEK_TENSION_DEFAULT,
-      bool kochanekEndsCopyNearestDerivatives=vtkSlicerMarkupsToModelCurveGeneration::KOCHANEK_ENDS_COPY_NEAREST_DERIVATIVE_DEFAULT );
+      bool kochanekEndsCopyNearestDerivatives=vtkSlicerMarkupsToModelCurveGeneration::KOCHANEK_ENDS_COPY_NEAREST_DERIVATIVE_DEFAULT,
+      double tubeSamplingTolerance=vtkSlicerMarkupsToModelCurveGeneration::TUBE_SAMPLING_TOLERANCE_DEFAULT,
+      vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers=NULL );
 
     // Generates a polynomial curve model.
     //   controlPoints - the curve will be fit through these points.
@@ -98,40 +122,158 @@ class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelCurve
     //   tubeSegmentsBetweenControlPoints - The number of points sampled between each control point (higher = smoother).
     //   tubeLoop - Indicates whether the tube will loop back to the first point or not in outputTubePolyData.
     //   polynomial - The order of polynomial to fit. Higher = fit the points better, but slower and risk of 'overfitting'
+    //     (at most POLYNOMIAL_ORDER_MAXIMUM)
     //   markupsPointsParameters - Indicate the parameter (independent) values for fitting each point. See also:
     //     - ComputePointParametersFromIndices
     //     - ComputePointParametersFromMinimumSpanningTree
+    //     - ComputePointParametersFromDenseMinimumSpanningTree
+    //   tubeSamplingTolerance - If positive then each segment is subdivided until the curve deviates less than this distance (in mm)
+    //     from the chords between the samples, and tubeSegmentsBetweenControlPoints is ignored. If 0 then the segments are sampled uniformly.
+    //   scratchBuffers - Optional memory for the temporary arrays and points, kept between calls (see vtkSlicerMarkupsToModelScratchBuffers).
     static void GeneratePolynomialCurveModel( vtkPoints* points, vtkPolyData* outputPolyData,
       double tubeRadius=vtkSlicerMarkupsToModelCurveGeneration::TUBE_RADIUS_DEFAULT,
       int tubeNumberOfSides=vtkSlicerMarkupsToModelCurveGeneration::TUBE_NUMBER_OF_SIDES_DEFAULT,
       int tubeSegmentsBetweenControlPoints=vtkSlicerMarkupsToModelCurveGeneration::TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS_DEFAULT,
       bool tubeLoop=vtkSlicerMarkupsToModelCurveGeneration::TUBE_LOOP_DEFAULT,
       int polynomialOrder=vtkSlicerMarkupsToModelCurveGeneration::POLYNOMIAL_ORDER_DEFAULT,
-      vtkDoubleArray* markupsPointsParameters=NULL );
+      vtkDoubleArray* markupsPointsParameters=NULL,
+      double tubeSamplingTolerance=vtkSlicerMarkupsToModelCurveGeneration::TUBE_SAMPLING_TOLERANCE_DEFAULT,
+      vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers=NULL );
 
     // Assign parameter values to points based on their position in the markups list (good for ordered point sets)
     // Either ComputePointParametersFromIndices or ComputePointParametersFromMinimumSpanningTree should be used
     // before GeneratePolynomialCurve
     static void ComputePointParametersFromIndices( vtkPoints* points, vtkDoubleArray* outputPointParameters );
 
-    // Assign parameter values to points based on their position in a minimum spanning tree between the two
-    // farthest points (good for unordered point sets)
-    // Parameters are assigned based on the length along the MST path connecting the two farthest points.
+    // Assign parameter values to points based on their position in a minimum spanning tree (good for unordered point sets)
+    // Parameters are assigned based on the length along the longest path in the MST (the "trunk").
     // For points that branch off this path, the parameter will be copied from the branching point.
+    // The tree is computed from a sparse graph that connects each point to its nearest neighbors,
+    // so it scales to large point sets (memory is linear in the number of points). If the graph is not connected
+    // (clusters that are farther apart than the neighborhood) then the components are connected by Boruvka's algorithm.
+    // The total length of the tree is stored in outputTreeLength if it is specified.
     // Either ComputePointParametersFromIndices or ComputePointParametersFromMinimumSpanningTree should be used
     // before GeneratePolynomialCurve
-    static void ComputePointParametersFromMinimumSpanningTree( vtkPoints* points, vtkDoubleArray* outputPointParameters );
+    static void ComputePointParametersFromMinimumSpanningTree( vtkPoints* points, vtkDoubleArray* outputPointParameters,
+      vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers=NULL, double* outputTreeLength=NULL );
+
+    // Reference implementation of ComputePointParametersFromMinimumSpanningTree, using a dense distance matrix
+    // and Prim's algorithm starting from the two farthest points in the Euclidean sense.
+    // Computation time and memory are quadratic in the number of points.
+    // The temporary arrays of both are allocated from scratchBuffers if it is specified.
+    static void ComputePointParametersFromDenseMinimumSpanningTree( vtkPoints* points, vtkDoubleArray* outputPointParameters,
+      vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers=NULL, double* outputTreeLength=NULL );
+
+    // Incrementally update a linear, Cardinal spline or Kochanek spline curve model.
+    // The generator instance remembers the control points, curve points and tube frames of the previous call.
+    // If only a few control points moved since then (and all other parameters and the output are unchanged)
+    // then only the affected curve segments and tube rings are recomputed and the points of outputTubePolyData
+    // are overwritten in place, keeping its topology. Otherwise the whole curve model is regenerated.
+    // Cardinal splines have global support, so changes are only propagated to nearby segments (4 on each side)
+    // and these are fitted to the nearby control points only. When a single control point is moved, the curve points
+    // deviate from a full regeneration by less than 0.2% of the sum of the displacement and the largest distance
+    // between consecutive control points. Linear and Kochanek spline curves are the same as a full regeneration.
+    // The tube frames of the patched rings are rotated to connect to the rings that are kept, so the vertices
+    // may be rotated around the curve compared to a full regeneration. Polynomial curves are global fits and are not supported here.
+    // Returns true if the output was patched in place, false if it was regenerated (or could not be generated).
+    bool UpdateCurveModelIncrementally( vtkPoints* controlPoints, vtkPolyData* outputTubePolyData,
+      int interpolationType, double tubeRadius, int tubeNumberOfSides, int tubeSegmentsBetweenControlPoints, bool tubeLoop,
+      double kochanekBias, double kochanekContinuity, double kochanekTension, bool kochanekEndsCopyNearestDerivatives );
+
+    // Forget the state of the previous incremental update, so the next one regenerates the whole curve model.
+    void ResetIncrementalState();
+
+    // Update a linear, Cardinal spline or Kochanek spline curve model that grows by appending control points at the end,
+    // for example from the positions of a continuously tracked tool. The curve can not be a loop.
+    // Only the control points that were appended since the previous call are processed: the last few curve segments
+    // (the ones that the new points affect) are recomputed and the new tube rings and cells are appended to
+    // outputTubePolyData, which is modified in place. The cost of appending a point does not depend on the length of the curve.
+    // The tube of the output has one triangle strip between each pair of consecutive rings (see vtkSlicerMarkupsToModelTubeGeneration::AppendTubeRings).
+    // If the control points used by the previous call were modified near the end of the curve or removed, or the parameters
+    // or the output changed, then the model is regenerated from the control points.
+    // Appended control points closer than minimumPointDistance to the last used point are skipped.
+    // Optional retention limits (0 = unlimited): only the most recent maximumNumberOfPoints control points and the
+    // control points appended in the last maximumPointAge seconds (currentTime is the current time in seconds) are kept.
+    // Old points are removed in batches, so the model may temporarily contain up to 25% more points than the limit;
+    // this keeps the cost of removing points constant per appended point as well.
+    // Returns true if the output was updated in place, false if it was regenerated (or could not be generated).
+    bool UpdateCurveModelStreaming( vtkPoints* controlPoints, vtkPolyData* outputTubePolyData,
+      int interpolationType, double tubeRadius, int tubeNumberOfSides, int tubeSegmentsBetweenControlPoints,
+      double kochanekBias, double kochanekContinuity, double kochanekTension, bool kochanekEndsCopyNearestDerivatives,
+      double minimumPointDistance, int maximumNumberOfPoints, double maximumPointAge, double currentTime );
+
+    // Forget the state of the previous streaming update, so the next one regenerates the whole curve model.
+    void ResetStreamingState();
 
   protected:
     vtkSlicerMarkupsToModelCurveGeneration();
     ~vtkSlicerMarkupsToModelCurveGeneration();
 
+    // state of the previous incremental update
+    vtkSmartPointer< vtkPoints > IncrementalControlPoints;
+    vtkSmartPointer< vtkPoints > IncrementalCurvePoints;
+    std::vector< double > IncrementalTubeNormals; // unit normal of the tube frame at each curve point (x,y,z)
+    vtkWeakPointer< vtkPolyData > IncrementalOutputPolyData;
+    vtkMTimeType IncrementalOutputMTime;
+    int IncrementalInterpolationType;
+    double IncrementalTubeRadius;
+    int IncrementalTubeNumberOfSides;
+    int IncrementalTubeSegmentsBetweenControlPoints;
+    bool IncrementalTubeLoop;
+    double IncrementalKochanekBias;
+    double IncrementalKochanekContinuity;
+    double IncrementalKochanekTension;
+    bool IncrementalKochanekEndsCopyNearestDerivatives;
+
+    // control point of a streaming curve
+    struct StreamingControlPoint
+    {
+      double Position[3];
+      double Time; // time when the point was appended, in seconds
+      vtkIdType InputIndex; // index of the point in the input control points
+    };
+
+    // state of the previous streaming update
+    // retained control points, the most recent points at the end form the window of the spline fits
+    std::deque< StreamingControlPoint > StreamingControlPoints;
+    vtkIdType StreamingNumberOfInputPoints; // number of input control points that have been processed
+    double StreamingLastInputPoint[3]; // last processed input control point, for detecting changes of the input
+    vtkSmartPointer< vtkPoints > StreamingCurvePoints;
+    std::vector< double > StreamingTubeNormals; // unit normal of the tube frame at each curve point (x,y,z)
+    vtkWeakPointer< vtkPolyData > StreamingOutputPolyData;
+    vtkMTimeType StreamingOutputMTime;
+    int StreamingInterpolationType;
+    double StreamingTubeRadius;
+    int StreamingTubeNumberOfSides;
+    int StreamingTubeSegmentsBetweenControlPoints;
+    double StreamingKochanekBias;
+    double StreamingKochanekContinuity;
+    double StreamingKochanekTension;
+    bool StreamingKochanekEndsCopyNearestDerivatives;
+    double StreamingMinimumPointDistance;
+
   private:
     static void AllocateCurvePoints(vtkPoints* controlPoints, vtkPoints* outputPoints, int tubeSegmentsBetweenControlPoints, bool tubeLoop);
     static void CloseLoop(vtkPoints* outputPoints);
+    // Append the final control point (and the extra point of a loop) to adaptively sampled curve points
+    static void AddFinalCurvePoints(vtkPoints* curvePoints, const double finalPoint[3], bool tubeLoop);
     static void GetTubePolyDataFromPoints(vtkPoints* pointsToConnect, vtkPolyData* outputTube, double tubeRadius, int tubeNumberOfSides);
     static void SetKochanekSplineParameters(vtkPoints* controlPoints, vtkKochanekSpline* splineX, vtkKochanekSpline* splineY, vtkKochanekSpline* splineZ, bool tubeLoop, double kochanekBias, double kochanekContinuity, double kochanekTension, bool kochanekEndsCopyNearestDerivatives);
     static void SetCardinalSplineParameters(vtkPoints* controlPoints, vtkCardinalSpline* splineX, vtkCardinalSpline* splineY, vtkCardinalSpline* splineZ, bool tubeLoop);
+    // Least squares fit of a polynomial in shifted Chebyshev basis (parameters in [0,1]) to the points.
+    // Coefficients are stored interleaved (coefficient index * 3 + dimension), there must be room for numberOfCoefficients * 3 values.
+    // Returns the number of coefficients that could be determined, which is less than requested if the parameters do not determine all of them.
+    static int FitShiftedChebyshevPolynomial(vtkPoints* points, vtkDoubleArray* pointParameters, int numberOfCoefficients, double* coefficients);
+
+    // helpers for incremental update
+    void ComputeIncrementalCurveSegments(vtkPoints* controlPoints, int firstSegment, int lastSegment);
+
+    // helpers for streaming update
+    // Append the input control points starting at firstInputIndex to the retained control points (skipping the ones
+    // that are too close to the previous point). Returns the number of appended points.
+    int AppendStreamingControlPoints(vtkPoints* controlPoints, vtkIdType firstInputIndex, double currentTime);
+    // Recompute the curve points starting at firstSegment, extend the tube and update its rings from the first modified curve point
+    void UpdateStreamingCurve(vtkPolyData* outputTubePolyData, int firstSegment);
 
     // not used
     vtkSlicerMarkupsToModelCurveGeneration ( const vtkSlicerMarkupsToModelCurveGeneration& ) VTK_DELETE_FUNCTION;
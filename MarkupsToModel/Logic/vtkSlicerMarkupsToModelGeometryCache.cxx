@@ -0,0 +1,238 @@
+#include "vtkSlicerMarkupsToModelGeometryCache.h"
+
+// vtk includes
+#include <vtkDataArray.h>
+#include <vtkObjectFactory.h>
+
+// std includes
+#include <cstring>
+
+//------------------------------------------------------------------------------
+// constants within this file
+static const unsigned long GEOMETRY_CACHE_MEMORY_BUDGET_DEFAULT = 262144; // KiB, 256 MiB
+// 64-bit FNV-1a hash parameters
+static const vtkTypeUInt64 FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const vtkTypeUInt64 FNV_PRIME = 1099511628211ULL;
+
+//------------------------------------------------------------------------------
+// Add the bytes of the data to the FNV-1a hash
+static void AddToHash(vtkTypeUInt64& hash, const void* data, size_t numberOfBytes)
+{
+  const unsigned char* bytes = static_cast< const unsigned char* >(data);
+  for (size_t i = 0; i < numberOfBytes; i++)
+  {
+    hash ^= bytes[i];
+    hash *= FNV_PRIME;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void AddToHash(vtkTypeUInt64& hash, int value)
+{
+  AddToHash(hash, &value, sizeof(value));
+}
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerMarkupsToModelGeometryCache);
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelGeometryCache::vtkSlicerMarkupsToModelGeometryCache()
+  : MemoryBudget(GEOMETRY_CACHE_MEMORY_BUDGET_DEFAULT)
+  , MemorySize(0)
+  , NumberOfHits(0)
+  , NumberOfMisses(0)
+{
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelGeometryCache::~vtkSlicerMarkupsToModelGeometryCache()
+{
+}
+
+//------------------------------------------------------------------------------
+vtkTypeUInt64 vtkSlicerMarkupsToModelGeometryCache::ComputeKey(vtkPoints* controlPoints, vtkMRMLMarkupsToModelNode* parameters)
+{
+  vtkTypeUInt64 hash = FNV_OFFSET_BASIS;
+  if (controlPoints == NULL || parameters == NULL)
+  {
+    return hash;
+  }
+
+  // control points
+  vtkDataArray* pointsArray = controlPoints->GetData();
+  int numberOfPoints = controlPoints->GetNumberOfPoints();
+  AddToHash(hash, numberOfPoints);
+  AddToHash(hash, controlPoints->GetDataType());
+  if (numberOfPoints > 0)
+  {
+    AddToHash(hash, pointsArray->GetVoidPointer(0), static_cast< size_t >(numberOfPoints) * 3 * pointsArray->GetDataTypeSize());
+  }
+
+  // parameters
+  vtkTypeUInt64 parametersKey = parameters->GetGeometryParametersKey();
+  AddToHash(hash, &parametersKey, sizeof(parametersKey));
+  return hash;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelGeometryCache::ArePointsEqual(vtkPoints* points1, vtkPoints* points2)
+{
+  int numberOfPoints = points1->GetNumberOfPoints();
+  if (points2->GetNumberOfPoints() != numberOfPoints || points2->GetDataType() != points1->GetDataType())
+  {
+    return false;
+  }
+  if (numberOfPoints == 0)
+  {
+    return true;
+  }
+  size_t numberOfBytes = static_cast< size_t >(numberOfPoints) * 3 * points1->GetData()->GetDataTypeSize();
+  return memcmp(points1->GetData()->GetVoidPointer(0), points2->GetData()->GetVoidPointer(0), numberOfBytes) == 0;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelGeometryCache::Find(vtkTypeUInt64 key, vtkPoints* controlPoints, vtkMRMLMarkupsToModelNode* parameters,
+  vtkPolyData* outputPolyData)
+{
+  if (controlPoints == NULL || parameters == NULL || outputPolyData == NULL)
+  {
+    vtkErrorMacro("Control points, parameters or output poly data is null. No model retrieved.");
+    return false;
+  }
+
+  std::map< vtkTypeUInt64, std::list< Entry >::iterator >::iterator indexIt = this->EntryIndex.find(key);
+  if (indexIt == this->EntryIndex.end()
+    || indexIt->second->ParametersSignature != parameters->GetGeometryParametersSignature()
+    || !vtkSlicerMarkupsToModelGeometryCache::ArePointsEqual(indexIt->second->ControlPoints, controlPoints))
+  {
+    // a different model with the same key is kept, it is replaced when the model of this lookup is inserted
+    this->NumberOfMisses++;
+    return false;
+  }
+  this->NumberOfHits++;
+  // move to the front of the list, the iterators remain valid
+  this->Entries.splice(this->Entries.begin(), this->Entries, indexIt->second);
+  outputPolyData->ShallowCopy(indexIt->second->PolyData);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelGeometryCache::Insert(vtkTypeUInt64 key, vtkPoints* controlPoints, vtkMRMLMarkupsToModelNode* parameters,
+  vtkPolyData* polyData)
+{
+  if (controlPoints == NULL || parameters == NULL || polyData == NULL)
+  {
+    vtkErrorMacro("Control points, parameters or poly data is null. No model stored.");
+    return;
+  }
+
+  std::map< vtkTypeUInt64, std::list< Entry >::iterator >::iterator indexIt = this->EntryIndex.find(key);
+  if (indexIt != this->EntryIndex.end())
+  {
+    this->MemorySize -= indexIt->second->MemorySize;
+    this->Entries.erase(indexIt->second);
+    this->EntryIndex.erase(indexIt);
+  }
+
+  if (!this->CanStore(controlPoints, polyData))
+  {
+    // would not fit even if the cache was empty
+    return;
+  }
+  unsigned long memorySize = polyData->GetActualMemorySize() + controlPoints->GetActualMemorySize();
+  this->RemoveLeastRecentlyUsedEntries(this->MemoryBudget - memorySize);
+
+  Entry entry;
+  entry.Key = key;
+  entry.ControlPoints = controlPoints;
+  entry.ParametersSignature = parameters->GetGeometryParametersSignature();
+  // a separate poly data object, so that changing the structure of the original does not affect the stored model
+  entry.PolyData = vtkSmartPointer< vtkPolyData >::New();
+  entry.PolyData->ShallowCopy(polyData);
+  entry.MemorySize = memorySize;
+  this->Entries.push_front(entry);
+  this->EntryIndex[key] = this->Entries.begin();
+  this->MemorySize += memorySize;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelGeometryCache::CanStore(vtkPoints* controlPoints, vtkPolyData* polyData)
+{
+  if (controlPoints == NULL)
+  {
+    return false;
+  }
+  unsigned long memorySize = controlPoints->GetActualMemorySize();
+  if (polyData != NULL)
+  {
+    memorySize += polyData->GetActualMemorySize();
+  }
+  return (memorySize <= this->MemoryBudget);
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelGeometryCache::RemoveLeastRecentlyUsedEntries(unsigned long maximumMemorySize)
+{
+  while (this->MemorySize > maximumMemorySize && !this->Entries.empty())
+  {
+    const Entry& leastRecentlyUsedEntry = this->Entries.back();
+    this->MemorySize -= leastRecentlyUsedEntry.MemorySize;
+    this->EntryIndex.erase(leastRecentlyUsedEntry.Key);
+    this->Entries.pop_back();
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelGeometryCache::Clear()
+{
+  this->Entries.clear();
+  this->EntryIndex.clear();
+  this->MemorySize = 0;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelGeometryCache::ResetStatistics()
+{
+  this->NumberOfHits = 0;
+  this->NumberOfMisses = 0;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelGeometryCache::SetMemoryBudget(unsigned long memoryBudget)
+{
+  if (this->MemoryBudget == memoryBudget)
+  {
+    return;
+  }
+  this->MemoryBudget = memoryBudget;
+  this->RemoveLeastRecentlyUsedEntries(memoryBudget);
+  this->Modified();
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelGeometryCache::GetNumberOfEntries()
+{
+  return static_cast< int >(this->Entries.size());
+}
+
+//------------------------------------------------------------------------------
+double vtkSlicerMarkupsToModelGeometryCache::GetHitRate()
+{
+  unsigned long numberOfLookups = this->NumberOfHits + this->NumberOfMisses;
+  if (numberOfLookups == 0)
+  {
+    return 0.0;
+  }
+  return static_cast< double >(this->NumberOfHits) / numberOfLookups;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelGeometryCache::PrintSelf( ostream &os, vtkIndent indent )
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "MemoryBudget: " << this->MemoryBudget << " KiB" << std::endl;
+  os << indent << "MemorySize: " << this->MemorySize << " KiB" << std::endl;
+  os << indent << "NumberOfEntries: " << this->Entries.size() << std::endl;
+  os << indent << "NumberOfHits: " << this->NumberOfHits << std::endl;
+  os << indent << "NumberOfMisses: " << this->NumberOfMisses << std::endl;
+}
@@ -0,0 +1,104 @@
+#ifndef __vtkSlicerMarkupsToModelGeometryCache_h
+#define __vtkSlicerMarkupsToModelGeometryCache_h
+
+#include "vtkMRMLMarkupsToModelNode.h"
+
+// vtk includes
+#include <vtkObject.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+// std includes
+#include <list>
+#include <map>
+#include <string>
+
+#include "vtkSlicerMarkupsToModelModuleLogicExport.h"
+
+// Stores previously generated output models, keyed by the control points and the parameters
+// that affect the geometry. The least recently used models are removed when the total memory size
+// would exceed the memory budget.
+// The key is a hash, so each model is stored together with its control points and parameter signature,
+// and a model is only returned if these are equal to the ones of the lookup.
+// An instance must only be accessed by one thread at a time.
+class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelGeometryCache : public vtkObject
+{
+  public:
+    // standard vtk object methods
+    vtkTypeMacro( vtkSlicerMarkupsToModelGeometryCache, vtkObject );
+    void PrintSelf( ostream& os, vtkIndent indent ) VTK_OVERRIDE;
+    static vtkSlicerMarkupsToModelGeometryCache *New();
+
+    // Compute the key of the model that would be generated from the control points with the parameters of the node.
+    // Only the parameters that affect the geometry of the model are taken into account.
+    static vtkTypeUInt64 ComputeKey( vtkPoints* controlPoints, vtkMRMLMarkupsToModelNode* parameters );
+
+    // If a model is stored with the key, and it was generated from the same control points with the same
+    // geometry parameters, then shallow copy it into outputPolyData and return true.
+    bool Find( vtkTypeUInt64 key, vtkPoints* controlPoints, vtkMRMLMarkupsToModelNode* parameters, vtkPolyData* outputPolyData );
+
+    // Store a shallow copy of the model with the key, replacing any model previously stored with the same key.
+    // controlPoints are the points that the model was generated from, before any cleaning.
+    // Neither the control points nor the poly data may be modified in place after they are stored.
+    void Insert( vtkTypeUInt64 key, vtkPoints* controlPoints, vtkMRMLMarkupsToModelNode* parameters, vtkPolyData* polyData );
+
+    // Returns true if a model with the control points is small enough to be stored within the memory budget.
+    // If polyData is NULL then only the control points are taken into account (for example, before the model is generated).
+    // Can be used for avoiding copying the control points for Insert when the model would not be stored anyway.
+    bool CanStore( vtkPoints* controlPoints, vtkPolyData* polyData );
+
+    // Remove all stored models
+    void Clear();
+
+    // Reset the number of hits and misses
+    void ResetStatistics();
+
+    // Maximum total memory size of the stored models in kibibytes. 0 disables caching.
+    vtkGetMacro( MemoryBudget, unsigned long );
+    void SetMemoryBudget( unsigned long memoryBudget );
+
+    int GetNumberOfEntries();
+    // Total memory size of the stored models and their control points in kibibytes
+    vtkGetMacro( MemorySize, unsigned long );
+    vtkGetMacro( NumberOfHits, unsigned long );
+    vtkGetMacro( NumberOfMisses, unsigned long );
+    // Fraction of Find calls that found a model, between 0 and 1
+    double GetHitRate();
+
+  protected:
+    vtkSlicerMarkupsToModelGeometryCache();
+    ~vtkSlicerMarkupsToModelGeometryCache();
+
+  private:
+    struct Entry
+    {
+      vtkTypeUInt64 Key;
+      vtkSmartPointer< vtkPoints > ControlPoints;
+      std::string ParametersSignature;
+      vtkSmartPointer< vtkPolyData > PolyData;
+      unsigned long MemorySize;
+    };
+
+    // true if the points have the same data type and coordinates
+    static bool ArePointsEqual( vtkPoints* points1, vtkPoints* points2 );
+
+    // remove the least recently used entries until the memory size does not exceed maximumMemorySize
+    void RemoveLeastRecentlyUsedEntries( unsigned long maximumMemorySize );
+
+    // most recently used entry first
+    std::list< Entry > Entries;
+    std::map< vtkTypeUInt64, std::list< Entry >::iterator > EntryIndex;
+
+    unsigned long MemoryBudget;
+    unsigned long MemorySize;
+    unsigned long NumberOfHits;
+    unsigned long NumberOfMisses;
+
+    // not used
+    vtkSlicerMarkupsToModelGeometryCache ( const vtkSlicerMarkupsToModelGeometryCache& ) VTK_DELETE_FUNCTION;
+    void operator= ( const vtkSlicerMarkupsToModelGeometryCache& ) VTK_DELETE_FUNCTION;
+};
+
+#endif
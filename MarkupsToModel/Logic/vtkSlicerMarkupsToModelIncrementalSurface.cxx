@@ -0,0 +1,1040 @@
+#include "vtkSlicerMarkupsToModelIncrementalSurface.h"
+#include "vtkSlicerMarkupsToModelConvexHullFilter.h"
+#include "vtkSlicerMarkupsToModelSubdivisionFilter.h"
+
+// vtk includes
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+// std includes
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+//------------------------------------------------------------------------------
+// constants within this file
+// the distance tolerance is this multiple of the rounding error of the coordinates (same as in the convex hull filter)
+static const double INCREMENTAL_SURFACE_TOLERANCE_MULTIPLIER = 3.0;
+// if more than this fraction of the points changed then the hull is computed again instead of updated
+static const double INCREMENTAL_SURFACE_MAXIMUM_CHANGED_FRACTION = 0.25;
+// The subdivided surface around a point only depends on the points within this many edges from it: the stencils
+// of the edge points of each subdivision reach one edge further, but the edges are halved by each subdivision.
+static const int PATCH_DEPENDENCY_RINGS = 2;
+// if more patches than this fraction of all patches need to be subdivided then the whole surface is subdivided
+static const double PATCH_MAXIMUM_LOCAL_FRACTION = 0.5;
+
+//------------------------------------------------------------------------------
+// The points of a patch are in a triangular grid: the point (a, b) has the weights a / gridSize and b / gridSize
+// of the first and second vertex of the triangle. The points are stored in rows of equal a.
+static vtkIdType GetPatchPointIndex( vtkIdType a, vtkIdType b, vtkIdType gridSize )
+{
+  return a * ( gridSize + 1 ) - a * ( a - 1 ) / 2 + b;
+}
+
+//------------------------------------------------------------------------------
+// Copy the points of a subdivided triangle into its patch. Each subdivision replaces triangle i by triangles
+// 4 * i ... 4 * i + 3 (see vtkSlicerMarkupsToModelSubdivisionFilter), the corners are the grid positions of
+// the vertices of the triangle.
+static void StorePatchPoints( const vtkIdType* cellPointIds, vtkPoints* points, vtkIdType triangleIndex, int numberOfSubdivisions,
+  vtkIdType gridSize, const vtkIdType corners[ 3 ][ 2 ], double* patch )
+{
+  if ( numberOfSubdivisions == 0 )
+  {
+    const vtkIdType* triangle = cellPointIds + 4 * triangleIndex + 1;
+    for ( int i = 0; i < 3; i++ )
+    {
+      points->GetPoint( triangle[ i ], patch + 3 * GetPatchPointIndex( corners[ i ][ 0 ], corners[ i ][ 1 ], gridSize ) );
+    }
+    return;
+  }
+  vtkIdType midpoints[ 3 ][ 2 ] = { { 0, 0 }, { 0, 0 }, { 0, 0 } }; // 01, 12, 20
+  for ( int i = 0; i < 3; i++ )
+  {
+    midpoints[ i ][ 0 ] = ( corners[ i ][ 0 ] + corners[ ( i + 1 ) % 3 ][ 0 ] ) / 2;
+    midpoints[ i ][ 1 ] = ( corners[ i ][ 1 ] + corners[ ( i + 1 ) % 3 ][ 1 ] ) / 2;
+  }
+  const vtkIdType* childCorners[ 4 ][ 3 ] =
+  {
+    { corners[ 0 ], midpoints[ 0 ], midpoints[ 2 ] },
+    { midpoints[ 0 ], corners[ 1 ], midpoints[ 1 ] },
+    { midpoints[ 2 ], midpoints[ 1 ], corners[ 2 ] },
+    { midpoints[ 0 ], midpoints[ 1 ], midpoints[ 2 ] }
+  };
+  for ( int child = 0; child < 4; child++ )
+  {
+    vtkIdType corners[ 3 ][ 2 ] = { { 0, 0 }, { 0, 0 }, { 0, 0 } };
+    for ( int i = 0; i < 3; i++ )
+    {
+      corners[ i ][ 0 ] = childCorners[ child ][ i ][ 0 ];
+      corners[ i ][ 1 ] = childCorners[ child ][ i ][ 1 ];
+    }
+    StorePatchPoints( cellPointIds, points, 4 * triangleIndex + child, numberOfSubdivisions - 1, gridSize, corners, patch );
+  }
+}
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro( vtkSlicerMarkupsToModelIncrementalSurface );
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelIncrementalSurface::PointKey::operator<( const PointKey& other ) const
+{
+  return std::lexicographical_compare( this->Coordinates, this->Coordinates + 3, other.Coordinates, other.Coordinates + 3 );
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelIncrementalSurface::vtkSlicerMarkupsToModelIncrementalSurface()
+{
+  this->PointsDataType = VTK_FLOAT;
+  this->NumberOfAddedPoints = 0;
+  this->NumberOfRemovedPoints = 0;
+  this->HullRebuilt = false;
+  this->NumberOfSubdividedPatches = 0;
+  this->Reset();
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelIncrementalSurface::~vtkSlicerMarkupsToModelIncrementalSurface()
+{
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelIncrementalSurface::Reset()
+{
+  std::vector< double >().swap( this->Coordinates );
+  std::vector< vtkIdType >().swap( this->PointMultiplicities );
+  std::vector< vtkIdType >().swap( this->FreePointIds );
+  this->PointIds.clear();
+  std::vector< vtkIdType >().swap( this->PointNumberOfFaces );
+  std::vector< Face >().swap( this->Faces );
+  std::vector< int >().swap( this->FreeFaceIndices );
+  this->EdgeToFace.clear();
+  this->Tolerance = 0.0;
+  this->MaximumAbsoluteCoordinates[ 0 ] = 0.0;
+  this->MaximumAbsoluteCoordinates[ 1 ] = 0.0;
+  this->MaximumAbsoluteCoordinates[ 2 ] = 0.0;
+  this->PatchNumberOfSubdivisions = -1;
+  this->PatchButterflyScheme = false;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelIncrementalSurface::UpdatePoints( vtkPoints* points )
+{
+  this->NumberOfAddedPoints = 0;
+  this->NumberOfRemovedPoints = 0;
+  this->HullRebuilt = false;
+  if ( points == NULL )
+  {
+    this->Reset();
+    return false;
+  }
+  this->PointsDataType = points->GetDataType();
+
+  // The new point set is compared to the current one in the order of the coordinates
+  std::map< PointKey, vtkIdType > multiplicities;
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  for ( vtkIdType i = 0; i < numberOfPoints; i++ )
+  {
+    PointKey key;
+    points->GetPoint( i, key.Coordinates );
+    multiplicities[ key ]++;
+  }
+  std::vector< vtkIdType > removedPointIds;
+  std::vector< std::pair< PointKey, vtkIdType > > addedPoints;
+  std::map< PointKey, vtkIdType >::iterator currentIt = this->PointIds.begin();
+  std::map< PointKey, vtkIdType >::const_iterator newIt = multiplicities.begin();
+  while ( currentIt != this->PointIds.end() || newIt != multiplicities.end() )
+  {
+    if ( newIt == multiplicities.end() || ( currentIt != this->PointIds.end() && currentIt->first < newIt->first ) )
+    {
+      removedPointIds.push_back( currentIt->second );
+      ++currentIt;
+    }
+    else if ( currentIt == this->PointIds.end() || newIt->first < currentIt->first )
+    {
+      addedPoints.push_back( *newIt );
+      ++newIt;
+    }
+    else
+    {
+      // duplicates of a point do not change the hull, only their number is updated
+      this->PointMultiplicities[ currentIt->second ] = newIt->second;
+      ++currentIt;
+      ++newIt;
+    }
+  }
+  this->NumberOfAddedPoints = static_cast< vtkIdType >( addedPoints.size() );
+  this->NumberOfRemovedPoints = static_cast< vtkIdType >( removedPointIds.size() );
+
+  bool rebuildHull = ( this->FreeFaceIndices.size() == this->Faces.size() // no hull yet
+    || this->NumberOfAddedPoints + this->NumberOfRemovedPoints
+      > INCREMENTAL_SURFACE_MAXIMUM_CHANGED_FRACTION * static_cast< double >( this->PointIds.size() ) );
+  for ( size_t i = 0; i < removedPointIds.size(); i++ )
+  {
+    if ( !rebuildHull && this->PointNumberOfFaces[ removedPointIds[ i ] ] > 0 )
+    {
+      // removing a point inside the hull does not change it
+      rebuildHull = !this->RemoveHullVertex( removedPointIds[ i ] );
+    }
+    this->RemovePoint( removedPointIds[ i ] );
+  }
+  for ( size_t i = 0; i < addedPoints.size(); i++ )
+  {
+    vtkIdType pointId = this->AddPoint( addedPoints[ i ].first );
+    this->PointMultiplicities[ pointId ] = addedPoints[ i ].second;
+    if ( !rebuildHull )
+    {
+      this->InsertHullPoint( pointId );
+    }
+  }
+
+  if ( rebuildHull )
+  {
+    return this->BuildHull();
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+vtkIdType vtkSlicerMarkupsToModelIncrementalSurface::AddPoint( const PointKey& key )
+{
+  vtkIdType pointId = static_cast< vtkIdType >( this->PointMultiplicities.size() );
+  if ( !this->FreePointIds.empty() )
+  {
+    pointId = this->FreePointIds.back();
+    this->FreePointIds.pop_back();
+  }
+  else
+  {
+    this->Coordinates.resize( 3 * ( pointId + 1 ) );
+    this->PointMultiplicities.resize( pointId + 1 );
+    this->PointNumberOfFaces.resize( pointId + 1 );
+  }
+  std::copy( key.Coordinates, key.Coordinates + 3, this->Coordinates.begin() + 3 * pointId );
+  this->PointMultiplicities[ pointId ] = 1;
+  this->PointNumberOfFaces[ pointId ] = 0;
+  this->PointIds[ key ] = pointId;
+  this->UpdateTolerance( key.Coordinates );
+  return pointId;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelIncrementalSurface::RemovePoint( vtkIdType pointId )
+{
+  PointKey key;
+  std::copy( this->Coordinates.begin() + 3 * pointId, this->Coordinates.begin() + 3 * ( pointId + 1 ), key.Coordinates );
+  this->PointIds.erase( key );
+  this->PointMultiplicities[ pointId ] = 0;
+  this->FreePointIds.push_back( pointId );
+}
+
+//------------------------------------------------------------------------------
+const double* vtkSlicerMarkupsToModelIncrementalSurface::GetPoint( vtkIdType pointId ) const
+{
+  return &( this->Coordinates[ 3 * pointId ] );
+}
+
+//------------------------------------------------------------------------------
+// The tolerance is proportional to the magnitude of the coordinates, as in the convex hull filter.
+// It is only increased when points are added, so that the faces that are kept remain valid.
+void vtkSlicerMarkupsToModelIncrementalSurface::UpdateTolerance( const double point[ 3 ] )
+{
+  for ( int i = 0; i < 3; i++ )
+  {
+    this->MaximumAbsoluteCoordinates[ i ] = std::max( this->MaximumAbsoluteCoordinates[ i ], std::fabs( point[ i ] ) );
+  }
+  this->Tolerance = INCREMENTAL_SURFACE_TOLERANCE_MULTIPLIER * DBL_EPSILON
+    * ( this->MaximumAbsoluteCoordinates[ 0 ] + this->MaximumAbsoluteCoordinates[ 1 ] + this->MaximumAbsoluteCoordinates[ 2 ] );
+}
+
+//------------------------------------------------------------------------------
+double vtkSlicerMarkupsToModelIncrementalSurface::GetDistance( const Face& face, const double point[ 3 ] ) const
+{
+  return vtkMath::Dot( face.Normal, point ) - face.Offset;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelIncrementalSurface::ClearFaces()
+{
+  std::vector< Face >().swap( this->Faces );
+  std::vector< int >().swap( this->FreeFaceIndices );
+  this->EdgeToFace.clear();
+  this->PointNumberOfFaces.assign( this->PointNumberOfFaces.size(), 0 );
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelIncrementalSurface::AddFace( vtkIdType vertex0, vtkIdType vertex1, vtkIdType vertex2 )
+{
+  int faceIndex = static_cast< int >( this->Faces.size() );
+  if ( !this->FreeFaceIndices.empty() )
+  {
+    faceIndex = this->FreeFaceIndices.back();
+    this->FreeFaceIndices.pop_back();
+  }
+  else
+  {
+    this->Faces.push_back( Face() );
+  }
+  Face& face = this->Faces[ faceIndex ];
+  face.Vertices[ 0 ] = vertex0;
+  face.Vertices[ 1 ] = vertex1;
+  face.Vertices[ 2 ] = vertex2;
+  face.Removed = false;
+  // the patch of a new face is computed by the next GetSubdividedSurface
+  std::vector< double >().swap( face.Patch );
+
+  const double* point0 = this->GetPoint( vertex0 );
+  double edge1[ 3 ] = { 0.0, 0.0, 0.0 };
+  double edge2[ 3 ] = { 0.0, 0.0, 0.0 };
+  vtkMath::Subtract( this->GetPoint( vertex1 ), point0, edge1 );
+  vtkMath::Subtract( this->GetPoint( vertex2 ), point0, edge2 );
+  vtkMath::Cross( edge1, edge2, face.Normal );
+  vtkMath::Normalize( face.Normal );
+  face.Offset = vtkMath::Dot( face.Normal, point0 );
+
+  for ( int i = 0; i < 3; i++ )
+  {
+    this->EdgeToFace[ Edge( face.Vertices[ i ], face.Vertices[ ( i + 1 ) % 3 ] ) ] = faceIndex;
+    this->PointNumberOfFaces[ face.Vertices[ i ] ]++;
+  }
+  return faceIndex;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelIncrementalSurface::RemoveFace( int faceIndex )
+{
+  Face& face = this->Faces[ faceIndex ];
+  face.Removed = true;
+  std::vector< double >().swap( face.Patch );
+  for ( int i = 0; i < 3; i++ )
+  {
+    this->EdgeToFace.erase( Edge( face.Vertices[ i ], face.Vertices[ ( i + 1 ) % 3 ] ) );
+    this->PointNumberOfFaces[ face.Vertices[ i ] ]--;
+  }
+  this->FreeFaceIndices.push_back( faceIndex );
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelIncrementalSurface::BuildHull()
+{
+  this->HullRebuilt = true;
+  this->ClearFaces();
+  this->MaximumAbsoluteCoordinates[ 0 ] = 0.0;
+  this->MaximumAbsoluteCoordinates[ 1 ] = 0.0;
+  this->MaximumAbsoluteCoordinates[ 2 ] = 0.0;
+  vtkSmartPointer< vtkPoints > points = vtkSmartPointer< vtkPoints >::New();
+  points->SetDataTypeToDouble();
+  points->Allocate( static_cast< vtkIdType >( this->PointIds.size() ) );
+  for ( std::map< PointKey, vtkIdType >::const_iterator pointIt = this->PointIds.begin(); pointIt != this->PointIds.end(); ++pointIt )
+  {
+    points->InsertNextPoint( pointIt->first.Coordinates );
+    this->UpdateTolerance( pointIt->first.Coordinates );
+  }
+
+  vtkSmartPointer< vtkPolyData > hullPolyData = vtkSmartPointer< vtkPolyData >::New();
+  if ( !vtkSlicerMarkupsToModelConvexHullFilter::ComputeConvexHull( points, hullPolyData ) )
+  {
+    return false;
+  }
+  // the hull only contains its vertices, with the same coordinates as the input
+  vtkPoints* hullPoints = hullPolyData->GetPoints();
+  std::vector< vtkIdType > hullPointIds( hullPoints->GetNumberOfPoints(), -1 );
+  for ( vtkIdType i = 0; i < hullPoints->GetNumberOfPoints(); i++ )
+  {
+    PointKey key;
+    hullPoints->GetPoint( i, key.Coordinates );
+    hullPointIds[ i ] = this->PointIds[ key ];
+  }
+  vtkCellArray* hullPolys = hullPolyData->GetPolys();
+  vtkIdType numberOfCellPoints = 0;
+  vtkIdType* cellPointIds = NULL;
+  for ( hullPolys->InitTraversal(); hullPolys->GetNextCell( numberOfCellPoints, cellPointIds ); )
+  {
+    this->AddFace( hullPointIds[ cellPointIds[ 0 ] ], hullPointIds[ cellPointIds[ 1 ] ], hullPointIds[ cellPointIds[ 2 ] ] );
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Replace the faces that are visible from the point by a cone of faces from the horizon to the point,
+// the same step as in the quickhull algorithm. A point that is not above any face is inside the hull.
+void vtkSlicerMarkupsToModelIncrementalSurface::InsertHullPoint( vtkIdType pointId )
+{
+  const double* point = this->GetPoint( pointId );
+  int startFaceIndex = -1;
+  double largestDistance = this->Tolerance;
+  for ( size_t faceIndex = 0; faceIndex < this->Faces.size(); faceIndex++ )
+  {
+    const Face& face = this->Faces[ faceIndex ];
+    if ( face.Removed )
+    {
+      continue;
+    }
+    double distance = this->GetDistance( face, point );
+    if ( distance > largestDistance )
+    {
+      largestDistance = distance;
+      startFaceIndex = static_cast< int >( faceIndex );
+    }
+  }
+  if ( startFaceIndex < 0 )
+  {
+    return;
+  }
+
+  // the connected set of visible faces, and the horizon edges on their boundary
+  enum { NOT_VISITED = 0, VISIBLE, NOT_VISIBLE };
+  std::vector< char > visibility( this->Faces.size(), NOT_VISITED );
+  std::vector< int > visibleFaceIndices;
+  std::vector< Edge > horizonEdges;
+  std::vector< int > faceIndicesToVisit( 1, startFaceIndex );
+  visibility[ startFaceIndex ] = VISIBLE;
+  while ( !faceIndicesToVisit.empty() )
+  {
+    int faceIndex = faceIndicesToVisit.back();
+    faceIndicesToVisit.pop_back();
+    visibleFaceIndices.push_back( faceIndex );
+    const Face& face = this->Faces[ faceIndex ];
+    for ( int i = 0; i < 3; i++ )
+    {
+      Edge edge( face.Vertices[ i ], face.Vertices[ ( i + 1 ) % 3 ] );
+      std::map< Edge, int >::const_iterator neighborIt = this->EdgeToFace.find( Edge( edge.second, edge.first ) );
+      if ( neighborIt == this->EdgeToFace.end() )
+      {
+        // cannot happen in a closed hull, handle it as a horizon edge anyway
+        horizonEdges.push_back( edge );
+        continue;
+      }
+      char& neighborVisibility = visibility[ neighborIt->second ];
+      if ( neighborVisibility == NOT_VISITED )
+      {
+        neighborVisibility = ( this->GetDistance( this->Faces[ neighborIt->second ], point ) > this->Tolerance ) ? VISIBLE : NOT_VISIBLE;
+        if ( neighborVisibility == VISIBLE )
+        {
+          faceIndicesToVisit.push_back( neighborIt->second );
+        }
+      }
+      if ( neighborVisibility == NOT_VISIBLE )
+      {
+        horizonEdges.push_back( edge );
+      }
+    }
+  }
+
+  for ( size_t i = 0; i < visibleFaceIndices.size(); i++ )
+  {
+    this->RemoveFace( visibleFaceIndices[ i ] );
+  }
+  for ( size_t i = 0; i < horizonEdges.size(); i++ )
+  {
+    this->AddFace( horizonEdges[ i ].first, horizonEdges[ i ].second, pointId );
+  }
+}
+
+//------------------------------------------------------------------------------
+// The faces that are not around the removed vertex remain faces of the hull, so only the hole bounded by the neighbors
+// of the vertex needs to be closed. The points that can be vertices of the new faces are the neighbors and the points
+// that the vertex covered, which are in the convex hull of the vertex and its neighbors. The new faces are the faces
+// of the convex hull of these points that have no vertex of the hull above them.
+// Returns false if the hole cannot be closed consistently, then the hull is not changed.
+bool vtkSlicerMarkupsToModelIncrementalSurface::RemoveHullVertex( vtkIdType pointId )
+{
+  std::vector< int > starFaceIndices;
+  std::vector< Edge > linkEdges;
+  for ( size_t faceIndex = 0; faceIndex < this->Faces.size(); faceIndex++ )
+  {
+    const Face& face = this->Faces[ faceIndex ];
+    if ( face.Removed )
+    {
+      continue;
+    }
+    for ( int i = 0; i < 3; i++ )
+    {
+      if ( face.Vertices[ i ] == pointId )
+      {
+        starFaceIndices.push_back( static_cast< int >( faceIndex ) );
+        linkEdges.push_back( Edge( face.Vertices[ ( i + 1 ) % 3 ], face.Vertices[ ( i + 2 ) % 3 ] ) );
+        break;
+      }
+    }
+  }
+
+  // candidate points: the neighbors, and the points inside the hull within the bounding box of the star
+  vtkIdType numberOfPointIds = static_cast< vtkIdType >( this->PointMultiplicities.size() );
+  std::vector< char > isCandidate( numberOfPointIds, 0 );
+  std::vector< vtkIdType > candidatePointIds;
+  double bounds[ 6 ] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+  for ( size_t i = 0; i <= linkEdges.size(); i++ )
+  {
+    vtkIdType starPointId = ( i < linkEdges.size() ) ? linkEdges[ i ].first : pointId;
+    const double* point = this->GetPoint( starPointId );
+    for ( int j = 0; j < 3; j++ )
+    {
+      bounds[ 2 * j ] = std::min( bounds[ 2 * j ], point[ j ] - this->Tolerance );
+      bounds[ 2 * j + 1 ] = std::max( bounds[ 2 * j + 1 ], point[ j ] + this->Tolerance );
+    }
+    if ( starPointId != pointId && !isCandidate[ starPointId ] )
+    {
+      isCandidate[ starPointId ] = 1;
+      candidatePointIds.push_back( starPointId );
+    }
+  }
+  for ( vtkIdType candidatePointId = 0; candidatePointId < numberOfPointIds; candidatePointId++ )
+  {
+    if ( this->PointMultiplicities[ candidatePointId ] == 0 || this->PointNumberOfFaces[ candidatePointId ] > 0 )
+    {
+      continue;
+    }
+    const double* point = this->GetPoint( candidatePointId );
+    if ( point[ 0 ] >= bounds[ 0 ] && point[ 0 ] <= bounds[ 1 ] && point[ 1 ] >= bounds[ 2 ] && point[ 1 ] <= bounds[ 3 ]
+      && point[ 2 ] >= bounds[ 4 ] && point[ 2 ] <= bounds[ 5 ] )
+    {
+      isCandidate[ candidatePointId ] = 1;
+      candidatePointIds.push_back( candidatePointId );
+    }
+  }
+
+  vtkSmartPointer< vtkPoints > candidatePoints = vtkSmartPointer< vtkPoints >::New();
+  candidatePoints->SetDataTypeToDouble();
+  candidatePoints->SetNumberOfPoints( static_cast< vtkIdType >( candidatePointIds.size() ) );
+  for ( size_t i = 0; i < candidatePointIds.size(); i++ )
+  {
+    candidatePoints->SetPoint( static_cast< vtkIdType >( i ), this->GetPoint( candidatePointIds[ i ] ) );
+  }
+  vtkSmartPointer< vtkPolyData > candidateHull = vtkSmartPointer< vtkPolyData >::New();
+  if ( !vtkSlicerMarkupsToModelConvexHullFilter::ComputeConvexHull( candidatePoints, candidateHull ) )
+  {
+    // the neighbors are on a plane (or there are too few of them), the faces of the hole are ambiguous
+    return false;
+  }
+
+  // vertices of the hull that are not candidates, the new faces must not have any of them above
+  std::vector< vtkIdType > otherHullPointIds;
+  for ( vtkIdType otherPointId = 0; otherPointId < numberOfPointIds; otherPointId++ )
+  {
+    if ( this->PointNumberOfFaces[ otherPointId ] > 0 && otherPointId != pointId && !isCandidate[ otherPointId ] )
+    {
+      otherHullPointIds.push_back( otherPointId );
+    }
+  }
+  std::vector< char > isStarFace( this->Faces.size(), 0 );
+  for ( size_t i = 0; i < starFaceIndices.size(); i++ )
+  {
+    isStarFace[ starFaceIndices[ i ] ] = 1;
+  }
+
+  vtkPoints* hullPoints = candidateHull->GetPoints();
+  std::vector< vtkIdType > hullPointIds( hullPoints->GetNumberOfPoints(), -1 );
+  for ( vtkIdType i = 0; i < hullPoints->GetNumberOfPoints(); i++ )
+  {
+    PointKey key;
+    hullPoints->GetPoint( i, key.Coordinates );
+    hullPointIds[ i ] = this->PointIds[ key ];
+  }
+  std::vector< vtkIdType > newFaceVertices;
+  std::map< Edge, int > newEdges;
+  vtkCellArray* hullPolys = candidateHull->GetPolys();
+  vtkIdType numberOfCellPoints = 0;
+  vtkIdType* cellPointIds = NULL;
+  for ( hullPolys->InitTraversal(); hullPolys->GetNextCell( numberOfCellPoints, cellPointIds ); )
+  {
+    vtkIdType vertices[ 3 ] = { hullPointIds[ cellPointIds[ 0 ] ], hullPointIds[ cellPointIds[ 1 ] ], hullPointIds[ cellPointIds[ 2 ] ] };
+    // faces of the candidate hull that are already faces of the hull (around the hole) are kept as they are
+    std::map< Edge, int >::const_iterator existingFaceIt = this->EdgeToFace.find( Edge( vertices[ 0 ], vertices[ 1 ] ) );
+    if ( existingFaceIt != this->EdgeToFace.end() && !isStarFace[ existingFaceIt->second ] )
+    {
+      const vtkIdType* existingVertices = this->Faces[ existingFaceIt->second ].Vertices;
+      if ( std::find( existingVertices, existingVertices + 3, vertices[ 2 ] ) != existingVertices + 3 )
+      {
+        continue;
+      }
+    }
+    // faces that have a vertex of the hull above them face inwards
+    Face face;
+    const double* point0 = this->GetPoint( vertices[ 0 ] );
+    double edge1[ 3 ] = { 0.0, 0.0, 0.0 };
+    double edge2[ 3 ] = { 0.0, 0.0, 0.0 };
+    vtkMath::Subtract( this->GetPoint( vertices[ 1 ] ), point0, edge1 );
+    vtkMath::Subtract( this->GetPoint( vertices[ 2 ] ), point0, edge2 );
+    vtkMath::Cross( edge1, edge2, face.Normal );
+    vtkMath::Normalize( face.Normal );
+    face.Offset = vtkMath::Dot( face.Normal, point0 );
+    bool facesOutwards = true;
+    for ( size_t i = 0; i < otherHullPointIds.size() && facesOutwards; i++ )
+    {
+      facesOutwards = ( this->GetDistance( face, this->GetPoint( otherHullPointIds[ i ] ) ) <= this->Tolerance );
+    }
+    if ( !facesOutwards )
+    {
+      continue;
+    }
+    for ( int i = 0; i < 3; i++ )
+    {
+      Edge edge( vertices[ i ], vertices[ ( i + 1 ) % 3 ] );
+      std::map< Edge, int >::const_iterator edgeIt = this->EdgeToFace.find( edge );
+      if ( newEdges.count( edge ) > 0 || ( edgeIt != this->EdgeToFace.end() && !isStarFace[ edgeIt->second ] ) )
+      {
+        // the edge would be in more than one face
+        return false;
+      }
+      newEdges[ edge ] = 1;
+    }
+    newFaceVertices.insert( newFaceVertices.end(), vertices, vertices + 3 );
+  }
+
+  // the new faces must exactly close the hole: each of their edges is either between two new faces
+  // or on the boundary of the hole
+  std::map< Edge, int > linkEdgeSet;
+  for ( size_t i = 0; i < linkEdges.size(); i++ )
+  {
+    if ( newEdges.count( linkEdges[ i ] ) == 0 )
+    {
+      return false;
+    }
+    linkEdgeSet[ linkEdges[ i ] ] = 1;
+  }
+  for ( std::map< Edge, int >::const_iterator edgeIt = newEdges.begin(); edgeIt != newEdges.end(); ++edgeIt )
+  {
+    Edge reverseEdge( edgeIt->first.second, edgeIt->first.first );
+    if ( newEdges.count( reverseEdge ) == 0 && linkEdgeSet.count( edgeIt->first ) == 0 )
+    {
+      return false;
+    }
+  }
+
+  for ( size_t i = 0; i < starFaceIndices.size(); i++ )
+  {
+    this->RemoveFace( starFaceIndices[ i ] );
+  }
+  for ( size_t i = 0; i < newFaceVertices.size(); i += 3 )
+  {
+    this->AddFace( newFaceVertices[ i ], newFaceVertices[ i + 1 ], newFaceVertices[ i + 2 ] );
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelIncrementalSurface::GetSurface( vtkPolyData* outputPolyData )
+{
+  if ( outputPolyData == NULL )
+  {
+    vtkGenericWarningMacro( "Output poly data is null. No surface stored." );
+    return;
+  }
+  outputPolyData->Initialize();
+
+  std::vector< vtkIdType > outputPointIds( this->PointMultiplicities.size(), -1 );
+  vtkSmartPointer< vtkPoints > outputPoints = vtkSmartPointer< vtkPoints >::New();
+  outputPoints->SetDataType( this->PointsDataType );
+  vtkSmartPointer< vtkCellArray > outputTriangles = vtkSmartPointer< vtkCellArray >::New();
+  vtkIdType numberOfFaces = static_cast< vtkIdType >( this->Faces.size() - this->FreeFaceIndices.size() );
+  outputTriangles->Allocate( outputTriangles->EstimateSize( numberOfFaces, 3 ) );
+  for ( size_t faceIndex = 0; faceIndex < this->Faces.size(); faceIndex++ )
+  {
+    const Face& face = this->Faces[ faceIndex ];
+    if ( face.Removed )
+    {
+      continue;
+    }
+    outputTriangles->InsertNextCell( 3 );
+    for ( int i = 0; i < 3; i++ )
+    {
+      vtkIdType& outputPointId = outputPointIds[ face.Vertices[ i ] ];
+      if ( outputPointId < 0 )
+      {
+        outputPointId = outputPoints->InsertNextPoint( this->GetPoint( face.Vertices[ i ] ) );
+      }
+      outputTriangles->InsertCellPoint( outputPointId );
+    }
+  }
+  outputPolyData->SetPoints( outputPoints );
+  outputPolyData->SetPolys( outputTriangles );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelIncrementalSurface::ExpandPointSet( std::vector< char >& pointSet, int numberOfRings,
+  const std::vector< vtkIdType >& pointFaceOffsets, const std::vector< int >& pointFaces ) const
+{
+  vtkIdType numberOfPointIds = static_cast< vtkIdType >( pointSet.size() );
+  for ( int ring = 0; ring < numberOfRings; ring++ )
+  {
+    std::vector< char > expandedPointSet( pointSet );
+    for ( vtkIdType pointId = 0; pointId < numberOfPointIds; pointId++ )
+    {
+      if ( !pointSet[ pointId ] )
+      {
+        continue;
+      }
+      for ( vtkIdType i = pointFaceOffsets[ pointId ]; i < pointFaceOffsets[ pointId + 1 ]; i++ )
+      {
+        const vtkIdType* vertices = this->Faces[ pointFaces[ i ] ].Vertices;
+        expandedPointSet[ vertices[ 0 ] ] = 1;
+        expandedPointSet[ vertices[ 1 ] ] = 1;
+        expandedPointSet[ vertices[ 2 ] ] = 1;
+      }
+    }
+    pointSet.swap( expandedPointSet );
+  }
+}
+
+//------------------------------------------------------------------------------
+// The faces are subdivided together with the faces around them, which are only needed so that the surface
+// around the faces is the same as in the subdivision of the whole surface. The faces are first in the submesh,
+// so the triangles of their patches are the first triangles of the subdivided submesh.
+void vtkSlicerMarkupsToModelIncrementalSurface::SubdividePatches( const std::vector< int >& faceIndices,
+  const std::vector< int >& submeshFaceIndices, int numberOfSubdivisions, bool butterflyScheme )
+{
+  std::vector< int > orderedFaceIndices( faceIndices );
+  std::vector< char > isPatchFace( this->Faces.size(), 0 );
+  for ( size_t i = 0; i < faceIndices.size(); i++ )
+  {
+    isPatchFace[ faceIndices[ i ] ] = 1;
+  }
+  for ( size_t i = 0; i < submeshFaceIndices.size(); i++ )
+  {
+    if ( !isPatchFace[ submeshFaceIndices[ i ] ] )
+    {
+      orderedFaceIndices.push_back( submeshFaceIndices[ i ] );
+    }
+  }
+
+  std::vector< vtkIdType > submeshPointIds( this->PointMultiplicities.size(), -1 );
+  vtkSmartPointer< vtkPoints > submeshPoints = vtkSmartPointer< vtkPoints >::New();
+  submeshPoints->SetDataTypeToDouble();
+  vtkSmartPointer< vtkIdTypeArray > submeshCellIds = vtkSmartPointer< vtkIdTypeArray >::New();
+  vtkIdType* submeshCellId = submeshCellIds->WritePointer( 0, 4 * static_cast< vtkIdType >( orderedFaceIndices.size() ) );
+  for ( size_t i = 0; i < orderedFaceIndices.size(); i++ )
+  {
+    const Face& face = this->Faces[ orderedFaceIndices[ i ] ];
+    *( submeshCellId++ ) = 3;
+    for ( int j = 0; j < 3; j++ )
+    {
+      vtkIdType& submeshPointId = submeshPointIds[ face.Vertices[ j ] ];
+      if ( submeshPointId < 0 )
+      {
+        submeshPointId = submeshPoints->InsertNextPoint( this->GetPoint( face.Vertices[ j ] ) );
+      }
+      *( submeshCellId++ ) = submeshPointId;
+    }
+  }
+  vtkSmartPointer< vtkCellArray > submeshPolys = vtkSmartPointer< vtkCellArray >::New();
+  submeshPolys->SetCells( static_cast< vtkIdType >( orderedFaceIndices.size() ), submeshCellIds );
+  vtkSmartPointer< vtkPolyData > submesh = vtkSmartPointer< vtkPolyData >::New();
+  submesh->SetPoints( submeshPoints );
+  submesh->SetPolys( submeshPolys );
+
+  vtkSmartPointer< vtkPolyData > subdividedSubmesh = vtkSmartPointer< vtkPolyData >::New();
+  vtkSlicerMarkupsToModelSubdivisionFilter::Subdivide( submesh, subdividedSubmesh, numberOfSubdivisions, butterflyScheme, false );
+  const vtkIdType* subdividedCellPointIds = subdividedSubmesh->GetPolys()->GetPointer();
+  vtkPoints* subdividedPoints = subdividedSubmesh->GetPoints();
+
+  vtkIdType gridSize = static_cast< vtkIdType >( 1 ) << numberOfSubdivisions;
+  const vtkIdType corners[ 3 ][ 2 ] = { { gridSize, 0 }, { 0, gridSize }, { 0, 0 } };
+  vtkIdType numberOfPatchPoints = ( gridSize + 1 ) * ( gridSize + 2 ) / 2;
+  for ( size_t i = 0; i < faceIndices.size(); i++ )
+  {
+    std::vector< double >& patch = this->Faces[ faceIndices[ i ] ].Patch;
+    patch.resize( 3 * numberOfPatchPoints );
+    StorePatchPoints( subdividedCellPointIds, subdividedPoints, static_cast< vtkIdType >( i ), numberOfSubdivisions,
+      gridSize, corners, &( patch[ 0 ] ) );
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelIncrementalSurface::GetSubdividedSurface( vtkPolyData* outputPolyData, int numberOfSubdivisions, bool butterflyScheme )
+{
+  this->NumberOfSubdividedPatches = 0;
+  if ( outputPolyData == NULL )
+  {
+    vtkGenericWarningMacro( "Output poly data is null. No surface stored." );
+    return;
+  }
+  outputPolyData->Initialize();
+  numberOfSubdivisions = std::max( numberOfSubdivisions, 0 );
+
+  std::vector< int > faceIndices;
+  for ( size_t faceIndex = 0; faceIndex < this->Faces.size(); faceIndex++ )
+  {
+    if ( !this->Faces[ faceIndex ].Removed )
+    {
+      faceIndices.push_back( static_cast< int >( faceIndex ) );
+    }
+  }
+  if ( faceIndices.empty() )
+  {
+    return;
+  }
+  if ( numberOfSubdivisions != this->PatchNumberOfSubdivisions || butterflyScheme != this->PatchButterflyScheme )
+  {
+    for ( size_t i = 0; i < faceIndices.size(); i++ )
+    {
+      std::vector< double >().swap( this->Faces[ faceIndices[ i ] ].Patch );
+    }
+    this->PatchNumberOfSubdivisions = numberOfSubdivisions;
+    this->PatchButterflyScheme = butterflyScheme;
+  }
+
+  // faces around each point
+  vtkIdType numberOfPointIds = static_cast< vtkIdType >( this->PointMultiplicities.size() );
+  std::vector< vtkIdType > pointFaceOffsets( numberOfPointIds + 1, 0 );
+  for ( size_t i = 0; i < faceIndices.size(); i++ )
+  {
+    const vtkIdType* vertices = this->Faces[ faceIndices[ i ] ].Vertices;
+    pointFaceOffsets[ vertices[ 0 ] + 1 ]++;
+    pointFaceOffsets[ vertices[ 1 ] + 1 ]++;
+    pointFaceOffsets[ vertices[ 2 ] + 1 ]++;
+  }
+  for ( vtkIdType pointId = 0; pointId < numberOfPointIds; pointId++ )
+  {
+    pointFaceOffsets[ pointId + 1 ] += pointFaceOffsets[ pointId ];
+  }
+  std::vector< int > pointFaces( pointFaceOffsets[ numberOfPointIds ] );
+  std::vector< vtkIdType > insertPositions( pointFaceOffsets.begin(), pointFaceOffsets.end() - 1 );
+  for ( size_t i = 0; i < faceIndices.size(); i++ )
+  {
+    const vtkIdType* vertices = this->Faces[ faceIndices[ i ] ].Vertices;
+    for ( int j = 0; j < 3; j++ )
+    {
+      pointFaces[ insertPositions[ vertices[ j ] ]++ ] = faceIndices[ i ];
+    }
+  }
+
+  // The neighbors of the vertices of the new faces changed, the patches that are close to them are affected
+  std::vector< char > affectedPoints( numberOfPointIds, 0 );
+  for ( size_t i = 0; i < faceIndices.size(); i++ )
+  {
+    const Face& face = this->Faces[ faceIndices[ i ] ];
+    if ( face.Patch.empty() )
+    {
+      affectedPoints[ face.Vertices[ 0 ] ] = 1;
+      affectedPoints[ face.Vertices[ 1 ] ] = 1;
+      affectedPoints[ face.Vertices[ 2 ] ] = 1;
+    }
+  }
+  this->ExpandPointSet( affectedPoints, PATCH_DEPENDENCY_RINGS, pointFaceOffsets, pointFaces );
+  std::vector< int > patchFaceIndices;
+  for ( size_t i = 0; i < faceIndices.size(); i++ )
+  {
+    const vtkIdType* vertices = this->Faces[ faceIndices[ i ] ].Vertices;
+    if ( affectedPoints[ vertices[ 0 ] ] || affectedPoints[ vertices[ 1 ] ] || affectedPoints[ vertices[ 2 ] ] )
+    {
+      patchFaceIndices.push_back( faceIndices[ i ] );
+    }
+  }
+  if ( static_cast< double >( patchFaceIndices.size() ) > PATCH_MAXIMUM_LOCAL_FRACTION * faceIndices.size() )
+  {
+    this->SubdividePatches( faceIndices, faceIndices, numberOfSubdivisions, butterflyScheme );
+    this->NumberOfSubdividedPatches = static_cast< vtkIdType >( faceIndices.size() );
+  }
+  else if ( !patchFaceIndices.empty() )
+  {
+    // the points within the dependency distance from the patches must have all their faces in the submesh
+    std::vector< char > submeshPoints( numberOfPointIds, 0 );
+    for ( size_t i = 0; i < patchFaceIndices.size(); i++ )
+    {
+      const vtkIdType* vertices = this->Faces[ patchFaceIndices[ i ] ].Vertices;
+      submeshPoints[ vertices[ 0 ] ] = 1;
+      submeshPoints[ vertices[ 1 ] ] = 1;
+      submeshPoints[ vertices[ 2 ] ] = 1;
+    }
+    this->ExpandPointSet( submeshPoints, PATCH_DEPENDENCY_RINGS, pointFaceOffsets, pointFaces );
+    std::vector< int > submeshFaceIndices;
+    for ( size_t i = 0; i < faceIndices.size(); i++ )
+    {
+      const vtkIdType* vertices = this->Faces[ faceIndices[ i ] ].Vertices;
+      if ( submeshPoints[ vertices[ 0 ] ] || submeshPoints[ vertices[ 1 ] ] || submeshPoints[ vertices[ 2 ] ] )
+      {
+        submeshFaceIndices.push_back( faceIndices[ i ] );
+      }
+    }
+    this->SubdividePatches( patchFaceIndices, submeshFaceIndices, numberOfSubdivisions, butterflyScheme );
+    this->NumberOfSubdividedPatches = static_cast< vtkIdType >( patchFaceIndices.size() );
+  }
+
+  // Output point ids: the vertices of the hull, then gridSize - 1 points inside each edge (in the direction from
+  // its vertex with the smaller id), then the points inside the faces. The points on the edges and vertices are
+  // shared by the patches around them.
+  vtkIdType gridSize = static_cast< vtkIdType >( 1 ) << numberOfSubdivisions;
+  std::vector< vtkIdType > vertexOutputPointIds( numberOfPointIds, -1 );
+  vtkIdType numberOfOutputPoints = 0;
+  for ( size_t i = 0; i < faceIndices.size(); i++ )
+  {
+    const vtkIdType* vertices = this->Faces[ faceIndices[ i ] ].Vertices;
+    for ( int j = 0; j < 3; j++ )
+    {
+      if ( vertexOutputPointIds[ vertices[ j ] ] < 0 )
+      {
+        vertexOutputPointIds[ vertices[ j ] ] = numberOfOutputPoints++;
+      }
+    }
+  }
+  std::vector< vtkIdType > faceEdgeFirstOutputPointIds( 3 * faceIndices.size(), 0 );
+  std::map< Edge, vtkIdType > edgeFirstOutputPointIds;
+  for ( size_t i = 0; i < faceIndices.size(); i++ )
+  {
+    const vtkIdType* vertices = this->Faces[ faceIndices[ i ] ].Vertices;
+    for ( int j = 0; j < 3; j++ )
+    {
+      Edge edge( std::min( vertices[ j ], vertices[ ( j + 1 ) % 3 ] ), std::max( vertices[ j ], vertices[ ( j + 1 ) % 3 ] ) );
+      std::map< Edge, vtkIdType >::iterator edgeIt = edgeFirstOutputPointIds.find( edge );
+      if ( edgeIt == edgeFirstOutputPointIds.end() )
+      {
+        edgeIt = edgeFirstOutputPointIds.insert( std::make_pair( edge, numberOfOutputPoints ) ).first;
+        numberOfOutputPoints += gridSize - 1;
+      }
+      faceEdgeFirstOutputPointIds[ 3 * i + j ] = edgeIt->second;
+    }
+  }
+  vtkIdType numberOfFaceInteriorPoints = ( gridSize - 1 ) * ( gridSize - 2 ) / 2;
+  vtkIdType firstFaceInteriorOutputPointId = numberOfOutputPoints;
+  numberOfOutputPoints += numberOfFaceInteriorPoints * static_cast< vtkIdType >( faceIndices.size() );
+
+  vtkIdType numberOfPatchPoints = ( gridSize + 1 ) * ( gridSize + 2 ) / 2;
+  std::vector< double > outputCoordinates( 3 * numberOfOutputPoints );
+  std::vector< vtkIdType > outputTriangles;
+  outputTriangles.reserve( 3 * gridSize * gridSize * faceIndices.size() );
+  std::vector< vtkIdType > patchOutputPointIds( numberOfPatchPoints );
+  for ( size_t i = 0; i < faceIndices.size(); i++ )
+  {
+    const Face& face = this->Faces[ faceIndices[ i ] ];
+    // the vertices are at (gridSize, 0), (0, gridSize) and (0, 0)
+    for ( vtkIdType a = 0; a <= gridSize; a++ )
+    {
+      for ( vtkIdType b = 0; a + b <= gridSize; b++ )
+      {
+        // edge j goes from vertex j to vertex j + 1, steps is the distance from vertex j
+        int edgeIndex = -1;
+        vtkIdType steps = 0;
+        vtkIdType outputPointId = -1;
+        if ( a == gridSize )
+        {
+          outputPointId = vertexOutputPointIds[ face.Vertices[ 0 ] ];
+        }
+        else if ( b == gridSize )
+        {
+          outputPointId = vertexOutputPointIds[ face.Vertices[ 1 ] ];
+        }
+        else if ( a == 0 && b == 0 )
+        {
+          outputPointId = vertexOutputPointIds[ face.Vertices[ 2 ] ];
+        }
+        else if ( a + b == gridSize )
+        {
+          edgeIndex = 0;
+          steps = b;
+        }
+        else if ( a == 0 )
+        {
+          edgeIndex = 1;
+          steps = gridSize - b;
+        }
+        else if ( b == 0 )
+        {
+          edgeIndex = 2;
+          steps = a;
+        }
+        else
+        {
+          outputPointId = firstFaceInteriorOutputPointId + numberOfFaceInteriorPoints * static_cast< vtkIdType >( i )
+            + ( a - 1 ) * ( gridSize - 1 ) - ( a - 1 ) * a / 2 + ( b - 1 );
+        }
+        if ( edgeIndex >= 0 )
+        {
+          bool forward = ( face.Vertices[ edgeIndex ] < face.Vertices[ ( edgeIndex + 1 ) % 3 ] );
+          outputPointId = faceEdgeFirstOutputPointIds[ 3 * i + edgeIndex ] + ( forward ? steps : gridSize - steps ) - 1;
+        }
+        vtkIdType patchPointIndex = GetPatchPointIndex( a, b, gridSize );
+        patchOutputPointIds[ patchPointIndex ] = outputPointId;
+        std::copy( face.Patch.begin() + 3 * patchPointIndex, face.Patch.begin() + 3 * ( patchPointIndex + 1 ),
+          outputCoordinates.begin() + 3 * outputPointId );
+      }
+    }
+    // two triangles in each cell of the grid, with the same orientation as the face
+    for ( vtkIdType a = 0; a < gridSize; a++ )
+    {
+      for ( vtkIdType b = 0; a + b < gridSize; b++ )
+      {
+        outputTriangles.push_back( patchOutputPointIds[ GetPatchPointIndex( a + 1, b, gridSize ) ] );
+        outputTriangles.push_back( patchOutputPointIds[ GetPatchPointIndex( a, b + 1, gridSize ) ] );
+        outputTriangles.push_back( patchOutputPointIds[ GetPatchPointIndex( a, b, gridSize ) ] );
+        if ( a + b + 1 < gridSize )
+        {
+          outputTriangles.push_back( patchOutputPointIds[ GetPatchPointIndex( a + 1, b, gridSize ) ] );
+          outputTriangles.push_back( patchOutputPointIds[ GetPatchPointIndex( a + 1, b + 1, gridSize ) ] );
+          outputTriangles.push_back( patchOutputPointIds[ GetPatchPointIndex( a, b + 1, gridSize ) ] );
+        }
+      }
+    }
+  }
+
+  // the point normals are the area weighted averages of the normals of the triangles around the points,
+  // as in the subdivision filter
+  vtkIdType numberOfOutputTriangles = static_cast< vtkIdType >( outputTriangles.size() / 3 );
+  std::vector< double > normals( 3 * numberOfOutputPoints, 0.0 );
+  for ( vtkIdType i = 0; i < numberOfOutputTriangles; i++ )
+  {
+    const vtkIdType* triangle = &( outputTriangles[ 3 * i ] );
+    const double* point0 = &( outputCoordinates[ 3 * triangle[ 0 ] ] );
+    double edge1[ 3 ] = { 0.0, 0.0, 0.0 };
+    double edge2[ 3 ] = { 0.0, 0.0, 0.0 };
+    vtkMath::Subtract( &( outputCoordinates[ 3 * triangle[ 1 ] ] ), point0, edge1 );
+    vtkMath::Subtract( &( outputCoordinates[ 3 * triangle[ 2 ] ] ), point0, edge2 );
+    double triangleNormal[ 3 ] = { 0.0, 0.0, 0.0 };
+    vtkMath::Cross( edge1, edge2, triangleNormal );
+    for ( int j = 0; j < 3; j++ )
+    {
+      double* normal = &( normals[ 3 * triangle[ j ] ] );
+      normal[ 0 ] += triangleNormal[ 0 ];
+      normal[ 1 ] += triangleNormal[ 1 ];
+      normal[ 2 ] += triangleNormal[ 2 ];
+    }
+  }
+
+  vtkSmartPointer< vtkPoints > outputPoints = vtkSmartPointer< vtkPoints >::New();
+  outputPoints->SetDataType( this->PointsDataType );
+  outputPoints->SetNumberOfPoints( numberOfOutputPoints );
+  vtkSmartPointer< vtkFloatArray > outputNormals = vtkSmartPointer< vtkFloatArray >::New();
+  outputNormals->SetName( "Normals" );
+  outputNormals->SetNumberOfComponents( 3 );
+  outputNormals->SetNumberOfTuples( numberOfOutputPoints );
+  float* outputNormal = outputNormals->GetPointer( 0 );
+  for ( vtkIdType i = 0; i < numberOfOutputPoints; i++ )
+  {
+    outputPoints->SetPoint( i, &( outputCoordinates[ 3 * i ] ) );
+    double* normal = &( normals[ 3 * i ] );
+    vtkMath::Normalize( normal );
+    *( outputNormal++ ) = static_cast< float >( normal[ 0 ] );
+    *( outputNormal++ ) = static_cast< float >( normal[ 1 ] );
+    *( outputNormal++ ) = static_cast< float >( normal[ 2 ] );
+  }
+  vtkSmartPointer< vtkIdTypeArray > outputCellIds = vtkSmartPointer< vtkIdTypeArray >::New();
+  vtkIdType* outputCellId = outputCellIds->WritePointer( 0, 4 * numberOfOutputTriangles );
+  for ( vtkIdType i = 0; i < numberOfOutputTriangles; i++ )
+  {
+    *( outputCellId++ ) = 3;
+    *( outputCellId++ ) = outputTriangles[ 3 * i ];
+    *( outputCellId++ ) = outputTriangles[ 3 * i + 1 ];
+    *( outputCellId++ ) = outputTriangles[ 3 * i + 2 ];
+  }
+  vtkSmartPointer< vtkCellArray > outputPolys = vtkSmartPointer< vtkCellArray >::New();
+  outputPolys->SetCells( numberOfOutputTriangles, outputCellIds );
+  outputPolyData->SetPoints( outputPoints );
+  outputPolyData->SetPolys( outputPolys );
+  outputPolyData->GetPointData()->SetNormals( outputNormals );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelIncrementalSurface::PrintSelf( ostream &os, vtkIndent indent )
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfPoints: " << this->PointIds.size() << std::endl;
+  os << indent << "NumberOfFaces: " << ( this->Faces.size() - this->FreeFaceIndices.size() ) << std::endl;
+  os << indent << "NumberOfAddedPoints: " << this->NumberOfAddedPoints << std::endl;
+  os << indent << "NumberOfRemovedPoints: " << this->NumberOfRemovedPoints << std::endl;
+  os << indent << "HullRebuilt: " << ( this->HullRebuilt ? "true" : "false" ) << std::endl;
+  os << indent << "NumberOfSubdividedPatches: " << this->NumberOfSubdividedPatches << std::endl;
+}
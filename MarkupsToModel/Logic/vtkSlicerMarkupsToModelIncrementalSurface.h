@@ -0,0 +1,141 @@
+#ifndef __vtkSlicerMarkupsToModelIncrementalSurface_h
+#define __vtkSlicerMarkupsToModelIncrementalSurface_h
+
+// vtk includes
+#include <vtkObject.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkType.h>
+
+// std includes
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "vtkSlicerMarkupsToModelModuleLogicExport.h"
+
+// Closed surface of a point set that is updated locally when points are added, moved or removed.
+// The surface is the boundary of the Delaunay tetrahedralization of the points without alpha filtering,
+// which is the convex hull of the points. Instead of tetrahedralizing all points on each update, the hull
+// is kept between updates: an added point replaces the faces that it can see by a cone of faces from their
+// boundary to the point, a removed vertex of the hull is replaced by the part of the convex hull of its
+// neighbors (and the points that it covered) that faces outwards. Moved points are removed and added again.
+// If a change cannot be done locally (e.g., the replacement is ambiguous because the points are on a plane)
+// then the whole hull is computed again.
+// The subdivided surface is stored in a patch for each triangle of the hull. Only the patches of the triangles
+// that are close enough to a change to be affected by it are subdivided again, on a small part of the surface around them.
+// An instance must only be accessed by one thread at a time.
+class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelIncrementalSurface : public vtkObject
+{
+  public:
+    // standard vtk object methods
+    vtkTypeMacro( vtkSlicerMarkupsToModelIncrementalSurface, vtkObject );
+    void PrintSelf( ostream& os, vtkIndent indent ) VTK_OVERRIDE;
+    static vtkSlicerMarkupsToModelIncrementalSurface *New();
+
+    // Update the hull to the points: the points that are not in the previous point set are added,
+    // the ones that are no longer in it are removed. Points are identified by their coordinates, so
+    // reordering the points does not change the surface. Returns false if there are less than 4 different
+    // points or they are all on a plane, in this case the surface is empty.
+    bool UpdatePoints( vtkPoints* points );
+
+    // Remove all points and patches
+    void Reset();
+
+    // Store the triangles of the hull in outputPolyData, oriented so that their normals point outwards.
+    // Only the vertices of the hull are stored.
+    void GetSurface( vtkPolyData* outputPolyData );
+
+    // Store the subdivided surface and its point normals in outputPolyData. The result is the same as subdividing
+    // the surface with vtkSlicerMarkupsToModelSubdivisionFilter, except for the order of the points and triangles.
+    // Only the patches of the triangles that are affected by the changes since the previous call (or whose parameters
+    // are different) are computed. The output points have the data type of the points of the last UpdatePoints.
+    void GetSubdividedSurface( vtkPolyData* outputPolyData, int numberOfSubdivisions, bool butterflyScheme );
+
+    // Number of points that were added and removed by the last UpdatePoints (moved points are counted in both)
+    vtkGetMacro( NumberOfAddedPoints, vtkIdType );
+    vtkGetMacro( NumberOfRemovedPoints, vtkIdType );
+    // True if the whole hull was computed by the last UpdatePoints
+    vtkGetMacro( HullRebuilt, bool );
+    // Number of triangles whose patch was subdivided by the last GetSubdividedSurface
+    vtkGetMacro( NumberOfSubdividedPatches, vtkIdType );
+
+  protected:
+    vtkSlicerMarkupsToModelIncrementalSurface();
+    ~vtkSlicerMarkupsToModelIncrementalSurface();
+
+    // Coordinates of a point, ordered lexicographically
+    struct PointKey
+    {
+      double Coordinates[ 3 ];
+      bool operator<( const PointKey& other ) const;
+    };
+
+    // Triangle of the hull, the vertices are in counter-clockwise order when viewed from outside
+    struct Face
+    {
+      vtkIdType Vertices[ 3 ];
+      double Normal[ 3 ]; // unit normal, pointing outwards
+      double Offset; // signed distance of a point from the face plane is dot(Normal, point) - Offset
+      bool Removed;
+      // coordinates of the subdivided patch, 3 for each point of the triangular grid of the patch
+      std::vector< double > Patch;
+    };
+
+    typedef std::pair< vtkIdType, vtkIdType > Edge;
+
+    // points
+    vtkIdType AddPoint( const PointKey& key );
+    void RemovePoint( vtkIdType pointId );
+    const double* GetPoint( vtkIdType pointId ) const;
+
+    // hull operations
+    bool BuildHull();
+    void InsertHullPoint( vtkIdType pointId );
+    bool RemoveHullVertex( vtkIdType pointId );
+    int AddFace( vtkIdType vertex0, vtkIdType vertex1, vtkIdType vertex2 );
+    void RemoveFace( int faceIndex );
+    double GetDistance( const Face& face, const double point[ 3 ] ) const;
+    void UpdateTolerance( const double point[ 3 ] );
+    void ClearFaces();
+
+    // patches
+    void SubdividePatches( const std::vector< int >& faceIndices, const std::vector< int >& submeshFaceIndices,
+      int numberOfSubdivisions, bool butterflyScheme );
+    void ExpandPointSet( std::vector< char >& pointSet, int numberOfRings,
+      const std::vector< vtkIdType >& pointFaceOffsets, const std::vector< int >& pointFaces ) const;
+
+    // coordinates of the points, 3 for each point id, and the number of input points that have these coordinates
+    // (0 for ids that are not used)
+    std::vector< double > Coordinates;
+    std::vector< vtkIdType > PointMultiplicities;
+    std::vector< vtkIdType > FreePointIds;
+    std::map< PointKey, vtkIdType > PointIds;
+    // number of hull faces that each point is a vertex of (0 for points inside the hull)
+    std::vector< vtkIdType > PointNumberOfFaces;
+    int PointsDataType;
+
+    std::vector< Face > Faces;
+    std::vector< int > FreeFaceIndices;
+    // face that contains the directed edge
+    std::map< Edge, int > EdgeToFace;
+    // distances below this are considered to be rounding errors
+    double Tolerance;
+    double MaximumAbsoluteCoordinates[ 3 ];
+
+    // parameters of the stored patches. The patches of new faces are empty, the neighbors of their vertices changed.
+    int PatchNumberOfSubdivisions;
+    bool PatchButterflyScheme;
+
+    vtkIdType NumberOfAddedPoints;
+    vtkIdType NumberOfRemovedPoints;
+    bool HullRebuilt;
+    vtkIdType NumberOfSubdividedPatches;
+
+  private:
+    // not used
+    vtkSlicerMarkupsToModelIncrementalSurface ( const vtkSlicerMarkupsToModelIncrementalSurface& ) VTK_DELETE_FUNCTION;
+    void operator= ( const vtkSlicerMarkupsToModelIncrementalSurface& ) VTK_DELETE_FUNCTION;
+};
+
+#endif
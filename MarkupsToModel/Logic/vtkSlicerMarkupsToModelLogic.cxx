@@ -19,57 +19,648 @@
 #include "vtkSlicerMarkupsToModelLogic.h"
 #include "vtkSlicerMarkupsToModelClosedSurfaceGeneration.h"
 #include "vtkSlicerMarkupsToModelCurveGeneration.h"
+#include "vtkSlicerMarkupsToModelGeometryCache.h"
+#include "vtkSlicerMarkupsToModelPointProcessing.h"
+#include "vtkSlicerMarkupsToModelScratchBuffers.h"
+#include "vtkSlicerMarkupsToModelTubeGeneration.h"
+#include "vtkSlicerMarkupsToModelUpdateStatistics.h"
+
+// Slicer includes
+#include "vtkSlicerApplicationLogic.h"
 
 // MRML includes
 #include "vtkMRMLMarkupsFiducialNode.h"
 #include "vtkMRMLModelNode.h"
 #include "vtkMRMLSelectionNode.h"
+#include "vtkMRMLTransformNode.h"
+#include "vtkMRMLTransformableNode.h"
 #include <vtkMRMLModelDisplayNode.h>
 #include <vtkMRMLModelNode.h>
 #include <vtkMRMLScene.h>
 
 // VTK includes
 #include <vtkAppendPolyData.h>
+#include <vtkCallbackCommand.h>
 #include <vtkCellArray.h>
-#include <vtkCleanPolyData.h>
 #include <vtkCollection.h>
 #include <vtkCollectionIterator.h>
+#include <vtkConditionVariable.h>
 #include <vtkDoubleArray.h>
 #include <vtkDataSetSurfaceFilter.h>
 #include <vtkIntArray.h>
 #include <vtkMath.h>
 #include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPoints.h>
 #include <vtkPolyDataNormals.h>
+#include <vtkSMPTools.h>
+#include <vtkTimerLog.h>
 #include <vtkTransform.h>
 #include <vtkTransformFilter.h>
 #include <vtkUnstructuredGrid.h>
 
+#include <vtkWeakPointer.h>
+
+// vtksys includes
+#include <vtksys/SystemTools.hxx>
+
 // STD includes
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <map>
 #include <vector>
 #include <set>
+#include <string>
+
+// longest time the scheduler thread sleeps before it checks the scheduled time again
+static const unsigned int SCHEDULER_MAXIMUM_SLEEP_MSEC = 10;
+
+//----------------------------------------------------------------------------
+// Per-node state that is kept between updates
+class vtkSlicerMarkupsToModelLogic::vtkInternal
+{
+public:
+  struct NodeState
+  {
+    NodeState()
+      : UpdatePending( false )
+      , LastUpdateTime( 0.0 )
+      , LatestGeneration( 0 )
+      , OutputParametersValid( false )
+      , GeometryParametersKey( 0 )
+      , OutputAssignmentInProgress( false )
+      , FollowingInputTransform( false )
+      , NonlinearInputTransformReported( false )
+    {
+    }
+
+    vtkWeakPointer< vtkMRMLMarkupsToModelNode > Node;
+    vtkSmartPointer< vtkSlicerMarkupsToModelCurveGeneration > CurveGenerator;
+    // closed surface pipeline of the synchronous updates, the filters are kept between updates
+    vtkSmartPointer< vtkSlicerMarkupsToModelClosedSurfaceGeneration > ClosedSurfaceGenerator;
+    // control points of the input, reused between updates to avoid reallocation
+    vtkSmartPointer< vtkPoints > ControlPointsBuffer;
+    // memory for the temporary arrays of the synchronous updates, reused between updates
+    vtkSmartPointer< vtkSlicerMarkupsToModelScratchBuffers > ScratchBuffers;
+    // stages of the most recent completed update
+    vtkSmartPointer< vtkSlicerMarkupsToModelUpdateStatistics > UpdateStatistics;
+
+    // update scheduling
+    bool UpdatePending;
+    double LastUpdateTime; // universal time of the last output update, in seconds
+    // identifies the most recent update request, results of older requests are discarded
+    unsigned long LatestGeneration;
+
+    // parameters that the output model has been (or is being) generated with,
+    // used for ignoring parameter node modifications that do not affect the output
+    bool OutputParametersValid;
+    vtkTypeUInt64 GeometryParametersKey;
+    std::string InputNodeID;
+    std::string OutputModelNodeID;
+    // true while the logic assigns the output model, which may modify the parameter node
+    bool OutputAssignmentInProgress;
+
+    // FollowInputTransform: the output model that was placed under the transform of the input, and
+    // the transform that the output model had before, which is restored when following stops
+    bool FollowingInputTransform;
+    std::string FollowedInputNodeID;
+    std::string FollowedOutputModelNodeID;
+    std::string OutputTransformNodeIDBeforeFollowing;
+    // the warning about a non-linear input transform is only logged once until following is possible again
+    bool NonlinearInputTransformReported;
+  };
+
+  // Output generation job for the background thread.
+  // The worker thread only accesses the copies of the parameters and control points.
+  // NodeKey identifies the parameter node, it is never dereferenced on the worker thread.
+  struct GenerationJob
+  {
+    GenerationJob()
+      : NodeKey( NULL )
+      , Generation( 0 )
+      , CacheKey( 0 )
+      , Succeeded( false )
+    {
+    }
+
+    vtkMRMLMarkupsToModelNode* NodeKey;
+    unsigned long Generation;
+    vtkTypeUInt64 CacheKey; // key of the output in the geometry cache
+    bool Succeeded;
+    vtkSmartPointer< vtkMRMLMarkupsToModelNode > Parameters;
+    vtkSmartPointer< vtkPoints > ControlPoints;
+    vtkSmartPointer< vtkPoints > CacheControlPoints; // control points before cleaning, stored with the output in the geometry cache
+    vtkSmartPointer< vtkPolyData > OutputPolyData;
+    vtkSmartPointer< vtkSlicerMarkupsToModelUpdateStatistics > Statistics;
+    // pipeline of closed surface jobs, it is aborted when a newer update of the node is requested while the job is running
+    vtkSmartPointer< vtkSlicerMarkupsToModelClosedSurfaceGeneration > ClosedSurfaceGenerator;
+  };
+
+  // Generates the output of a range of jobs, for vtkSMPTools::For
+  class GenerationJobsFunctor
+  {
+  public:
+    GenerationJobsFunctor( std::vector< GenerationJob >& jobs )
+      : Jobs( jobs )
+    {
+    }
+
+    void operator()( vtkIdType firstJobIndex, vtkIdType endJobIndex )
+    {
+      for ( vtkIdType jobIndex = firstJobIndex; jobIndex < endJobIndex; jobIndex++ )
+      {
+        GenerationJob& job = this->Jobs[ jobIndex ];
+        if ( job.OutputPolyData.GetPointer() != NULL )
+        {
+          // already available, for example from the geometry cache
+          continue;
+        }
+        job.OutputPolyData = vtkSmartPointer< vtkPolyData >::New();
+        job.Succeeded = vtkSlicerMarkupsToModelLogic::GenerateOutputPolyData( job.ControlPoints, job.Parameters, job.OutputPolyData, job.Statistics,
+          job.ClosedSurfaceGenerator );
+      }
+    }
+
+  private:
+    std::vector< GenerationJob >& Jobs;
+  };
+
+  vtkInternal();
+  ~vtkInternal();
+
+  // Get the state of the node, create it if it does not exist yet
+  NodeState& GetNodeState( vtkMRMLMarkupsToModelNode* node )
+  {
+    NodeState& nodeState = this->NodeStates[ node ];
+    if ( nodeState.Node.GetPointer() != node )
+    {
+      // new node, or a node that was deleted and a new one was created at the same address
+      nodeState = NodeState();
+      nodeState.Node = node;
+      nodeState.CurveGenerator = vtkSmartPointer< vtkSlicerMarkupsToModelCurveGeneration >::New();
+      nodeState.ClosedSurfaceGenerator = vtkSmartPointer< vtkSlicerMarkupsToModelClosedSurfaceGeneration >::New();
+      nodeState.ControlPointsBuffer = vtkSmartPointer< vtkPoints >::New();
+      nodeState.ScratchBuffers = vtkSmartPointer< vtkSlicerMarkupsToModelScratchBuffers >::New();
+    }
+    return nodeState;
+  }
+
+  // Store the parameters that the output of the node is generated with
+  static void StoreOutputParameters( NodeState& nodeState, vtkMRMLMarkupsToModelNode* node )
+  {
+    nodeState.OutputParametersValid = true;
+    nodeState.GeometryParametersKey = node->GetGeometryParametersKey();
+    nodeState.InputNodeID = ( node->GetInputNode() != NULL && node->GetInputNode()->GetID() != NULL ) ? node->GetInputNode()->GetID() : "";
+    nodeState.OutputModelNodeID = ( node->GetOutputModelNode() != NULL && node->GetOutputModelNode()->GetID() != NULL ) ? node->GetOutputModelNode()->GetID() : "";
+  }
+
+  // Returns true if the parameters of the node that affect the output are different from the stored ones
+  static bool IsOutputParametersModified( NodeState& nodeState, vtkMRMLMarkupsToModelNode* node )
+  {
+    if ( !nodeState.OutputParametersValid )
+    {
+      return true;
+    }
+    NodeState currentState;
+    vtkInternal::StoreOutputParameters( currentState, node );
+    return ( currentState.GeometryParametersKey != nodeState.GeometryParametersKey
+      || currentState.InputNodeID != nodeState.InputNodeID
+      || currentState.OutputModelNodeID != nodeState.OutputModelNodeID );
+  }
+
+  void RemoveNodeState( vtkMRMLNode* node )
+  {
+    this->NodeStates.erase( vtkMRMLMarkupsToModelNode::SafeDownCast( node ) );
+  }
+
+  // Get the control points from the input node of the parameter node.
+  // If the points are not modified during model generation (no cleaning) then the points of an input model node
+  // are returned directly, without copying. Otherwise the points are copied into the buffer of the node state.
+  // The returned points must not be modified. Returns NULL if the input node type is not supported.
+  vtkPoints* GetInputControlPoints( NodeState& nodeState, vtkMRMLMarkupsToModelNode* node );
+
+  // Take a snapshot of the parameters and control points of the node, on the main thread.
+  // The stages of the job are appended to statistics.
+  static GenerationJob CreateGenerationJob( vtkMRMLMarkupsToModelNode* node, vtkPoints* controlPoints, unsigned long generation,
+    vtkTypeUInt64 cacheKey, vtkSlicerMarkupsToModelUpdateStatistics* statistics );
+  // Add a job for the background thread. A queued job of the same node that has not been started yet is replaced.
+  // The stages of the job are appended to statistics. When the job is finished, processing on the main thread
+  // is requested through applicationLogic (if it is specified), which publishes the result.
+  // A running job of the same node that was created for an older update request is aborted.
+  void QueueGenerationJob( vtkMRMLMarkupsToModelNode* node, vtkPoints* controlPoints, unsigned long generation,
+    vtkTypeUInt64 cacheKey, vtkSlicerMarkupsToModelUpdateStatistics* statistics, vtkSlicerApplicationLogic* applicationLogic );
+  // Abort the running job of the node if it was created for an older update request than generation.
+  // Only closed surface jobs can be aborted, curve jobs run to completion (their result is discarded).
+  void AbortRunningJob( vtkMRMLMarkupsToModelNode* node, unsigned long generation );
+
+  // Compute the geometry cache key of the output of the node and look it up in the cache.
+  // If found then the cached output is copied into outputPolyData and true is returned.
+  bool FindCachedOutput( vtkPoints* controlPoints, vtkMRMLMarkupsToModelNode* node, vtkTypeUInt64& cacheKey,
+    vtkPolyData* outputPolyData, vtkSlicerMarkupsToModelUpdateStatistics* statistics );
+  // Get the jobs that have been completed since the last call
+  void TakeFinishedJobs( std::vector< GenerationJob >& finishedJobs );
+  // Returns true if there are queued, running or finished but not yet published jobs
+  bool HasActiveJobs();
+  // Block until there are no queued or running jobs
+  void WaitForJobs();
+
+  static VTK_THREAD_RETURN_TYPE WorkerThreadFunction( void* arg );
+  void RunWorker();
+
+  // Request the application logic to invoke ModifiedEvent of ProcessingRequest on the main thread
+  // at the specified universal time (or as soon as possible if it has already passed).
+  // Must be called on the main thread. Returns false if no application logic is specified.
+  bool ScheduleProcessing( vtkSlicerApplicationLogic* applicationLogic, double processingTime );
+  // Request the application logic to invoke ModifiedEvent of ProcessingRequest on the main thread as soon as possible.
+  // Can be called from any thread. Does nothing if no application logic has been specified yet.
+  void RequestProcessing();
+  static VTK_THREAD_RETURN_TYPE SchedulerThreadFunction( void* arg );
+  void RunScheduler();
+
+  std::map< vtkMRMLMarkupsToModelNode*, NodeState > NodeStates;
+  unsigned long GenerationCounter;
+
+  // previously generated outputs, only accessed from the main thread
+  vtkSmartPointer< vtkSlicerMarkupsToModelGeometryCache > GeometryCache;
+
+  // background generation, the job containers are protected by JobMutex
+  vtkSmartPointer< vtkMultiThreader > Threader;
+  int WorkerThreadId; // -1 if the worker thread is not running
+  vtkSmartPointer< vtkMutexLock > JobMutex;
+  vtkSmartPointer< vtkConditionVariable > JobCondition;
+  vtkSmartPointer< vtkConditionVariable > JobFinishedCondition;
+  std::map< vtkMRMLMarkupsToModelNode*, GenerationJob > QueuedJobs;
+  std::map< vtkMRMLMarkupsToModelNode*, GenerationJob > RunningJobs;
+  std::map< vtkMRMLMarkupsToModelNode*, GenerationJob > FinishedJobs;
+  bool StopWorker;
+
+  // Processing of deferred updates on the main thread. The application logic invokes ModifiedEvent
+  // of ProcessingRequest on the main thread (vtkSlicerApplicationLogic::RequestModified can be called from any thread),
+  // which is observed by the logic. The scheduler thread sends the request when the scheduled time is reached.
+  // The members below ProcessingRequestCallback are protected by SchedulerMutex.
+  vtkSmartPointer< vtkObject > ProcessingRequest;
+  vtkSmartPointer< vtkCallbackCommand > ProcessingRequestCallback;
+  int SchedulerThreadId; // -1 if the scheduler thread is not running
+  vtkSmartPointer< vtkMutexLock > SchedulerMutex;
+  vtkSmartPointer< vtkConditionVariable > SchedulerCondition;
+  vtkSlicerApplicationLogic* SchedulerApplicationLogic;
+  double ScheduledProcessingTime; // universal time in seconds, 0 if no processing is scheduled
+  bool StopScheduler;
+};
+
+//----------------------------------------------------------------------------
+vtkSlicerMarkupsToModelLogic::vtkInternal::vtkInternal()
+  : GenerationCounter( 0 )
+  , WorkerThreadId( -1 )
+  , StopWorker( false )
+  , SchedulerThreadId( -1 )
+  , SchedulerApplicationLogic( NULL )
+  , ScheduledProcessingTime( 0.0 )
+  , StopScheduler( false )
+{
+  this->GeometryCache = vtkSmartPointer< vtkSlicerMarkupsToModelGeometryCache >::New();
+  this->Threader = vtkSmartPointer< vtkMultiThreader >::New();
+  this->JobMutex = vtkSmartPointer< vtkMutexLock >::New();
+  this->JobCondition = vtkSmartPointer< vtkConditionVariable >::New();
+  this->JobFinishedCondition = vtkSmartPointer< vtkConditionVariable >::New();
+  this->ProcessingRequest = vtkSmartPointer< vtkObject >::New();
+  this->ProcessingRequestCallback = vtkSmartPointer< vtkCallbackCommand >::New();
+  this->SchedulerMutex = vtkSmartPointer< vtkMutexLock >::New();
+  this->SchedulerCondition = vtkSmartPointer< vtkConditionVariable >::New();
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerMarkupsToModelLogic::vtkInternal::~vtkInternal()
+{
+  this->JobMutex->Lock();
+  this->StopWorker = true;
+  this->JobCondition->Broadcast();
+  this->JobMutex->Unlock();
+  if ( this->WorkerThreadId >= 0 )
+  {
+    // waits for the thread to finish
+    this->Threader->TerminateThread( this->WorkerThreadId );
+    this->WorkerThreadId = -1;
+  }
+
+  this->SchedulerMutex->Lock();
+  this->StopScheduler = true;
+  this->SchedulerCondition->Broadcast();
+  this->SchedulerMutex->Unlock();
+  if ( this->SchedulerThreadId >= 0 )
+  {
+    this->Threader->TerminateThread( this->SchedulerThreadId );
+    this->SchedulerThreadId = -1;
+  }
+  // a request that is already queued in the application logic must not reach the deleted logic
+  this->ProcessingRequest->RemoveObserver( this->ProcessingRequestCallback );
+}
+
+//----------------------------------------------------------------------------
+vtkPoints* vtkSlicerMarkupsToModelLogic::vtkInternal::GetInputControlPoints( NodeState& nodeState, vtkMRMLMarkupsToModelNode* node )
+{
+  vtkMRMLNode* inputNode = node->GetInputNode();
+  vtkMRMLMarkupsFiducialNode* inputMarkupsNode = vtkMRMLMarkupsFiducialNode::SafeDownCast( inputNode );
+  vtkMRMLModelNode* inputModelNode = vtkMRMLModelNode::SafeDownCast( inputNode );
+  if ( inputMarkupsNode != NULL )
+  {
+    // markups do not store their positions in a vtkPoints object, they always have to be copied
+    nodeState.ControlPointsBuffer->Reset();
+    vtkSlicerMarkupsToModelLogic::MarkupsToPoints( inputMarkupsNode, nodeState.ControlPointsBuffer );
+    return nodeState.ControlPointsBuffer;
+  }
+  else if ( inputModelNode != NULL )
+  {
+    vtkPolyData* inputPolyData = inputModelNode->GetPolyData();
+    if ( !node->GetCleanMarkups() && inputPolyData != NULL && inputPolyData->GetPoints() != NULL )
+    {
+      return inputPolyData->GetPoints();
+    }
+    nodeState.ControlPointsBuffer->Reset();
+    vtkSlicerMarkupsToModelLogic::ModelToPoints( inputModelNode, nodeState.ControlPointsBuffer );
+    return nodeState.ControlPointsBuffer;
+  }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerMarkupsToModelLogic::vtkInternal::GenerationJob vtkSlicerMarkupsToModelLogic::vtkInternal::CreateGenerationJob(
+  vtkMRMLMarkupsToModelNode* node, vtkPoints* controlPoints, unsigned long generation,
+  vtkTypeUInt64 cacheKey, vtkSlicerMarkupsToModelUpdateStatistics* statistics )
+{
+  GenerationJob job;
+  job.NodeKey = node;
+  job.Generation = generation;
+  job.CacheKey = cacheKey;
+  job.Parameters = vtkSmartPointer< vtkMRMLMarkupsToModelNode >::New();
+  job.Parameters->Copy( node );
+  // the interaction state is not copied, so the quality level that applies now is stored in the copy
+  job.Parameters->SetQualityLevel( node->GetCurrentQualityLevel() );
+  job.ControlPoints = vtkSmartPointer< vtkPoints >::New();
+  job.ControlPoints->DeepCopy( controlPoints );
+  job.CacheControlPoints = job.ControlPoints;
+  if ( node->GetCleanMarkups() )
+  {
+    // the control points of the job are cleaned in place
+    job.CacheControlPoints = vtkSmartPointer< vtkPoints >::New();
+    job.CacheControlPoints->DeepCopy( controlPoints );
+  }
+  job.Statistics = statistics;
+  if ( node->GetModelType() == vtkMRMLMarkupsToModelNode::ClosedSurface )
+  {
+    job.ClosedSurfaceGenerator = vtkSmartPointer< vtkSlicerMarkupsToModelClosedSurfaceGeneration >::New();
+  }
+  return job;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::vtkInternal::QueueGenerationJob( vtkMRMLMarkupsToModelNode* node, vtkPoints* controlPoints, unsigned long generation,
+  vtkTypeUInt64 cacheKey, vtkSlicerMarkupsToModelUpdateStatistics* statistics, vtkSlicerApplicationLogic* applicationLogic )
+{
+  // take a snapshot of the inputs on the main thread
+  GenerationJob job = vtkInternal::CreateGenerationJob( node, controlPoints, generation, cacheKey, statistics );
+  // the result of the running job would be discarded anyway
+  this->AbortRunningJob( node, generation );
+
+  if ( applicationLogic != NULL )
+  {
+    this->SchedulerMutex->Lock();
+    this->SchedulerApplicationLogic = applicationLogic;
+    this->SchedulerMutex->Unlock();
+  }
+
+  this->JobMutex->Lock();
+  if ( this->WorkerThreadId < 0 )
+  {
+    this->WorkerThreadId = this->Threader->SpawnThread( &vtkInternal::WorkerThreadFunction, this );
+  }
+  this->QueuedJobs[ node ] = job;
+  this->JobCondition->Signal();
+  this->JobMutex->Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::vtkInternal::AbortRunningJob( vtkMRMLMarkupsToModelNode* node, unsigned long generation )
+{
+  this->JobMutex->Lock();
+  std::map< vtkMRMLMarkupsToModelNode*, GenerationJob >::iterator jobIt = this->RunningJobs.find( node );
+  if ( jobIt != this->RunningJobs.end() && jobIt->second.Generation < generation && jobIt->second.ClosedSurfaceGenerator.GetPointer() != NULL )
+  {
+    // the generator of the job is only used by this job, so the abort request does not have to be cleared
+    jobIt->second.ClosedSurfaceGenerator->SetAbortUpdate( true );
+  }
+  this->JobMutex->Unlock();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelLogic::vtkInternal::FindCachedOutput( vtkPoints* controlPoints, vtkMRMLMarkupsToModelNode* node, vtkTypeUInt64& cacheKey,
+  vtkPolyData* outputPolyData, vtkSlicerMarkupsToModelUpdateStatistics* statistics )
+{
+  double stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+  cacheKey = vtkSlicerMarkupsToModelGeometryCache::ComputeKey( controlPoints, node );
+  bool found = this->GeometryCache->Find( cacheKey, controlPoints, node, outputPolyData );
+  statistics->AddPolyDataStage( "cache lookup", stageStartTime, found ? outputPolyData : NULL );
+  return found;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::vtkInternal::TakeFinishedJobs( std::vector< GenerationJob >& finishedJobs )
+{
+  this->JobMutex->Lock();
+  std::map< vtkMRMLMarkupsToModelNode*, GenerationJob >::iterator jobIt;
+  for ( jobIt = this->FinishedJobs.begin(); jobIt != this->FinishedJobs.end(); ++jobIt )
+  {
+    finishedJobs.push_back( jobIt->second );
+  }
+  this->FinishedJobs.clear();
+  this->JobMutex->Unlock();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelLogic::vtkInternal::HasActiveJobs()
+{
+  this->JobMutex->Lock();
+  bool hasActiveJobs = ( !this->QueuedJobs.empty() || !this->RunningJobs.empty() || !this->FinishedJobs.empty() );
+  this->JobMutex->Unlock();
+  return hasActiveJobs;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::vtkInternal::WaitForJobs()
+{
+  this->JobMutex->Lock();
+  while ( !this->QueuedJobs.empty() || !this->RunningJobs.empty() )
+  {
+    this->JobFinishedCondition->Wait( this->JobMutex );
+  }
+  this->JobMutex->Unlock();
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkSlicerMarkupsToModelLogic::vtkInternal::WorkerThreadFunction( void* arg )
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast< vtkMultiThreader::ThreadInfo* >( arg );
+  vtkInternal* self = static_cast< vtkInternal* >( threadInfo->UserData );
+  self->RunWorker();
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::vtkInternal::RunWorker()
+{
+  this->JobMutex->Lock();
+  while ( true )
+  {
+    while ( !this->StopWorker && this->QueuedJobs.empty() )
+    {
+      this->JobCondition->Wait( this->JobMutex );
+    }
+    if ( this->StopWorker )
+    {
+      break;
+    }
+
+    // serve the oldest request first
+    std::map< vtkMRMLMarkupsToModelNode*, GenerationJob >::iterator jobIt = this->QueuedJobs.begin();
+    std::map< vtkMRMLMarkupsToModelNode*, GenerationJob >::iterator oldestJobIt = jobIt;
+    for ( ; jobIt != this->QueuedJobs.end(); ++jobIt )
+    {
+      if ( jobIt->second.Generation < oldestJobIt->second.Generation )
+      {
+        oldestJobIt = jobIt;
+      }
+    }
+    GenerationJob job = oldestJobIt->second;
+    this->QueuedJobs.erase( oldestJobIt );
+    // listed while running, so that a newer update request of the node can abort it
+    this->RunningJobs[ job.NodeKey ] = job;
+    this->JobMutex->Unlock();
+
+    // an aborted job does not succeed, its result is not published
+    job.OutputPolyData = vtkSmartPointer< vtkPolyData >::New();
+    job.Succeeded = vtkSlicerMarkupsToModelLogic::GenerateOutputPolyData( job.ControlPoints, job.Parameters, job.OutputPolyData, job.Statistics,
+      job.ClosedSurfaceGenerator );
+    // the parameters are kept, the output is stored with them in the geometry cache when it is published
+    job.ControlPoints = NULL;
+    job.ClosedSurfaceGenerator = NULL;
+
+    this->JobMutex->Lock();
+    this->RunningJobs.erase( job.NodeKey );
+    std::map< vtkMRMLMarkupsToModelNode*, GenerationJob >::iterator finishedJobIt = this->FinishedJobs.find( job.NodeKey );
+    if ( finishedJobIt == this->FinishedJobs.end() || finishedJobIt->second.Generation < job.Generation )
+    {
+      this->FinishedJobs[ job.NodeKey ] = job;
+    }
+    this->JobFinishedCondition->Broadcast();
+
+    // publish the result on the main thread
+    this->JobMutex->Unlock();
+    this->RequestProcessing();
+    this->JobMutex->Lock();
+  }
+  this->JobMutex->Unlock();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelLogic::vtkInternal::ScheduleProcessing( vtkSlicerApplicationLogic* applicationLogic, double processingTime )
+{
+  if ( applicationLogic == NULL )
+  {
+    return false;
+  }
+  this->SchedulerMutex->Lock();
+  this->SchedulerApplicationLogic = applicationLogic;
+  if ( this->ScheduledProcessingTime <= 0.0 || processingTime < this->ScheduledProcessingTime )
+  {
+    this->ScheduledProcessingTime = std::max( processingTime, 1.0e-6 ); // 0 means that nothing is scheduled
+  }
+  if ( this->SchedulerThreadId < 0 )
+  {
+    this->SchedulerThreadId = this->Threader->SpawnThread( &vtkInternal::SchedulerThreadFunction, this );
+  }
+  this->SchedulerCondition->Signal();
+  this->SchedulerMutex->Unlock();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::vtkInternal::RequestProcessing()
+{
+  this->SchedulerMutex->Lock();
+  if ( this->SchedulerApplicationLogic != NULL )
+  {
+    this->SchedulerApplicationLogic->RequestModified( this->ProcessingRequest );
+  }
+  this->SchedulerMutex->Unlock();
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkSlicerMarkupsToModelLogic::vtkInternal::SchedulerThreadFunction( void* arg )
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast< vtkMultiThreader::ThreadInfo* >( arg );
+  vtkInternal* self = static_cast< vtkInternal* >( threadInfo->UserData );
+  self->RunScheduler();
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::vtkInternal::RunScheduler()
+{
+  this->SchedulerMutex->Lock();
+  while ( !this->StopScheduler )
+  {
+    if ( this->ScheduledProcessingTime <= 0.0 )
+    {
+      // nothing to do until processing is scheduled
+      this->SchedulerCondition->Wait( this->SchedulerMutex );
+      continue;
+    }
+    double remainingTime = this->ScheduledProcessingTime - vtkTimerLog::GetUniversalTime();
+    if ( remainingTime <= 0.0 )
+    {
+      this->ScheduledProcessingTime = 0.0;
+      // the application logic invokes the event on the main thread
+      this->SchedulerApplicationLogic->RequestModified( this->ProcessingRequest );
+      continue;
+    }
+    // sleep in short steps, so that stopping the thread is not delayed
+    unsigned int sleepTime = std::min( static_cast< unsigned int >( remainingTime * 1000.0 ) + 1, SCHEDULER_MAXIMUM_SLEEP_MSEC );
+    this->SchedulerMutex->Unlock();
+    vtksys::SystemTools::Delay( sleepTime );
+    this->SchedulerMutex->Lock();
+  }
+  this->SchedulerMutex->Unlock();
+}
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerMarkupsToModelLogic);
 
 //----------------------------------------------------------------------------
 vtkSlicerMarkupsToModelLogic::vtkSlicerMarkupsToModelLogic()
+  : UpdateStatisticsEventEnabled( false )
 {
+  this->Internal = new vtkInternal;
+  this->Internal->ProcessingRequestCallback->SetCallback( &vtkSlicerMarkupsToModelLogic::OnProcessingRequested );
+  this->Internal->ProcessingRequestCallback->SetClientData( this );
+  this->Internal->ProcessingRequest->AddObserver( vtkCommand::ModifiedEvent, this->Internal->ProcessingRequestCallback );
 }
 
 //----------------------------------------------------------------------------
 vtkSlicerMarkupsToModelLogic::~vtkSlicerMarkupsToModelLogic()
 {
+  delete this->Internal;
+  this->Internal = NULL;
 }
 
 //----------------------------------------------------------------------------
 void vtkSlicerMarkupsToModelLogic::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "UpdateStatisticsEventEnabled: " << this->UpdateStatisticsEventEnabled << std::endl;
 }
 
 //---------------------------------------------------------------------------
@@ -83,6 +674,7 @@ void vtkSlicerMarkupsToModelLogic::SetMRMLSceneInternal(vtkMRMLScene * newScene)
   events->InsertNextValue(vtkMRMLScene::StartImportEvent);
   events->InsertNextValue(vtkMRMLScene::EndImportEvent);
   this->SetAndObserveMRMLSceneEventsInternal(newScene, events.GetPointer());
+  this->Internal->NodeStates.clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -108,16 +700,7 @@ void vtkSlicerMarkupsToModelLogic::OnMRMLSceneEndImport()
 {
   vtkSmartPointer<vtkCollection> markupsToModelNodes = vtkSmartPointer<vtkCollection>::Take(
     this->GetMRMLScene()->GetNodesByClass("vtkMRMLMarkupsToModelNode"));
-  vtkNew<vtkCollectionIterator> markupsToModelNodeIt;
-  markupsToModelNodeIt->SetCollection(markupsToModelNodes);
-  for (markupsToModelNodeIt->InitTraversal(); !markupsToModelNodeIt->IsDoneWithTraversal(); markupsToModelNodeIt->GoToNextItem())
-  {
-    vtkMRMLMarkupsToModelNode* markupsToModelNode = vtkMRMLMarkupsToModelNode::SafeDownCast(markupsToModelNodeIt->GetCurrentObject());
-    if (markupsToModelNode != NULL)
-    {
-      this->UpdateOutputModel(markupsToModelNode);
-    }
-  }
+  this->UpdateOutputModels(markupsToModelNodes);
 }
 
 //---------------------------------------------------------------------------
@@ -142,6 +725,8 @@ void vtkSlicerMarkupsToModelLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
     vtkNew<vtkIntArray> events;
     events->InsertNextValue(vtkCommand::ModifiedEvent);
     events->InsertNextValue(vtkMRMLMarkupsToModelNode::MarkupsPositionModifiedEvent);
+    events->InsertNextValue(vtkMRMLMarkupsToModelNode::InputInteractionEndedEvent);
+    events->InsertNextValue(vtkMRMLMarkupsToModelNode::InputTransformModifiedEvent);
     vtkObserveMRMLNodeEventsMacro(markupsToModelNode, events.GetPointer());
   }
 }
@@ -155,10 +740,11 @@ void vtkSlicerMarkupsToModelLogic::OnMRMLSceneNodeRemoved(vtkMRMLNode* node)
     return;
   }
 
-  if (node->IsA("vtkSlicerMarkupsToModelNode"))
+  if (node->IsA("vtkMRMLMarkupsToModelNode"))
   {
     vtkDebugMacro("OnMRMLSceneNodeRemoved");
     vtkUnObserveMRMLNodeMacro(node);
+    this->Internal->RemoveNodeState(node);
   }
 }
 
@@ -225,6 +811,12 @@ void vtkSlicerMarkupsToModelLogic::UpdateOutputModel(vtkMRMLMarkupsToModelNode*
     vtkErrorMacro( "No markupsToModelModuleNode provided to UpdateOutputModel. No operation performed." );
     return;
   }
+
+  // this update takes care of any deferred update requests
+  vtkInternal::NodeState& nodeState = this->Internal->GetNodeState( markupsToModelModuleNode );
+  nodeState.UpdatePending = false;
+  nodeState.LastUpdateTime = vtkTimerLog::GetUniversalTime();
+  vtkInternal::StoreOutputParameters( nodeState, markupsToModelModuleNode );
   
   // check if the input node is defined
   // (no need to worry about output. if not defined, it will be created later on)
@@ -235,26 +827,279 @@ void vtkSlicerMarkupsToModelLogic::UpdateOutputModel(vtkMRMLMarkupsToModelNode*
   }
 
   // extract the input points from the MRML node, according to its type
-  vtkSmartPointer< vtkPoints > controlPoints = vtkSmartPointer< vtkPoints >::New();
-  vtkMRMLMarkupsFiducialNode* inputMarkupsNode = vtkMRMLMarkupsFiducialNode::SafeDownCast( inputNode );
-  vtkMRMLModelNode* inputModelNode = vtkMRMLModelNode::SafeDownCast( inputNode );
-  if ( inputMarkupsNode != NULL )
+  double stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+  vtkPoints* controlPoints = this->Internal->GetInputControlPoints( nodeState, markupsToModelModuleNode );
+  if ( controlPoints == NULL )
   {
-    vtkSlicerMarkupsToModelLogic::MarkupsToPoints( inputMarkupsNode, controlPoints );
+    vtkErrorMacro( "Input node type is not supported. No operation performed." );
+    return;
   }
-  else if ( inputModelNode != NULL )
+  vtkSmartPointer< vtkSlicerMarkupsToModelUpdateStatistics > statistics = vtkSmartPointer< vtkSlicerMarkupsToModelUpdateStatistics >::New();
+  statistics->AddPointsStage( "extraction", stageStartTime, controlPoints );
+
+  // each update request supersedes the previous ones
+  nodeState.LatestGeneration = ++this->Internal->GenerationCounter;
+
+  vtkSmartPointer<vtkPolyData> outputPolyData = vtkSmartPointer<vtkPolyData>::New();
+  int interpolationType = markupsToModelModuleNode->GetInterpolationType();
+  // if there is no event loop that the result could be published on then the model is generated synchronously
+  bool asynchronousUpdate = markupsToModelModuleNode->GetAsynchronousUpdate()
+    && ( this->HasObserver( PendingUpdatesEvent ) || this->GetApplicationLogic() != NULL );
+  // the in-place updates maintain tessellated tubes, a centerline is cheap to regenerate
+  bool centerlineOutput = ( markupsToModelModuleNode->GetCenterlineOutput() && markupsToModelModuleNode->GetTubeRadius() > 0.0 );
+  bool incrementalUpdate = ( !asynchronousUpdate && !centerlineOutput && markupsToModelModuleNode->GetModelType() == vtkMRMLMarkupsToModelNode::Curve
+    && markupsToModelModuleNode->GetIncrementalCurveUpdate() && interpolationType != vtkMRMLMarkupsToModelNode::Polynomial
+    && markupsToModelModuleNode->GetTubeSamplingTolerance() <= 0.0 ); // adaptive sampling changes the number of curve points
+  bool streamingUpdate = ( !asynchronousUpdate && !centerlineOutput && markupsToModelModuleNode->GetModelType() == vtkMRMLMarkupsToModelNode::Curve
+    && markupsToModelModuleNode->GetStreamingCurveUpdate() && interpolationType != vtkMRMLMarkupsToModelNode::Polynomial
+    && !markupsToModelModuleNode->GetTubeLoop() && markupsToModelModuleNode->GetTubeSamplingTolerance() <= 0.0 );
+  if ( streamingUpdate )
   {
-    vtkSlicerMarkupsToModelLogic::ModelToPoints( inputModelNode, controlPoints );
+    // streaming takes precedence, it handles appended points more efficiently
+    incrementalUpdate = false;
   }
-  else
+  if ( !asynchronousUpdate )
   {
-    vtkErrorMacro( "Input node type is not supported. No operation performed." );
+    // a background update of the node that is still running is superseded by this one
+    this->Internal->AbortRunningJob( markupsToModelModuleNode, nodeState.LatestGeneration );
+  }
+
+  // the incrementally updated output is modified in place, therefore it is not cached
+  vtkTypeUInt64 cacheKey = 0;
+  if ( !incrementalUpdate && !streamingUpdate
+    && this->Internal->FindCachedOutput( controlPoints, markupsToModelModuleNode, cacheKey, outputPolyData, statistics ) )
+  {
+    this->AssignGeneratedPolyDataToOutput( markupsToModelModuleNode, outputPolyData, statistics );
+    return;
+  }
+
+  if ( asynchronousUpdate )
+  {
+    // the result is published by ProcessPendingUpdates, which the worker thread requests on the main thread when the job is finished
+    this->Internal->QueueGenerationJob( markupsToModelModuleNode, controlPoints, nodeState.LatestGeneration, cacheKey, statistics,
+      this->GetApplicationLogic() );
+    this->InvokeEvent( PendingUpdatesEvent );
     return;
   }
 
+  // the temporary arrays of the previous update are not used anymore
+  nodeState.ScratchBuffers->Reset();
+
   // Create the model from the points
-  vtkSmartPointer<vtkPolyData> outputPolyData = vtkSmartPointer<vtkPolyData>::New();
-  bool cleanMarkups = markupsToModelModuleNode->GetCleanMarkups();
+  if ( incrementalUpdate )
+  {
+    // update the current output mesh in place if possible
+    if ( markupsToModelModuleNode->GetCleanMarkups() )
+    {
+      stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+      vtkSlicerMarkupsToModelPointProcessing::RemoveDuplicatePoints( controlPoints, markupsToModelModuleNode->GetCleanMarkupsTolerance(), NULL,
+        nodeState.ScratchBuffers );
+      statistics->AddPointsStage( "deduplication", stageStartTime, controlPoints );
+    }
+    stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+    vtkMRMLModelNode* outputModelNode = markupsToModelModuleNode->GetOutputModelNode();
+    if ( outputModelNode != NULL && outputModelNode->GetPolyData() != NULL )
+    {
+      outputPolyData = outputModelNode->GetPolyData();
+    }
+    nodeState.CurveGenerator->UpdateCurveModelIncrementally( controlPoints, outputPolyData, interpolationType,
+      markupsToModelModuleNode->GetTubeRadius(), markupsToModelModuleNode->GetTubeNumberOfSides(),
+      markupsToModelModuleNode->GetTubeSegmentsBetweenControlPoints(), markupsToModelModuleNode->GetTubeLoop(),
+      markupsToModelModuleNode->GetKochanekBias(), markupsToModelModuleNode->GetKochanekContinuity(),
+      markupsToModelModuleNode->GetKochanekTension(), markupsToModelModuleNode->GetKochanekEndsCopyNearestDerivatives() );
+    statistics->AddPolyDataStage( "incremental curve update", stageStartTime, outputPolyData );
+  }
+  else if ( streamingUpdate )
+  {
+    // extend the current output mesh in place if possible,
+    // duplicates are skipped by the streaming update itself so that the indices of the input points are kept
+    stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+    vtkMRMLModelNode* outputModelNode = markupsToModelModuleNode->GetOutputModelNode();
+    if ( outputModelNode != NULL && outputModelNode->GetPolyData() != NULL )
+    {
+      outputPolyData = outputModelNode->GetPolyData();
+    }
+    double minimumPointDistance = markupsToModelModuleNode->GetCleanMarkups() ? markupsToModelModuleNode->GetCleanMarkupsTolerance() : 0.0;
+    nodeState.CurveGenerator->UpdateCurveModelStreaming( controlPoints, outputPolyData, interpolationType,
+      markupsToModelModuleNode->GetTubeRadius(), markupsToModelModuleNode->GetTubeNumberOfSides(),
+      markupsToModelModuleNode->GetTubeSegmentsBetweenControlPoints(),
+      markupsToModelModuleNode->GetKochanekBias(), markupsToModelModuleNode->GetKochanekContinuity(),
+      markupsToModelModuleNode->GetKochanekTension(), markupsToModelModuleNode->GetKochanekEndsCopyNearestDerivatives(),
+      minimumPointDistance, markupsToModelModuleNode->GetStreamingMaximumNumberOfPoints(),
+      markupsToModelModuleNode->GetStreamingMaximumPointAge(), vtkTimerLog::GetUniversalTime() );
+    statistics->AddPolyDataStage( "streaming curve update", stageStartTime, outputPolyData );
+  }
+  else
+  {
+    // The control points may be reused by the next update, the cache keeps its own copy. Cleaning modifies them in place,
+    // so then they are copied before generation, otherwise only if the generated model is small enough to be stored.
+    vtkSlicerMarkupsToModelGeometryCache* geometryCache = this->Internal->GeometryCache;
+    vtkSmartPointer< vtkPoints > cacheControlPoints;
+    if ( markupsToModelModuleNode->GetCleanMarkups() && geometryCache->CanStore( controlPoints, NULL ) )
+    {
+      cacheControlPoints = vtkSmartPointer< vtkPoints >::New();
+      cacheControlPoints->DeepCopy( controlPoints );
+    }
+    if ( vtkSlicerMarkupsToModelLogic::GenerateOutputPolyData( controlPoints, markupsToModelModuleNode, outputPolyData, statistics,
+      nodeState.ClosedSurfaceGenerator, nodeState.ScratchBuffers ) )
+    {
+      if ( !markupsToModelModuleNode->GetCleanMarkups() && geometryCache->CanStore( controlPoints, outputPolyData ) )
+      {
+        cacheControlPoints = vtkSmartPointer< vtkPoints >::New();
+        cacheControlPoints->DeepCopy( controlPoints );
+      }
+      if ( cacheControlPoints.GetPointer() != NULL && geometryCache->CanStore( cacheControlPoints, outputPolyData ) )
+      {
+        geometryCache->Insert( cacheKey, cacheControlPoints, markupsToModelModuleNode, outputPolyData );
+      }
+    }
+  }
+
+  this->AssignGeneratedPolyDataToOutput( markupsToModelModuleNode, outputPolyData, statistics );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::UpdateOutputModels( vtkCollection* markupsToModelModuleNodes, vtkMRMLModelNode* combinedOutputModelNode )
+{
+  if ( markupsToModelModuleNodes == NULL )
+  {
+    vtkErrorMacro( "No node collection provided to UpdateOutputModels. No operation performed." );
+    return;
+  }
+
+  // take a snapshot of the inputs of all nodes
+  std::vector< vtkInternal::GenerationJob > jobs;
+  vtkNew< vtkCollectionIterator > nodeIt;
+  nodeIt->SetCollection( markupsToModelModuleNodes );
+  for ( nodeIt->InitTraversal(); !nodeIt->IsDoneWithTraversal(); nodeIt->GoToNextItem() )
+  {
+    vtkMRMLMarkupsToModelNode* markupsToModelModuleNode = vtkMRMLMarkupsToModelNode::SafeDownCast( nodeIt->GetCurrentObject() );
+    if ( markupsToModelModuleNode == NULL )
+    {
+      continue;
+    }
+    vtkInternal::NodeState& nodeState = this->Internal->GetNodeState( markupsToModelModuleNode );
+    nodeState.UpdatePending = false;
+    nodeState.LastUpdateTime = vtkTimerLog::GetUniversalTime();
+    vtkInternal::StoreOutputParameters( nodeState, markupsToModelModuleNode );
+    if ( markupsToModelModuleNode->GetInputNode() == NULL )
+    {
+      continue;
+    }
+    double stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+    vtkPoints* controlPoints = this->Internal->GetInputControlPoints( nodeState, markupsToModelModuleNode );
+    if ( controlPoints == NULL )
+    {
+      vtkErrorMacro( "Input node type of " << markupsToModelModuleNode->GetID() << " is not supported. No operation performed." );
+      continue;
+    }
+    vtkSmartPointer< vtkSlicerMarkupsToModelUpdateStatistics > statistics = vtkSmartPointer< vtkSlicerMarkupsToModelUpdateStatistics >::New();
+    statistics->AddPointsStage( "extraction", stageStartTime, controlPoints );
+    // results of background updates that are still running are discarded
+    nodeState.LatestGeneration = ++this->Internal->GenerationCounter;
+    this->Internal->AbortRunningJob( markupsToModelModuleNode, nodeState.LatestGeneration );
+    vtkSmartPointer< vtkPolyData > cachedPolyData = vtkSmartPointer< vtkPolyData >::New();
+    vtkTypeUInt64 cacheKey = 0;
+    if ( this->Internal->FindCachedOutput( controlPoints, markupsToModelModuleNode, cacheKey, cachedPolyData, statistics ) )
+    {
+      // no need to copy the inputs, the output is not generated
+      vtkInternal::GenerationJob job;
+      job.NodeKey = markupsToModelModuleNode;
+      job.Generation = nodeState.LatestGeneration;
+      job.OutputPolyData = cachedPolyData;
+      job.Statistics = statistics;
+      jobs.push_back( job );
+      continue;
+    }
+    jobs.push_back( vtkInternal::CreateGenerationJob( markupsToModelModuleNode, controlPoints, nodeState.LatestGeneration, cacheKey, statistics ) );
+  }
+  if ( jobs.empty() )
+  {
+    return;
+  }
+
+  // the jobs only access their own copies of the inputs, so they can be run concurrently
+  vtkInternal::GenerationJobsFunctor generateJobs( jobs );
+  vtkSMPTools::For( 0, static_cast< vtkIdType >( jobs.size() ), 1, generateJobs );
+  for ( unsigned int i = 0; i < jobs.size(); i++ )
+  {
+    if ( jobs[ i ].Succeeded )
+    {
+      this->Internal->GeometryCache->Insert( jobs[ i ].CacheKey, jobs[ i ].CacheControlPoints, jobs[ i ].Parameters, jobs[ i ].OutputPolyData );
+    }
+  }
+
+  if ( combinedOutputModelNode != NULL )
+  {
+    // the generated (or cached) models are copied into one mesh, they are not modified
+    double stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+    std::vector< vtkPolyData* > outputPolyDatas;
+    for ( unsigned int i = 0; i < jobs.size(); i++ )
+    {
+      outputPolyDatas.push_back( jobs[ i ].OutputPolyData );
+    }
+    vtkSmartPointer< vtkPolyData > combinedPolyData = vtkSmartPointer< vtkPolyData >::New();
+    vtkSlicerMarkupsToModelTubeGeneration::CombineModels( outputPolyDatas, combinedPolyData );
+    combinedOutputModelNode->SetAndObservePolyData( combinedPolyData );
+    if ( combinedOutputModelNode->GetDisplayNode() == NULL && combinedOutputModelNode->GetScene() != NULL )
+    {
+      combinedOutputModelNode->CreateDefaultDisplayNodes();
+    }
+    for ( unsigned int i = 0; i < jobs.size(); i++ )
+    {
+      std::map< vtkMRMLMarkupsToModelNode*, vtkInternal::NodeState >::iterator nodeStateIt = this->Internal->NodeStates.find( jobs[ i ].NodeKey );
+      if ( nodeStateIt == this->Internal->NodeStates.end() || nodeStateIt->second.Node.GetPointer() == NULL )
+      {
+        continue;
+      }
+      jobs[ i ].Statistics->AddPolyDataStage( "combined output assignment", stageStartTime, combinedPolyData );
+      this->SetUpdateStatistics( nodeStateIt->second.Node, jobs[ i ].Statistics );
+    }
+    return;
+  }
+
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  if ( scene != NULL )
+  {
+    scene->StartState( vtkMRMLScene::BatchProcessState );
+  }
+  for ( unsigned int i = 0; i < jobs.size(); i++ )
+  {
+    // the node may only be accessed through its state, as it may have been deleted by observers of previous outputs
+    std::map< vtkMRMLMarkupsToModelNode*, vtkInternal::NodeState >::iterator nodeStateIt = this->Internal->NodeStates.find( jobs[ i ].NodeKey );
+    if ( nodeStateIt == this->Internal->NodeStates.end() || nodeStateIt->second.Node.GetPointer() == NULL )
+    {
+      continue;
+    }
+    this->AssignGeneratedPolyDataToOutput( nodeStateIt->second.Node, jobs[ i ].OutputPolyData, jobs[ i ].Statistics );
+  }
+  if ( scene != NULL )
+  {
+    scene->EndState( vtkMRMLScene::BatchProcessState );
+  }
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelLogic::GenerateOutputPolyData( vtkPoints* controlPoints, vtkMRMLMarkupsToModelNode* markupsToModelModuleNode, vtkPolyData* outputPolyData,
+  vtkSlicerMarkupsToModelUpdateStatistics* statistics, vtkSlicerMarkupsToModelClosedSurfaceGeneration* closedSurfaceGenerator,
+  vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers )
+{
+  if ( controlPoints == NULL || markupsToModelModuleNode == NULL || outputPolyData == NULL )
+  {
+    vtkGenericWarningMacro( "GenerateOutputPolyData: invalid inputs. No operation performed." );
+    return false;
+  }
+
+  if ( markupsToModelModuleNode->GetCleanMarkups() )
+  {
+    double stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+    vtkSlicerMarkupsToModelPointProcessing::RemoveDuplicatePoints( controlPoints, markupsToModelModuleNode->GetCleanMarkupsTolerance(), NULL, scratchBuffers );
+    if ( statistics != NULL )
+    {
+      statistics->AddPointsStage( "deduplication", stageStartTime, controlPoints );
+    }
+  }
+  bool cleanMarkups = false; // already done
   switch ( markupsToModelModuleNode->GetModelType() )
   {
     case vtkMRMLMarkupsToModelNode::ClosedSurface:
@@ -262,8 +1107,27 @@ void vtkSlicerMarkupsToModelLogic::UpdateOutputModel(vtkMRMLMarkupsToModelNode*
       double delaunayAlpha = markupsToModelModuleNode->GetDelaunayAlpha();
       bool smoothing = markupsToModelModuleNode->GetButterflySubdivision();
       bool forceConvex = markupsToModelModuleNode->GetConvexHull();
-      vtkSlicerMarkupsToModelLogic::UpdateClosedSurfaceModel( controlPoints, outputPolyData, smoothing, forceConvex, delaunayAlpha, cleanMarkups );
-      break;
+      if ( markupsToModelModuleNode->GetCurrentQualityLevel() == vtkMRMLMarkupsToModelNode::PreviewQuality )
+      {
+        // subdivision and the convex hull re-triangulation of the subdivided surface are by far the most expensive steps
+        smoothing = false;
+        forceConvex = false;
+      }
+      int surfaceGenerationMethod = markupsToModelModuleNode->GetSurfaceGenerationMethod();
+      vtkSmartPointer< vtkSlicerMarkupsToModelClosedSurfaceGeneration > temporaryClosedSurfaceGenerator;
+      if ( closedSurfaceGenerator == NULL )
+      {
+        temporaryClosedSurfaceGenerator = vtkSmartPointer< vtkSlicerMarkupsToModelClosedSurfaceGeneration >::New();
+        closedSurfaceGenerator = temporaryClosedSurfaceGenerator;
+      }
+      closedSurfaceGenerator->SetDecimationTargetNumberOfPoints( markupsToModelModuleNode->GetDecimationTargetNumberOfPoints() );
+      closedSurfaceGenerator->SetDecimationSpacing( markupsToModelModuleNode->GetDecimationSpacing() );
+      closedSurfaceGenerator->SetNumberOfSubdivisions( markupsToModelModuleNode->GetNumberOfSubdivisions() );
+      closedSurfaceGenerator->SetSinglePrecisionOutput( markupsToModelModuleNode->GetSinglePrecisionOutput() );
+      closedSurfaceGenerator->SetIncrementalDelaunay( markupsToModelModuleNode->GetIncrementalDelaunay() );
+      closedSurfaceGenerator->SetScratchBuffers( scratchBuffers );
+      return closedSurfaceGenerator->UpdateClosedSurfaceModel( controlPoints, outputPolyData, delaunayAlpha, smoothing, forceConvex,
+        surfaceGenerationMethod, statistics );
     }
     case vtkMRMLMarkupsToModelNode::Curve:
     {
@@ -278,12 +1142,372 @@ void vtkSlicerMarkupsToModelLogic::UpdateOutputModel(vtkMRMLMarkupsToModelNode*
       double kochanekBias = markupsToModelModuleNode->GetKochanekBias();
       double kochanekContinuity = markupsToModelModuleNode->GetKochanekContinuity();
       double kochanekTension = markupsToModelModuleNode->GetKochanekTension();
-      vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel( controlPoints, outputPolyData, interpolationType, tubeLoop, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, cleanMarkups, polynomialOrder, pointParameterType, kochanekEndsCopyNearestDerivatives, kochanekBias, kochanekContinuity, kochanekTension );
-      break;
+      double tubeSamplingTolerance = markupsToModelModuleNode->GetTubeSamplingTolerance();
+      // a single point is shown as a sphere, which is small enough to be tessellated
+      bool centerlineOutput = ( markupsToModelModuleNode->GetCenterlineOutput() && tubeRadius > 0.0 && controlPoints->GetNumberOfPoints() >= 2 );
+      if ( !centerlineOutput )
+      {
+        return vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel( controlPoints, outputPolyData, interpolationType, tubeLoop, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, cleanMarkups, polynomialOrder, pointParameterType, kochanekEndsCopyNearestDerivatives, kochanekBias, kochanekContinuity, kochanekTension, tubeSamplingTolerance, statistics, scratchBuffers );
+      }
+      // generate the polyline of the curve points, then add the tube parameters to it
+      if ( !vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel( controlPoints, outputPolyData, interpolationType, tubeLoop, 0.0, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, cleanMarkups, polynomialOrder, pointParameterType, kochanekEndsCopyNearestDerivatives, kochanekBias, kochanekContinuity, kochanekTension, tubeSamplingTolerance, statistics, scratchBuffers ) )
+      {
+        return false;
+      }
+      double stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+      vtkSmartPointer< vtkPoints > curvePoints = outputPolyData->GetPoints();
+      if ( curvePoints.GetPointer() != NULL )
+      {
+        vtkSlicerMarkupsToModelTubeGeneration::GenerateCenterlineModel( curvePoints, outputPolyData, tubeRadius, tubeNumberOfSides );
+      }
+      if ( statistics != NULL )
+      {
+        statistics->AddPolyDataStage( "centerline frames", stageStartTime, outputPolyData );
+      }
+      return true;
+    }
+    default:
+    {
+      vtkGenericWarningMacro( "GenerateOutputPolyData: unknown model type. No operation performed." );
+      return false;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::RequestOutputModelUpdate( vtkMRMLMarkupsToModelNode* markupsToModelModuleNode )
+{
+  if ( markupsToModelModuleNode == NULL )
+  {
+    vtkErrorMacro( "No markupsToModelModuleNode provided to RequestOutputModelUpdate. No operation performed." );
+    return;
+  }
+
+  if ( markupsToModelModuleNode->GetMaximumUpdateRate() <= 0.0 )
+  {
+    this->UpdateOutputModel( markupsToModelModuleNode );
+    return;
+  }
+
+  vtkInternal::NodeState& nodeState = this->Internal->GetNodeState( markupsToModelModuleNode );
+  if ( nodeState.UpdatePending )
+  {
+    // already scheduled, this change is merged into that update
+    return;
+  }
+  // the update will be performed by ProcessPendingUpdates
+  nodeState.UpdatePending = true;
+  double updateTime = nodeState.LastUpdateTime + 1.0 / markupsToModelModuleNode->GetMaximumUpdateRate();
+  if ( !this->SchedulePendingUpdates( updateTime ) )
+  {
+    // there is no event loop that the update could be deferred to
+    this->UpdateOutputModel( markupsToModelModuleNode );
+  }
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelLogic::SchedulePendingUpdates( double processingTime )
+{
+  if ( this->HasObserver( PendingUpdatesEvent ) )
+  {
+    // the observer calls ProcessPendingUpdates
+    this->InvokeEvent( PendingUpdatesEvent );
+    return true;
+  }
+  return this->Internal->ScheduleProcessing( this->GetApplicationLogic(), processingTime );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::OnProcessingRequested( vtkObject* vtkNotUsed( caller ), unsigned long vtkNotUsed( eid ),
+  void* clientData, void* vtkNotUsed( callData ) )
+{
+  vtkSlicerMarkupsToModelLogic* self = static_cast< vtkSlicerMarkupsToModelLogic* >( clientData );
+  self->ProcessPendingUpdates();
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::ProcessPendingUpdates( bool force )
+{
+  if ( this->GetMRMLScene() &&
+    ( this->GetMRMLScene()->IsImporting() ||
+    this->GetMRMLScene()->IsRestoring() ||
+    this->GetMRMLScene()->IsClosing() ) )
+  {
+    return;
+  }
+
+  // publish the results of background generation
+  std::vector< vtkInternal::GenerationJob > finishedJobs;
+  this->Internal->TakeFinishedJobs( finishedJobs );
+  for ( unsigned int i = 0; i < finishedJobs.size(); i++ )
+  {
+    if ( finishedJobs[ i ].Succeeded )
+    {
+      // the output is valid for its inputs even if it is not shown anymore
+      this->Internal->GeometryCache->Insert( finishedJobs[ i ].CacheKey, finishedJobs[ i ].CacheControlPoints, finishedJobs[ i ].Parameters,
+        finishedJobs[ i ].OutputPolyData );
+    }
+    std::map< vtkMRMLMarkupsToModelNode*, vtkInternal::NodeState >::iterator nodeStateIt =
+      this->Internal->NodeStates.find( finishedJobs[ i ].NodeKey );
+    if ( nodeStateIt == this->Internal->NodeStates.end()
+      || nodeStateIt->second.Node.GetPointer() == NULL
+      || nodeStateIt->second.LatestGeneration != finishedJobs[ i ].Generation )
+    {
+      // the node has been removed or a newer update has been requested since
+      continue;
+    }
+    this->AssignGeneratedPolyDataToOutput( nodeStateIt->second.Node, finishedJobs[ i ].OutputPolyData, finishedJobs[ i ].Statistics );
+  }
+
+  // collect nodes first, as updating the output may modify the node states
+  double currentTime = vtkTimerLog::GetUniversalTime();
+  std::vector< vtkWeakPointer< vtkMRMLMarkupsToModelNode > > nodesToUpdate;
+  std::map< vtkMRMLMarkupsToModelNode*, vtkInternal::NodeState >::iterator nodeStateIt = this->Internal->NodeStates.begin();
+  while ( nodeStateIt != this->Internal->NodeStates.end() )
+  {
+    vtkInternal::NodeState& nodeState = nodeStateIt->second;
+    if ( nodeState.Node.GetPointer() == NULL )
+    {
+      // the node has been deleted
+      this->Internal->NodeStates.erase( nodeStateIt++ );
+      continue;
+    }
+    if ( nodeState.UpdatePending )
+    {
+      double maximumUpdateRate = nodeState.Node->GetMaximumUpdateRate();
+      bool updateIntervalElapsed = ( maximumUpdateRate <= 0.0
+        || currentTime - nodeState.LastUpdateTime >= 1.0 / maximumUpdateRate );
+      if ( force || updateIntervalElapsed )
+      {
+        nodesToUpdate.push_back( nodeState.Node );
+      }
+    }
+    ++nodeStateIt;
+  }
+
+  for ( unsigned int i = 0; i < nodesToUpdate.size(); i++ )
+  {
+    if ( nodesToUpdate[ i ].GetPointer() != NULL )
+    {
+      this->UpdateOutputModel( nodesToUpdate[ i ] );
+    }
+  }
+
+  // the remaining deferred updates are processed when their update interval has elapsed
+  double nextUpdateTime = 0.0;
+  for ( nodeStateIt = this->Internal->NodeStates.begin(); nodeStateIt != this->Internal->NodeStates.end(); ++nodeStateIt )
+  {
+    vtkInternal::NodeState& nodeState = nodeStateIt->second;
+    if ( !nodeState.UpdatePending || nodeState.Node.GetPointer() == NULL || nodeState.Node->GetMaximumUpdateRate() <= 0.0 )
+    {
+      continue;
+    }
+    double updateTime = nodeState.LastUpdateTime + 1.0 / nodeState.Node->GetMaximumUpdateRate();
+    if ( nextUpdateTime <= 0.0 || updateTime < nextUpdateTime )
+    {
+      nextUpdateTime = updateTime;
     }
   }
+  if ( nextUpdateTime > 0.0 && !this->HasObserver( PendingUpdatesEvent ) )
+  {
+    this->Internal->ScheduleProcessing( this->GetApplicationLogic(), nextUpdateTime );
+  }
+}
 
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::WaitForPendingUpdates()
+{
+  // a deferred update that is performed now may queue a background job, which is published in the second round
+  for ( int round = 0; round < 2 && this->HasPendingUpdates(); round++ )
+  {
+    this->Internal->WaitForJobs();
+    this->ProcessPendingUpdates( true );
+  }
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelLogic::HasPendingUpdates()
+{
+  if ( this->Internal->HasActiveJobs() )
+  {
+    return true;
+  }
+  std::map< vtkMRMLMarkupsToModelNode*, vtkInternal::NodeState >::iterator nodeStateIt;
+  for ( nodeStateIt = this->Internal->NodeStates.begin(); nodeStateIt != this->Internal->NodeStates.end(); ++nodeStateIt )
+  {
+    if ( nodeStateIt->second.UpdatePending && nodeStateIt->second.Node.GetPointer() != NULL )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelGeometryCache* vtkSlicerMarkupsToModelLogic::GetGeometryCache()
+{
+  return this->Internal->GeometryCache;
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelUpdateStatistics* vtkSlicerMarkupsToModelLogic::GetUpdateStatistics( vtkMRMLMarkupsToModelNode* markupsToModelModuleNode )
+{
+  std::map< vtkMRMLMarkupsToModelNode*, vtkInternal::NodeState >::iterator nodeStateIt =
+    this->Internal->NodeStates.find( markupsToModelModuleNode );
+  if ( nodeStateIt == this->Internal->NodeStates.end() || nodeStateIt->second.Node.GetPointer() != markupsToModelModuleNode )
+  {
+    return NULL;
+  }
+  return nodeStateIt->second.UpdateStatistics;
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelScratchBuffers* vtkSlicerMarkupsToModelLogic::GetScratchBuffers( vtkMRMLMarkupsToModelNode* markupsToModelModuleNode )
+{
+  std::map< vtkMRMLMarkupsToModelNode*, vtkInternal::NodeState >::iterator nodeStateIt =
+    this->Internal->NodeStates.find( markupsToModelModuleNode );
+  if ( nodeStateIt == this->Internal->NodeStates.end() || nodeStateIt->second.Node.GetPointer() != markupsToModelModuleNode )
+  {
+    return NULL;
+  }
+  return nodeStateIt->second.ScratchBuffers;
+}
+
+//------------------------------------------------------------------------------
+double vtkSlicerMarkupsToModelLogic::GetOutputCurveLength( vtkMRMLMarkupsToModelNode* markupsToModelModuleNode )
+{
+  if ( markupsToModelModuleNode == NULL || markupsToModelModuleNode->GetOutputModelNode() == NULL )
+  {
+    return 0.0;
+  }
+  return vtkSlicerMarkupsToModelTubeGeneration::GetCurveLength( markupsToModelModuleNode->GetOutputModelNode()->GetPolyData() );
+}
+
+//------------------------------------------------------------------------------
+double vtkSlicerMarkupsToModelLogic::GetOutputSurfaceVolume( vtkMRMLMarkupsToModelNode* markupsToModelModuleNode )
+{
+  if ( markupsToModelModuleNode == NULL || markupsToModelModuleNode->GetOutputModelNode() == NULL )
+  {
+    return 0.0;
+  }
+  return vtkSlicerMarkupsToModelClosedSurfaceGeneration::GetSurfaceVolume( markupsToModelModuleNode->GetOutputModelNode()->GetPolyData() );
+}
+
+//------------------------------------------------------------------------------
+double vtkSlicerMarkupsToModelLogic::GetOutputSurfaceArea( vtkMRMLMarkupsToModelNode* markupsToModelModuleNode )
+{
+  if ( markupsToModelModuleNode == NULL || markupsToModelModuleNode->GetOutputModelNode() == NULL )
+  {
+    return 0.0;
+  }
+  return vtkSlicerMarkupsToModelClosedSurfaceGeneration::GetSurfaceArea( markupsToModelModuleNode->GetOutputModelNode()->GetPolyData() );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::AssignGeneratedPolyDataToOutput( vtkMRMLMarkupsToModelNode* markupsToModelModuleNode, vtkPolyData* outputPolyData,
+  vtkSlicerMarkupsToModelUpdateStatistics* statistics )
+{
+  double stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+  this->Internal->GetNodeState( markupsToModelModuleNode ).OutputAssignmentInProgress = true;
   vtkSlicerMarkupsToModelLogic::AssignPolyDataToOutput( markupsToModelModuleNode, outputPolyData );
+  // the output model node may have been created by the assignment, that does not require another update
+  vtkInternal::NodeState& nodeState = this->Internal->GetNodeState( markupsToModelModuleNode );
+  nodeState.OutputAssignmentInProgress = false;
+  if ( nodeState.OutputParametersValid && markupsToModelModuleNode->GetOutputModelNode() != NULL
+    && markupsToModelModuleNode->GetOutputModelNode()->GetID() != NULL )
+  {
+    nodeState.OutputModelNodeID = markupsToModelModuleNode->GetOutputModelNode()->GetID();
+  }
+  this->UpdateOutputModelTransform( markupsToModelModuleNode );
+  statistics->AddPolyDataStage( "output assignment", stageStartTime, outputPolyData );
+  this->SetUpdateStatistics( markupsToModelModuleNode, statistics );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::UpdateOutputModelTransform( vtkMRMLMarkupsToModelNode* markupsToModelModuleNode )
+{
+  if ( markupsToModelModuleNode == NULL )
+  {
+    return;
+  }
+  vtkInternal::NodeState& nodeState = this->Internal->GetNodeState( markupsToModelModuleNode );
+  vtkMRMLTransformableNode* inputNode = vtkMRMLTransformableNode::SafeDownCast( markupsToModelModuleNode->GetInputNode() );
+  vtkMRMLModelNode* outputModelNode = markupsToModelModuleNode->GetOutputModelNode();
+  std::string inputNodeID = ( inputNode != NULL && inputNode->GetID() != NULL ) ? inputNode->GetID() : "";
+  std::string outputModelNodeID = ( outputModelNode != NULL && outputModelNode->GetID() != NULL ) ? outputModelNode->GetID() : "";
+
+  // The model is generated from the untransformed input points, so under a non-linear transform the output would be
+  // warped as a whole (e.g., the cross-section of a tube would not stay circular) instead of following the transformed points.
+  // The output is only placed under linear transforms, the input transform has to be hardened to use a non-linear one.
+  bool nonlinearInputTransform = ( inputNode != NULL && inputNode->GetParentTransformNode() != NULL
+    && !inputNode->GetParentTransformNode()->IsTransformToWorldLinear() );
+  if ( nonlinearInputTransform && markupsToModelModuleNode->GetFollowInputTransform() && !nodeState.NonlinearInputTransformReported )
+  {
+    vtkWarningMacro( "The input of " << ( markupsToModelModuleNode->GetID() != NULL ? markupsToModelModuleNode->GetID() : "" )
+      << " is under a non-linear transform. The output model does not follow it, harden the transform of the input instead." );
+    nodeState.NonlinearInputTransformReported = true;
+  }
+  if ( !nonlinearInputTransform )
+  {
+    nodeState.NonlinearInputTransformReported = false;
+  }
+  bool followInputTransform = ( markupsToModelModuleNode->GetFollowInputTransform() && inputNode != NULL && outputModelNode != NULL
+    && !inputNodeID.empty() && !outputModelNodeID.empty() && !nonlinearInputTransform );
+
+  // give back the transform that the output model had before following started, when the option is disabled,
+  // or the input or output node is changed
+  if ( nodeState.FollowingInputTransform && ( !followInputTransform
+    || nodeState.FollowedInputNodeID != inputNodeID || nodeState.FollowedOutputModelNodeID != outputModelNodeID ) )
+  {
+    nodeState.FollowingInputTransform = false;
+    vtkMRMLModelNode* followedOutputModelNode = ( this->GetMRMLScene() != NULL ) ?
+      vtkMRMLModelNode::SafeDownCast( this->GetMRMLScene()->GetNodeByID( nodeState.FollowedOutputModelNodeID ) ) : NULL;
+    if ( followedOutputModelNode != NULL )
+    {
+      // the previous transform may have been deleted meanwhile, in this case the transform is cleared
+      const char* previousTransformNodeID = NULL;
+      if ( !nodeState.OutputTransformNodeIDBeforeFollowing.empty()
+        && this->GetMRMLScene()->GetNodeByID( nodeState.OutputTransformNodeIDBeforeFollowing ) != NULL )
+      {
+        previousTransformNodeID = nodeState.OutputTransformNodeIDBeforeFollowing.c_str();
+      }
+      followedOutputModelNode->SetAndObserveTransformNodeID( previousTransformNodeID );
+    }
+  }
+  if ( !followInputTransform )
+  {
+    return;
+  }
+
+  if ( !nodeState.FollowingInputTransform )
+  {
+    nodeState.FollowingInputTransform = true;
+    nodeState.FollowedInputNodeID = inputNodeID;
+    nodeState.FollowedOutputModelNodeID = outputModelNodeID;
+    nodeState.OutputTransformNodeIDBeforeFollowing = ( outputModelNode->GetTransformNodeID() != NULL ) ? outputModelNode->GetTransformNodeID() : "";
+  }
+
+  // the output model observes the same transform node as the input, so changes of the matrix
+  // are applied to the output by the transform node itself
+  std::string inputTransformNodeID = ( inputNode->GetTransformNodeID() != NULL ) ? inputNode->GetTransformNodeID() : "";
+  std::string outputTransformNodeID = ( outputModelNode->GetTransformNodeID() != NULL ) ? outputModelNode->GetTransformNodeID() : "";
+  if ( inputTransformNodeID == outputTransformNodeID )
+  {
+    return;
+  }
+  outputModelNode->SetAndObserveTransformNodeID( inputNode->GetTransformNodeID() );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::SetUpdateStatistics( vtkMRMLMarkupsToModelNode* markupsToModelModuleNode, vtkSlicerMarkupsToModelUpdateStatistics* statistics )
+{
+  this->Internal->GetNodeState( markupsToModelModuleNode ).UpdateStatistics = statistics;
+  vtkDebugMacro( "Output model update of " << ( markupsToModelModuleNode->GetName() ? markupsToModelModuleNode->GetName() : "(unnamed)" )
+    << " took " << statistics->GetTotalDuration() << " s:" << std::endl << statistics->GetStagesAsString() );
+  if ( this->UpdateStatisticsEventEnabled )
+  {
+    this->InvokeEvent( UpdateStatisticsEvent, markupsToModelModuleNode );
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -296,10 +1520,16 @@ void vtkSlicerMarkupsToModelLogic::ProcessMRMLNodesEvents(vtkObject* caller, uns
   }
 
   vtkMRMLMarkupsToModelNode* markupsToModelModuleNode = vtkMRMLMarkupsToModelNode::SafeDownCast(callerNode);
-  if (markupsToModelModuleNode == NULL || !markupsToModelModuleNode->GetAutoUpdateOutput())
+  if (markupsToModelModuleNode == NULL)
   {
     return;
   }
+  if (!markupsToModelModuleNode->GetAutoUpdateOutput())
+  {
+    // the input may change without the output being updated, so the output has to be updated when auto-update is enabled
+    this->Internal->GetNodeState(markupsToModelModuleNode).OutputParametersValid = false;
+    return;
+  }
 
   if (this->GetMRMLScene() &&
     (this->GetMRMLScene()->IsImporting() ||
@@ -309,10 +1539,39 @@ void vtkSlicerMarkupsToModelLogic::ProcessMRMLNodesEvents(vtkObject* caller, uns
     return;
   }
 
-  if (event == vtkMRMLMarkupsToModelNode::MarkupsPositionModifiedEvent
-    || event == vtkCommand::ModifiedEvent)
+  if (event == vtkMRMLMarkupsToModelNode::MarkupsPositionModifiedEvent)
+  {
+    this->RequestOutputModelUpdate(markupsToModelModuleNode);
+  }
+  else if (event == vtkMRMLMarkupsToModelNode::InputTransformModifiedEvent)
   {
-    this->UpdateOutputModel(markupsToModelModuleNode);
+    // the geometry of the output does not depend on the transform of the input, only the output transform is updated
+    this->UpdateOutputModelTransform(markupsToModelModuleNode);
+  }
+  else if (event == vtkCommand::ModifiedEvent)
+  {
+    // FollowInputTransform does not affect the geometry of the output
+    this->UpdateOutputModelTransform(markupsToModelModuleNode);
+    // ignore changes of parameters that the output model does not depend on
+    // (update scheduling, parameters of other model or interpolation types, etc.)
+    vtkInternal::NodeState& nodeState = this->Internal->GetNodeState(markupsToModelModuleNode);
+    if (!nodeState.OutputAssignmentInProgress && vtkInternal::IsOutputParametersModified(nodeState, markupsToModelModuleNode))
+    {
+      this->RequestOutputModelUpdate(markupsToModelModuleNode);
+    }
+  }
+  else if (event == vtkMRMLMarkupsToModelNode::InputInteractionEndedEvent)
+  {
+    if (markupsToModelModuleNode->GetFinalUpdateOnInteractionEnd())
+    {
+      // show the final state right away, without waiting for the update interval
+      this->UpdateOutputModel(markupsToModelModuleNode);
+    }
+    else if (markupsToModelModuleNode->GetInteractionQualityLevel() != markupsToModelModuleNode->GetQualityLevel())
+    {
+      // refine the model that was generated during interaction
+      this->RequestOutputModelUpdate(markupsToModelModuleNode);
+    }
   }
 }
 
@@ -374,7 +1633,8 @@ bool vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel( vtkMRMLMarkupsFiducia
 bool vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel( vtkPoints* controlPoints, vtkPolyData* outputPolyData,
   int interpolationType, bool tubeLoop, double tubeRadius, int tubeNumberOfSides, int tubeSegmentsBetweenControlPoints,
   bool cleanMarkups, int polynomialOrder, int pointParameterType,
-  bool kochanekEndsCopyNearestDerivatives, double kochanekBias, double kochanekContinuity, double kochanekTension )
+  bool kochanekEndsCopyNearestDerivatives, double kochanekBias, double kochanekContinuity, double kochanekTension,
+  double tubeSamplingTolerance, vtkSlicerMarkupsToModelUpdateStatistics* statistics, vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers )
 {
   if ( controlPoints == NULL )
   {
@@ -389,9 +1649,16 @@ bool vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel( vtkPoints* controlPoi
   }
 
   // get rid of duplicate points
+  double stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
   if ( cleanMarkups )
   {
-    vtkSlicerMarkupsToModelLogic::RemoveDuplicatePoints( controlPoints );
+    vtkSlicerMarkupsToModelPointProcessing::RemoveDuplicatePoints( controlPoints, vtkSlicerMarkupsToModelPointProcessing::DUPLICATE_POINT_TOLERANCE_DEFAULT,
+      NULL, scratchBuffers );
+    if ( statistics != NULL )
+    {
+      statistics->AddPointsStage( "deduplication", stageStartTime, controlPoints );
+      stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+    }
   }
 
   // check a few special cases before handling the different types of curve
@@ -404,12 +1671,20 @@ bool vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel( vtkPoints* controlPoi
   if ( controlPoints->GetNumberOfPoints() == 1 )
   {
     vtkSlicerMarkupsToModelCurveGeneration::GenerateSphereModel( controlPoints->GetPoint( 0 ), outputPolyData, tubeRadius, tubeNumberOfSides );
+    if ( statistics != NULL )
+    {
+      statistics->AddPolyDataStage( "curve generation", stageStartTime, outputPolyData );
+    }
     return true;
   }
   
   if ( controlPoints->GetNumberOfPoints() == 2 )
   {
-    vtkSlicerMarkupsToModelCurveGeneration::GeneratePiecewiseLinearCurveModel( controlPoints, outputPolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop );
+    vtkSlicerMarkupsToModelCurveGeneration::GeneratePiecewiseLinearCurveModel( controlPoints, outputPolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop, tubeSamplingTolerance, scratchBuffers );
+    if ( statistics != NULL )
+    {
+      statistics->AddPolyDataStage( "curve generation", stageStartTime, outputPolyData );
+    }
     return true;
   }
 
@@ -418,22 +1693,30 @@ bool vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel( vtkPoints* controlPoi
     // Generates a polynomial curve model.
     case vtkMRMLMarkupsToModelNode::Linear:
     {
-      vtkSlicerMarkupsToModelCurveGeneration::GeneratePiecewiseLinearCurveModel( controlPoints, outputPolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop );
+      vtkSlicerMarkupsToModelCurveGeneration::GeneratePiecewiseLinearCurveModel( controlPoints, outputPolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop, tubeSamplingTolerance, scratchBuffers );
       break;
     }
     case vtkMRMLMarkupsToModelNode::CardinalSpline:
     {
-      vtkSlicerMarkupsToModelCurveGeneration::GenerateCardinalSplineCurveModel( controlPoints, outputPolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop );
+      vtkSlicerMarkupsToModelCurveGeneration::GenerateCardinalSplineCurveModel( controlPoints, outputPolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop, tubeSamplingTolerance, scratchBuffers );
       break;
     }
     case vtkMRMLMarkupsToModelNode::KochanekSpline:
     {
-      vtkSlicerMarkupsToModelCurveGeneration::GenerateKochanekSplineCurveModel( controlPoints, outputPolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop, kochanekBias, kochanekContinuity, kochanekTension, kochanekEndsCopyNearestDerivatives );
+      vtkSlicerMarkupsToModelCurveGeneration::GenerateKochanekSplineCurveModel( controlPoints, outputPolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop, kochanekBias, kochanekContinuity, kochanekTension, kochanekEndsCopyNearestDerivatives, tubeSamplingTolerance, scratchBuffers );
       break;
     }
     case vtkMRMLMarkupsToModelNode::Polynomial:
     {
-      vtkSmartPointer< vtkDoubleArray > controlPointParameters = vtkSmartPointer< vtkDoubleArray >::New();
+      vtkSmartPointer< vtkDoubleArray > controlPointParameters;
+      if ( scratchBuffers != NULL )
+      {
+        controlPointParameters = scratchBuffers->GetDoubleArray();
+      }
+      else
+      {
+        controlPointParameters = vtkSmartPointer< vtkDoubleArray >::New();
+      }
       switch ( pointParameterType )
       {
         case vtkMRMLMarkupsToModelNode::RawIndices:
@@ -443,7 +1726,12 @@ bool vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel( vtkPoints* controlPoi
         }
         case vtkMRMLMarkupsToModelNode::MinimumSpanningTree:
         {
-          vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSpanningTree( controlPoints, controlPointParameters );
+          vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSpanningTree( controlPoints, controlPointParameters, scratchBuffers );
+          break;
+        }
+        case vtkMRMLMarkupsToModelNode::MinimumSpanningTreeDense:
+        {
+          vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromDenseMinimumSpanningTree( controlPoints, controlPointParameters, scratchBuffers );
           break;
         }
         default:
@@ -452,7 +1740,12 @@ bool vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel( vtkPoints* controlPoi
           return false;
         }
       }
-      vtkSlicerMarkupsToModelCurveGeneration::GeneratePolynomialCurveModel( controlPoints, outputPolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop, polynomialOrder, controlPointParameters );
+      if ( statistics != NULL )
+      {
+        statistics->AddStage( "parameterization", stageStartTime, controlPointParameters->GetNumberOfTuples(), 0, controlPointParameters->GetActualMemorySize() );
+        stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+      }
+      vtkSlicerMarkupsToModelCurveGeneration::GeneratePolynomialCurveModel( controlPoints, outputPolyData, tubeRadius, tubeNumberOfSides, tubeSegmentsBetweenControlPoints, tubeLoop, polynomialOrder, controlPointParameters, tubeSamplingTolerance, scratchBuffers );
       break;
     }
     default:
@@ -461,6 +1754,10 @@ bool vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel( vtkPoints* controlPoi
       return false;
     }
   }
+  if ( statistics != NULL )
+  {
+    statistics->AddPolyDataStage( "curve generation", stageStartTime, outputPolyData );
+  }
   return true;
 }
 
@@ -497,7 +1794,8 @@ bool vtkSlicerMarkupsToModelLogic::UpdateClosedSurfaceModel(
 //------------------------------------------------------------------------------
 bool vtkSlicerMarkupsToModelLogic::UpdateClosedSurfaceModel(
   vtkPoints* controlPoints, vtkPolyData* outputPolyData,
-  bool smoothing, bool forceConvex, double delaunayAlpha, bool cleanMarkups )
+  bool smoothing, bool forceConvex, double delaunayAlpha, bool cleanMarkups,
+  vtkSlicerMarkupsToModelUpdateStatistics* statistics )
 {
   if ( controlPoints == NULL )
   {
@@ -512,12 +1810,18 @@ bool vtkSlicerMarkupsToModelLogic::UpdateClosedSurfaceModel(
   }
 
   // get rid of duplicate points
+  double stageStartTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
   if ( cleanMarkups )
   {
     vtkSlicerMarkupsToModelLogic::RemoveDuplicatePoints( controlPoints );
+    if ( statistics != NULL )
+    {
+      statistics->AddPointsStage( "deduplication", stageStartTime, controlPoints );
+    }
   }
 
-  vtkSlicerMarkupsToModelClosedSurfaceGeneration::GenerateClosedSurfaceModel( controlPoints, outputPolyData, delaunayAlpha, smoothing, forceConvex );
+  vtkSlicerMarkupsToModelClosedSurfaceGeneration::GenerateClosedSurfaceModel( controlPoints, outputPolyData, delaunayAlpha, smoothing, forceConvex,
+    vtkMRMLMarkupsToModelNode::DelaunaySurface, statistics );
   return true;
 }
 
@@ -577,15 +1881,13 @@ void vtkSlicerMarkupsToModelLogic::MarkupsToPoints( vtkMRMLMarkupsFiducialNode*
 //------------------------------------------------------------------------------
 void vtkSlicerMarkupsToModelLogic::RemoveDuplicatePoints( vtkPoints* points )
 {
-  vtkSmartPointer< vtkPolyData > polyData = vtkSmartPointer< vtkPolyData >::New();
-  polyData->Initialize();
-  polyData->SetPoints( points );
+  vtkSlicerMarkupsToModelLogic::RemoveDuplicatePoints( points, vtkSlicerMarkupsToModelPointProcessing::DUPLICATE_POINT_TOLERANCE_DEFAULT );
+}
 
-  vtkSmartPointer< vtkCleanPolyData > cleanPointPolyData = vtkSmartPointer< vtkCleanPolyData >::New();
-  cleanPointPolyData->SetInputData( polyData );
-  const double CLEAN_POLYDATA_TOLERANCE_MM = 0.01;
-  cleanPointPolyData->SetTolerance( CLEAN_POLYDATA_TOLERANCE_MM );
-  cleanPointPolyData->Update();
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelLogic::RemoveDuplicatePoints( vtkPoints* points, double tolerance )
+{
+  vtkSlicerMarkupsToModelPointProcessing::RemoveDuplicatePoints( points, tolerance );
 }
 
 //------------------------------------------------------------------------------
@@ -43,10 +43,15 @@ limitations under the License.
 
 #include "vtkSlicerMarkupsToModelModuleLogicExport.h"
 
+class vtkCollection;
 class vtkMRMLMarkupsFiducialNode;
 class vtkMRMLMarkupsToModelNode;
 class vtkMRMLModelNode;
 class vtkPolyData;
+class vtkSlicerMarkupsToModelClosedSurfaceGeneration;
+class vtkSlicerMarkupsToModelGeometryCache;
+class vtkSlicerMarkupsToModelScratchBuffers;
+class vtkSlicerMarkupsToModelUpdateStatistics;
 
 /// \ingroup Slicer_QtModules_ExtensionTemplate
 class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelLogic :
@@ -57,6 +62,24 @@ public:
   vtkTypeMacro(vtkSlicerMarkupsToModelLogic, vtkSlicerModuleLogic);
   void PrintSelf(ostream& os, vtkIndent indent);
   vtkSlicerMarkupsLogic* MarkupsLogic;  
+
+  enum Events
+  {
+    /// UpdateStatisticsEvent is invoked after the output model of a parameter node is updated,
+    /// if UpdateStatisticsEventEnabled is set. The parameter node is passed as call data.
+    // vtkCommand::UserEvent + 778 is just a random value that is very unlikely to be used for anything else in this class
+    UpdateStatisticsEvent = vtkCommand::UserEvent + 778,
+    /// PendingUpdatesEvent is invoked when an output model update of a node is deferred (see RequestOutputModelUpdate).
+    /// If this event is observed then the observer is responsible for calling ProcessPendingUpdates
+    /// (the module does it from a timer that runs only while HasPendingUpdates returns true).
+    /// Otherwise the logic schedules the deferred updates itself, on the main thread of the application.
+    PendingUpdatesEvent
+  };
+
+  // Enable invoking UpdateStatisticsEvent after each update of an output model. Disabled by default.
+  vtkGetMacro( UpdateStatisticsEventEnabled, bool );
+  vtkSetMacro( UpdateStatisticsEventEnabled, bool );
+  vtkBooleanMacro( UpdateStatisticsEventEnabled, bool );
   void ProcessMRMLNodesEvents( vtkObject* caller, unsigned long event, void* callData );
 
   // Updates the mouse selection type to create markups or to navigate the scene.
@@ -64,13 +87,84 @@ public:
 
   // Updates closed surface or curve output model from markups
   void UpdateOutputModel( vtkMRMLMarkupsToModelNode* moduleNode );
+
+  // Updates the output models of all the vtkMRMLMarkupsToModelNode objects in the collection.
+  // The models are generated concurrently, then all outputs are assigned in a single batch process
+  // of the scene, so that observers of the scene are notified only once.
+  // If combinedOutputModelNode is specified then the output models of the nodes are not modified, instead all
+  // generated models are combined into the poly data of combinedOutputModelNode, in the order of the collection.
+  // Many curves (such as electrodes or needle tracks) can then be rendered in a single draw call.
+  void UpdateOutputModels( vtkCollection* moduleNodes, vtkMRMLModelNode* combinedOutputModelNode = NULL );
+
+  // Request an update of the output model. If the node has a maximum update rate then the update
+  // is deferred until the minimum time since the last update has elapsed, so that bursts of changes are merged into
+  // a single update. The deferred update is performed by ProcessPendingUpdates, which is called by the observer of
+  // PendingUpdatesEvent or, if there is none, requested by the logic through the application logic.
+  // If neither is available (the logic is used without the application) or the node has no maximum update rate
+  // then the output model is updated immediately.
+  void RequestOutputModelUpdate( vtkMRMLMarkupsToModelNode* moduleNode );
+
+  // If FollowInputTransform is enabled in the node then place the output model under the parent transform
+  // of the input node. Only the transform reference of the output model is changed, the model is not regenerated.
+  // The transform that the output model had before is restored when FollowInputTransform is disabled or the input
+  // or output node is changed. Non-linear input transforms are not followed.
+  void UpdateOutputModelTransform( vtkMRMLMarkupsToModelNode* moduleNode );
+
+  // Perform the deferred updates for which the minimum time since the last update has elapsed
+  // and publish the results of background (asynchronous) generation to the output model nodes.
+  // If force is true then all deferred updates are performed, regardless of the update rate.
+  // It does not have to be called by the user, unless PendingUpdatesEvent is observed.
+  void ProcessPendingUpdates( bool force = false );
+
+  // Returns true if there are deferred updates or background generation results that have not been published yet
+  bool HasPendingUpdates();
+
+  // Wait until the background generation of all nodes is completed, then publish the results and perform
+  // all deferred updates. Scripts can call it to make sure that the output models are up to date.
+  void WaitForPendingUpdates();
+
+  // Get the time and output size of each stage of the most recent output model update of the node.
+  // Returns NULL if the output model of the node has not been updated yet.
+  // The returned object is replaced by a new one at the next update, it must not be modified.
+  vtkSlicerMarkupsToModelUpdateStatistics* GetUpdateStatistics( vtkMRMLMarkupsToModelNode* moduleNode );
+
+  // Get the memory that the synchronous updates of the node use for their temporary arrays and objects.
+  // It is kept between updates, so its size and the number of allocations show whether updates still allocate memory.
+  // Returns NULL if the node has not been updated yet.
+  vtkSlicerMarkupsToModelScratchBuffers* GetScratchBuffers( vtkMRMLMarkupsToModelNode* moduleNode );
+
+  // Get the length of the curve, and the volume and the area of the closed surface of the current output model of the node,
+  // in the coordinate system of the model. They are computed together with the model and stored in its field data,
+  // so getting them does not process the model. Returns 0 if the output model does not contain the value
+  // (for example, the volume of a curve model) or the node has no output model.
+  double GetOutputCurveLength( vtkMRMLMarkupsToModelNode* moduleNode );
+  double GetOutputSurfaceVolume( vtkMRMLMarkupsToModelNode* moduleNode );
+  double GetOutputSurfaceArea( vtkMRMLMarkupsToModelNode* moduleNode );
+
+  // Previously generated output models. If the control points and the parameters of a node are the same
+  // as in a previous update then the stored model is used instead of generating it again.
+  // The memory budget, the hit rate and the memory size can be accessed through the returned object.
+  vtkSlicerMarkupsToModelGeometryCache* GetGeometryCache();
+
+  // Generates the output poly data from the control points, using the parameters of the markupsToModelModuleNode.
+  // Only the parameters of the node are used, therefore it is safe to call it from any thread
+  // with a copy of the parameter node.
+  // If statistics is specified then the time and output size of each stage are recorded in it.
+  // If closedSurfaceGenerator is specified then closed surfaces are generated with its persistent pipeline,
+  // which only executes the filters affected by the changes since its previous update.
+  // A generator must not be used by multiple threads at the same time.
+  // If scratchBuffers is specified then the temporary arrays are allocated from it, with the same restriction.
+  static bool GenerateOutputPolyData( vtkPoints* controlPoints, vtkMRMLMarkupsToModelNode* markupsToModelModuleNode, vtkPolyData* outputPolyData,
+    vtkSlicerMarkupsToModelUpdateStatistics* statistics = NULL, vtkSlicerMarkupsToModelClosedSurfaceGeneration* closedSurfaceGenerator = NULL,
+    vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers = NULL );
   
   // lower-level access to functionality for making a closed surface model
   static bool UpdateClosedSurfaceModel( vtkMRMLMarkupsFiducialNode* markupsNode, vtkMRMLModelNode* modelNode,
       bool smoothing = true, bool forceConvex = false, double delaunayAlpha = 0.0, bool cleanMarkups = true );
 
   static bool UpdateClosedSurfaceModel( vtkPoints* controlPoints, vtkPolyData* polyData,
-    bool smoothing = true, bool forceConvex = false, double delaunayAlpha = 0.0, bool cleanMarkups = true );
+    bool smoothing = true, bool forceConvex = false, double delaunayAlpha = 0.0, bool cleanMarkups = true,
+    vtkSlicerMarkupsToModelUpdateStatistics* statistics = NULL );
 
   // Lower-level access to functionality for making a curve model.
   // If tubeRadius<=0.0 then a line will be created instead of a tube.
@@ -84,7 +178,8 @@ public:
       bool tubeLoop = false, double tubeRadius = 1.0, int tubeNumberOfSides = 8, int tubeSegmentsBetweenControlPoints = 5,
       bool cleanMarkups = true, int polynomialOrder = 3, int pointParameterType = vtkMRMLMarkupsToModelNode::RawIndices,
       bool kochanekEndsCopyNearestDerivative = false, double kochanekBias = 0.0,
-      double kochanekContinuity = 0.0, double kochanekTension = 0.0 );
+      double kochanekContinuity = 0.0, double kochanekTension = 0.0, double tubeSamplingTolerance = 0.0,
+      vtkSlicerMarkupsToModelUpdateStatistics* statistics = NULL, vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers = NULL );
 
   // Get the points store in a vtkMRMLMarkupsFiducialNode
   static void MarkupsToPoints( vtkMRMLMarkupsFiducialNode* markupsNode, vtkPoints* outputPoints );
@@ -92,8 +187,11 @@ public:
   // Get the points store in a vtkMRMLModelNode
   static void ModelToPoints( vtkMRMLModelNode* modelNode, vtkPoints* outputPoints );
 
-  // Remove duplicate points from a vtkPoints object
+  // Remove duplicate points from a vtkPoints object, keeping the order of the remaining points.
+  // Points closer than tolerance (in mm) to a preceding point are removed.
+  // See vtkSlicerMarkupsToModelPointProcessing::RemoveDuplicatePoints for getting the index mapping.
   static void RemoveDuplicatePoints( vtkPoints* points );
+  static void RemoveDuplicatePoints( vtkPoints* points, double tolerance );
 
   // DEPRECATED - Sets the input node to be processed
   void SetMarkupsNode( vtkMRMLMarkupsFiducialNode* newMarkups, vtkMRMLMarkupsToModelNode* moduleNode );
@@ -112,11 +210,31 @@ protected:
   virtual void OnMRMLSceneNodeAdded(vtkMRMLNode* node);
   virtual void OnMRMLSceneNodeRemoved(vtkMRMLNode* node);
 
+  bool UpdateStatisticsEventEnabled;
+
 private:
   vtkSlicerMarkupsToModelLogic(const vtkSlicerMarkupsToModelLogic&); // Not implemented
   void operator=(const vtkSlicerMarkupsToModelLogic&); // Not implemented
 
   static void AssignPolyDataToOutput( vtkMRMLMarkupsToModelNode* moduleNode, vtkPolyData* polyData );
+
+  // Assign the generated poly data to the output model and store the statistics of the completed update
+  void AssignGeneratedPolyDataToOutput( vtkMRMLMarkupsToModelNode* moduleNode, vtkPolyData* polyData,
+    vtkSlicerMarkupsToModelUpdateStatistics* statistics );
+
+  // Store the statistics of a completed update and notify observers
+  void SetUpdateStatistics( vtkMRMLMarkupsToModelNode* moduleNode, vtkSlicerMarkupsToModelUpdateStatistics* statistics );
+
+  // Make sure that the deferred updates are processed: notify the observers of PendingUpdatesEvent or,
+  // if there are none, request processing at processingTime (universal time, in seconds) through the application logic.
+  // Returns false if there is nothing that would process the updates.
+  bool SchedulePendingUpdates( double processingTime );
+
+  // Called on the main thread when the processing requested by SchedulePendingUpdates is due
+  static void OnProcessingRequested( vtkObject* caller, unsigned long eid, void* clientData, void* callData );
+
+  class vtkInternal;
+  vtkInternal* Internal;
 };
 
 #endif
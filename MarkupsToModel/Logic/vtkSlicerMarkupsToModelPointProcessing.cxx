@@ -0,0 +1,366 @@
+#include "vtkSlicerMarkupsToModelPointProcessing.h"
+#include "vtkSlicerMarkupsToModelScratchBuffers.h"
+
+// vtk includes
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+
+// std includes
+#include <algorithm>
+#include <cmath>
+
+//------------------------------------------------------------------------------
+// constant default values defined here due to VS2013 compile issue C2864
+const double vtkSlicerMarkupsToModelPointProcessing::DUPLICATE_POINT_TOLERANCE_DEFAULT = 0.01;
+
+//------------------------------------------------------------------------------
+// constants within this file
+// grid cell size if only exactly coincident points are merged (any value works, it only affects speed)
+static const double EXACT_DUPLICATE_GRID_CELL_SIZE = 1.0;
+// the voxel size search stops if the number of decimated points is between this fraction of the target and the target
+static const double DECIMATION_ACCEPTED_FRACTION_OF_TARGET = 0.8;
+static const int DECIMATION_MAXIMUM_NUMBER_OF_VOXEL_SIZE_ITERATIONS = 5;
+// flat extents are replaced by this fraction of the bounding box diagonal when the initial voxel size is estimated
+static const double DECIMATION_MINIMUM_RELATIVE_EXTENT = 0.01;
+
+//------------------------------------------------------------------------------
+// Hash of integer grid cell coordinates, see Teschner et al., "Optimized Spatial Hashing for Collision Detection of Deformable Objects"
+static unsigned long GetGridCellHash( long cellX, long cellY, long cellZ, unsigned long numberOfBuckets )
+{
+  unsigned long hash = ( static_cast< unsigned long >( cellX ) * 73856093UL )
+    ^ ( static_cast< unsigned long >( cellY ) * 19349663UL )
+    ^ ( static_cast< unsigned long >( cellZ ) * 83492791UL );
+  return hash % numberOfBuckets;
+}
+
+//------------------------------------------------------------------------------
+// Occupied cell of a uniform grid, with the sum of the points in it
+struct DecimationGridCell
+{
+  long Coordinates[ 3 ];
+  double PointSum[ 3 ];
+  int NumberOfPoints;
+};
+
+//------------------------------------------------------------------------------
+// Bin the points in a uniform grid with the specified cell size. The occupied cells are stored in the order of their first point,
+// outputCells must have space for one cell for each point. Returns the number of occupied cells.
+static int BinPointsInGrid( vtkPoints* points, double cellSize, DecimationGridCell* outputCells,
+  vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers )
+{
+  vtkSlicerMarkupsToModelScratchBuffers::Scope scratchScope( scratchBuffers );
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  const unsigned long numberOfBuckets = 2 * static_cast< unsigned long >( numberOfPoints ) + 1;
+  // each bucket is a list of the occupied cells that were hashed into it
+  int* bucketFirstCells = scratchBuffers->Allocate< int >( numberOfBuckets );
+  std::fill( bucketFirstCells, bucketFirstCells + numberOfBuckets, -1 );
+  int* nextBucketCells = scratchBuffers->Allocate< int >( numberOfPoints );
+  int numberOfCells = 0;
+  for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+  {
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    points->GetPoint( pointIndex, point );
+    long coordinates[ 3 ] = { 0, 0, 0 };
+    for ( int i = 0; i < 3; i++ )
+    {
+      coordinates[ i ] = static_cast< long >( floor( point[ i ] / cellSize ) );
+    }
+
+    unsigned long bucketIndex = GetGridCellHash( coordinates[ 0 ], coordinates[ 1 ], coordinates[ 2 ], numberOfBuckets );
+    int cellIndex = bucketFirstCells[ bucketIndex ];
+    while ( cellIndex >= 0 )
+    {
+      const long* bucketCellCoordinates = outputCells[ cellIndex ].Coordinates;
+      if ( bucketCellCoordinates[ 0 ] == coordinates[ 0 ] && bucketCellCoordinates[ 1 ] == coordinates[ 1 ] && bucketCellCoordinates[ 2 ] == coordinates[ 2 ] )
+      {
+        break;
+      }
+      cellIndex = nextBucketCells[ cellIndex ];
+    }
+    if ( cellIndex < 0 )
+    {
+      cellIndex = numberOfCells++;
+      DecimationGridCell& cell = outputCells[ cellIndex ];
+      for ( int i = 0; i < 3; i++ )
+      {
+        cell.Coordinates[ i ] = coordinates[ i ];
+        cell.PointSum[ i ] = 0.0;
+      }
+      cell.NumberOfPoints = 0;
+      nextBucketCells[ cellIndex ] = bucketFirstCells[ bucketIndex ];
+      bucketFirstCells[ bucketIndex ] = cellIndex;
+    }
+
+    DecimationGridCell& cell = outputCells[ cellIndex ];
+    for ( int i = 0; i < 3; i++ )
+    {
+      cell.PointSum[ i ] += point[ i ];
+    }
+    cell.NumberOfPoints++;
+  }
+  return numberOfCells;
+}
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro( vtkSlicerMarkupsToModelPointProcessing );
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelPointProcessing::vtkSlicerMarkupsToModelPointProcessing()
+{
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelPointProcessing::~vtkSlicerMarkupsToModelPointProcessing()
+{
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelPointProcessing::RemoveDuplicatePoints( vtkPoints* points, double tolerance, vtkIdList* outputOriginalToUniqueIndices,
+  vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers )
+{
+  if ( points == NULL )
+  {
+    vtkGenericWarningMacro( "Input points are null. No operation performed." );
+    return 0;
+  }
+
+  if ( tolerance < 0.0 )
+  {
+    vtkGenericWarningMacro( "Duplicate point tolerance " << tolerance << " is negative. Using 0 instead." );
+    tolerance = 0.0;
+  }
+
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  if ( outputOriginalToUniqueIndices != NULL )
+  {
+    outputOriginalToUniqueIndices->SetNumberOfIds( numberOfPoints );
+  }
+  if ( numberOfPoints == 0 )
+  {
+    return 0;
+  }
+
+  vtkSmartPointer< vtkSlicerMarkupsToModelScratchBuffers > temporaryScratchBuffers;
+  if ( scratchBuffers == NULL )
+  {
+    temporaryScratchBuffers = vtkSmartPointer< vtkSlicerMarkupsToModelScratchBuffers >::New();
+    scratchBuffers = temporaryScratchBuffers;
+  }
+  vtkSlicerMarkupsToModelScratchBuffers::Scope scratchScope( scratchBuffers );
+
+  // Points closer than the tolerance are in the same or in a neighboring grid cell.
+  // Each bucket is a list of the (output) indices of the unique points that were hashed into it, in the order of insertion.
+  const double cellSize = ( tolerance > 0.0 ? tolerance : EXACT_DUPLICATE_GRID_CELL_SIZE );
+  const double toleranceSquared = tolerance * tolerance;
+  const unsigned long numberOfBuckets = 2 * static_cast< unsigned long >( numberOfPoints ) + 1;
+  vtkIdType* bucketFirstPoints = scratchBuffers->Allocate< vtkIdType >( numberOfBuckets );
+  vtkIdType* bucketLastPoints = scratchBuffers->Allocate< vtkIdType >( numberOfBuckets );
+  std::fill( bucketFirstPoints, bucketFirstPoints + numberOfBuckets, -1 );
+  vtkIdType* nextBucketPoints = scratchBuffers->Allocate< vtkIdType >( numberOfPoints );
+
+  vtkIdType numberOfUniquePoints = 0;
+  for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+  {
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    points->GetPoint( pointIndex, point );
+    long cell[ 3 ] = { 0, 0, 0 };
+    for ( int i = 0; i < 3; i++ )
+    {
+      cell[ i ] = static_cast< long >( floor( point[ i ] / cellSize ) );
+    }
+
+    // look for a matching unique point in the neighboring cells
+    vtkIdType matchingUniqueIndex = -1;
+    for ( long dx = -1; dx <= 1 && matchingUniqueIndex < 0; dx++ )
+    {
+      for ( long dy = -1; dy <= 1 && matchingUniqueIndex < 0; dy++ )
+      {
+        for ( long dz = -1; dz <= 1 && matchingUniqueIndex < 0; dz++ )
+        {
+          unsigned long bucketIndex = GetGridCellHash( cell[ 0 ] + dx, cell[ 1 ] + dy, cell[ 2 ] + dz, numberOfBuckets );
+          for ( vtkIdType uniqueIndex = bucketFirstPoints[ bucketIndex ]; uniqueIndex >= 0; uniqueIndex = nextBucketPoints[ uniqueIndex ] )
+          {
+            // unique points are already moved to their output position, in front of the current point
+            if ( vtkMath::Distance2BetweenPoints( point, points->GetPoint( uniqueIndex ) ) <= toleranceSquared )
+            {
+              matchingUniqueIndex = uniqueIndex;
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    if ( matchingUniqueIndex < 0 )
+    {
+      // compact the points in place, this keeps the original order
+      matchingUniqueIndex = numberOfUniquePoints;
+      if ( matchingUniqueIndex != pointIndex )
+      {
+        points->SetPoint( matchingUniqueIndex, point );
+      }
+      unsigned long bucketIndex = GetGridCellHash( cell[ 0 ], cell[ 1 ], cell[ 2 ], numberOfBuckets );
+      nextBucketPoints[ matchingUniqueIndex ] = -1;
+      if ( bucketFirstPoints[ bucketIndex ] < 0 )
+      {
+        bucketFirstPoints[ bucketIndex ] = matchingUniqueIndex;
+      }
+      else
+      {
+        nextBucketPoints[ bucketLastPoints[ bucketIndex ] ] = matchingUniqueIndex;
+      }
+      bucketLastPoints[ bucketIndex ] = matchingUniqueIndex;
+      numberOfUniquePoints++;
+    }
+
+    if ( outputOriginalToUniqueIndices != NULL )
+    {
+      outputOriginalToUniqueIndices->SetId( pointIndex, matchingUniqueIndex );
+    }
+  }
+
+  int numberOfRemovedPoints = static_cast< int >( numberOfPoints - numberOfUniquePoints );
+  if ( numberOfRemovedPoints > 0 )
+  {
+    points->SetNumberOfPoints( numberOfUniquePoints );
+    points->Modified();
+  }
+  return numberOfRemovedPoints;
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelPointProcessing::DecimatePoints( vtkPoints* points, double voxelSize, vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers )
+{
+  if ( points == NULL )
+  {
+    vtkGenericWarningMacro( "Input points are null. No operation performed." );
+    return 0;
+  }
+
+  if ( voxelSize <= 0.0 )
+  {
+    vtkGenericWarningMacro( "Decimation voxel size " << voxelSize << " is not positive. No operation performed." );
+    return 0;
+  }
+
+  vtkSmartPointer< vtkSlicerMarkupsToModelScratchBuffers > temporaryScratchBuffers;
+  if ( scratchBuffers == NULL )
+  {
+    temporaryScratchBuffers = vtkSmartPointer< vtkSlicerMarkupsToModelScratchBuffers >::New();
+    scratchBuffers = temporaryScratchBuffers;
+  }
+  vtkSlicerMarkupsToModelScratchBuffers::Scope scratchScope( scratchBuffers );
+
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  DecimationGridCell* cells = scratchBuffers->Allocate< DecimationGridCell >( numberOfPoints );
+  vtkIdType numberOfDecimatedPoints = BinPointsInGrid( points, voxelSize, cells, scratchBuffers );
+  if ( numberOfDecimatedPoints == numberOfPoints )
+  {
+    // each point is in a separate cell
+    return 0;
+  }
+
+  for ( vtkIdType cellIndex = 0; cellIndex < numberOfDecimatedPoints; cellIndex++ )
+  {
+    const DecimationGridCell& cell = cells[ cellIndex ];
+    double centroid[ 3 ] = { 0.0, 0.0, 0.0 };
+    for ( int i = 0; i < 3; i++ )
+    {
+      centroid[ i ] = cell.PointSum[ i ] / cell.NumberOfPoints;
+    }
+    points->SetPoint( cellIndex, centroid );
+  }
+  points->SetNumberOfPoints( numberOfDecimatedPoints );
+  points->Modified();
+  return static_cast< int >( numberOfPoints - numberOfDecimatedPoints );
+}
+
+//------------------------------------------------------------------------------
+double vtkSlicerMarkupsToModelPointProcessing::ComputeDecimationVoxelSize( vtkPoints* points, int targetNumberOfPoints,
+  vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers )
+{
+  if ( points == NULL )
+  {
+    vtkGenericWarningMacro( "Input points are null. Returning 0." );
+    return 0.0;
+  }
+
+  if ( targetNumberOfPoints <= 0 || points->GetNumberOfPoints() <= targetNumberOfPoints )
+  {
+    return 0.0;
+  }
+
+  double bounds[ 6 ] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+  points->GetBounds( bounds );
+  double extents[ 3 ] = { bounds[ 1 ] - bounds[ 0 ], bounds[ 3 ] - bounds[ 2 ], bounds[ 5 ] - bounds[ 4 ] };
+  double diagonal = vtkMath::Norm( extents );
+  if ( diagonal <= 0.0 )
+  {
+    // all points are coincident
+    return EXACT_DUPLICATE_GRID_CELL_SIZE;
+  }
+
+  // Initial guess assumes that the points fill the bounding box. The number of occupied cells grows with
+  // the power of the dimension of the point set (1 for curves, 2 for surfaces, 3 for volumes) as the voxel
+  // size decreases, the dimension is estimated from the counts of successive iterations.
+  double volume = 1.0;
+  for ( int i = 0; i < 3; i++ )
+  {
+    volume *= std::max( extents[ i ], DECIMATION_MINIMUM_RELATIVE_EXTENT * diagonal );
+  }
+  double voxelSize = pow( volume / targetNumberOfPoints, 1.0 / 3.0 );
+  double previousVoxelSize = 0.0;
+  int previousNumberOfCells = 0;
+  double bestVoxelSize = 0.0;
+  vtkSmartPointer< vtkSlicerMarkupsToModelScratchBuffers > temporaryScratchBuffers;
+  if ( scratchBuffers == NULL )
+  {
+    temporaryScratchBuffers = vtkSmartPointer< vtkSlicerMarkupsToModelScratchBuffers >::New();
+    scratchBuffers = temporaryScratchBuffers;
+  }
+  vtkSlicerMarkupsToModelScratchBuffers::Scope scratchScope( scratchBuffers );
+  // the cells of all iterations are stored in the same array
+  DecimationGridCell* cells = scratchBuffers->Allocate< DecimationGridCell >( points->GetNumberOfPoints() );
+  for ( int iteration = 0; iteration < DECIMATION_MAXIMUM_NUMBER_OF_VOXEL_SIZE_ITERATIONS; iteration++ )
+  {
+    int numberOfCells = BinPointsInGrid( points, voxelSize, cells, scratchBuffers );
+    if ( numberOfCells <= targetNumberOfPoints && ( bestVoxelSize == 0.0 || voxelSize < bestVoxelSize ) )
+    {
+      bestVoxelSize = voxelSize;
+    }
+    if ( numberOfCells <= targetNumberOfPoints && numberOfCells >= DECIMATION_ACCEPTED_FRACTION_OF_TARGET * targetNumberOfPoints )
+    {
+      break;
+    }
+
+    double dimension = 2.0;
+    if ( previousNumberOfCells > 0 && numberOfCells != previousNumberOfCells && voxelSize != previousVoxelSize )
+    {
+      dimension = log( static_cast< double >( numberOfCells ) / previousNumberOfCells ) / log( previousVoxelSize / voxelSize );
+      dimension = std::min( std::max( dimension, 1.0 ), 3.0 );
+    }
+    previousVoxelSize = voxelSize;
+    previousNumberOfCells = numberOfCells;
+    // aim slightly below the target, so that the result is more likely to be accepted
+    double targetCount = 0.5 * ( 1.0 + DECIMATION_ACCEPTED_FRACTION_OF_TARGET ) * targetNumberOfPoints;
+    voxelSize *= pow( numberOfCells / targetCount, 1.0 / dimension );
+  }
+
+  while ( bestVoxelSize == 0.0 )
+  {
+    // no result below the target was found yet, the number of cells decreases until only one remains
+    voxelSize *= 2.0;
+    if ( BinPointsInGrid( points, voxelSize, cells, scratchBuffers ) <= targetNumberOfPoints )
+    {
+      bestVoxelSize = voxelSize;
+    }
+  }
+  return bestVoxelSize;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelPointProcessing::PrintSelf( ostream &os, vtkIndent indent )
+{
+  Superclass::PrintSelf( os, indent );
+}
@@ -0,0 +1,59 @@
+#ifndef __vtkSlicerMarkupsToModelPointProcessing_h
+#define __vtkSlicerMarkupsToModelPointProcessing_h
+
+// vtk includes
+#include <vtkIdList.h>
+#include <vtkObject.h>
+#include <vtkPoints.h>
+
+#include "vtkSlicerMarkupsToModelModuleLogicExport.h"
+
+class vtkSlicerMarkupsToModelScratchBuffers;
+
+// Processing steps that are applied to the input points before the model is generated
+class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelPointProcessing : public vtkObject
+{
+  public:
+    // standard vtk object methods
+    vtkTypeMacro( vtkSlicerMarkupsToModelPointProcessing, vtkObject );
+    void PrintSelf( ostream& os, vtkIndent indent ) VTK_OVERRIDE;
+    static vtkSlicerMarkupsToModelPointProcessing *New();
+
+    // constant default values
+    // defined in implementation file due to VS2013 compile issue C2864
+    static const double DUPLICATE_POINT_TOLERANCE_DEFAULT;
+
+    // Remove points that are closer than tolerance (in mm) to a point that precedes them in the list.
+    // The points are modified in place and the order of the remaining points is preserved.
+    // Points are binned in a uniform grid with the tolerance as cell size, so the computation time
+    // is linear in the number of points. If tolerance is 0 then only exactly coincident points are removed.
+    //   outputOriginalToUniqueIndices - optional. For each original point, it stores the index of the point
+    //     that it was merged into, in the output point list.
+    // Returns the number of removed points.
+    // The temporary arrays of the processing functions are allocated from scratchBuffers if it is specified.
+    static int RemoveDuplicatePoints( vtkPoints* points, double tolerance = DUPLICATE_POINT_TOLERANCE_DEFAULT,
+      vtkIdList* outputOriginalToUniqueIndices = NULL, vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers = NULL );
+
+    // Replace the points in each cell of a uniform grid with voxelSize (in mm) cell size by their centroid.
+    // Since each output point is an average of input points, points on a line or plane stay on it.
+    // The points are modified in place, the output points are in the order of the first point of each cell.
+    // The computation time is linear in the number of points. Returns the number of removed points.
+    static int DecimatePoints( vtkPoints* points, double voxelSize, vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers = NULL );
+
+    // Find a voxel size for DecimatePoints that results in approximately (at most) targetNumberOfPoints points.
+    // The number of occupied grid cells is counted for a few candidate sizes, so the computation time is linear.
+    // Returns 0 if the points do not need to be decimated.
+    static double ComputeDecimationVoxelSize( vtkPoints* points, int targetNumberOfPoints,
+      vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers = NULL );
+
+  protected:
+    vtkSlicerMarkupsToModelPointProcessing();
+    ~vtkSlicerMarkupsToModelPointProcessing();
+
+  private:
+    // not used
+    vtkSlicerMarkupsToModelPointProcessing ( const vtkSlicerMarkupsToModelPointProcessing& ) VTK_DELETE_FUNCTION;
+    void operator= ( const vtkSlicerMarkupsToModelPointProcessing& ) VTK_DELETE_FUNCTION;
+};
+
+#endif
@@ -0,0 +1,231 @@
+#include "vtkSlicerMarkupsToModelScratchBuffers.h"
+
+// vtk includes
+#include <vtkObjectFactory.h>
+
+// std includes
+#include <algorithm>
+#include <new>
+
+//------------------------------------------------------------------------------
+// constants within this file
+// allocated arrays start at multiples of this, which is enough for any plain data type
+static const size_t SCRATCH_BUFFER_ALIGNMENT = 16;
+static const size_t SCRATCH_BUFFER_MINIMUM_BLOCK_SIZE = 65536;
+
+//------------------------------------------------------------------------------
+static size_t AlignSize( size_t numberOfBytes )
+{
+  return ( numberOfBytes + SCRATCH_BUFFER_ALIGNMENT - 1 ) / SCRATCH_BUFFER_ALIGNMENT * SCRATCH_BUFFER_ALIGNMENT;
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelScratchBuffers::Scope::Scope( vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers )
+  : ScratchBuffers( scratchBuffers )
+  , BlockIndex( 0 )
+  , BlockPosition( 0 )
+  , UsedSize( 0 )
+  , NumberOfUsedPoints( 0 )
+  , NumberOfUsedDoubleArrays( 0 )
+{
+  if ( scratchBuffers == NULL )
+  {
+    return;
+  }
+  this->BlockIndex = scratchBuffers->CurrentBlockIndex;
+  this->BlockPosition = scratchBuffers->BlockPosition;
+  this->UsedSize = scratchBuffers->UsedSize;
+  this->NumberOfUsedPoints = scratchBuffers->NumberOfUsedPoints;
+  this->NumberOfUsedDoubleArrays = scratchBuffers->NumberOfUsedDoubleArrays;
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelScratchBuffers::Scope::~Scope()
+{
+  if ( this->ScratchBuffers == NULL )
+  {
+    return;
+  }
+  this->ScratchBuffers->CurrentBlockIndex = this->BlockIndex;
+  this->ScratchBuffers->BlockPosition = this->BlockPosition;
+  this->ScratchBuffers->UsedSize = this->UsedSize;
+  this->ScratchBuffers->NumberOfUsedPoints = this->NumberOfUsedPoints;
+  this->ScratchBuffers->NumberOfUsedDoubleArrays = this->NumberOfUsedDoubleArrays;
+}
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro( vtkSlicerMarkupsToModelScratchBuffers );
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelScratchBuffers::vtkSlicerMarkupsToModelScratchBuffers()
+  : CurrentBlockIndex( 0 )
+  , BlockPosition( 0 )
+  , UsedSize( 0 )
+  , PeakUsedSizeSinceReset( 0 )
+  , PeakUsedSize( 0 )
+  , NumberOfUsedPoints( 0 )
+  , NumberOfUsedDoubleArrays( 0 )
+  , NumberOfAllocations( 0 )
+  , NumberOfBlockAllocations( 0 )
+  , NumberOfCreatedObjects( 0 )
+  , NumberOfResets( 0 )
+{
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelScratchBuffers::~vtkSlicerMarkupsToModelScratchBuffers()
+{
+  this->ReleaseBlocks();
+}
+
+//------------------------------------------------------------------------------
+void* vtkSlicerMarkupsToModelScratchBuffers::AllocateBytes( size_t numberOfBytes )
+{
+  // each array gets a distinct address, even if it is empty
+  numberOfBytes = AlignSize( std::max( numberOfBytes, static_cast< size_t >( 1 ) ) );
+  this->NumberOfAllocations++;
+
+  // blocks after the current one are only in use if a scope has ended, they are free
+  while ( this->CurrentBlockIndex < this->Blocks.size() && this->BlockPosition + numberOfBytes > this->Blocks[ this->CurrentBlockIndex ].Size )
+  {
+    this->CurrentBlockIndex++;
+    this->BlockPosition = 0;
+  }
+  if ( this->CurrentBlockIndex >= this->Blocks.size() )
+  {
+    // the blocks grow geometrically, so that the number of blocks stays small until the next Reset merges them
+    Block block;
+    block.Size = std::max( numberOfBytes, SCRATCH_BUFFER_MINIMUM_BLOCK_SIZE );
+    if ( !this->Blocks.empty() )
+    {
+      block.Size = std::max( block.Size, 2 * this->Blocks.back().Size );
+    }
+    block.Memory = static_cast< char* >( ::operator new( block.Size ) );
+    this->Blocks.push_back( block );
+    this->NumberOfBlockAllocations++;
+    this->CurrentBlockIndex = this->Blocks.size() - 1;
+    this->BlockPosition = 0;
+  }
+
+  void* memory = this->Blocks[ this->CurrentBlockIndex ].Memory + this->BlockPosition;
+  this->BlockPosition += numberOfBytes;
+  this->UsedSize += numberOfBytes;
+  this->PeakUsedSizeSinceReset = std::max( this->PeakUsedSizeSinceReset, this->UsedSize );
+  this->PeakUsedSize = std::max( this->PeakUsedSize, this->UsedSize );
+  return memory;
+}
+
+//------------------------------------------------------------------------------
+vtkPoints* vtkSlicerMarkupsToModelScratchBuffers::GetPoints()
+{
+  if ( this->NumberOfUsedPoints == this->PointsPool.size() )
+  {
+    this->PointsPool.push_back( vtkSmartPointer< vtkPoints >::New() );
+    this->NumberOfCreatedObjects++;
+  }
+  vtkPoints* points = this->PointsPool[ this->NumberOfUsedPoints++ ];
+  if ( points->GetDataType() != VTK_FLOAT )
+  {
+    points->SetDataTypeToFloat();
+  }
+  // the memory of the points is kept
+  points->Reset();
+  points->Modified();
+  return points;
+}
+
+//------------------------------------------------------------------------------
+vtkDoubleArray* vtkSlicerMarkupsToModelScratchBuffers::GetDoubleArray()
+{
+  if ( this->NumberOfUsedDoubleArrays == this->DoubleArrayPool.size() )
+  {
+    this->DoubleArrayPool.push_back( vtkSmartPointer< vtkDoubleArray >::New() );
+    this->NumberOfCreatedObjects++;
+  }
+  vtkDoubleArray* array = this->DoubleArrayPool[ this->NumberOfUsedDoubleArrays++ ];
+  array->SetNumberOfComponents( 1 );
+  array->SetName( NULL );
+  array->Reset();
+  array->Modified();
+  return array;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelScratchBuffers::Reset()
+{
+  if ( this->Blocks.size() > 1 )
+  {
+    // all arrays fit in one block of the peak size, as there are no gaps between them in a single block
+    size_t blockSize = std::max( this->PeakUsedSizeSinceReset, SCRATCH_BUFFER_MINIMUM_BLOCK_SIZE );
+    this->ReleaseBlocks();
+    Block block;
+    block.Size = blockSize;
+    block.Memory = static_cast< char* >( ::operator new( block.Size ) );
+    this->Blocks.push_back( block );
+    this->NumberOfBlockAllocations++;
+  }
+  this->CurrentBlockIndex = 0;
+  this->BlockPosition = 0;
+  this->UsedSize = 0;
+  this->PeakUsedSizeSinceReset = 0;
+  this->NumberOfUsedPoints = 0;
+  this->NumberOfUsedDoubleArrays = 0;
+  this->NumberOfAllocations = 0;
+  this->NumberOfResets++;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelScratchBuffers::Clear()
+{
+  this->ReleaseBlocks();
+  this->PointsPool.clear();
+  this->DoubleArrayPool.clear();
+  this->CurrentBlockIndex = 0;
+  this->BlockPosition = 0;
+  this->UsedSize = 0;
+  this->PeakUsedSizeSinceReset = 0;
+  this->NumberOfUsedPoints = 0;
+  this->NumberOfUsedDoubleArrays = 0;
+  this->NumberOfAllocations = 0;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelScratchBuffers::ReleaseBlocks()
+{
+  for ( size_t i = 0; i < this->Blocks.size(); i++ )
+  {
+    ::operator delete( this->Blocks[ i ].Memory );
+  }
+  this->Blocks.clear();
+}
+
+//------------------------------------------------------------------------------
+unsigned long vtkSlicerMarkupsToModelScratchBuffers::GetReservedSize()
+{
+  size_t reservedSize = 0;
+  for ( size_t i = 0; i < this->Blocks.size(); i++ )
+  {
+    reservedSize += this->Blocks[ i ].Size;
+  }
+  return static_cast< unsigned long >( ( reservedSize + 1023 ) / 1024 );
+}
+
+//------------------------------------------------------------------------------
+unsigned long vtkSlicerMarkupsToModelScratchBuffers::GetPeakUsedSize()
+{
+  return static_cast< unsigned long >( ( this->PeakUsedSize + 1023 ) / 1024 );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelScratchBuffers::PrintSelf( ostream &os, vtkIndent indent )
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "ReservedSize: " << this->GetReservedSize() << " KiB" << std::endl;
+  os << indent << "PeakUsedSize: " << this->GetPeakUsedSize() << " KiB" << std::endl;
+  os << indent << "NumberOfBlocks: " << this->Blocks.size() << std::endl;
+  os << indent << "NumberOfAllocations: " << this->NumberOfAllocations << std::endl;
+  os << indent << "NumberOfBlockAllocations: " << this->NumberOfBlockAllocations << std::endl;
+  os << indent << "NumberOfPooledObjects: " << ( this->PointsPool.size() + this->DoubleArrayPool.size() ) << std::endl;
+  os << indent << "NumberOfCreatedObjects: " << this->NumberOfCreatedObjects << std::endl;
+  os << indent << "NumberOfResets: " << this->NumberOfResets << std::endl;
+}
@@ -0,0 +1,121 @@
+#ifndef __vtkSlicerMarkupsToModelScratchBuffers_h
+#define __vtkSlicerMarkupsToModelScratchBuffers_h
+
+// vtk includes
+#include <vtkDoubleArray.h>
+#include <vtkObject.h>
+#include <vtkPoints.h>
+#include <vtkSmartPointer.h>
+
+// std includes
+#include <cstddef>
+#include <vector>
+
+#include "vtkSlicerMarkupsToModelModuleLogicExport.h"
+
+// Memory for the temporary arrays and objects of model generation, which is kept between updates.
+// Arrays are allocated from large memory blocks by advancing a position in the current block, and
+// the objects are taken from pools, so after the first updates no memory is allocated from the system.
+// Reset makes all memory and objects available again. If the arrays of an update did not fit in one
+// block then the blocks are replaced by a single block that is large enough for all of them.
+// An instance must only be accessed by one thread at a time.
+class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelScratchBuffers : public vtkObject
+{
+  public:
+    // standard vtk object methods
+    vtkTypeMacro( vtkSlicerMarkupsToModelScratchBuffers, vtkObject );
+    void PrintSelf( ostream& os, vtkIndent indent ) VTK_OVERRIDE;
+    static vtkSlicerMarkupsToModelScratchBuffers *New();
+
+    // Memory and objects that are taken from the buffers while a scope exists are made available again
+    // when the scope is destroyed. Scopes must be destroyed in the reverse order of their creation.
+    // If scratchBuffers is NULL then the scope does nothing.
+    class Scope
+    {
+      public:
+        Scope( vtkSlicerMarkupsToModelScratchBuffers* scratchBuffers );
+        ~Scope();
+      private:
+        vtkSlicerMarkupsToModelScratchBuffers* ScratchBuffers;
+        size_t BlockIndex;
+        size_t BlockPosition;
+        size_t UsedSize;
+        size_t NumberOfUsedPoints;
+        size_t NumberOfUsedDoubleArrays;
+        Scope( const Scope& );
+        void operator=( const Scope& );
+    };
+
+    // Allocate an uninitialized array of numberOfValues values. The values are not constructed, therefore
+    // T must be a plain data type (number, pointer or a struct of these). The array is valid until the next Reset
+    // (or until the end of the enclosing scope).
+    template< typename T > T* Allocate( size_t numberOfValues )
+    {
+      return static_cast< T* >( this->AllocateBytes( numberOfValues * sizeof( T ) ) );
+    }
+    void* AllocateBytes( size_t numberOfBytes );
+
+    // Get an empty points object with the default (float) data type. The object is not used by anyone else
+    // until the next Reset (or the end of the enclosing scope), it must not be referenced by any output.
+    vtkPoints* GetPoints();
+    // Get an empty single component double array, with the same lifetime as above
+    vtkDoubleArray* GetDoubleArray();
+
+    // Make all memory and objects available again. The arrays and objects that were taken before must not be used after this.
+    void Reset();
+
+    // Release all memory and objects
+    void Clear();
+
+    // Number of arrays allocated since the last Reset
+    vtkGetMacro( NumberOfAllocations, unsigned long );
+    // Number of memory blocks allocated from the system since the creation of the buffers.
+    // If it does not increase between updates then the updates do not allocate memory for temporary arrays.
+    vtkGetMacro( NumberOfBlockAllocations, unsigned long );
+    // Number of points and array objects that were created for the pools since the creation of the buffers
+    vtkGetMacro( NumberOfCreatedObjects, unsigned long );
+    vtkGetMacro( NumberOfResets, unsigned long );
+    // Memory size of the blocks in kibibytes
+    unsigned long GetReservedSize();
+    // Largest memory size in kibibytes that was in use between two resets
+    unsigned long GetPeakUsedSize();
+
+  protected:
+    vtkSlicerMarkupsToModelScratchBuffers();
+    ~vtkSlicerMarkupsToModelScratchBuffers();
+
+  private:
+    struct Block
+    {
+      char* Memory;
+      size_t Size;
+    };
+
+    void ReleaseBlocks();
+
+    friend class Scope;
+
+    // arrays are allocated from the current block, the blocks after it are free
+    std::vector< Block > Blocks;
+    size_t CurrentBlockIndex;
+    size_t BlockPosition;
+    size_t UsedSize; // bytes allocated since the last Reset, including the alignment
+    size_t PeakUsedSizeSinceReset;
+    size_t PeakUsedSize;
+
+    std::vector< vtkSmartPointer< vtkPoints > > PointsPool;
+    size_t NumberOfUsedPoints;
+    std::vector< vtkSmartPointer< vtkDoubleArray > > DoubleArrayPool;
+    size_t NumberOfUsedDoubleArrays;
+
+    unsigned long NumberOfAllocations;
+    unsigned long NumberOfBlockAllocations;
+    unsigned long NumberOfCreatedObjects;
+    unsigned long NumberOfResets;
+
+    // not used
+    vtkSlicerMarkupsToModelScratchBuffers ( const vtkSlicerMarkupsToModelScratchBuffers& ) VTK_DELETE_FUNCTION;
+    void operator= ( const vtkSlicerMarkupsToModelScratchBuffers& ) VTK_DELETE_FUNCTION;
+};
+
+#endif
@@ -0,0 +1,741 @@
+#include "vtkSlicerMarkupsToModelSubdivisionFilter.h"
+
+// vtk includes
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// constants within this file
+// valence of the points of a regular triangle mesh, the butterfly stencil is used for edges between such points
+static const vtkIdType SUBDIVISION_REGULAR_VALENCE = 6;
+// weight of the point with irregular valence in the stencil of its edges (Zorin et al.)
+static const double SUBDIVISION_EXTRAORDINARY_POINT_WEIGHT = 0.75;
+// the volume and area are summed in blocks of this many triangles, so that the sums do not depend on the number of threads
+static const vtkIdType SUBDIVISION_MEASURES_BLOCK_SIZE = 4096;
+
+//------------------------------------------------------------------------------
+// Triangle mesh with the connectivity that a subdivision step needs.
+// The connectivity is built in parallel, except the prefix sums.
+class SubdivisionMesh
+{
+public:
+  // 3 coordinates per point
+  std::vector< double > Coordinates;
+  // 3 point ids per triangle, the triangles have no repeated points
+  std::vector< vtkIdType > Triangles;
+
+  // triangles around point i: PointTriangles[ PointTriangleOffsets[ i ] ... PointTriangleOffsets[ i + 1 ] - 1 ]
+  std::vector< vtkIdType > PointTriangleOffsets;
+  std::vector< vtkIdType > PointTriangles;
+  // Neighbors of point i start at PointNeighbors[ 2 * PointTriangleOffsets[ i ] ], as a point cannot have more neighbors
+  // than twice the number of its triangles. If the triangles around the point form a single closed fan then RingValid
+  // is set and the neighbors are in order around the point, otherwise they are in increasing order.
+  std::vector< vtkIdType > PointNeighbors;
+  std::vector< vtkIdType > NumberOfPointNeighbors;
+  std::vector< char > RingValid;
+  // Edges of point i, to its neighbors with larger id, in increasing order of the neighbor id:
+  // EdgeEndPoints[ EdgeOffsets[ i ] ... EdgeOffsets[ i + 1 ] - 1 ]. The index in EdgeEndPoints is the id of the edge.
+  std::vector< vtkIdType > EdgeOffsets;
+  std::vector< vtkIdType > EdgeEndPoints;
+
+  vtkIdType GetNumberOfPoints() const
+  {
+    return static_cast< vtkIdType >( this->Coordinates.size() / 3 );
+  }
+
+  vtkIdType GetNumberOfTriangles() const
+  {
+    return static_cast< vtkIdType >( this->Triangles.size() / 3 );
+  }
+
+  vtkIdType GetNumberOfEdges() const
+  {
+    return static_cast< vtkIdType >( this->EdgeEndPoints.size() );
+  }
+
+  const vtkIdType* GetNeighbors( vtkIdType pointId ) const
+  {
+    return &( this->PointNeighbors[ 0 ] ) + 2 * this->PointTriangleOffsets[ pointId ];
+  }
+
+  // Lists the triangles around each point. This is a counting sort of the triangle corners, it is not parallelized,
+  // as it only reads and increments integers.
+  void BuildPointTriangles()
+  {
+    vtkIdType numberOfPoints = this->GetNumberOfPoints();
+    this->PointTriangleOffsets.assign( numberOfPoints + 1, 0 );
+    for ( size_t i = 0; i < this->Triangles.size(); i++ )
+    {
+      this->PointTriangleOffsets[ this->Triangles[ i ] + 1 ]++;
+    }
+    for ( vtkIdType i = 0; i < numberOfPoints; i++ )
+    {
+      this->PointTriangleOffsets[ i + 1 ] += this->PointTriangleOffsets[ i ];
+    }
+    this->PointTriangles.resize( this->Triangles.size() );
+    std::vector< vtkIdType > insertPositions( this->PointTriangleOffsets.begin(), this->PointTriangleOffsets.end() - 1 );
+    for ( size_t i = 0; i < this->Triangles.size(); i++ )
+    {
+      this->PointTriangles[ insertPositions[ this->Triangles[ i ] ]++ ] = static_cast< vtkIdType >( i / 3 );
+    }
+  }
+
+  // Allocates the per point arrays of BuildPointNeighbors
+  void AllocatePointNeighbors()
+  {
+    vtkIdType numberOfPoints = this->GetNumberOfPoints();
+    // one more element, so that the neighbors of the last point can be addressed even if it has no triangles
+    this->PointNeighbors.resize( 2 * this->Triangles.size() + 1 );
+    this->NumberOfPointNeighbors.assign( numberOfPoints, 0 );
+    this->RingValid.assign( numberOfPoints, 0 );
+    this->EdgeOffsets.assign( numberOfPoints + 1, 0 );
+  }
+
+  // Find the neighbors of a point, and order them around the point if possible.
+  // The number of its edges is stored in EdgeOffsets[ pointId + 1 ] (before the prefix sum).
+  // pairs and usedPairs are work arrays.
+  void BuildPointNeighbors( vtkIdType pointId, std::vector< vtkIdType >& pairs, std::vector< char >& usedPairs )
+  {
+    vtkIdType firstTriangle = this->PointTriangleOffsets[ pointId ];
+    vtkIdType numberOfTriangles = this->PointTriangleOffsets[ pointId + 1 ] - firstTriangle;
+    vtkIdType* neighbors = &( this->PointNeighbors[ 0 ] ) + 2 * firstTriangle;
+
+    // the two other points of each triangle
+    pairs.resize( 2 * numberOfTriangles );
+    for ( vtkIdType i = 0; i < numberOfTriangles; i++ )
+    {
+      const vtkIdType* triangle = &( this->Triangles[ 3 * this->PointTriangles[ firstTriangle + i ] ] );
+      int corner = ( triangle[ 0 ] == pointId ) ? 0 : ( ( triangle[ 1 ] == pointId ) ? 1 : 2 );
+      pairs[ 2 * i ] = triangle[ ( corner + 1 ) % 3 ];
+      pairs[ 2 * i + 1 ] = triangle[ ( corner + 2 ) % 3 ];
+    }
+
+    // walk around the point: each step continues with the unused triangle that contains the last neighbor
+    bool ringValid = ( numberOfTriangles >= 3 );
+    if ( ringValid )
+    {
+      usedPairs.assign( numberOfTriangles, 0 );
+      usedPairs[ 0 ] = 1;
+      neighbors[ 0 ] = pairs[ 0 ];
+      neighbors[ 1 ] = pairs[ 1 ];
+      vtkIdType currentNeighbor = pairs[ 1 ];
+      for ( vtkIdType step = 1; step < numberOfTriangles && ringValid; step++ )
+      {
+        vtkIdType nextNeighbor = -1;
+        for ( vtkIdType i = 1; i < numberOfTriangles; i++ )
+        {
+          if ( usedPairs[ i ] )
+          {
+            continue;
+          }
+          if ( pairs[ 2 * i ] == currentNeighbor || pairs[ 2 * i + 1 ] == currentNeighbor )
+          {
+            nextNeighbor = ( pairs[ 2 * i ] == currentNeighbor ) ? pairs[ 2 * i + 1 ] : pairs[ 2 * i ];
+            usedPairs[ i ] = 1;
+            break;
+          }
+        }
+        if ( nextNeighbor < 0 )
+        {
+          // the triangles do not form a closed fan (boundary or non-manifold point)
+          ringValid = false;
+        }
+        else if ( step < numberOfTriangles - 1 )
+        {
+          neighbors[ step + 1 ] = nextNeighbor;
+          currentNeighbor = nextNeighbor;
+        }
+        else
+        {
+          // the last triangle must close the fan
+          ringValid = ( nextNeighbor == neighbors[ 0 ] );
+        }
+      }
+      if ( ringValid )
+      {
+        // the fan must go around the point only once
+        pairs.assign( neighbors, neighbors + numberOfTriangles );
+        std::sort( pairs.begin(), pairs.end() );
+        ringValid = ( std::adjacent_find( pairs.begin(), pairs.end() ) == pairs.end() );
+      }
+    }
+
+    vtkIdType numberOfNeighbors = numberOfTriangles;
+    if ( !ringValid )
+    {
+      // all neighbors, from the triangles again, as the pairs were reused for checking the ring
+      for ( vtkIdType i = 0; i < numberOfTriangles; i++ )
+      {
+        const vtkIdType* triangle = &( this->Triangles[ 3 * this->PointTriangles[ firstTriangle + i ] ] );
+        int corner = ( triangle[ 0 ] == pointId ) ? 0 : ( ( triangle[ 1 ] == pointId ) ? 1 : 2 );
+        neighbors[ 2 * i ] = triangle[ ( corner + 1 ) % 3 ];
+        neighbors[ 2 * i + 1 ] = triangle[ ( corner + 2 ) % 3 ];
+      }
+      std::sort( neighbors, neighbors + 2 * numberOfTriangles );
+      numberOfNeighbors = static_cast< vtkIdType >( std::unique( neighbors, neighbors + 2 * numberOfTriangles ) - neighbors );
+    }
+    this->NumberOfPointNeighbors[ pointId ] = numberOfNeighbors;
+    this->RingValid[ pointId ] = ringValid ? 1 : 0;
+
+    vtkIdType numberOfEdges = 0;
+    for ( vtkIdType i = 0; i < numberOfNeighbors; i++ )
+    {
+      if ( neighbors[ i ] > pointId )
+      {
+        numberOfEdges++;
+      }
+    }
+    this->EdgeOffsets[ pointId + 1 ] = numberOfEdges;
+  }
+
+  // Converts the numbers of edges of the points to offsets
+  void ComputeEdgeOffsets()
+  {
+    vtkIdType numberOfPoints = this->GetNumberOfPoints();
+    for ( vtkIdType i = 0; i < numberOfPoints; i++ )
+    {
+      this->EdgeOffsets[ i + 1 ] += this->EdgeOffsets[ i ];
+    }
+    this->EdgeEndPoints.resize( this->EdgeOffsets[ numberOfPoints ] );
+  }
+
+  // Stores the edges of a point, after the edge offsets are computed
+  void BuildEdges( vtkIdType pointId )
+  {
+    const vtkIdType* neighbors = this->GetNeighbors( pointId );
+    vtkIdType numberOfNeighbors = this->NumberOfPointNeighbors[ pointId ];
+    vtkIdType* edgeEndPoints = &( this->EdgeEndPoints[ 0 ] ) + this->EdgeOffsets[ pointId ];
+    vtkIdType numberOfEdges = 0;
+    for ( vtkIdType i = 0; i < numberOfNeighbors; i++ )
+    {
+      if ( neighbors[ i ] > pointId )
+      {
+        edgeEndPoints[ numberOfEdges++ ] = neighbors[ i ];
+      }
+    }
+    std::sort( edgeEndPoints, edgeEndPoints + numberOfEdges );
+  }
+
+  // Returns the id of the edge between two different points of a triangle
+  vtkIdType FindEdge( vtkIdType pointId1, vtkIdType pointId2 ) const
+  {
+    vtkIdType smallerPointId = std::min( pointId1, pointId2 );
+    vtkIdType largerPointId = std::max( pointId1, pointId2 );
+    const vtkIdType* edgesBegin = &( this->EdgeEndPoints[ 0 ] ) + this->EdgeOffsets[ smallerPointId ];
+    const vtkIdType* edgesEnd = &( this->EdgeEndPoints[ 0 ] ) + this->EdgeOffsets[ smallerPointId + 1 ];
+    return static_cast< vtkIdType >( std::lower_bound( edgesBegin, edgesEnd, largerPointId ) - &( this->EdgeEndPoints[ 0 ] ) );
+  }
+
+  // Computes the point inserted on the edge between the two points
+  void ComputeEdgePoint( vtkIdType pointId1, vtkIdType pointId2, bool butterflyScheme, double outputPoint[ 3 ] ) const
+  {
+    const double* point1 = &( this->Coordinates[ 3 * pointId1 ] );
+    const double* point2 = &( this->Coordinates[ 3 * pointId2 ] );
+    if ( !butterflyScheme || !this->RingValid[ pointId1 ] || !this->RingValid[ pointId2 ] )
+    {
+      for ( int i = 0; i < 3; i++ )
+      {
+        outputPoint[ i ] = 0.5 * ( point1[ i ] + point2[ i ] );
+      }
+      return;
+    }
+
+    const vtkIdType* ring1 = this->GetNeighbors( pointId1 );
+    const vtkIdType* ring2 = this->GetNeighbors( pointId2 );
+    vtkIdType valence1 = this->NumberOfPointNeighbors[ pointId1 ];
+    vtkIdType valence2 = this->NumberOfPointNeighbors[ pointId2 ];
+    // position of each point in the ring of the other one
+    vtkIdType ringIndex2 = static_cast< vtkIdType >( std::find( ring1, ring1 + valence1, pointId2 ) - ring1 );
+    vtkIdType ringIndex1 = static_cast< vtkIdType >( std::find( ring2, ring2 + valence2, pointId1 ) - ring2 );
+
+    if ( valence1 == SUBDIVISION_REGULAR_VALENCE && valence2 == SUBDIVISION_REGULAR_VALENCE )
+    {
+      // 8 point butterfly stencil: the edge points, the two points opposite to the edge, and the four "wing" points
+      // opposite to the other edges of the two triangles of the edge
+      const double* opposite1 = &( this->Coordinates[ 3 * ring1[ ( ringIndex2 + 1 ) % valence1 ] ] );
+      const double* opposite2 = &( this->Coordinates[ 3 * ring1[ ( ringIndex2 + valence1 - 1 ) % valence1 ] ] );
+      const double* wing1 = &( this->Coordinates[ 3 * ring1[ ( ringIndex2 + 2 ) % valence1 ] ] );
+      const double* wing2 = &( this->Coordinates[ 3 * ring1[ ( ringIndex2 + valence1 - 2 ) % valence1 ] ] );
+      const double* wing3 = &( this->Coordinates[ 3 * ring2[ ( ringIndex1 + 2 ) % valence2 ] ] );
+      const double* wing4 = &( this->Coordinates[ 3 * ring2[ ( ringIndex1 + valence2 - 2 ) % valence2 ] ] );
+      for ( int i = 0; i < 3; i++ )
+      {
+        outputPoint[ i ] = 0.5 * ( point1[ i ] + point2[ i ] ) + 0.125 * ( opposite1[ i ] + opposite2[ i ] )
+          - 0.0625 * ( wing1[ i ] + wing2[ i ] + wing3[ i ] + wing4[ i ] );
+      }
+      return;
+    }
+
+    // the stencil of the extraordinary endpoints, averaged if both are extraordinary
+    outputPoint[ 0 ] = 0.0;
+    outputPoint[ 1 ] = 0.0;
+    outputPoint[ 2 ] = 0.0;
+    int numberOfStencils = 0;
+    if ( valence1 != SUBDIVISION_REGULAR_VALENCE )
+    {
+      this->AddExtraordinaryStencil( pointId1, ring1, valence1, ringIndex2, outputPoint );
+      numberOfStencils++;
+    }
+    if ( valence2 != SUBDIVISION_REGULAR_VALENCE )
+    {
+      this->AddExtraordinaryStencil( pointId2, ring2, valence2, ringIndex1, outputPoint );
+      numberOfStencils++;
+    }
+    if ( numberOfStencils > 1 )
+    {
+      vtkMath::MultiplyScalar( outputPoint, 1.0 / numberOfStencils );
+    }
+  }
+
+  // Adds the point computed from the ring of an extraordinary point (valence other than 6) to outputPoint.
+  // ringIndex is the position of the other endpoint of the edge in the ring.
+  void AddExtraordinaryStencil( vtkIdType pointId, const vtkIdType* ring, vtkIdType valence, vtkIdType ringIndex, double outputPoint[ 3 ] ) const
+  {
+    const double* point = &( this->Coordinates[ 3 * pointId ] );
+    for ( int i = 0; i < 3; i++ )
+    {
+      outputPoint[ i ] += SUBDIVISION_EXTRAORDINARY_POINT_WEIGHT * point[ i ];
+    }
+    for ( vtkIdType j = 0; j < valence; j++ )
+    {
+      double weight = 0.0;
+      if ( valence == 3 )
+      {
+        weight = ( j == 0 ) ? 5.0 / 12.0 : -1.0 / 12.0;
+      }
+      else if ( valence == 4 )
+      {
+        weight = ( j == 0 ) ? 3.0 / 8.0 : ( ( j == 2 ) ? -1.0 / 8.0 : 0.0 );
+      }
+      else
+      {
+        double angle = 2.0 * vtkMath::Pi() * j / valence;
+        weight = ( 0.25 + cos( angle ) + 0.5 * cos( 2.0 * angle ) ) / valence;
+      }
+      const double* neighbor = &( this->Coordinates[ 3 * ring[ ( ringIndex + j ) % valence ] ] );
+      for ( int i = 0; i < 3; i++ )
+      {
+        outputPoint[ i ] += weight * neighbor[ i ];
+      }
+    }
+  }
+};
+
+//------------------------------------------------------------------------------
+// Functors for vtkSMPTools::For, each one processes a range of points or triangles of the mesh.
+class PointNeighborsFunctor
+{
+public:
+  PointNeighborsFunctor( SubdivisionMesh& mesh )
+    : Mesh( mesh )
+  {
+  }
+
+  void operator()( vtkIdType firstPointId, vtkIdType endPointId )
+  {
+    std::vector< vtkIdType >& pairs = this->Pairs.Local();
+    std::vector< char >& usedPairs = this->UsedPairs.Local();
+    for ( vtkIdType pointId = firstPointId; pointId < endPointId; pointId++ )
+    {
+      this->Mesh.BuildPointNeighbors( pointId, pairs, usedPairs );
+    }
+  }
+
+private:
+  SubdivisionMesh& Mesh;
+  vtkSMPThreadLocal< std::vector< vtkIdType > > Pairs;
+  vtkSMPThreadLocal< std::vector< char > > UsedPairs;
+};
+
+class EdgesFunctor
+{
+public:
+  EdgesFunctor( SubdivisionMesh& mesh )
+    : Mesh( mesh )
+  {
+  }
+
+  void operator()( vtkIdType firstPointId, vtkIdType endPointId )
+  {
+    for ( vtkIdType pointId = firstPointId; pointId < endPointId; pointId++ )
+    {
+      this->Mesh.BuildEdges( pointId );
+    }
+  }
+
+private:
+  SubdivisionMesh& Mesh;
+};
+
+class EdgePointsFunctor
+{
+public:
+  // The point of edge i is stored as point ( number of points + i ) in outputCoordinates
+  EdgePointsFunctor( const SubdivisionMesh& mesh, bool butterflyScheme, std::vector< double >& outputCoordinates )
+    : Mesh( mesh )
+    , ButterflyScheme( butterflyScheme )
+    , OutputCoordinates( outputCoordinates )
+  {
+  }
+
+  void operator()( vtkIdType firstPointId, vtkIdType endPointId )
+  {
+    vtkIdType numberOfPoints = this->Mesh.GetNumberOfPoints();
+    for ( vtkIdType pointId = firstPointId; pointId < endPointId; pointId++ )
+    {
+      for ( vtkIdType edgeId = this->Mesh.EdgeOffsets[ pointId ]; edgeId < this->Mesh.EdgeOffsets[ pointId + 1 ]; edgeId++ )
+      {
+        this->Mesh.ComputeEdgePoint( pointId, this->Mesh.EdgeEndPoints[ edgeId ], this->ButterflyScheme,
+          &( this->OutputCoordinates[ 3 * ( numberOfPoints + edgeId ) ] ) );
+      }
+    }
+  }
+
+private:
+  const SubdivisionMesh& Mesh;
+  bool ButterflyScheme;
+  std::vector< double >& OutputCoordinates;
+};
+
+class SplitTrianglesFunctor
+{
+public:
+  // The 4 triangles of triangle i are stored as triangles 4 * i ... 4 * i + 3 in outputTriangles
+  SplitTrianglesFunctor( const SubdivisionMesh& mesh, std::vector< vtkIdType >& outputTriangles )
+    : Mesh( mesh )
+    , OutputTriangles( outputTriangles )
+  {
+  }
+
+  void operator()( vtkIdType firstTriangleId, vtkIdType endTriangleId )
+  {
+    vtkIdType numberOfPoints = this->Mesh.GetNumberOfPoints();
+    for ( vtkIdType triangleId = firstTriangleId; triangleId < endTriangleId; triangleId++ )
+    {
+      const vtkIdType* triangle = &( this->Mesh.Triangles[ 3 * triangleId ] );
+      vtkIdType edgePoint01 = numberOfPoints + this->Mesh.FindEdge( triangle[ 0 ], triangle[ 1 ] );
+      vtkIdType edgePoint12 = numberOfPoints + this->Mesh.FindEdge( triangle[ 1 ], triangle[ 2 ] );
+      vtkIdType edgePoint20 = numberOfPoints + this->Mesh.FindEdge( triangle[ 2 ], triangle[ 0 ] );
+      // same orientation as the original triangle
+      vtkIdType* outputTriangles = &( this->OutputTriangles[ 12 * triangleId ] );
+      outputTriangles[ 0 ] = triangle[ 0 ];
+      outputTriangles[ 1 ] = edgePoint01;
+      outputTriangles[ 2 ] = edgePoint20;
+      outputTriangles[ 3 ] = edgePoint01;
+      outputTriangles[ 4 ] = triangle[ 1 ];
+      outputTriangles[ 5 ] = edgePoint12;
+      outputTriangles[ 6 ] = edgePoint20;
+      outputTriangles[ 7 ] = edgePoint12;
+      outputTriangles[ 8 ] = triangle[ 2 ];
+      outputTriangles[ 9 ] = edgePoint01;
+      outputTriangles[ 10 ] = edgePoint12;
+      outputTriangles[ 11 ] = edgePoint20;
+    }
+  }
+
+private:
+  const SubdivisionMesh& Mesh;
+  std::vector< vtkIdType >& OutputTriangles;
+};
+
+class TriangleNormalsFunctor
+{
+public:
+  // The normals are not normalized, so that their length is proportional to the area of the triangles.
+  // The functor processes blocks of SUBDIVISION_MEASURES_BLOCK_SIZE triangles, and stores the sum of the signed volumes
+  // of the tetrahedra between the triangles and the first point, and the sum of the areas of the triangles of each block.
+  TriangleNormalsFunctor( const SubdivisionMesh& mesh, std::vector< double >& outputNormals,
+    std::vector< double >& outputBlockVolumes, std::vector< double >& outputBlockAreas )
+    : Mesh( mesh )
+    , OutputNormals( outputNormals )
+    , OutputBlockVolumes( outputBlockVolumes )
+    , OutputBlockAreas( outputBlockAreas )
+  {
+  }
+
+  void operator()( vtkIdType firstBlock, vtkIdType endBlock )
+  {
+    vtkIdType numberOfTriangles = this->Mesh.GetNumberOfTriangles();
+    // the first point is used instead of the origin, so that the rounding errors do not depend on the position of the surface
+    const double* origin = &( this->Mesh.Coordinates[ 0 ] );
+    for ( vtkIdType block = firstBlock; block < endBlock; block++ )
+    {
+      double volume = 0.0;
+      double area = 0.0;
+      vtkIdType endTriangleId = std::min( ( block + 1 ) * SUBDIVISION_MEASURES_BLOCK_SIZE, numberOfTriangles );
+      for ( vtkIdType triangleId = block * SUBDIVISION_MEASURES_BLOCK_SIZE; triangleId < endTriangleId; triangleId++ )
+      {
+        const vtkIdType* triangle = &( this->Mesh.Triangles[ 3 * triangleId ] );
+        const double* point0 = &( this->Mesh.Coordinates[ 3 * triangle[ 0 ] ] );
+        const double* point1 = &( this->Mesh.Coordinates[ 3 * triangle[ 1 ] ] );
+        const double* point2 = &( this->Mesh.Coordinates[ 3 * triangle[ 2 ] ] );
+        double edge1[ 3 ] = { point1[ 0 ] - point0[ 0 ], point1[ 1 ] - point0[ 1 ], point1[ 2 ] - point0[ 2 ] };
+        double edge2[ 3 ] = { point2[ 0 ] - point0[ 0 ], point2[ 1 ] - point0[ 1 ], point2[ 2 ] - point0[ 2 ] };
+        double* normal = &( this->OutputNormals[ 3 * triangleId ] );
+        vtkMath::Cross( edge1, edge2, normal );
+        double relativePoint0[ 3 ] = { point0[ 0 ] - origin[ 0 ], point0[ 1 ] - origin[ 1 ], point0[ 2 ] - origin[ 2 ] };
+        volume += vtkMath::Dot( relativePoint0, normal ) / 6.0;
+        area += 0.5 * vtkMath::Norm( normal );
+      }
+      this->OutputBlockVolumes[ block ] = volume;
+      this->OutputBlockAreas[ block ] = area;
+    }
+  }
+
+private:
+  const SubdivisionMesh& Mesh;
+  std::vector< double >& OutputNormals;
+  std::vector< double >& OutputBlockVolumes;
+  std::vector< double >& OutputBlockAreas;
+};
+
+class PointNormalsFunctor
+{
+public:
+  PointNormalsFunctor( const SubdivisionMesh& mesh, const std::vector< double >& triangleNormals, float* outputNormals )
+    : Mesh( mesh )
+    , TriangleNormals( triangleNormals )
+    , OutputNormals( outputNormals )
+  {
+  }
+
+  void operator()( vtkIdType firstPointId, vtkIdType endPointId )
+  {
+    for ( vtkIdType pointId = firstPointId; pointId < endPointId; pointId++ )
+    {
+      double normal[ 3 ] = { 0.0, 0.0, 0.0 };
+      for ( vtkIdType i = this->Mesh.PointTriangleOffsets[ pointId ]; i < this->Mesh.PointTriangleOffsets[ pointId + 1 ]; i++ )
+      {
+        const double* triangleNormal = &( this->TriangleNormals[ 3 * this->Mesh.PointTriangles[ i ] ] );
+        normal[ 0 ] += triangleNormal[ 0 ];
+        normal[ 1 ] += triangleNormal[ 1 ];
+        normal[ 2 ] += triangleNormal[ 2 ];
+      }
+      vtkMath::Normalize( normal );
+      this->OutputNormals[ 3 * pointId ] = static_cast< float >( normal[ 0 ] );
+      this->OutputNormals[ 3 * pointId + 1 ] = static_cast< float >( normal[ 1 ] );
+      this->OutputNormals[ 3 * pointId + 2 ] = static_cast< float >( normal[ 2 ] );
+    }
+  }
+
+private:
+  const SubdivisionMesh& Mesh;
+  const std::vector< double >& TriangleNormals;
+  float* OutputNormals;
+};
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro( vtkSlicerMarkupsToModelSubdivisionFilter );
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelSubdivisionFilter::vtkSlicerMarkupsToModelSubdivisionFilter()
+{
+  this->NumberOfSubdivisions = 1;
+  this->ButterflyScheme = true;
+  this->ComputePointNormals = true;
+  this->SurfaceVolume = 0.0;
+  this->SurfaceArea = 0.0;
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelSubdivisionFilter::~vtkSlicerMarkupsToModelSubdivisionFilter()
+{
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelSubdivisionFilter::RequestData( vtkInformation* vtkNotUsed( request ),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector )
+{
+  vtkPolyData* input = vtkPolyData::GetData( inputVector[ 0 ] );
+  vtkPolyData* output = vtkPolyData::GetData( outputVector );
+  if ( input == NULL || output == NULL )
+  {
+    vtkErrorMacro( "Input or output is missing. No subdivision computed." );
+    return 0;
+  }
+
+  if ( !Subdivide( input, output, this->NumberOfSubdivisions, this->ButterflyScheme, this->ComputePointNormals, this,
+    &this->SurfaceVolume, &this->SurfaceArea ) && !this->GetAbortExecute() )
+  {
+    vtkErrorMacro( "Subdivision failed." );
+    return 0;
+  }
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelSubdivisionFilter::Subdivide( vtkPolyData* inputPolyData, vtkPolyData* outputPolyData, int numberOfSubdivisions,
+  bool butterflyScheme, bool computePointNormals, vtkAlgorithm* abortingAlgorithm, double* outputSurfaceVolume, double* outputSurfaceArea )
+{
+  if ( outputSurfaceVolume != NULL )
+  {
+    *outputSurfaceVolume = 0.0;
+  }
+  if ( outputSurfaceArea != NULL )
+  {
+    *outputSurfaceArea = 0.0;
+  }
+  if ( outputPolyData == NULL )
+  {
+    vtkGenericWarningMacro( "Output poly data is null. No subdivision computed." );
+    return false;
+  }
+  outputPolyData->Initialize();
+  if ( inputPolyData == NULL || numberOfSubdivisions < 0 )
+  {
+    vtkGenericWarningMacro( "Input poly data is null or the number of subdivisions is negative. No subdivision computed." );
+    return false;
+  }
+  vtkPoints* inputPoints = inputPolyData->GetPoints();
+  if ( inputPoints == NULL )
+  {
+    // nothing to subdivide
+    return true;
+  }
+
+  // triangles of the input, without the degenerate ones (they have no area and would not have 3 edges)
+  SubdivisionMesh mesh;
+  vtkIdType numberOfInputPoints = inputPoints->GetNumberOfPoints();
+  mesh.Coordinates.resize( 3 * numberOfInputPoints );
+  for ( vtkIdType i = 0; i < numberOfInputPoints; i++ )
+  {
+    inputPoints->GetPoint( i, &( mesh.Coordinates[ 3 * i ] ) );
+  }
+  vtkCellArray* inputPolys = inputPolyData->GetPolys();
+  if ( inputPolys != NULL )
+  {
+    mesh.Triangles.reserve( 3 * inputPolys->GetNumberOfCells() );
+    vtkIdType numberOfCellPoints = 0;
+    vtkIdType* cellPointIds = NULL;
+    for ( inputPolys->InitTraversal(); inputPolys->GetNextCell( numberOfCellPoints, cellPointIds ); )
+    {
+      for ( vtkIdType i = 2; i < numberOfCellPoints; i++ )
+      {
+        vtkIdType triangle[ 3 ] = { cellPointIds[ 0 ], cellPointIds[ i - 1 ], cellPointIds[ i ] };
+        if ( triangle[ 0 ] == triangle[ 1 ] || triangle[ 1 ] == triangle[ 2 ] || triangle[ 2 ] == triangle[ 0 ] )
+        {
+          continue;
+        }
+        mesh.Triangles.insert( mesh.Triangles.end(), triangle, triangle + 3 );
+      }
+    }
+  }
+
+  for ( int subdivision = 0; subdivision < numberOfSubdivisions && !mesh.Triangles.empty(); subdivision++ )
+  {
+    if ( abortingAlgorithm != NULL && abortingAlgorithm->GetAbortExecute() )
+    {
+      return false;
+    }
+    // edges
+    mesh.BuildPointTriangles();
+    mesh.AllocatePointNeighbors();
+    vtkIdType numberOfPoints = mesh.GetNumberOfPoints();
+    PointNeighborsFunctor pointNeighborsFunctor( mesh );
+    vtkSMPTools::For( 0, numberOfPoints, pointNeighborsFunctor );
+    mesh.ComputeEdgeOffsets();
+    EdgesFunctor edgesFunctor( mesh );
+    vtkSMPTools::For( 0, numberOfPoints, edgesFunctor );
+
+    // the existing points are kept, the edge points are appended
+    std::vector< double > subdividedCoordinates( 3 * ( numberOfPoints + mesh.GetNumberOfEdges() ) );
+    std::copy( mesh.Coordinates.begin(), mesh.Coordinates.end(), subdividedCoordinates.begin() );
+    EdgePointsFunctor edgePointsFunctor( mesh, butterflyScheme, subdividedCoordinates );
+    vtkSMPTools::For( 0, numberOfPoints, edgePointsFunctor );
+
+    std::vector< vtkIdType > subdividedTriangles( 4 * mesh.Triangles.size() );
+    SplitTrianglesFunctor splitTrianglesFunctor( mesh, subdividedTriangles );
+    vtkSMPTools::For( 0, mesh.GetNumberOfTriangles(), splitTrianglesFunctor );
+
+    mesh.Coordinates.swap( subdividedCoordinates );
+    mesh.Triangles.swap( subdividedTriangles );
+  }
+
+  if ( abortingAlgorithm != NULL && abortingAlgorithm->GetAbortExecute() )
+  {
+    return false;
+  }
+  vtkIdType numberOfPoints = mesh.GetNumberOfPoints();
+  vtkIdType numberOfTriangles = mesh.GetNumberOfTriangles();
+  vtkSmartPointer< vtkPoints > outputPoints = vtkSmartPointer< vtkPoints >::New();
+  outputPoints->SetDataType( inputPoints->GetDataType() );
+  outputPoints->SetNumberOfPoints( numberOfPoints );
+  for ( vtkIdType i = 0; i < numberOfPoints; i++ )
+  {
+    outputPoints->SetPoint( i, &( mesh.Coordinates[ 3 * i ] ) );
+  }
+  vtkSmartPointer< vtkIdTypeArray > outputCellIds = vtkSmartPointer< vtkIdTypeArray >::New();
+  vtkIdType* outputCellId = outputCellIds->WritePointer( 0, 4 * numberOfTriangles );
+  for ( vtkIdType i = 0; i < numberOfTriangles; i++ )
+  {
+    *( outputCellId++ ) = 3;
+    *( outputCellId++ ) = mesh.Triangles[ 3 * i ];
+    *( outputCellId++ ) = mesh.Triangles[ 3 * i + 1 ];
+    *( outputCellId++ ) = mesh.Triangles[ 3 * i + 2 ];
+  }
+  vtkSmartPointer< vtkCellArray > outputPolys = vtkSmartPointer< vtkCellArray >::New();
+  outputPolys->SetCells( numberOfTriangles, outputCellIds );
+  outputPolyData->SetPoints( outputPoints );
+  outputPolyData->SetPolys( outputPolys );
+
+  if ( computePointNormals )
+  {
+    mesh.BuildPointTriangles();
+    std::vector< double > triangleNormals( 3 * numberOfTriangles );
+    vtkIdType numberOfBlocks = ( numberOfTriangles + SUBDIVISION_MEASURES_BLOCK_SIZE - 1 ) / SUBDIVISION_MEASURES_BLOCK_SIZE;
+    std::vector< double > blockVolumes( numberOfBlocks );
+    std::vector< double > blockAreas( numberOfBlocks );
+    TriangleNormalsFunctor triangleNormalsFunctor( mesh, triangleNormals, blockVolumes, blockAreas );
+    vtkSMPTools::For( 0, numberOfBlocks, 1, triangleNormalsFunctor );
+    double surfaceVolume = 0.0;
+    double surfaceArea = 0.0;
+    for ( vtkIdType block = 0; block < numberOfBlocks; block++ )
+    {
+      surfaceVolume += blockVolumes[ block ];
+      surfaceArea += blockAreas[ block ];
+    }
+    if ( outputSurfaceVolume != NULL )
+    {
+      *outputSurfaceVolume = surfaceVolume;
+    }
+    if ( outputSurfaceArea != NULL )
+    {
+      *outputSurfaceArea = surfaceArea;
+    }
+    vtkSmartPointer< vtkFloatArray > outputNormals = vtkSmartPointer< vtkFloatArray >::New();
+    outputNormals->SetName( "Normals" );
+    outputNormals->SetNumberOfComponents( 3 );
+    outputNormals->SetNumberOfTuples( numberOfPoints );
+    PointNormalsFunctor pointNormalsFunctor( mesh, triangleNormals, outputNormals->GetPointer( 0 ) );
+    vtkSMPTools::For( 0, numberOfPoints, pointNormalsFunctor );
+    outputPolyData->GetPointData()->SetNormals( outputNormals );
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelSubdivisionFilter::PrintSelf( ostream &os, vtkIndent indent )
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfSubdivisions: " << this->NumberOfSubdivisions << std::endl;
+  os << indent << "ButterflyScheme: " << ( this->ButterflyScheme ? "true" : "false" ) << std::endl;
+  os << indent << "ComputePointNormals: " << ( this->ComputePointNormals ? "true" : "false" ) << std::endl;
+  os << indent << "SurfaceVolume: " << this->SurfaceVolume << std::endl;
+  os << indent << "SurfaceArea: " << this->SurfaceArea << std::endl;
+}
@@ -0,0 +1,77 @@
+#ifndef __vtkSlicerMarkupsToModelSubdivisionFilter_h
+#define __vtkSlicerMarkupsToModelSubdivisionFilter_h
+
+// vtk includes
+#include <vtkPolyDataAlgorithm.h>
+
+#include "vtkSlicerMarkupsToModelModuleLogicExport.h"
+
+// Interpolating subdivision of a triangle mesh, that computes the point normals of the result in the same pass.
+// Each subdivision inserts a point on each edge and splits every triangle into 4 triangles, the existing points are kept.
+// With the butterfly scheme the edge points are computed with the modified butterfly scheme (Zorin, Schroeder, Sweldens:
+// Interpolating subdivision for meshes with arbitrary topology, 1996), the same as in vtkButterflySubdivisionFilter,
+// otherwise they are the edge midpoints, as in vtkLinearSubdivisionFilter. Edges that are not shared by two triangles,
+// or that have an endpoint that is not surrounded by a single fan of triangles, are split at their midpoint.
+// The point normals are the area weighted averages of the normals of the triangles around the points, so they follow
+// the orientation of the triangles, which is kept by the subdivision. The enclosed volume and the area of the surface
+// are summed from the same triangle normals.
+// The edges are indexed without a hash table or locks: each edge belongs to its endpoint with the smaller id, and the
+// edges of each point are stored in order of their other endpoint. Therefore the edge points, the triangles and the
+// normals can all be computed in parallel (using vtkSMPTools), and the result does not depend on the number of threads.
+// Only the polygons of the input are used, polygons with more than 3 points are triangulated. The output contains the
+// points and the triangles, and the normals if they are computed.
+class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelSubdivisionFilter : public vtkPolyDataAlgorithm
+{
+  public:
+    // standard vtk object methods
+    vtkTypeMacro( vtkSlicerMarkupsToModelSubdivisionFilter, vtkPolyDataAlgorithm );
+    void PrintSelf( ostream& os, vtkIndent indent ) VTK_OVERRIDE;
+    static vtkSlicerMarkupsToModelSubdivisionFilter *New();
+
+    // Number of times the triangles are subdivided, each subdivision quadruples the number of triangles. Default is 1.
+    vtkGetMacro( NumberOfSubdivisions, int );
+    vtkSetMacro( NumberOfSubdivisions, int );
+    // If enabled then the modified butterfly scheme is used (smooth surface), otherwise the edges are split at their midpoints.
+    // Default is on.
+    vtkGetMacro( ButterflyScheme, bool );
+    vtkSetMacro( ButterflyScheme, bool );
+    vtkBooleanMacro( ButterflyScheme, bool );
+    // If enabled then point normals are computed (in the "Normals" array). Default is on.
+    vtkGetMacro( ComputePointNormals, bool );
+    vtkSetMacro( ComputePointNormals, bool );
+    vtkBooleanMacro( ComputePointNormals, bool );
+
+    // Volume enclosed by the output and area of the output, computed together with the point normals (0 if they are
+    // not computed). The volume is the sum of the signed volumes of the tetrahedra between the triangles and the first point,
+    // the same as in vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeSurfaceMeasures.
+    vtkGetMacro( SurfaceVolume, double );
+    vtkGetMacro( SurfaceArea, double );
+
+    // Subdivide the triangles of the input. Returns false if the inputs are invalid, in this case the output is empty.
+    // If abortingAlgorithm is specified then its AbortExecute flag is checked before each subdivision level and before
+    // the output is created, if it is set then the subdivision stops with an empty output and false is returned.
+    // If the point normals are computed then the enclosed volume and the area of the output are stored in outputSurfaceVolume
+    // and outputSurfaceArea (if specified), otherwise they are set to 0.
+    static bool Subdivide( vtkPolyData* inputPolyData, vtkPolyData* outputPolyData, int numberOfSubdivisions,
+      bool butterflyScheme = true, bool computePointNormals = true, vtkAlgorithm* abortingAlgorithm = NULL,
+      double* outputSurfaceVolume = NULL, double* outputSurfaceArea = NULL );
+
+  protected:
+    vtkSlicerMarkupsToModelSubdivisionFilter();
+    ~vtkSlicerMarkupsToModelSubdivisionFilter();
+
+    int RequestData( vtkInformation* request, vtkInformationVector** inputVector, vtkInformationVector* outputVector ) VTK_OVERRIDE;
+
+    int NumberOfSubdivisions;
+    bool ButterflyScheme;
+    bool ComputePointNormals;
+    double SurfaceVolume;
+    double SurfaceArea;
+
+  private:
+    // not used
+    vtkSlicerMarkupsToModelSubdivisionFilter ( const vtkSlicerMarkupsToModelSubdivisionFilter& ) VTK_DELETE_FUNCTION;
+    void operator= ( const vtkSlicerMarkupsToModelSubdivisionFilter& ) VTK_DELETE_FUNCTION;
+};
+
+#endif
@@ -0,0 +1,1141 @@
+#include "vtkSlicerMarkupsToModelTubeGeneration.h"
+
+// vtk includes
+#include <vtkCellArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkFieldData.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkIntArray.h>
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSMPTools.h>
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// constants within this file
+static const double TUBE_GENERATION_EPSILON = 1e-12;
+static const int TUBE_MINIMUM_NUMBER_OF_SIDES = 3; // same as vtkTubeFilter
+static const char* CENTERLINE_RADIUS_ARRAY_NAME = "TubeRadius";
+static const char* CENTERLINE_NUMBER_OF_SIDES_ARRAY_NAME = "TubeNumberOfSides";
+static const char* CURVE_ARC_LENGTH_ARRAY_NAME = "ArcLength";
+static const char* CURVE_CURVATURE_ARRAY_NAME = "Curvature";
+static const char* CURVE_TORSION_ARRAY_NAME = "Torsion";
+static const char* CURVE_LENGTH_ARRAY_NAME = "CurveLength";
+
+//------------------------------------------------------------------------------
+// Move the tube normal from the previous curve point to the current one by the double reflection
+// method, which approximates a rotation minimizing frame (the tube does not twist around the curve).
+static void TransportTubeNormal(const double previousPoint[3], const double previousTangent[3], const double previousNormal[3],
+  const double point[3], const double tangent[3], double normal[3])
+{
+  double reflectionAxis[3] = { point[0] - previousPoint[0], point[1] - previousPoint[1], point[2] - previousPoint[2] };
+  double reflectionAxisLengthSquared = vtkMath::Dot(reflectionAxis, reflectionAxis);
+  double reflectedNormal[3] = { previousNormal[0], previousNormal[1], previousNormal[2] };
+  double reflectedTangent[3] = { previousTangent[0], previousTangent[1], previousTangent[2] };
+  if (reflectionAxisLengthSquared > TUBE_GENERATION_EPSILON)
+  {
+    double normalFactor = 2.0 * vtkMath::Dot(reflectionAxis, previousNormal) / reflectionAxisLengthSquared;
+    double tangentFactor = 2.0 * vtkMath::Dot(reflectionAxis, previousTangent) / reflectionAxisLengthSquared;
+    for (int d = 0; d < 3; d++)
+    {
+      reflectedNormal[d] -= normalFactor * reflectionAxis[d];
+      reflectedTangent[d] -= tangentFactor * reflectionAxis[d];
+    }
+  }
+  double secondReflectionAxis[3] = { tangent[0] - reflectedTangent[0], tangent[1] - reflectedTangent[1], tangent[2] - reflectedTangent[2] };
+  double secondReflectionAxisLengthSquared = vtkMath::Dot(secondReflectionAxis, secondReflectionAxis);
+  normal[0] = reflectedNormal[0];
+  normal[1] = reflectedNormal[1];
+  normal[2] = reflectedNormal[2];
+  if (secondReflectionAxisLengthSquared > TUBE_GENERATION_EPSILON)
+  {
+    double normalFactor = 2.0 * vtkMath::Dot(secondReflectionAxis, reflectedNormal) / secondReflectionAxisLengthSquared;
+    for (int d = 0; d < 3; d++)
+    {
+      normal[d] -= normalFactor * secondReflectionAxis[d];
+    }
+  }
+
+  // remove accumulated numerical error
+  double tangentComponent = vtkMath::Dot(normal, tangent);
+  for (int d = 0; d < 3; d++)
+  {
+    normal[d] -= tangentComponent * tangent[d];
+  }
+  if (vtkMath::Normalize(normal) < TUBE_GENERATION_EPSILON)
+  {
+    double unused[3];
+    vtkMath::Perpendiculars(tangent, normal, unused, 0.0);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Rotate a vector that is perpendicular to the unit length axis around that axis
+static void RotatePerpendicularVector(const double axis[3], double angle, double vector[3])
+{
+  double axisCrossVector[3];
+  vtkMath::Cross(axis, vector, axisCrossVector);
+  double cosAngle = cos(angle);
+  double sinAngle = sin(angle);
+  for (int d = 0; d < 3; d++)
+  {
+    vector[d] = cosAngle * vector[d] + sinAngle * axisCrossVector[d];
+  }
+}
+
+//------------------------------------------------------------------------------
+// Compute the directions of the vertices of a tube ring, relative to the tube normal and binormal
+static void ComputeTubeCrossSection(int tubeNumberOfSides, std::vector< double >& cosines, std::vector< double >& sines)
+{
+  cosines.resize(tubeNumberOfSides);
+  sines.resize(tubeNumberOfSides);
+  for (int k = 0; k < tubeNumberOfSides; k++)
+  {
+    double angle = 2.0 * vtkMath::Pi() * k / tubeNumberOfSides;
+    cosines[k] = cos(angle);
+    sines[k] = sin(angle);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Cross-section of tubes with the most common numbers of sides, shared by all tubes.
+// The tables are filled when the library is loaded (see TubeCrossSectionInitializer), before any tube
+// can be generated, therefore they can be read by multiple threads without synchronization.
+template< int NumberOfSides >
+struct TubeCrossSection
+{
+  static double Cosines[NumberOfSides];
+  static double Sines[NumberOfSides];
+
+  static void Initialize()
+  {
+    std::vector< double > cosines;
+    std::vector< double > sines;
+    ComputeTubeCrossSection(NumberOfSides, cosines, sines);
+    std::copy(cosines.begin(), cosines.end(), Cosines);
+    std::copy(sines.begin(), sines.end(), Sines);
+  }
+};
+
+template< int NumberOfSides > double TubeCrossSection< NumberOfSides >::Cosines[NumberOfSides];
+template< int NumberOfSides > double TubeCrossSection< NumberOfSides >::Sines[NumberOfSides];
+
+class TubeCrossSectionInitializer
+{
+public:
+  TubeCrossSectionInitializer()
+  {
+    TubeCrossSection< 4 >::Initialize();
+    TubeCrossSection< 6 >::Initialize();
+    TubeCrossSection< 8 >::Initialize();
+    TubeCrossSection< 12 >::Initialize();
+    TubeCrossSection< 16 >::Initialize();
+  }
+};
+static TubeCrossSectionInitializer TubeCrossSectionTables;
+
+//------------------------------------------------------------------------------
+// Write the vertices and vertex normals of the tube rings of the curve points between firstCurvePoint
+// and lastCurvePoint (inclusive) into float arrays.
+// If NumberOfSides is not 0 then it must be equal to tubeNumberOfSides. The number of iterations of the
+// inner loop is then a compile-time constant, so the compiler can fully unroll it.
+template< int NumberOfSides >
+static void WriteTubeRings(vtkPoints* curvePoints, const double* tubeNormals, double tubeRadius, int tubeNumberOfSides,
+  const double* cosines, const double* sines, vtkIdType firstCurvePoint, vtkIdType lastCurvePoint,
+  float* outputPoints, float* outputNormals)
+{
+  const int numberOfSides = (NumberOfSides > 0 ? NumberOfSides : tubeNumberOfSides);
+  for (vtkIdType i = firstCurvePoint; i <= lastCurvePoint; i++)
+  {
+    double center[3];
+    curvePoints->GetPoint(i, center);
+    double tangent[3];
+    vtkSlicerMarkupsToModelTubeGeneration::GetCurveTangent(curvePoints, i, tangent);
+    const double* normal = tubeNormals + 3 * i;
+    double binormal[3];
+    vtkMath::Cross(tangent, normal, binormal);
+    float* ringPoints = outputPoints + 3 * i * numberOfSides;
+    float* ringNormals = outputNormals + 3 * i * numberOfSides;
+    for (int k = 0; k < numberOfSides; k++)
+    {
+      for (int d = 0; d < 3; d++)
+      {
+        double direction = cosines[k] * normal[d] + sines[k] * binormal[d];
+        ringPoints[3 * k + d] = static_cast< float >(center[d] + tubeRadius * direction);
+        ringNormals[3 * k + d] = static_cast< float >(direction);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Compute the unit binormal of the circle through a curve point and its two neighbors.
+// Returns false if the binormal is not defined (at the ends of the curve and where the three points are on a line).
+static bool GetCurveBinormal(vtkPoints* curvePoints, vtkIdType curvePointIndex, double binormal[3], double* curvature)
+{
+  if (curvePointIndex < 1 || curvePointIndex + 1 >= curvePoints->GetNumberOfPoints())
+  {
+    return false;
+  }
+  double previousPoint[3];
+  curvePoints->GetPoint(curvePointIndex - 1, previousPoint);
+  double point[3];
+  curvePoints->GetPoint(curvePointIndex, point);
+  double nextPoint[3];
+  curvePoints->GetPoint(curvePointIndex + 1, nextPoint);
+  double previousEdge[3] = { point[0] - previousPoint[0], point[1] - previousPoint[1], point[2] - previousPoint[2] };
+  double nextEdge[3] = { nextPoint[0] - point[0], nextPoint[1] - point[1], nextPoint[2] - point[2] };
+  double previousEdgeLength = vtkMath::Norm(previousEdge);
+  double nextEdgeLength = vtkMath::Norm(nextEdge);
+  vtkMath::Cross(previousEdge, nextEdge, binormal);
+  double binormalLength = vtkMath::Normalize(binormal);
+  if (binormalLength <= TUBE_GENERATION_EPSILON * previousEdgeLength * nextEdgeLength || binormalLength < TUBE_GENERATION_EPSILON)
+  {
+    return false;
+  }
+  if (curvature != NULL)
+  {
+    // inverse of the radius of the circle through the three points
+    double chordLength = sqrt(vtkMath::Distance2BetweenPoints(previousPoint, nextPoint));
+    *curvature = 2.0 * binormalLength / (previousEdgeLength * nextEdgeLength * chordLength);
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Get a field data array with one value for each curve point, allocating it if it does not exist
+// and growing it if curve points were appended. Returns the number of values that were already in the array.
+template< class ArrayType, typename ValueType >
+static vtkIdType GetCurveMeasureArray(vtkPolyData* polyData, const char* arrayName, vtkIdType numberCurvePoints, ValueType*& values)
+{
+  ArrayType* array = ArrayType::SafeDownCast(polyData->GetFieldData()->GetArray(arrayName));
+  vtkIdType numberOfExistingValues = 0;
+  if (array == NULL || array->GetNumberOfComponents() != 1 || array->GetNumberOfTuples() > numberCurvePoints)
+  {
+    vtkSmartPointer< ArrayType > newArray = vtkSmartPointer< ArrayType >::New();
+    newArray->SetName(arrayName);
+    newArray->SetNumberOfTuples(numberCurvePoints);
+    polyData->GetFieldData()->AddArray(newArray);
+    array = newArray;
+  }
+  else
+  {
+    numberOfExistingValues = array->GetNumberOfTuples();
+    // the tube is grown by AppendTubeRings, the array grows geometrically the same way as the points
+    for (vtkIdType i = numberOfExistingValues; i < numberCurvePoints; i++)
+    {
+      array->InsertNextValue(0);
+    }
+  }
+  array->Modified();
+  values = array->GetPointer(0);
+  return numberOfExistingValues;
+}
+
+//------------------------------------------------------------------------------
+static const int NUMBER_OF_CELL_TYPES = 4; // verts, lines, polys, strips
+
+static vtkCellArray* GetCellsOfType(vtkPolyData* polyData, int cellType)
+{
+  switch (cellType)
+  {
+    case 0: return polyData->GetVerts();
+    case 1: return polyData->GetLines();
+    case 2: return polyData->GetPolys();
+    default: return polyData->GetStrips();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Copies each input model into its part of the combined arrays. The parts do not overlap,
+// so the inputs can be copied concurrently.
+class CombineModelsFunctor
+{
+public:
+  CombineModelsFunctor(const std::vector< vtkPolyData* >& inputPolyDatas, const std::vector< vtkIdType >& pointOffsets,
+    const std::vector< vtkIdType >& connectivityOffsets, float* outputPoints, float* outputNormals, vtkIdType* outputConnectivity[NUMBER_OF_CELL_TYPES])
+    : InputPolyDatas(inputPolyDatas)
+    , PointOffsets(pointOffsets)
+    , ConnectivityOffsets(connectivityOffsets)
+    , OutputPoints(outputPoints)
+    , OutputNormals(outputNormals)
+  {
+    for (int cellType = 0; cellType < NUMBER_OF_CELL_TYPES; cellType++)
+    {
+      this->OutputConnectivity[cellType] = outputConnectivity[cellType];
+    }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for (vtkIdType inputIndex = begin; inputIndex < end; inputIndex++)
+    {
+      vtkPolyData* inputPolyData = this->InputPolyDatas[inputIndex];
+      vtkIdType pointOffset = this->PointOffsets[inputIndex];
+      vtkIdType numberOfPoints = this->PointOffsets[inputIndex + 1] - pointOffset;
+      if (numberOfPoints > 0)
+      {
+        vtkFloatArray* inputPointsArray = vtkFloatArray::SafeDownCast(inputPolyData->GetPoints()->GetData());
+        float* outputPoints = this->OutputPoints + 3 * pointOffset;
+        if (inputPointsArray != NULL)
+        {
+          memcpy(outputPoints, inputPointsArray->GetPointer(0), 3 * numberOfPoints * sizeof(float));
+        }
+        else
+        {
+          for (vtkIdType i = 0; i < numberOfPoints; i++)
+          {
+            double* point = inputPolyData->GetPoints()->GetPoint(i);
+            outputPoints[3 * i] = static_cast< float >(point[0]);
+            outputPoints[3 * i + 1] = static_cast< float >(point[1]);
+            outputPoints[3 * i + 2] = static_cast< float >(point[2]);
+          }
+        }
+      }
+      if (numberOfPoints > 0 && this->OutputNormals != NULL)
+      {
+        vtkDataArray* inputNormals = inputPolyData->GetPointData()->GetNormals();
+        vtkFloatArray* inputNormalsArray = vtkFloatArray::SafeDownCast(inputNormals);
+        float* outputNormals = this->OutputNormals + 3 * pointOffset;
+        if (inputNormalsArray != NULL)
+        {
+          memcpy(outputNormals, inputNormalsArray->GetPointer(0), 3 * numberOfPoints * sizeof(float));
+        }
+        else
+        {
+          for (vtkIdType i = 0; i < numberOfPoints; i++)
+          {
+            double* normal = inputNormals->GetTuple3(i);
+            outputNormals[3 * i] = static_cast< float >(normal[0]);
+            outputNormals[3 * i + 1] = static_cast< float >(normal[1]);
+            outputNormals[3 * i + 2] = static_cast< float >(normal[2]);
+          }
+        }
+      }
+      for (int cellType = 0; cellType < NUMBER_OF_CELL_TYPES; cellType++)
+      {
+        vtkCellArray* inputCells = GetCellsOfType(inputPolyData, cellType);
+        vtkIdType connectivityOffset = this->ConnectivityOffsets[NUMBER_OF_CELL_TYPES * inputIndex + cellType];
+        vtkIdType connectivitySize = this->ConnectivityOffsets[NUMBER_OF_CELL_TYPES * (inputIndex + 1) + cellType] - connectivityOffset;
+        if (connectivitySize == 0)
+        {
+          continue;
+        }
+        // the cell sizes are copied, the point ids are shifted to the part of the input
+        const vtkIdType* inputIds = inputCells->GetPointer();
+        vtkIdType* outputIds = this->OutputConnectivity[cellType] + connectivityOffset;
+        vtkIdType position = 0;
+        while (position < connectivitySize)
+        {
+          vtkIdType numberOfCellPoints = inputIds[position];
+          outputIds[position++] = numberOfCellPoints;
+          for (vtkIdType j = 0; j < numberOfCellPoints; j++, position++)
+          {
+            outputIds[position] = inputIds[position] + pointOffset;
+          }
+        }
+      }
+    }
+  }
+
+private:
+  const std::vector< vtkPolyData* >& InputPolyDatas;
+  const std::vector< vtkIdType >& PointOffsets;
+  const std::vector< vtkIdType >& ConnectivityOffsets;
+  float* OutputPoints;
+  float* OutputNormals;
+  vtkIdType* OutputConnectivity[NUMBER_OF_CELL_TYPES];
+};
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerMarkupsToModelTubeGeneration);
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelTubeGeneration::vtkSlicerMarkupsToModelTubeGeneration()
+{
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelTubeGeneration::~vtkSlicerMarkupsToModelTubeGeneration()
+{
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelTubeGeneration::GenerateTubeModel(vtkPoints* curvePoints, vtkPolyData* outputTubePolyData, double tubeRadius, int tubeNumberOfSides)
+{
+  if (curvePoints == NULL)
+  {
+    vtkGenericWarningMacro("Curve points are null. No model generated.");
+    return;
+  }
+
+  if (outputTubePolyData == NULL)
+  {
+    vtkGenericWarningMacro("Output tube poly data is null. No model generated.");
+    return;
+  }
+
+  vtkIdType numberCurvePoints = curvePoints->GetNumberOfPoints();
+  vtkSlicerMarkupsToModelTubeGeneration::AllocateTubePolyData(numberCurvePoints, tubeRadius, tubeNumberOfSides, outputTubePolyData);
+  if (numberCurvePoints == 0)
+  {
+    return;
+  }
+  std::vector< double > tubeNormals(3 * numberCurvePoints, 0.0);
+  if (tubeRadius > 0.0)
+  {
+    vtkSlicerMarkupsToModelTubeGeneration::ComputeTubeNormals(curvePoints, &(tubeNormals[0]), 0, numberCurvePoints - 1, false);
+  }
+  vtkSlicerMarkupsToModelTubeGeneration::UpdateTubeRings(curvePoints, &(tubeNormals[0]), tubeRadius, tubeNumberOfSides,
+    outputTubePolyData, 0, numberCurvePoints - 1);
+  vtkSlicerMarkupsToModelTubeGeneration::UpdateCurveMeasures(curvePoints, tubeRadius, tubeNumberOfSides,
+    outputTubePolyData, 0, numberCurvePoints - 1);
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelTubeGeneration::GenerateCenterlineModel(vtkPoints* curvePoints, vtkPolyData* outputCenterlinePolyData, double tubeRadius, int tubeNumberOfSides)
+{
+  if (curvePoints == NULL)
+  {
+    vtkGenericWarningMacro("Curve points are null. No model generated.");
+    return;
+  }
+
+  if (outputCenterlinePolyData == NULL)
+  {
+    vtkGenericWarningMacro("Output centerline poly data is null. No model generated.");
+    return;
+  }
+
+  // polyline
+  vtkSlicerMarkupsToModelTubeGeneration::GenerateTubeModel(curvePoints, outputCenterlinePolyData, 0.0, tubeNumberOfSides);
+
+  vtkIdType numberCurvePoints = curvePoints->GetNumberOfPoints();
+  std::vector< double > tubeNormals(3 * std::max(numberCurvePoints, (vtkIdType)1), 0.0);
+  if (numberCurvePoints > 0)
+  {
+    vtkSlicerMarkupsToModelTubeGeneration::ComputeTubeNormals(curvePoints, &(tubeNormals[0]), 0, numberCurvePoints - 1, false);
+  }
+  vtkSmartPointer< vtkFloatArray > outputNormals = vtkSmartPointer< vtkFloatArray >::New();
+  outputNormals->SetName("TubeNormals");
+  outputNormals->SetNumberOfComponents(3);
+  outputNormals->SetNumberOfTuples(numberCurvePoints);
+  vtkSmartPointer< vtkFloatArray > outputRadii = vtkSmartPointer< vtkFloatArray >::New();
+  outputRadii->SetName(CENTERLINE_RADIUS_ARRAY_NAME);
+  outputRadii->SetNumberOfTuples(numberCurvePoints);
+  float* normalsPointer = outputNormals->GetPointer(0);
+  float* radiiPointer = outputRadii->GetPointer(0);
+  for (vtkIdType i = 0; i < numberCurvePoints; i++)
+  {
+    normalsPointer[3 * i] = static_cast< float >(tubeNormals[3 * i]);
+    normalsPointer[3 * i + 1] = static_cast< float >(tubeNormals[3 * i + 1]);
+    normalsPointer[3 * i + 2] = static_cast< float >(tubeNormals[3 * i + 2]);
+    radiiPointer[i] = static_cast< float >(tubeRadius);
+  }
+  outputCenterlinePolyData->GetPointData()->SetNormals(outputNormals);
+  outputCenterlinePolyData->GetPointData()->AddArray(outputRadii);
+
+  vtkSmartPointer< vtkIntArray > outputNumberOfSides = vtkSmartPointer< vtkIntArray >::New();
+  outputNumberOfSides->SetName(CENTERLINE_NUMBER_OF_SIDES_ARRAY_NAME);
+  outputNumberOfSides->InsertNextValue(std::max(tubeNumberOfSides, TUBE_MINIMUM_NUMBER_OF_SIDES));
+  outputCenterlinePolyData->GetFieldData()->AddArray(outputNumberOfSides);
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelTubeGeneration::GenerateTubeModelFromCenterline(vtkPolyData* centerlinePolyData, vtkPolyData* outputTubePolyData, int tubeNumberOfSides)
+{
+  if (centerlinePolyData == NULL || outputTubePolyData == NULL)
+  {
+    vtkGenericWarningMacro("Centerline or output tube poly data is null. No model generated.");
+    return;
+  }
+
+  vtkPoints* curvePoints = centerlinePolyData->GetPoints();
+  vtkDataArray* centerlineNormals = centerlinePolyData->GetPointData()->GetNormals();
+  vtkDataArray* centerlineRadii = centerlinePolyData->GetPointData()->GetArray(CENTERLINE_RADIUS_ARRAY_NAME);
+  if (curvePoints == NULL || curvePoints->GetNumberOfPoints() == 0 || centerlineNormals == NULL || centerlineRadii == NULL
+    || centerlineNormals->GetNumberOfComponents() != 3 || centerlineNormals->GetNumberOfTuples() != curvePoints->GetNumberOfPoints()
+    || centerlineRadii->GetNumberOfTuples() == 0)
+  {
+    vtkGenericWarningMacro("Centerline does not contain the tube parameters. No model generated.");
+    return;
+  }
+  if (tubeNumberOfSides <= 0)
+  {
+    vtkDataArray* centerlineNumberOfSides = centerlinePolyData->GetFieldData()->GetArray(CENTERLINE_NUMBER_OF_SIDES_ARRAY_NAME);
+    tubeNumberOfSides = (centerlineNumberOfSides != NULL && centerlineNumberOfSides->GetNumberOfTuples() > 0)
+      ? static_cast< int >(centerlineNumberOfSides->GetTuple1(0)) : TUBE_MINIMUM_NUMBER_OF_SIDES;
+  }
+
+  // the radius is the same at all points
+  double tubeRadius = centerlineRadii->GetTuple1(0);
+  vtkIdType numberCurvePoints = curvePoints->GetNumberOfPoints();
+  std::vector< double > tubeNormals(3 * numberCurvePoints);
+  for (vtkIdType i = 0; i < numberCurvePoints; i++)
+  {
+    centerlineNormals->GetTuple(i, &(tubeNormals[3 * i]));
+  }
+  vtkSlicerMarkupsToModelTubeGeneration::AllocateTubePolyData(numberCurvePoints, tubeRadius, tubeNumberOfSides, outputTubePolyData);
+  vtkSlicerMarkupsToModelTubeGeneration::UpdateTubeRings(curvePoints, &(tubeNormals[0]), tubeRadius, tubeNumberOfSides,
+    outputTubePolyData, 0, numberCurvePoints - 1);
+  vtkSlicerMarkupsToModelTubeGeneration::UpdateCurveMeasures(curvePoints, tubeRadius, tubeNumberOfSides,
+    outputTubePolyData, 0, numberCurvePoints - 1);
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelTubeGeneration::AllocateTubePolyData(vtkIdType numberCurvePoints, double tubeRadius, int tubeNumberOfSides, vtkPolyData* outputTubePolyData)
+{
+  if (outputTubePolyData == NULL)
+  {
+    vtkGenericWarningMacro("Output tube poly data is null. No model generated.");
+    return;
+  }
+
+  outputTubePolyData->Initialize();
+  vtkSmartPointer< vtkPoints > outputPoints = vtkSmartPointer< vtkPoints >::New();
+  outputPoints->SetDataTypeToFloat();
+
+  if (tubeRadius <= 0.0)
+  {
+    // polyline through the curve points
+    outputPoints->SetNumberOfPoints(numberCurvePoints);
+    vtkSmartPointer< vtkIdTypeArray > lineConnectivity = vtkSmartPointer< vtkIdTypeArray >::New();
+    lineConnectivity->SetNumberOfValues(numberCurvePoints + 1);
+    vtkIdType* lineIds = lineConnectivity->GetPointer(0);
+    lineIds[0] = numberCurvePoints;
+    for (vtkIdType i = 0; i < numberCurvePoints; i++)
+    {
+      lineIds[i + 1] = i;
+    }
+    vtkSmartPointer< vtkCellArray > lines = vtkSmartPointer< vtkCellArray >::New();
+    lines->SetCells(1, lineConnectivity);
+    outputTubePolyData->SetPoints(outputPoints);
+    outputTubePolyData->SetLines(lines);
+    return;
+  }
+
+  if (numberCurvePoints < 2)
+  {
+    // vtkTubeFilter does not generate any output in this case either
+    return;
+  }
+  tubeNumberOfSides = std::max(tubeNumberOfSides, TUBE_MINIMUM_NUMBER_OF_SIDES);
+
+  vtkIdType numberOfTubePoints = numberCurvePoints * tubeNumberOfSides;
+  outputPoints->SetNumberOfPoints(numberOfTubePoints);
+  vtkSmartPointer< vtkFloatArray > outputNormals = vtkSmartPointer< vtkFloatArray >::New();
+  outputNormals->SetName("TubeNormals");
+  outputNormals->SetNumberOfComponents(3);
+  outputNormals->SetNumberOfTuples(numberOfTubePoints);
+
+  // one triangle strip for each side
+  vtkSmartPointer< vtkIdTypeArray > stripConnectivity = vtkSmartPointer< vtkIdTypeArray >::New();
+  stripConnectivity->SetNumberOfValues(tubeNumberOfSides * (2 * numberCurvePoints + 1));
+  vtkIdType* stripIds = stripConnectivity->GetPointer(0);
+  for (int k = 0; k < tubeNumberOfSides; k++)
+  {
+    *(stripIds++) = 2 * numberCurvePoints;
+    int nextK = (k + 1) % tubeNumberOfSides;
+    for (vtkIdType i = 0; i < numberCurvePoints; i++)
+    {
+      *(stripIds++) = i * tubeNumberOfSides + k;
+      *(stripIds++) = i * tubeNumberOfSides + nextK;
+    }
+  }
+  vtkSmartPointer< vtkCellArray > strips = vtkSmartPointer< vtkCellArray >::New();
+  strips->SetCells(tubeNumberOfSides, stripConnectivity);
+
+  // caps, oriented outward
+  vtkSmartPointer< vtkIdTypeArray > capConnectivity = vtkSmartPointer< vtkIdTypeArray >::New();
+  capConnectivity->SetNumberOfValues(2 * (tubeNumberOfSides + 1));
+  vtkIdType* capIds = capConnectivity->GetPointer(0);
+  *(capIds++) = tubeNumberOfSides;
+  for (int k = tubeNumberOfSides - 1; k >= 0; k--)
+  {
+    *(capIds++) = k;
+  }
+  vtkIdType lastRingOffset = (numberCurvePoints - 1) * tubeNumberOfSides;
+  *(capIds++) = tubeNumberOfSides;
+  for (int k = 0; k < tubeNumberOfSides; k++)
+  {
+    *(capIds++) = lastRingOffset + k;
+  }
+  vtkSmartPointer< vtkCellArray > caps = vtkSmartPointer< vtkCellArray >::New();
+  caps->SetCells(2, capConnectivity);
+
+  outputTubePolyData->SetPoints(outputPoints);
+  outputTubePolyData->SetStrips(strips);
+  outputTubePolyData->SetPolys(caps);
+  outputTubePolyData->GetPointData()->SetNormals(outputNormals);
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelTubeGeneration::AppendTubeRings(vtkIdType numberCurvePoints, double tubeRadius, int tubeNumberOfSides, vtkPolyData* outputTubePolyData)
+{
+  if (outputTubePolyData == NULL)
+  {
+    vtkGenericWarningMacro("Output tube poly data is null. No tube rings appended.");
+    return;
+  }
+
+  // a polyline has a single point in each "ring"
+  bool isTube = (tubeRadius > 0.0);
+  int pointsPerRing = isTube ? std::max(tubeNumberOfSides, TUBE_MINIMUM_NUMBER_OF_SIDES) : 1;
+
+  vtkPoints* outputPoints = outputTubePolyData->GetPoints();
+  if (outputPoints == NULL)
+  {
+    vtkSmartPointer< vtkPoints > newPoints = vtkSmartPointer< vtkPoints >::New();
+    newPoints->SetDataTypeToFloat();
+    outputTubePolyData->SetPoints(newPoints);
+    outputPoints = newPoints;
+    if (isTube)
+    {
+      vtkSmartPointer< vtkFloatArray > newNormals = vtkSmartPointer< vtkFloatArray >::New();
+      newNormals->SetName("TubeNormals");
+      newNormals->SetNumberOfComponents(3);
+      outputTubePolyData->GetPointData()->SetNormals(newNormals);
+      vtkSmartPointer< vtkCellArray > newStrips = vtkSmartPointer< vtkCellArray >::New();
+      outputTubePolyData->SetStrips(newStrips);
+    }
+    else
+    {
+      vtkSmartPointer< vtkCellArray > newLines = vtkSmartPointer< vtkCellArray >::New();
+      outputTubePolyData->SetLines(newLines);
+    }
+  }
+
+  vtkIdType currentNumberCurvePoints = outputPoints->GetNumberOfPoints() / pointsPerRing;
+  if (numberCurvePoints <= currentNumberCurvePoints)
+  {
+    return;
+  }
+  vtkDataArray* outputNormals = outputTubePolyData->GetPointData()->GetNormals();
+  vtkCellArray* outputCells = isTube ? outputTubePolyData->GetStrips() : outputTubePolyData->GetLines();
+  if (outputCells == NULL || (isTube && (outputNormals == NULL || outputNormals->GetNumberOfTuples() != outputPoints->GetNumberOfPoints())))
+  {
+    vtkGenericWarningMacro("Output poly data was not created by AppendTubeRings. No tube rings appended.");
+    return;
+  }
+
+  // points are inserted one by one, the arrays grow geometrically so appending is amortized constant time
+  std::vector< vtkIdType > cellIds(isTube ? 2 * (pointsPerRing + 1) : 2);
+  for (vtkIdType i = currentNumberCurvePoints; i < numberCurvePoints; i++)
+  {
+    for (int k = 0; k < pointsPerRing; k++)
+    {
+      outputPoints->InsertNextPoint(0.0, 0.0, 0.0);
+      if (isTube)
+      {
+        outputNormals->InsertNextTuple3(0.0, 0.0, 0.0);
+      }
+    }
+    if (i == 0)
+    {
+      continue;
+    }
+    if (isTube)
+    {
+      // same orientation as the triangles of the strips that AllocateTubePolyData creates
+      for (int k = 0; k <= pointsPerRing; k++)
+      {
+        cellIds[2 * k] = i * pointsPerRing + k % pointsPerRing;
+        cellIds[2 * k + 1] = (i - 1) * pointsPerRing + k % pointsPerRing;
+      }
+    }
+    else
+    {
+      cellIds[0] = i - 1;
+      cellIds[1] = i;
+    }
+    outputCells->InsertNextCell(static_cast< vtkIdType >(cellIds.size()), &(cellIds[0]));
+  }
+  outputCells->Modified();
+
+  if (isTube && numberCurvePoints >= 2)
+  {
+    // caps, oriented outward (the cell array only contains the two caps, so it is cheap to recreate)
+    vtkSmartPointer< vtkCellArray > caps = vtkSmartPointer< vtkCellArray >::New();
+    std::vector< vtkIdType > capIds(pointsPerRing);
+    for (int k = 0; k < pointsPerRing; k++)
+    {
+      capIds[k] = pointsPerRing - 1 - k;
+    }
+    caps->InsertNextCell(pointsPerRing, &(capIds[0]));
+    vtkIdType lastRingOffset = (numberCurvePoints - 1) * pointsPerRing;
+    for (int k = 0; k < pointsPerRing; k++)
+    {
+      capIds[k] = lastRingOffset + k;
+    }
+    caps->InsertNextCell(pointsPerRing, &(capIds[0]));
+    outputTubePolyData->SetPolys(caps);
+  }
+
+  // the random access structures of the cells are out of date
+  outputTubePolyData->DeleteCells();
+  outputTubePolyData->Modified();
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelTubeGeneration::UpdateCurveMeasures(vtkPoints* curvePoints, double tubeRadius, int tubeNumberOfSides,
+  vtkPolyData* outputTubePolyData, vtkIdType firstCurvePoint, vtkIdType lastCurvePoint)
+{
+  if (curvePoints == NULL || outputTubePolyData == NULL)
+  {
+    vtkGenericWarningMacro("Curve points or output tube poly data is null. No curve measures computed.");
+    return;
+  }
+
+  vtkIdType numberCurvePoints = curvePoints->GetNumberOfPoints();
+  int pointsPerRing = (tubeRadius > 0.0) ? std::max(tubeNumberOfSides, TUBE_MINIMUM_NUMBER_OF_SIDES) : 1;
+  if (numberCurvePoints == 0 || outputTubePolyData->GetNumberOfPoints() != numberCurvePoints * pointsPerRing)
+  {
+    // there is no tube (for example, vtkTubeFilter does not generate any output for a single curve point either)
+    return;
+  }
+  firstCurvePoint = std::max(firstCurvePoint, (vtkIdType)0);
+  lastCurvePoint = std::min(lastCurvePoint, numberCurvePoints - 1);
+
+  // the arc length is stored in double precision, so that it can be continued from any stored value
+  // with exactly the same result as summing the lengths from the start of the curve
+  double* arcLengths = NULL;
+  float* curvatures = NULL;
+  float* torsions = NULL;
+  vtkIdType numberOfExistingCurvePoints = GetCurveMeasureArray< vtkDoubleArray >(outputTubePolyData, CURVE_ARC_LENGTH_ARRAY_NAME,
+    numberCurvePoints, arcLengths);
+  numberOfExistingCurvePoints = std::min(numberOfExistingCurvePoints,
+    GetCurveMeasureArray< vtkFloatArray >(outputTubePolyData, CURVE_CURVATURE_ARRAY_NAME, numberCurvePoints, curvatures));
+  numberOfExistingCurvePoints = std::min(numberOfExistingCurvePoints,
+    GetCurveMeasureArray< vtkFloatArray >(outputTubePolyData, CURVE_TORSION_ARRAY_NAME, numberCurvePoints, torsions));
+  if (numberOfExistingCurvePoints < numberCurvePoints)
+  {
+    // the values of new curve points are computed as well
+    firstCurvePoint = std::min(firstCurvePoint, numberOfExistingCurvePoints);
+    lastCurvePoint = numberCurvePoints - 1;
+  }
+  if (firstCurvePoint > lastCurvePoint)
+  {
+    return;
+  }
+
+  // Curvature is the inverse radius of the circle through a point and its neighbors, torsion is the rotation
+  // of the plane of that circle (of its binormal) around the tangent between the neighbors, so they also change
+  // at the two points on each side of the range.
+  vtkIdType firstMeasuredCurvePoint = std::max((vtkIdType)0, firstCurvePoint - 2);
+  vtkIdType lastMeasuredCurvePoint = std::min(numberCurvePoints - 1, lastCurvePoint + 2);
+  for (vtkIdType i = firstMeasuredCurvePoint; i <= lastMeasuredCurvePoint; i++)
+  {
+    double curvature = 0.0;
+    double binormal[3];
+    GetCurveBinormal(curvePoints, i, binormal, &curvature);
+    double torsion = 0.0;
+    double previousBinormal[3];
+    double nextBinormal[3];
+    if (GetCurveBinormal(curvePoints, i - 1, previousBinormal, NULL) && GetCurveBinormal(curvePoints, i + 1, nextBinormal, NULL))
+    {
+      double previousPoint[3];
+      curvePoints->GetPoint(i - 1, previousPoint);
+      double nextPoint[3];
+      curvePoints->GetPoint(i + 1, nextPoint);
+      double tangent[3];
+      vtkSlicerMarkupsToModelTubeGeneration::GetCurveTangent(curvePoints, i, tangent);
+      double cross[3];
+      vtkMath::Cross(previousBinormal, nextBinormal, cross);
+      double rotationAngle = atan2(vtkMath::Dot(cross, tangent), vtkMath::Dot(previousBinormal, nextBinormal));
+      torsion = rotationAngle / sqrt(vtkMath::Distance2BetweenPoints(previousPoint, nextPoint));
+    }
+    curvatures[i] = static_cast< float >(curvature);
+    torsions[i] = static_cast< float >(torsion);
+  }
+
+  // the length of the curve before the range is not changed
+  if (firstCurvePoint == 0)
+  {
+    arcLengths[0] = 0.0;
+  }
+  vtkIdType firstArcLengthCurvePoint = std::max(firstCurvePoint, (vtkIdType)1);
+  double arcLength = arcLengths[firstArcLengthCurvePoint - 1];
+  double previousPoint[3];
+  curvePoints->GetPoint(firstArcLengthCurvePoint - 1, previousPoint);
+  for (vtkIdType i = firstArcLengthCurvePoint; i < numberCurvePoints; i++)
+  {
+    double point[3];
+    curvePoints->GetPoint(i, point);
+    arcLength += sqrt(vtkMath::Distance2BetweenPoints(previousPoint, point));
+    arcLengths[i] = arcLength;
+    previousPoint[0] = point[0];
+    previousPoint[1] = point[1];
+    previousPoint[2] = point[2];
+  }
+
+  vtkDoubleArray* curveLengthArray = vtkDoubleArray::SafeDownCast(outputTubePolyData->GetFieldData()->GetArray(CURVE_LENGTH_ARRAY_NAME));
+  if (curveLengthArray == NULL)
+  {
+    vtkSmartPointer< vtkDoubleArray > newCurveLengthArray = vtkSmartPointer< vtkDoubleArray >::New();
+    newCurveLengthArray->SetName(CURVE_LENGTH_ARRAY_NAME);
+    outputTubePolyData->GetFieldData()->AddArray(newCurveLengthArray);
+    curveLengthArray = newCurveLengthArray;
+  }
+  curveLengthArray->SetNumberOfTuples(1);
+  curveLengthArray->SetValue(0, arcLength);
+  curveLengthArray->Modified();
+}
+
+//------------------------------------------------------------------------------
+double vtkSlicerMarkupsToModelTubeGeneration::GetCurveLength(vtkPolyData* tubePolyData)
+{
+  if (tubePolyData == NULL || tubePolyData->GetFieldData() == NULL)
+  {
+    return 0.0;
+  }
+  vtkDataArray* curveLengthArray = tubePolyData->GetFieldData()->GetArray(CURVE_LENGTH_ARRAY_NAME);
+  if (curveLengthArray == NULL || curveLengthArray->GetNumberOfTuples() == 0)
+  {
+    return 0.0;
+  }
+  return curveLengthArray->GetTuple1(0);
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelTubeGeneration::GetCurveTangent(vtkPoints* curvePoints, vtkIdType curvePointIndex, double tangent[3])
+{
+  // central difference, stepping outward past coincident points so that the tangent is always defined
+  vtkIdType numberCurvePoints = curvePoints->GetNumberOfPoints();
+  for (vtkIdType step = 1; step < numberCurvePoints; step++)
+  {
+    vtkIdType previousIndex = std::max((vtkIdType)0, curvePointIndex - step);
+    vtkIdType nextIndex = std::min(numberCurvePoints - 1, curvePointIndex + step);
+    double previousPoint[3];
+    curvePoints->GetPoint(previousIndex, previousPoint);
+    double nextPoint[3];
+    curvePoints->GetPoint(nextIndex, nextPoint);
+    tangent[0] = nextPoint[0] - previousPoint[0];
+    tangent[1] = nextPoint[1] - previousPoint[1];
+    tangent[2] = nextPoint[2] - previousPoint[2];
+    if (vtkMath::Normalize(tangent) > TUBE_GENERATION_EPSILON)
+    {
+      return;
+    }
+    if (previousIndex == 0 && nextIndex == numberCurvePoints - 1)
+    {
+      break;
+    }
+  }
+  // all points are coincident
+  tangent[0] = 0.0;
+  tangent[1] = 0.0;
+  tangent[2] = 1.0;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelTubeGeneration::ComputeTubeNormals(vtkPoints* curvePoints, double* normals,
+  vtkIdType firstCurvePoint, vtkIdType lastCurvePoint, bool matchFollowingNormal)
+{
+  if (curvePoints == NULL || normals == NULL)
+  {
+    vtkGenericWarningMacro("Curve points or tube normals are null. No normals computed.");
+    return;
+  }
+
+  vtkIdType numberCurvePoints = curvePoints->GetNumberOfPoints();
+  if (firstCurvePoint < 0 || lastCurvePoint >= numberCurvePoints || firstCurvePoint > lastCurvePoint)
+  {
+    return;
+  }
+
+  double previousPoint[3];
+  double previousTangent[3];
+  double previousNormal[3];
+  vtkIdType firstTransportedCurvePoint = firstCurvePoint;
+  if (firstCurvePoint == 0)
+  {
+    // keep the previous orientation of the first ring if it is still valid, to avoid sudden rotation
+    curvePoints->GetPoint(0, previousPoint);
+    vtkSlicerMarkupsToModelTubeGeneration::GetCurveTangent(curvePoints, 0, previousTangent);
+    double tangentComponent = vtkMath::Dot(normals, previousTangent);
+    for (int d = 0; d < 3; d++)
+    {
+      previousNormal[d] = normals[d] - tangentComponent * previousTangent[d];
+    }
+    if (vtkMath::Normalize(previousNormal) < 1e-6)
+    {
+      double unused[3];
+      vtkMath::Perpendiculars(previousTangent, previousNormal, unused, 0.0);
+    }
+    normals[0] = previousNormal[0];
+    normals[1] = previousNormal[1];
+    normals[2] = previousNormal[2];
+    firstTransportedCurvePoint = 1;
+  }
+  else
+  {
+    curvePoints->GetPoint(firstCurvePoint - 1, previousPoint);
+    vtkSlicerMarkupsToModelTubeGeneration::GetCurveTangent(curvePoints, firstCurvePoint - 1, previousTangent);
+    previousNormal[0] = normals[3 * (firstCurvePoint - 1)];
+    previousNormal[1] = normals[3 * (firstCurvePoint - 1) + 1];
+    previousNormal[2] = normals[3 * (firstCurvePoint - 1) + 2];
+  }
+
+  for (vtkIdType i = firstTransportedCurvePoint; i <= lastCurvePoint; i++)
+  {
+    double point[3];
+    curvePoints->GetPoint(i, point);
+    double tangent[3];
+    vtkSlicerMarkupsToModelTubeGeneration::GetCurveTangent(curvePoints, i, tangent);
+    TransportTubeNormal(previousPoint, previousTangent, previousNormal, point, tangent, normals + 3 * i);
+    for (int d = 0; d < 3; d++)
+    {
+      previousPoint[d] = point[d];
+      previousTangent[d] = tangent[d];
+      previousNormal[d] = normals[3 * i + d];
+    }
+  }
+
+  if (!matchFollowingNormal || lastCurvePoint + 1 >= numberCurvePoints)
+  {
+    return;
+  }
+
+  // The rings after the range are kept, so the twist between the transported frame
+  // and the existing frame of the next ring is distributed evenly along the range.
+  double followingPoint[3];
+  curvePoints->GetPoint(lastCurvePoint + 1, followingPoint);
+  double followingTangent[3];
+  vtkSlicerMarkupsToModelTubeGeneration::GetCurveTangent(curvePoints, lastCurvePoint + 1, followingTangent);
+  double transportedNormal[3];
+  TransportTubeNormal(previousPoint, previousTangent, previousNormal, followingPoint, followingTangent, transportedNormal);
+  double* followingNormal = normals + 3 * (lastCurvePoint + 1);
+  double cross[3];
+  vtkMath::Cross(transportedNormal, followingNormal, cross);
+  double twistAngle = atan2(vtkMath::Dot(cross, followingTangent), vtkMath::Dot(transportedNormal, followingNormal));
+  vtkIdType numberOfSteps = lastCurvePoint - firstTransportedCurvePoint + 2;
+  for (vtkIdType i = firstTransportedCurvePoint; i <= lastCurvePoint; i++)
+  {
+    double tangent[3];
+    vtkSlicerMarkupsToModelTubeGeneration::GetCurveTangent(curvePoints, i, tangent);
+    RotatePerpendicularVector(tangent, twistAngle * (i - firstTransportedCurvePoint + 1) / numberOfSteps, normals + 3 * i);
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelTubeGeneration::UpdateTubeRings(vtkPoints* curvePoints, const double* normals, double tubeRadius, int tubeNumberOfSides,
+  vtkPolyData* outputTubePolyData, vtkIdType firstCurvePoint, vtkIdType lastCurvePoint)
+{
+  if (curvePoints == NULL || normals == NULL || outputTubePolyData == NULL)
+  {
+    vtkGenericWarningMacro("Invalid inputs. No tube rings updated.");
+    return;
+  }
+
+  vtkPoints* outputPoints = outputTubePolyData->GetPoints();
+  if (outputPoints == NULL || firstCurvePoint < 0 || firstCurvePoint > lastCurvePoint)
+  {
+    // nothing to update (possibly not enough points for a tube)
+    return;
+  }
+
+  if (tubeRadius <= 0.0)
+  {
+    if (lastCurvePoint >= outputPoints->GetNumberOfPoints())
+    {
+      vtkGenericWarningMacro("Output poly data was not allocated for the curve points. No tube rings updated.");
+      return;
+    }
+    for (vtkIdType i = firstCurvePoint; i <= lastCurvePoint; i++)
+    {
+      outputPoints->SetPoint(i, curvePoints->GetPoint(i));
+    }
+    outputPoints->Modified();
+    return;
+  }
+
+  tubeNumberOfSides = std::max(tubeNumberOfSides, TUBE_MINIMUM_NUMBER_OF_SIDES);
+  vtkDataArray* outputNormals = outputTubePolyData->GetPointData()->GetNormals();
+  if ((lastCurvePoint + 1) * tubeNumberOfSides > outputPoints->GetNumberOfPoints()
+    || outputNormals == NULL || outputNormals->GetNumberOfTuples() != outputPoints->GetNumberOfPoints())
+  {
+    vtkGenericWarningMacro("Output poly data was not allocated for the curve points. No tube rings updated.");
+    return;
+  }
+
+  // write directly into the arrays if they have the type that AllocateTubePolyData creates
+  vtkFloatArray* outputPointsArray = vtkFloatArray::SafeDownCast(outputPoints->GetData());
+  vtkFloatArray* outputNormalsArray = vtkFloatArray::SafeDownCast(outputNormals);
+  if (outputPointsArray != NULL && outputNormalsArray != NULL)
+  {
+    float* outputPointsPointer = outputPointsArray->GetPointer(0);
+    float* outputNormalsPointer = outputNormalsArray->GetPointer(0);
+    switch (tubeNumberOfSides)
+    {
+      case 4:
+        WriteTubeRings< 4 >(curvePoints, normals, tubeRadius, 4, TubeCrossSection< 4 >::Cosines, TubeCrossSection< 4 >::Sines,
+          firstCurvePoint, lastCurvePoint, outputPointsPointer, outputNormalsPointer);
+        break;
+      case 6:
+        WriteTubeRings< 6 >(curvePoints, normals, tubeRadius, 6, TubeCrossSection< 6 >::Cosines, TubeCrossSection< 6 >::Sines,
+          firstCurvePoint, lastCurvePoint, outputPointsPointer, outputNormalsPointer);
+        break;
+      case 8:
+        WriteTubeRings< 8 >(curvePoints, normals, tubeRadius, 8, TubeCrossSection< 8 >::Cosines, TubeCrossSection< 8 >::Sines,
+          firstCurvePoint, lastCurvePoint, outputPointsPointer, outputNormalsPointer);
+        break;
+      case 12:
+        WriteTubeRings< 12 >(curvePoints, normals, tubeRadius, 12, TubeCrossSection< 12 >::Cosines, TubeCrossSection< 12 >::Sines,
+          firstCurvePoint, lastCurvePoint, outputPointsPointer, outputNormalsPointer);
+        break;
+      case 16:
+        WriteTubeRings< 16 >(curvePoints, normals, tubeRadius, 16, TubeCrossSection< 16 >::Cosines, TubeCrossSection< 16 >::Sines,
+          firstCurvePoint, lastCurvePoint, outputPointsPointer, outputNormalsPointer);
+        break;
+      default:
+      {
+        std::vector< double > cosines;
+        std::vector< double > sines;
+        ComputeTubeCrossSection(tubeNumberOfSides, cosines, sines);
+        WriteTubeRings< 0 >(curvePoints, normals, tubeRadius, tubeNumberOfSides, &(cosines[0]), &(sines[0]),
+          firstCurvePoint, lastCurvePoint, outputPointsPointer, outputNormalsPointer);
+        break;
+      }
+    }
+    outputPoints->Modified();
+    outputNormals->Modified();
+    return;
+  }
+
+  // arrays of other types are written point by point
+  std::vector< double > cosines;
+  std::vector< double > sines;
+  ComputeTubeCrossSection(tubeNumberOfSides, cosines, sines);
+  for (vtkIdType i = firstCurvePoint; i <= lastCurvePoint; i++)
+  {
+    double center[3];
+    curvePoints->GetPoint(i, center);
+    double tangent[3];
+    vtkSlicerMarkupsToModelTubeGeneration::GetCurveTangent(curvePoints, i, tangent);
+    const double* normal = normals + 3 * i;
+    double binormal[3];
+    vtkMath::Cross(tangent, normal, binormal);
+    for (int k = 0; k < tubeNumberOfSides; k++)
+    {
+      vtkIdType tubePointIndex = i * tubeNumberOfSides + k;
+      double direction[3];
+      double point[3];
+      for (int d = 0; d < 3; d++)
+      {
+        direction[d] = cosines[k] * normal[d] + sines[k] * binormal[d];
+        point[d] = center[d] + tubeRadius * direction[d];
+      }
+      outputPoints->SetPoint(tubePointIndex, point);
+      outputNormals->SetTuple(tubePointIndex, direction);
+    }
+  }
+  outputPoints->Modified();
+  outputNormals->Modified();
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelTubeGeneration::CombineModels(const std::vector< vtkPolyData* >& inputPolyDatas, vtkPolyData* outputPolyData)
+{
+  if (outputPolyData == NULL)
+  {
+    vtkGenericWarningMacro("Output poly data is null. No models combined.");
+    return;
+  }
+
+  // the part of each input in the combined arrays
+  std::vector< vtkPolyData* > nonEmptyInputPolyDatas;
+  std::vector< vtkIdType > pointOffsets(1, 0);
+  std::vector< vtkIdType > connectivityOffsets(NUMBER_OF_CELL_TYPES, 0);
+  bool allInputsHaveNormals = true;
+  for (unsigned int inputIndex = 0; inputIndex < inputPolyDatas.size(); inputIndex++)
+  {
+    vtkPolyData* inputPolyData = inputPolyDatas[inputIndex];
+    if (inputPolyData == NULL || inputPolyData->GetPoints() == NULL || inputPolyData->GetNumberOfPoints() == 0)
+    {
+      continue;
+    }
+    vtkDataArray* inputNormals = inputPolyData->GetPointData()->GetNormals();
+    if (inputNormals == NULL || inputNormals->GetNumberOfComponents() != 3
+      || inputNormals->GetNumberOfTuples() != inputPolyData->GetNumberOfPoints())
+    {
+      allInputsHaveNormals = false;
+    }
+    nonEmptyInputPolyDatas.push_back(inputPolyData);
+    pointOffsets.push_back(pointOffsets.back() + inputPolyData->GetNumberOfPoints());
+    for (int cellType = 0; cellType < NUMBER_OF_CELL_TYPES; cellType++)
+    {
+      vtkCellArray* inputCells = GetCellsOfType(inputPolyData, cellType);
+      vtkIdType connectivitySize = (inputCells != NULL ? inputCells->GetNumberOfConnectivityEntries() : 0);
+      connectivityOffsets.push_back(connectivityOffsets[connectivityOffsets.size() - NUMBER_OF_CELL_TYPES] + connectivitySize);
+    }
+  }
+
+  outputPolyData->Initialize();
+  vtkIdType numberOfInputs = static_cast< vtkIdType >(nonEmptyInputPolyDatas.size());
+  vtkSmartPointer< vtkPoints > outputPoints = vtkSmartPointer< vtkPoints >::New();
+  outputPoints->SetDataTypeToFloat();
+  outputPoints->SetNumberOfPoints(pointOffsets.back());
+  vtkSmartPointer< vtkFloatArray > outputNormals;
+  if (allInputsHaveNormals && numberOfInputs > 0)
+  {
+    outputNormals = vtkSmartPointer< vtkFloatArray >::New();
+    outputNormals->SetName(nonEmptyInputPolyDatas[0]->GetPointData()->GetNormals()->GetName());
+    outputNormals->SetNumberOfComponents(3);
+    outputNormals->SetNumberOfTuples(pointOffsets.back());
+  }
+  vtkSmartPointer< vtkIdTypeArray > outputConnectivityArrays[NUMBER_OF_CELL_TYPES];
+  vtkIdType* outputConnectivity[NUMBER_OF_CELL_TYPES];
+  for (int cellType = 0; cellType < NUMBER_OF_CELL_TYPES; cellType++)
+  {
+    outputConnectivityArrays[cellType] = vtkSmartPointer< vtkIdTypeArray >::New();
+    outputConnectivityArrays[cellType]->SetNumberOfValues(connectivityOffsets[NUMBER_OF_CELL_TYPES * numberOfInputs + cellType]);
+    outputConnectivity[cellType] = outputConnectivityArrays[cellType]->GetPointer(0);
+  }
+
+  CombineModelsFunctor combineModels(nonEmptyInputPolyDatas, pointOffsets, connectivityOffsets,
+    static_cast< vtkFloatArray* >(outputPoints->GetData())->GetPointer(0),
+    (outputNormals.GetPointer() != NULL ? outputNormals->GetPointer(0) : NULL), outputConnectivity);
+  vtkSMPTools::For(0, numberOfInputs, 1, combineModels);
+
+  outputPolyData->SetPoints(outputPoints);
+  if (outputNormals.GetPointer() != NULL)
+  {
+    outputPolyData->GetPointData()->SetNormals(outputNormals);
+  }
+  for (int cellType = 0; cellType < NUMBER_OF_CELL_TYPES; cellType++)
+  {
+    vtkIdType numberOfCells = 0;
+    for (vtkIdType inputIndex = 0; inputIndex < numberOfInputs; inputIndex++)
+    {
+      vtkCellArray* inputCells = GetCellsOfType(nonEmptyInputPolyDatas[inputIndex], cellType);
+      numberOfCells += (inputCells != NULL ? inputCells->GetNumberOfCells() : 0);
+    }
+    if (numberOfCells == 0)
+    {
+      continue;
+    }
+    vtkSmartPointer< vtkCellArray > outputCells = vtkSmartPointer< vtkCellArray >::New();
+    outputCells->SetCells(numberOfCells, outputConnectivityArrays[cellType]);
+    switch (cellType)
+    {
+      case 0: outputPolyData->SetVerts(outputCells); break;
+      case 1: outputPolyData->SetLines(outputCells); break;
+      case 2: outputPolyData->SetPolys(outputCells); break;
+      default: outputPolyData->SetStrips(outputCells); break;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelTubeGeneration::PrintSelf( ostream &os, vtkIndent indent )
+{
+  Superclass::PrintSelf( os, indent );
+}
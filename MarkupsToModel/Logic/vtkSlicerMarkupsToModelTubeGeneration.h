@@ -0,0 +1,108 @@
+#ifndef __vtkSlicerMarkupsToModelTubeGeneration_h
+#define __vtkSlicerMarkupsToModelTubeGeneration_h
+
+// vtk includes
+#include <vtkObject.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// std includes
+#include <vector>
+
+#include "vtkSlicerMarkupsToModelModuleLogicExport.h"
+
+// Generates a tube mesh around a curve.
+// The output has the same topology as the output of vtkTubeFilter with capping:
+// tubeNumberOfSides vertices for each curve point, one triangle strip for each side and a polygon at each end.
+// Vertex normals are stored in the "TubeNormals" point data array.
+// The tube frames are computed by parallel transport (rotation minimizing frames), so the tube does not twist.
+// The arc length, curvature and torsion of the curve and the length of the curve are stored in field data
+// (see UpdateCurveMeasures), so they are available without processing the model again.
+class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelTubeGeneration : public vtkObject
+{
+  public:
+    // standard vtk object methods
+    vtkTypeMacro( vtkSlicerMarkupsToModelTubeGeneration, vtkObject );
+    void PrintSelf( ostream& os, vtkIndent indent ) VTK_OVERRIDE;
+    static vtkSlicerMarkupsToModelTubeGeneration *New();
+
+    // Generates the tube model along the curve points into outputTubePolyData.
+    // If tubeRadius <= 0 then a polyline is created instead of a tube.
+    // The arrays of the output are allocated with their exact size and the mesh is written into them directly.
+    static void GenerateTubeModel( vtkPoints* curvePoints, vtkPolyData* outputTubePolyData, double tubeRadius, int tubeNumberOfSides );
+
+    // Generates only the centerline of the tube: a polyline through the curve points, with the parameters of the tube
+    // in its point data, so that the tube can be rendered on the display side (for example by a tube impostor shader)
+    // instead of being tessellated. The "TubeRadius" array contains the radius and the "TubeNormals" array (the point normals)
+    // contains the normal of the tube frame (the same frame as the one that GenerateTubeModel uses) at each point.
+    // The number of sides is stored in the "TubeNumberOfSides" field data array.
+    static void GenerateCenterlineModel( vtkPoints* curvePoints, vtkPolyData* outputCenterlinePolyData, double tubeRadius, int tubeNumberOfSides );
+
+    // Tessellate the tube of a centerline that was generated by GenerateCenterlineModel (for example for export).
+    // If tubeNumberOfSides is not positive then the number of sides stored in the centerline is used.
+    // Does not generate any tube if the centerline does not contain the tube parameters.
+    static void GenerateTubeModelFromCenterline( vtkPolyData* centerlinePolyData, vtkPolyData* outputTubePolyData, int tubeNumberOfSides = 0 );
+
+    // Lower-level functions for updating only a part of the tube.
+    // Allocate the points, normals and cells of a tube with numberOfCurvePoints rings.
+    // The point positions are not initialized.
+    static void AllocateTubePolyData( vtkIdType numberOfCurvePoints, double tubeRadius, int tubeNumberOfSides, vtkPolyData* outputTubePolyData );
+
+    // Compute the unit normal of the tube frame for the curve points between firstCurvePoint and lastCurvePoint (inclusive).
+    // tubeNormals contains 3 values for each curve point. The frame is transported from the normal preceding the range.
+    // If firstCurvePoint is 0 then the current first normal is used as initial orientation (if it is not
+    // parallel to the curve), otherwise an arbitrary perpendicular direction is chosen.
+    // If matchFollowingNormal is true then the twist between the transported frame and the normal following
+    // the range is distributed evenly along the range, so that the range connects smoothly to the rest of the tube.
+    static void ComputeTubeNormals( vtkPoints* curvePoints, double* tubeNormals, vtkIdType firstCurvePoint, vtkIdType lastCurvePoint, bool matchFollowingNormal );
+
+    // Write the ring vertices and normals for the curve points between firstCurvePoint and lastCurvePoint (inclusive)
+    // into outputTubePolyData, which must have been allocated by AllocateTubePolyData.
+    static void UpdateTubeRings( vtkPoints* curvePoints, const double* tubeNormals, double tubeRadius, int tubeNumberOfSides,
+      vtkPolyData* outputTubePolyData, vtkIdType firstCurvePoint, vtkIdType lastCurvePoint );
+
+    // Grow a tube at its end to numberOfCurvePoints rings, for curves that are extended by appending points.
+    // The tube has one triangle strip between each pair of consecutive rings (instead of one strip for each side),
+    // so new rings are connected to the existing ones without rebuilding the existing cells. The end cap is moved
+    // to the last ring. outputTubePolyData must be empty or grown by this function previously.
+    // The positions and normals of the new rings are not initialized, they have to be set by UpdateTubeRings.
+    // If tubeRadius <= 0 then a line segment is appended for each new curve point instead.
+    static void AppendTubeRings( vtkIdType numberOfCurvePoints, double tubeRadius, int tubeNumberOfSides, vtkPolyData* outputTubePolyData );
+
+    // Store the arc length, curvature and torsion of the curve at the curve points in the "ArcLength", "Curvature" and "Torsion"
+    // field data arrays of outputTubePolyData, which must have been generated from the curve points by the functions above.
+    // The arrays have one value for each curve point, value i belongs to ring i of a tube (vertices i * tubeNumberOfSides
+    // to (i + 1) * tubeNumberOfSides - 1), so the values are not repeated at every vertex. The arc length is the length of the curve
+    // from its first point, so for the curve point of each curve parameter value it is the parameter to arc length table.
+    // Curvature is the inverse radius of the circle through each curve point and its neighbors, torsion is the rotation angle
+    // of the plane of this circle per unit length. Both are 0 at the ends of the curve and where the curve is straight.
+    // The length of the whole curve is stored in the "CurveLength" field data array.
+    // Only the values that depend on the curve points between firstCurvePoint and lastCurvePoint (inclusive) are updated:
+    // curvature and torsion up to two curve points away from the range and the arc length from the range to the end of the curve.
+    // Values of curve points that were appended by AppendTubeRings are always computed.
+    static void UpdateCurveMeasures( vtkPoints* curvePoints, double tubeRadius, int tubeNumberOfSides, vtkPolyData* outputTubePolyData,
+      vtkIdType firstCurvePoint, vtkIdType lastCurvePoint );
+
+    // Get the length of the curve that is stored in a model by UpdateCurveMeasures. Returns 0 if the model does not contain it.
+    static double GetCurveLength( vtkPolyData* tubePolyData );
+
+    // Combine the models of multiple curves into a single poly data (for example, to render them with a single draw call).
+    // The points, the vertex normals and the cells of all inputs are written directly into arrays that are allocated with
+    // their exact size, the inputs are processed in parallel. Normals are only stored if all non-empty inputs have normals.
+    // Other point and cell data arrays are not copied. NULL inputs are ignored.
+    static void CombineModels( const std::vector< vtkPolyData* >& inputPolyDatas, vtkPolyData* outputPolyData );
+
+    // Compute the unit tangent of the curve at a curve point
+    static void GetCurveTangent( vtkPoints* curvePoints, vtkIdType curvePointIndex, double tangent[ 3 ] );
+
+  protected:
+    vtkSlicerMarkupsToModelTubeGeneration();
+    ~vtkSlicerMarkupsToModelTubeGeneration();
+
+  private:
+    // not used
+    vtkSlicerMarkupsToModelTubeGeneration ( const vtkSlicerMarkupsToModelTubeGeneration& ) VTK_DELETE_FUNCTION;
+    void operator= ( const vtkSlicerMarkupsToModelTubeGeneration& ) VTK_DELETE_FUNCTION;
+};
+
+#endif
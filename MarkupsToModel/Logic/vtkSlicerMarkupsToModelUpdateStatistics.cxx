@@ -0,0 +1,194 @@
+#include "vtkSlicerMarkupsToModelUpdateStatistics.h"
+
+// vtk includes
+#include <vtkDataArray.h>
+#include <vtkObjectFactory.h>
+#include <vtkTimerLog.h>
+
+// std includes
+#include <sstream>
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerMarkupsToModelUpdateStatistics);
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelUpdateStatistics::vtkSlicerMarkupsToModelUpdateStatistics()
+{
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerMarkupsToModelUpdateStatistics::~vtkSlicerMarkupsToModelUpdateStatistics()
+{
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelUpdateStatistics::Reset()
+{
+  this->Stages.clear();
+  this->Modified();
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelUpdateStatistics::DeepCopy(vtkSlicerMarkupsToModelUpdateStatistics* source)
+{
+  if (source == NULL)
+  {
+    vtkGenericWarningMacro("Source statistics is null. Nothing to copy.");
+    return;
+  }
+  this->Stages = source->Stages;
+  this->Modified();
+}
+
+//------------------------------------------------------------------------------
+double vtkSlicerMarkupsToModelUpdateStatistics::GetTime()
+{
+  return vtkTimerLog::GetUniversalTime();
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelUpdateStatistics::AddStage(const char* name, double startTime,
+  vtkIdType numberOfPoints, vtkIdType numberOfCells, unsigned long memorySize)
+{
+  Stage stage;
+  stage.Name = (name != NULL ? name : "");
+  stage.Duration = vtkSlicerMarkupsToModelUpdateStatistics::GetTime() - startTime;
+  stage.NumberOfPoints = numberOfPoints;
+  stage.NumberOfCells = numberOfCells;
+  stage.MemorySize = memorySize;
+  this->Stages.push_back(stage);
+  this->Modified();
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelUpdateStatistics::AddPointsStage(const char* name, double startTime, vtkPoints* outputPoints)
+{
+  vtkIdType numberOfPoints = 0;
+  unsigned long memorySize = 0;
+  if (outputPoints != NULL)
+  {
+    numberOfPoints = outputPoints->GetNumberOfPoints();
+    memorySize = outputPoints->GetData()->GetActualMemorySize();
+  }
+  this->AddStage(name, startTime, numberOfPoints, 0, memorySize);
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelUpdateStatistics::AddPolyDataStage(const char* name, double startTime, vtkPolyData* outputPolyData)
+{
+  vtkIdType numberOfPoints = 0;
+  vtkIdType numberOfCells = 0;
+  unsigned long memorySize = 0;
+  if (outputPolyData != NULL)
+  {
+    numberOfPoints = outputPolyData->GetNumberOfPoints();
+    numberOfCells = outputPolyData->GetNumberOfCells();
+    memorySize = outputPolyData->GetActualMemorySize();
+  }
+  this->AddStage(name, startTime, numberOfPoints, numberOfCells, memorySize);
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerMarkupsToModelUpdateStatistics::IsValidStageIndex(int stageIndex)
+{
+  if (stageIndex < 0 || stageIndex >= static_cast< int >(this->Stages.size()))
+  {
+    vtkErrorMacro("Stage index " << stageIndex << " is out of range (number of stages: " << this->Stages.size() << ").");
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelUpdateStatistics::GetNumberOfStages()
+{
+  return static_cast< int >(this->Stages.size());
+}
+
+//------------------------------------------------------------------------------
+const char* vtkSlicerMarkupsToModelUpdateStatistics::GetStageName(int stageIndex)
+{
+  if (!this->IsValidStageIndex(stageIndex))
+  {
+    return NULL;
+  }
+  return this->Stages[stageIndex].Name.c_str();
+}
+
+//------------------------------------------------------------------------------
+double vtkSlicerMarkupsToModelUpdateStatistics::GetStageDuration(int stageIndex)
+{
+  if (!this->IsValidStageIndex(stageIndex))
+  {
+    return 0.0;
+  }
+  return this->Stages[stageIndex].Duration;
+}
+
+//------------------------------------------------------------------------------
+vtkIdType vtkSlicerMarkupsToModelUpdateStatistics::GetStageNumberOfPoints(int stageIndex)
+{
+  if (!this->IsValidStageIndex(stageIndex))
+  {
+    return 0;
+  }
+  return this->Stages[stageIndex].NumberOfPoints;
+}
+
+//------------------------------------------------------------------------------
+vtkIdType vtkSlicerMarkupsToModelUpdateStatistics::GetStageNumberOfCells(int stageIndex)
+{
+  if (!this->IsValidStageIndex(stageIndex))
+  {
+    return 0;
+  }
+  return this->Stages[stageIndex].NumberOfCells;
+}
+
+//------------------------------------------------------------------------------
+unsigned long vtkSlicerMarkupsToModelUpdateStatistics::GetStageMemorySize(int stageIndex)
+{
+  if (!this->IsValidStageIndex(stageIndex))
+  {
+    return 0;
+  }
+  return this->Stages[stageIndex].MemorySize;
+}
+
+//------------------------------------------------------------------------------
+double vtkSlicerMarkupsToModelUpdateStatistics::GetTotalDuration()
+{
+  double totalDuration = 0.0;
+  for (unsigned int i = 0; i < this->Stages.size(); i++)
+  {
+    totalDuration += this->Stages[i].Duration;
+  }
+  return totalDuration;
+}
+
+//------------------------------------------------------------------------------
+std::string vtkSlicerMarkupsToModelUpdateStatistics::GetStagesAsString()
+{
+  std::stringstream ss;
+  ss.setf(std::ios::fixed);
+  ss.precision(1);
+  for (unsigned int i = 0; i < this->Stages.size(); i++)
+  {
+    const Stage& stage = this->Stages[i];
+    ss << (i > 0 ? "\n" : "") << stage.Name << ": " << stage.Duration * 1000.0 << " ms, "
+      << stage.NumberOfPoints << " points, " << stage.NumberOfCells << " cells, " << stage.MemorySize << " KiB";
+  }
+  return ss.str();
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerMarkupsToModelUpdateStatistics::PrintSelf( ostream &os, vtkIndent indent )
+{
+  Superclass::PrintSelf( os, indent );
+  for (unsigned int i = 0; i < this->Stages.size(); i++)
+  {
+    const Stage& stage = this->Stages[i];
+    os << indent << stage.Name << ": " << stage.Duration << " s, " << stage.NumberOfPoints << " points, "
+      << stage.NumberOfCells << " cells, " << stage.MemorySize << " KiB" << std::endl;
+  }
+}
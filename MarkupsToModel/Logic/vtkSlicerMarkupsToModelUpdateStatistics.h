@@ -0,0 +1,84 @@
+#ifndef __vtkSlicerMarkupsToModelUpdateStatistics_h
+#define __vtkSlicerMarkupsToModelUpdateStatistics_h
+
+// vtk includes
+#include <vtkObject.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// std includes
+#include <string>
+#include <vector>
+
+#include "vtkSlicerMarkupsToModelModuleLogicExport.h"
+
+// Records the wall time, output size and memory size of each stage of an output model update.
+// Stages are recorded in the order they are performed. A stage is recorded by first storing the start time:
+//   double startTime = vtkSlicerMarkupsToModelUpdateStatistics::GetTime();
+//   ... perform the stage ...
+//   statistics->AddPolyDataStage( "delaunay", startTime, outputPolyData );
+// An instance must only be accessed by one thread at a time.
+class VTK_SLICER_MARKUPSTOMODEL_MODULE_LOGIC_EXPORT vtkSlicerMarkupsToModelUpdateStatistics : public vtkObject
+{
+  public:
+    // standard vtk object methods
+    vtkTypeMacro( vtkSlicerMarkupsToModelUpdateStatistics, vtkObject );
+    void PrintSelf( ostream& os, vtkIndent indent ) VTK_OVERRIDE;
+    static vtkSlicerMarkupsToModelUpdateStatistics *New();
+
+    // Remove all recorded stages
+    void Reset();
+
+    // Copy all recorded stages from the source
+    void DeepCopy( vtkSlicerMarkupsToModelUpdateStatistics* source );
+
+    // Current wall time in seconds, to be used as the start time of a stage
+    static double GetTime();
+
+    // Record a stage that started at startTime and ended now.
+    // memorySize is in kibibytes, similarly to vtkDataObject::GetActualMemorySize.
+    void AddStage( const char* name, double startTime, vtkIdType numberOfPoints, vtkIdType numberOfCells, unsigned long memorySize );
+    // Record a stage that started at startTime and ended now, the stage produced the output points
+    void AddPointsStage( const char* name, double startTime, vtkPoints* outputPoints );
+    // Record a stage that started at startTime and ended now, the stage produced the output poly data
+    void AddPolyDataStage( const char* name, double startTime, vtkPolyData* outputPolyData );
+
+    int GetNumberOfStages();
+    const char* GetStageName( int stageIndex );
+    // Wall time of the stage in seconds
+    double GetStageDuration( int stageIndex );
+    vtkIdType GetStageNumberOfPoints( int stageIndex );
+    vtkIdType GetStageNumberOfCells( int stageIndex );
+    // Memory size of the stage output in kibibytes
+    unsigned long GetStageMemorySize( int stageIndex );
+
+    // Sum of the wall time of all stages in seconds
+    double GetTotalDuration();
+
+    // Human readable description of the stages, one line per stage
+    std::string GetStagesAsString();
+
+  protected:
+    vtkSlicerMarkupsToModelUpdateStatistics();
+    ~vtkSlicerMarkupsToModelUpdateStatistics();
+
+  private:
+    struct Stage
+    {
+      std::string Name;
+      double Duration;
+      vtkIdType NumberOfPoints;
+      vtkIdType NumberOfCells;
+      unsigned long MemorySize;
+    };
+
+    bool IsValidStageIndex( int stageIndex );
+
+    std::vector< Stage > Stages;
+
+    // not used
+    vtkSlicerMarkupsToModelUpdateStatistics ( const vtkSlicerMarkupsToModelUpdateStatistics& ) VTK_DELETE_FUNCTION;
+    void operator= ( const vtkSlicerMarkupsToModelUpdateStatistics& ) VTK_DELETE_FUNCTION;
+};
+
+#endif
@@ -10,6 +10,7 @@
 // Other MRML includes
 #include "vtkMRMLNode.h"
 #include "vtkMRMLMarkupsFiducialNode.h"
+#include "vtkMRMLTransformableNode.h"
 
 // VTK includes
 #include <vtkNew.h>
@@ -20,6 +21,17 @@
 static const char* INPUT_ROLE = "InputMarkups";
 static const char* OUTPUT_MODEL_ROLE = "OutputModel";
 
+// 64-bit FNV-1a hash parameters
+static const vtkTypeUInt64 FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const vtkTypeUInt64 FNV_PRIME = 1099511628211ULL;
+
+//-----------------------------------------------------------------
+// Append the bytes of the value to the signature
+template< typename T > static void AddToSignature( std::string& signature, T value )
+{
+  signature.append( reinterpret_cast< const char* >( &value ), sizeof( T ) );
+}
+
 //-----------------------------------------------------------------
 vtkMRMLMarkupsToModelNode* vtkMRMLMarkupsToModelNode::New()
 {
@@ -41,8 +53,11 @@ vtkMRMLMarkupsToModelNode::vtkMRMLMarkupsToModelNode()
 
   vtkNew<vtkIntArray> events;
   events->InsertNextValue( vtkCommand::ModifiedEvent );
-  events->InsertNextValue( vtkMRMLMarkupsNode::PointModifiedEvent );//PointEndInteractionEvent
+  events->InsertNextValue( vtkMRMLMarkupsNode::PointModifiedEvent );
+  events->InsertNextValue( vtkMRMLMarkupsNode::PointStartInteractionEvent );
+  events->InsertNextValue( vtkMRMLMarkupsNode::PointEndInteractionEvent );
   events->InsertNextValue( vtkMRMLModelNode::MeshModifiedEvent );
+  events->InsertNextValue( vtkMRMLTransformableNode::TransformModifiedEvent );
 
   this->AddNodeReferenceRole( INPUT_ROLE, NULL, events.GetPointer() );
   this->AddNodeReferenceRole( OUTPUT_MODEL_ROLE );
@@ -51,14 +66,23 @@ vtkMRMLMarkupsToModelNode::vtkMRMLMarkupsToModelNode()
   this->CleanMarkups = true;
   this->ConvexHull = true;
   this->ButterflySubdivision = true;
+  this->NumberOfSubdivisions = 3;
+  this->SinglePrecisionOutput = false;
+  this->IncrementalDelaunay = false;
+  this->FollowInputTransform = false;
   // DelaunayAlpha = 50 would work well most of the cases but in case if not then the user would not
   // know why no model is drawn around the points. It is better to use a safe and simple setting
   // by default (alpha = 0 => use convex hull).
   this->DelaunayAlpha = 0.0;
+  this->SurfaceGenerationMethod = DelaunaySurface;
+  this->DecimationTargetNumberOfPoints = 0;
+  this->DecimationSpacing = 0.0;
   this->TubeRadius = 1.0;
   this->TubeSegmentsBetweenControlPoints = 5;
+  this->TubeSamplingTolerance = 0.0;
   this->TubeNumberOfSides = 8;
   this->TubeLoop = false;
+  this->CenterlineOutput = false;
   this->ModelType = 0;
   this->InterpolationType = 0;
   this->PointParameterType = 0;
@@ -70,6 +94,19 @@ vtkMRMLMarkupsToModelNode::vtkMRMLMarkupsToModelNode()
   this->KochanekEndsCopyNearestDerivatives = false;
 
   this->PolynomialOrder = 3;
+
+  this->IncrementalCurveUpdate = false;
+  this->StreamingCurveUpdate = false;
+  this->StreamingMaximumNumberOfPoints = 0;
+  this->StreamingMaximumPointAge = 0.0;
+
+  this->MaximumUpdateRate = 0.0;
+  this->FinalUpdateOnInteractionEnd = true;
+  this->AsynchronousUpdate = false;
+  this->QualityLevel = FullQuality;
+  this->CleanMarkupsTolerance = 0.01;
+  this->InteractionQualityLevel = PreviewQuality;
+  this->InputInteractionInProgress = false;
 }
 
 //-----------------------------------------------------------------
@@ -101,18 +138,37 @@ void vtkMRMLMarkupsToModelNode::WriteXML( ostream& of, int nIndent )
   of << indent << " CleanMarkups =\"" << (this->CleanMarkups ? "true" : "false") << "\"";
   of << indent << " ConvexHull =\"" << (this->ConvexHull ? "true" : "false") << "\"";
   of << indent << " ButterflySubdivision =\"" << (this->ButterflySubdivision ? "true" : "false") << "\"";
+  of << indent << " NumberOfSubdivisions=\"" << this->NumberOfSubdivisions << "\"";
+  of << indent << " SinglePrecisionOutput=\"" << (this->SinglePrecisionOutput ? "true" : "false") << "\"";
+  of << indent << " IncrementalDelaunay=\"" << (this->IncrementalDelaunay ? "true" : "false") << "\"";
+  of << indent << " FollowInputTransform=\"" << (this->FollowInputTransform ? "true" : "false") << "\"";
   of << indent << " DelaunayAlpha =\"" << this->DelaunayAlpha << "\"";
+  of << indent << " SurfaceGenerationMethod=\"" << this->GetSurfaceGenerationMethodAsString(this->SurfaceGenerationMethod) << "\"";
+  of << indent << " DecimationTargetNumberOfPoints=\"" << this->DecimationTargetNumberOfPoints << "\"";
+  of << indent << " DecimationSpacing=\"" << this->DecimationSpacing << "\"";
   of << indent << " InterpolationType=\"" << this->GetInterpolationTypeAsString(this->InterpolationType) << "\"";
   of << indent << " PointParameterType=\"" << this->GetPointParameterTypeAsString(this->PointParameterType) << "\"";
   of << indent << " TubeRadius=\"" << this->TubeRadius << "\"";
   of << indent << " TubeNumberOfSides=\"" << this->TubeNumberOfSides << "\"";
   of << indent << " TubeSegmentsBetweenControlPoints=\"" << this->TubeSegmentsBetweenControlPoints << "\"";
+  of << indent << " TubeSamplingTolerance=\"" << this->TubeSamplingTolerance << "\"";
   of << indent << " TubeLoop=\"" << ( this->TubeLoop ? "true" : "false" ) << "\"";
+  of << indent << " CenterlineOutput=\"" << ( this->CenterlineOutput ? "true" : "false" ) << "\"";
   of << indent << " KochanekEndsCopyNearestDerivatives=\"" << ( this->KochanekEndsCopyNearestDerivatives ? "true" : "false" ) << "\"";
   of << indent << " KochanekBias=\"" << this->KochanekBias << "\"";
   of << indent << " KochanekContinuity=\"" << this->KochanekContinuity << "\"";
   of << indent << " KochanekTension=\"" << this->KochanekTension << "\"";
   of << indent << " PolynomialOrder=\"" << this->PolynomialOrder << "\"";
+  of << indent << " IncrementalCurveUpdate=\"" << ( this->IncrementalCurveUpdate ? "true" : "false" ) << "\"";
+  of << indent << " StreamingCurveUpdate=\"" << ( this->StreamingCurveUpdate ? "true" : "false" ) << "\"";
+  of << indent << " StreamingMaximumNumberOfPoints=\"" << this->StreamingMaximumNumberOfPoints << "\"";
+  of << indent << " StreamingMaximumPointAge=\"" << this->StreamingMaximumPointAge << "\"";
+  of << indent << " MaximumUpdateRate=\"" << this->MaximumUpdateRate << "\"";
+  of << indent << " FinalUpdateOnInteractionEnd=\"" << ( this->FinalUpdateOnInteractionEnd ? "true" : "false" ) << "\"";
+  of << indent << " AsynchronousUpdate=\"" << ( this->AsynchronousUpdate ? "true" : "false" ) << "\"";
+  of << indent << " QualityLevel=\"" << this->GetQualityLevelAsString(this->QualityLevel) << "\"";
+  of << indent << " InteractionQualityLevel=\"" << this->GetQualityLevelAsString(this->InteractionQualityLevel) << "\"";
+  of << indent << " CleanMarkupsTolerance=\"" << this->CleanMarkupsTolerance << "\"";
 }
 
 //-----------------------------------------------------------------
@@ -167,6 +223,55 @@ void vtkMRMLMarkupsToModelNode::ReadXMLAttributes( const char** atts )
       nameString >> delaunayAlpha;
       SetDelaunayAlpha(delaunayAlpha);
     }
+    else if ( ! strcmp( attName, "SurfaceGenerationMethod" ) )
+    {
+      int methodAsInt = GetSurfaceGenerationMethodFromString( attValue );
+      if ( methodAsInt >= 0 && methodAsInt < SurfaceGenerationMethod_Last)
+      {
+        this->SurfaceGenerationMethod = methodAsInt;
+      }
+      else
+      {
+        vtkWarningMacro("Unrecognized surface generation method read from MRML node: " << attValue << ". Setting to Delaunay.");
+        this->SurfaceGenerationMethod = this->DelaunaySurface;
+      }
+    }
+    else if ( ! strcmp( attName, "NumberOfSubdivisions" ) )
+    {
+      int numberOfSubdivisions = 0;
+      std::stringstream nameString;
+      nameString << attValue;
+      nameString >> numberOfSubdivisions;
+      SetNumberOfSubdivisions(numberOfSubdivisions);
+    }
+    else if ( ! strcmp( attName, "SinglePrecisionOutput" ) )
+    {
+      SetSinglePrecisionOutput(!strcmp(attValue,"true"));
+    }
+    else if ( ! strcmp( attName, "IncrementalDelaunay" ) )
+    {
+      SetIncrementalDelaunay(!strcmp(attValue,"true"));
+    }
+    else if ( ! strcmp( attName, "FollowInputTransform" ) )
+    {
+      SetFollowInputTransform(!strcmp(attValue,"true"));
+    }
+    else if ( ! strcmp( attName, "DecimationTargetNumberOfPoints" ) )
+    {
+      int decimationTargetNumberOfPoints = 0;
+      std::stringstream nameString;
+      nameString << attValue;
+      nameString >> decimationTargetNumberOfPoints;
+      SetDecimationTargetNumberOfPoints(decimationTargetNumberOfPoints);
+    }
+    else if ( ! strcmp( attName, "DecimationSpacing" ) )
+    {
+      double decimationSpacing = 0.0;
+      std::stringstream nameString;
+      nameString << attValue;
+      nameString >> decimationSpacing;
+      SetDecimationSpacing(decimationSpacing);
+    }
     else if ( ! strcmp( attName, "InterpolationType" ) )
     {
       int typeAsInt = GetInterpolationTypeFromString( attValue );
@@ -217,11 +322,23 @@ void vtkMRMLMarkupsToModelNode::ReadXMLAttributes( const char** atts )
       nameString >> tubeSegmentsBetweenControlPoints;
       SetTubeSegmentsBetweenControlPoints(tubeSegmentsBetweenControlPoints);
     }
+    else if ( ! strcmp( attName, "TubeSamplingTolerance" ) )
+    {
+      double tubeSamplingTolerance = 0.0;
+      std::stringstream nameString;
+      nameString << attValue;
+      nameString >> tubeSamplingTolerance;
+      SetTubeSamplingTolerance(tubeSamplingTolerance);
+    }
     else if ( ! strcmp( attName, "TubeLoop" ) )
     {
       bool isTrue = !strcmp( attValue, "true" );
       SetTubeLoop( isTrue );
     }
+    else if ( ! strcmp( attName, "CenterlineOutput" ) )
+    {
+      SetCenterlineOutput(!strcmp(attValue,"true"));
+    }
     else if ( ! strcmp( attName, "KochanekEndsCopyNearestDerivatives" ) )
     {
       bool isTrue = !strcmp( attValue, "true" );
@@ -294,6 +411,80 @@ void vtkMRMLMarkupsToModelNode::ReadXMLAttributes( const char** atts )
       }
       SetPolynomialOrder(polynomialOrder);
     }
+    else if ( ! strcmp( attName, "IncrementalCurveUpdate" ) )
+    {
+      SetIncrementalCurveUpdate(!strcmp(attValue,"true"));
+    }
+    else if ( ! strcmp( attName, "StreamingCurveUpdate" ) )
+    {
+      SetStreamingCurveUpdate(!strcmp(attValue,"true"));
+    }
+    else if ( ! strcmp( attName, "StreamingMaximumNumberOfPoints" ) )
+    {
+      int streamingMaximumNumberOfPoints = 0;
+      std::stringstream nameString;
+      nameString << attValue;
+      nameString >> streamingMaximumNumberOfPoints;
+      SetStreamingMaximumNumberOfPoints(streamingMaximumNumberOfPoints);
+    }
+    else if ( ! strcmp( attName, "StreamingMaximumPointAge" ) )
+    {
+      double streamingMaximumPointAge = 0.0;
+      std::stringstream nameString;
+      nameString << attValue;
+      nameString >> streamingMaximumPointAge;
+      SetStreamingMaximumPointAge(streamingMaximumPointAge);
+    }
+    else if ( ! strcmp( attName, "MaximumUpdateRate" ) )
+    {
+      double maximumUpdateRate = 0.0;
+      std::stringstream nameString;
+      nameString << attValue;
+      nameString >> maximumUpdateRate;
+      SetMaximumUpdateRate(maximumUpdateRate);
+    }
+    else if ( ! strcmp( attName, "FinalUpdateOnInteractionEnd" ) )
+    {
+      SetFinalUpdateOnInteractionEnd(!strcmp(attValue,"true"));
+    }
+    else if ( ! strcmp( attName, "AsynchronousUpdate" ) )
+    {
+      SetAsynchronousUpdate(!strcmp(attValue,"true"));
+    }
+    else if ( ! strcmp( attName, "QualityLevel" ) )
+    {
+      int levelAsInt = GetQualityLevelFromString( attValue );
+      if ( levelAsInt >= 0 && levelAsInt < QualityLevel_Last)
+      {
+        this->QualityLevel = levelAsInt;
+      }
+      else
+      {
+        vtkWarningMacro("Unrecognized quality level read from MRML node: " << attValue << ". Setting to FullQuality.");
+        this->QualityLevel = this->FullQuality;
+      }
+    }
+    else if ( ! strcmp( attName, "InteractionQualityLevel" ) )
+    {
+      int levelAsInt = GetQualityLevelFromString( attValue );
+      if ( levelAsInt >= 0 && levelAsInt < QualityLevel_Last)
+      {
+        this->InteractionQualityLevel = levelAsInt;
+      }
+      else
+      {
+        vtkWarningMacro("Unrecognized interaction quality level read from MRML node: " << attValue << ". Setting to PreviewQuality.");
+        this->InteractionQualityLevel = this->PreviewQuality;
+      }
+    }
+    else if ( ! strcmp( attName, "CleanMarkupsTolerance" ) )
+    {
+      double cleanMarkupsTolerance = 0.0;
+      std::stringstream nameString;
+      nameString << attValue;
+      nameString >> cleanMarkupsTolerance;
+      SetCleanMarkupsTolerance(cleanMarkupsTolerance);
+    }
   }
 
   this->EndModify(disabledModify);
@@ -302,8 +493,52 @@ void vtkMRMLMarkupsToModelNode::ReadXMLAttributes( const char** atts )
 //-----------------------------------------------------------------
 void vtkMRMLMarkupsToModelNode::Copy( vtkMRMLNode *anode )
 {  
+  int disabledModify = this->StartModify();
+
   Superclass::Copy( anode ); // This will take care of referenced nodes
-  this->Modified();
+
+  vtkMRMLMarkupsToModelNode* node = vtkMRMLMarkupsToModelNode::SafeDownCast( anode );
+  if ( node != NULL )
+  {
+    this->SetModelType( node->GetModelType() );
+    this->SetAutoUpdateOutput( node->GetAutoUpdateOutput() );
+    this->SetCleanMarkups( node->GetCleanMarkups() );
+    this->SetButterflySubdivision( node->GetButterflySubdivision() );
+    this->SetNumberOfSubdivisions( node->GetNumberOfSubdivisions() );
+    this->SetSinglePrecisionOutput( node->GetSinglePrecisionOutput() );
+    this->SetIncrementalDelaunay( node->GetIncrementalDelaunay() );
+    this->SetFollowInputTransform( node->GetFollowInputTransform() );
+    this->SetDelaunayAlpha( node->GetDelaunayAlpha() );
+    this->SetConvexHull( node->GetConvexHull() );
+    this->SetSurfaceGenerationMethod( node->GetSurfaceGenerationMethod() );
+    this->SetDecimationTargetNumberOfPoints( node->GetDecimationTargetNumberOfPoints() );
+    this->SetDecimationSpacing( node->GetDecimationSpacing() );
+    this->SetInterpolationType( node->GetInterpolationType() );
+    this->SetPointParameterType( node->GetPointParameterType() );
+    this->SetTubeRadius( node->GetTubeRadius() );
+    this->SetTubeSegmentsBetweenControlPoints( node->GetTubeSegmentsBetweenControlPoints() );
+    this->SetTubeSamplingTolerance( node->GetTubeSamplingTolerance() );
+    this->SetTubeNumberOfSides( node->GetTubeNumberOfSides() );
+    this->SetTubeLoop( node->GetTubeLoop() );
+    this->SetCenterlineOutput( node->GetCenterlineOutput() );
+    this->SetKochanekEndsCopyNearestDerivatives( node->GetKochanekEndsCopyNearestDerivatives() );
+    this->SetKochanekBias( node->GetKochanekBias() );
+    this->SetKochanekContinuity( node->GetKochanekContinuity() );
+    this->SetKochanekTension( node->GetKochanekTension() );
+    this->SetPolynomialOrder( node->GetPolynomialOrder() );
+    this->SetIncrementalCurveUpdate( node->GetIncrementalCurveUpdate() );
+    this->SetStreamingCurveUpdate( node->GetStreamingCurveUpdate() );
+    this->SetStreamingMaximumNumberOfPoints( node->GetStreamingMaximumNumberOfPoints() );
+    this->SetStreamingMaximumPointAge( node->GetStreamingMaximumPointAge() );
+    this->SetMaximumUpdateRate( node->GetMaximumUpdateRate() );
+    this->SetFinalUpdateOnInteractionEnd( node->GetFinalUpdateOnInteractionEnd() );
+    this->SetAsynchronousUpdate( node->GetAsynchronousUpdate() );
+    this->SetQualityLevel( node->GetQualityLevel() );
+    this->SetInteractionQualityLevel( node->GetInteractionQualityLevel() );
+    this->SetCleanMarkupsTolerance( node->GetCleanMarkupsTolerance() );
+  }
+
+  this->EndModify( disabledModify );
 }
 
 //-----------------------------------------------------------------
@@ -356,17 +591,118 @@ void vtkMRMLMarkupsToModelNode::SetAndObserveOutputModelNodeID( const char* outp
 }
 
 //-----------------------------------------------------------------
-void vtkMRMLMarkupsToModelNode::ProcessMRMLEvents( vtkObject *caller, unsigned long /*event*/, void* /*callData*/ )
+void vtkMRMLMarkupsToModelNode::ProcessMRMLEvents( vtkObject *caller, unsigned long event, void* /*callData*/ )
 {
   vtkMRMLNode* callerNode = vtkMRMLNode::SafeDownCast( caller );
   if ( callerNode == NULL ) return;
 
   if ( this->GetInputNode() && this->GetInputNode()==caller )
   {
-    this->InvokeCustomModifiedEvent(MarkupsPositionModifiedEvent);
+    if ( event == vtkMRMLMarkupsNode::PointStartInteractionEvent )
+    {
+      this->InputInteractionInProgress = true;
+      this->InvokeEvent( InputInteractionStartedEvent );
+    }
+    else if ( event == vtkMRMLMarkupsNode::PointEndInteractionEvent )
+    {
+      this->InputInteractionInProgress = false;
+      this->InvokeEvent( InputInteractionEndedEvent );
+    }
+    else if ( event == vtkMRMLTransformableNode::TransformModifiedEvent )
+    {
+      // the points are read in the coordinate system of the input node, they are not affected by its transform
+      this->InvokeEvent( InputTransformModifiedEvent );
+    }
+    else
+    {
+      this->InvokeCustomModifiedEvent(MarkupsPositionModifiedEvent);
+    }
   }
 }
 
+//-----------------------------------------------------------------
+int vtkMRMLMarkupsToModelNode::GetCurrentQualityLevel()
+{
+  if ( this->InputInteractionInProgress )
+  {
+    return this->InteractionQualityLevel;
+  }
+  return this->QualityLevel;
+}
+
+//-----------------------------------------------------------------
+std::string vtkMRMLMarkupsToModelNode::GetGeometryParametersSignature()
+{
+  std::string signature;
+  AddToSignature( signature, this->CleanMarkups );
+  if ( this->CleanMarkups )
+  {
+    AddToSignature( signature, this->CleanMarkupsTolerance );
+  }
+  AddToSignature( signature, this->ModelType );
+  if ( this->ModelType == ClosedSurface )
+  {
+    // preview quality skips smoothing and convex hull computation (see vtkSlicerMarkupsToModelLogic::GenerateOutputPolyData)
+    bool previewQuality = ( this->GetCurrentQualityLevel() == PreviewQuality );
+    AddToSignature( signature, this->SurfaceGenerationMethod );
+    AddToSignature( signature, this->DecimationTargetNumberOfPoints );
+    AddToSignature( signature, this->DecimationSpacing );
+    AddToSignature( signature, this->DelaunayAlpha );
+    AddToSignature( signature, this->ButterflySubdivision && !previewQuality );
+    if ( this->ButterflySubdivision && !previewQuality )
+    {
+      AddToSignature( signature, this->NumberOfSubdivisions );
+    }
+    AddToSignature( signature, this->ConvexHull && !previewQuality );
+    AddToSignature( signature, this->SinglePrecisionOutput );
+    AddToSignature( signature, this->IncrementalDelaunay );
+  }
+  else if ( this->ModelType == Curve )
+  {
+    AddToSignature( signature, this->InterpolationType );
+    AddToSignature( signature, this->TubeRadius );
+    AddToSignature( signature, this->TubeNumberOfSides );
+    AddToSignature( signature, this->TubeSegmentsBetweenControlPoints );
+    AddToSignature( signature, this->TubeSamplingTolerance );
+    AddToSignature( signature, this->TubeLoop );
+    AddToSignature( signature, this->CenterlineOutput );
+    // the retention limits of streaming curves determine which points the model contains
+    AddToSignature( signature, this->StreamingCurveUpdate );
+    if ( this->StreamingCurveUpdate )
+    {
+      AddToSignature( signature, this->StreamingMaximumNumberOfPoints );
+      AddToSignature( signature, this->StreamingMaximumPointAge );
+    }
+    if ( this->InterpolationType == KochanekSpline )
+    {
+      AddToSignature( signature, this->KochanekBias );
+      AddToSignature( signature, this->KochanekContinuity );
+      AddToSignature( signature, this->KochanekTension );
+      AddToSignature( signature, this->KochanekEndsCopyNearestDerivatives );
+    }
+    else if ( this->InterpolationType == Polynomial )
+    {
+      AddToSignature( signature, this->PolynomialOrder );
+      AddToSignature( signature, this->PointParameterType );
+    }
+  }
+  return signature;
+}
+
+//-----------------------------------------------------------------
+vtkTypeUInt64 vtkMRMLMarkupsToModelNode::GetGeometryParametersKey()
+{
+  // FNV-1a hash of the signature
+  std::string signature = this->GetGeometryParametersSignature();
+  vtkTypeUInt64 hash = FNV_OFFSET_BASIS;
+  for ( size_t i = 0; i < signature.size(); i++ )
+  {
+    hash ^= static_cast< unsigned char >( signature[ i ] );
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
 //-----------------------------------------------------------------
 const char* vtkMRMLMarkupsToModelNode::GetModelTypeAsString( int id )
 {
@@ -402,6 +738,34 @@ const char* vtkMRMLMarkupsToModelNode::GetPointParameterTypeAsString( int id )
   {
   case RawIndices: return "rawIndices";
   case MinimumSpanningTree: return "minimumSpanningTree";
+  case MinimumSpanningTreeDense: return "minimumSpanningTreeDense";
+  default:
+    // invalid id
+    return "";
+  }
+}
+
+//------------------------------------------------------------------------------
+const char* vtkMRMLMarkupsToModelNode::GetQualityLevelAsString( int id )
+{
+  switch ( id )
+  {
+  case PreviewQuality: return "preview";
+  case FullQuality: return "full";
+  default:
+    // invalid id
+    return "";
+  }
+}
+
+//------------------------------------------------------------------------------
+const char* vtkMRMLMarkupsToModelNode::GetSurfaceGenerationMethodAsString( int id )
+{
+  switch ( id )
+  {
+  case DelaunaySurface: return "delaunay";
+  case ConvexHullSurface: return "convexHull";
+  case ImplicitSurface: return "implicitSurface";
   default:
     // invalid id
     return "";
@@ -468,6 +832,46 @@ int vtkMRMLMarkupsToModelNode::GetPointParameterTypeFromString( const char* name
   return -1;
 }
 
+//------------------------------------------------------------------------------
+int vtkMRMLMarkupsToModelNode::GetQualityLevelFromString( const char* name )
+{
+  if ( name == NULL )
+  {
+    // invalid name
+    return -1;
+  }
+  for ( int i = 0; i < QualityLevel_Last; i++ )
+  {
+    if ( strcmp( name, GetQualityLevelAsString( i ) ) == 0 )
+    {
+      // found a matching name
+      return i;
+    }
+  }
+  // unknown name
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLMarkupsToModelNode::GetSurfaceGenerationMethodFromString( const char* name )
+{
+  if ( name == NULL )
+  {
+    // invalid name
+    return -1;
+  }
+  for ( int i = 0; i < SurfaceGenerationMethod_Last; i++ )
+  {
+    if ( strcmp( name, GetSurfaceGenerationMethodAsString( i ) ) == 0 )
+    {
+      // found a matching name
+      return i;
+    }
+  }
+  // unknown name
+  return -1;
+}
+
 //------------------------------------------------------------------------------
 vtkMRMLMarkupsFiducialNode* vtkMRMLMarkupsToModelNode::GetMarkupsNode()
 {
@@ -18,6 +18,7 @@
 // std includes
 #include <iostream>
 #include <list>
+#include <string>
 
 // vtk includes
 #include <vtkCommand.h>
@@ -68,7 +69,14 @@ public:
     /// MarkupsPositionModifiedEvent is called when markup point positions are modified.
     /// This make it easier for logic or other classes to observe any changes in input data.
     // vtkCommand::UserEvent + 777 is just a random value that is very unlikely to be used for anything else in this class
-    MarkupsPositionModifiedEvent = vtkCommand::UserEvent + 777
+    MarkupsPositionModifiedEvent = vtkCommand::UserEvent + 777,
+    /// InputInteractionStartedEvent and InputInteractionEndedEvent are called when the user starts/stops
+    /// dragging a point of the input markups.
+    InputInteractionStartedEvent,
+    InputInteractionEndedEvent,
+    /// InputTransformModifiedEvent is called when the parent transform of the input node or its matrix is modified.
+    /// The positions of the input points in the coordinate system of the input node do not change.
+    InputTransformModifiedEvent
   };
 
   enum ModelType
@@ -91,9 +99,25 @@ public:
   {
     RawIndices = 0,
     MinimumSpanningTree,
+    MinimumSpanningTreeDense, // reference implementation of MinimumSpanningTree, slow for large point sets
     PointParameterType_Last // insert valid types above this line
   };
 
+  enum SurfaceGenerationMethodType
+  {
+    DelaunaySurface = 0, // vtkDelaunay3D tetrahedralization, recommended for small point sets
+    ConvexHullSurface, // quickhull convex hull, fast for large point sets
+    ImplicitSurface, // contour of an implicit surface fitted to the points, fast for large non-convex point clouds
+    SurfaceGenerationMethod_Last // insert valid types above this line
+  };
+
+  enum QualityLevelType
+  {
+    PreviewQuality = 0, // fast approximate model, skips the expensive refinement steps
+    FullQuality,
+    QualityLevel_Last // insert valid types above this line
+  };
+
   vtkTypeMacro( vtkMRMLMarkupsToModelNode, vtkMRMLNode );
   
   // Standard MRML node methods  
@@ -126,23 +150,119 @@ public:
   vtkSetMacro( TubeRadius, double );
   vtkGetMacro( TubeSegmentsBetweenControlPoints, int );
   vtkSetMacro( TubeSegmentsBetweenControlPoints, int );
+  // If positive then curve segments are sampled adaptively, until the curve deviates less than this distance (in mm)
+  // from the straight lines between the samples. TubeSegmentsBetweenControlPoints is not used then.
+  vtkGetMacro( TubeSamplingTolerance, double );
+  vtkSetMacro( TubeSamplingTolerance, double );
   vtkGetMacro( TubeNumberOfSides, int );
   vtkSetMacro( TubeNumberOfSides, int );
   vtkGetMacro( TubeLoop, bool );
   vtkSetMacro( TubeLoop, bool );
+  // If enabled then the output of a curve with positive TubeRadius is its centerline only (a polyline),
+  // with the "TubeRadius" and "TubeNormals" (frame) point data arrays, instead of the tessellated tube.
+  // The tube can be rendered from these arrays on the display side, or tessellated on demand for export
+  // (see vtkSlicerMarkupsToModelTubeGeneration::GenerateTubeModelFromCenterline).
+  vtkGetMacro( CenterlineOutput, bool );
+  vtkSetMacro( CenterlineOutput, bool );
+  vtkBooleanMacro( CenterlineOutput, bool );
   vtkGetMacro( KochanekEndsCopyNearestDerivatives, bool );
   vtkSetMacro( KochanekEndsCopyNearestDerivatives, bool );
-  
+  // If enabled then moving a few control points only regenerates the affected curve segments
+  // and tube rings, and the output poly data is patched in place.
+  vtkGetMacro( IncrementalCurveUpdate, bool );
+  vtkSetMacro( IncrementalCurveUpdate, bool );
+  vtkBooleanMacro( IncrementalCurveUpdate, bool );
+  // If enabled then points appended to the end of the input are added to the end of the curve model,
+  // without regenerating the rest of it. Intended for inputs that grow continuously, such as the positions
+  // of a tracked tool. Not used for polynomial curves, loops and adaptive sampling.
+  // CleanMarkupsTolerance is used as the minimum distance between consecutive curve points.
+  vtkGetMacro( StreamingCurveUpdate, bool );
+  vtkSetMacro( StreamingCurveUpdate, bool );
+  vtkBooleanMacro( StreamingCurveUpdate, bool );
+  // Only this many of the most recent points are kept in a streaming curve. 0 means unlimited.
+  vtkGetMacro( StreamingMaximumNumberOfPoints, int );
+  vtkSetMacro( StreamingMaximumNumberOfPoints, int );
+  // Only the points appended in this many seconds are kept in a streaming curve. 0 means unlimited.
+  vtkGetMacro( StreamingMaximumPointAge, double );
+  vtkSetMacro( StreamingMaximumPointAge, double );
+
   vtkGetMacro( AutoUpdateOutput, bool );
   vtkSetMacro( AutoUpdateOutput, bool );
+  // Maximum number of automatic output updates per second. Changes that arrive faster are merged
+  // into a single update. 0 means that updates are performed immediately on every change.
+  vtkGetMacro( MaximumUpdateRate, double );
+  vtkSetMacro( MaximumUpdateRate, double );
+  // If enabled then the output is updated immediately when the user stops dragging an input point,
+  // regardless of the maximum update rate.
+  vtkGetMacro( FinalUpdateOnInteractionEnd, bool );
+  vtkSetMacro( FinalUpdateOnInteractionEnd, bool );
+  vtkBooleanMacro( FinalUpdateOnInteractionEnd, bool );
+  // If enabled then the output geometry is computed on a background thread, and the result is
+  // published to the output model node from the main thread when it is ready.
+  // The computation of a closed surface is aborted when a newer update is requested.
+  // Incremental curve update is not used in this mode.
+  vtkGetMacro( AsynchronousUpdate, bool );
+  vtkSetMacro( AsynchronousUpdate, bool );
+  vtkBooleanMacro( AsynchronousUpdate, bool );
+  // Quality level of the generated model (see QualityLevelType)
+  vtkGetMacro( QualityLevel, int );
+  vtkSetMacro( QualityLevel, int );
+  // Quality level of the generated model while the user is dragging a point of the input markups.
+  // When the interaction ends the model is regenerated at QualityLevel.
+  vtkGetMacro( InteractionQualityLevel, int );
+  vtkSetMacro( InteractionQualityLevel, int );
+  // Returns the quality level that applies to the next update, depending on whether
+  // an interaction is in progress
+  int GetCurrentQualityLevel();
+  // Returns the values of the parameters that the geometry of the output model depends on, as raw bytes.
+  // Only the parameters that are used by the current model type and interpolation type are
+  // taken into account, for example the Kochanek parameters do not affect the signature of a linear curve.
+  // Parameters that do not change the geometry (update scheduling, display) do not affect the signature either.
+  std::string GetGeometryParametersSignature();
+  // Returns a hash of GetGeometryParametersSignature. Different signatures may have the same key.
+  vtkTypeUInt64 GetGeometryParametersKey();
+  // True while the user is dragging a point of the input markups
+  vtkGetMacro( InputInteractionInProgress, bool );
   vtkGetMacro( CleanMarkups, bool );
   vtkSetMacro( CleanMarkups, bool );
+  // Input points closer than this distance (in mm) to a preceding point are removed if CleanMarkups is enabled
+  vtkGetMacro( CleanMarkupsTolerance, double );
+  vtkSetMacro( CleanMarkupsTolerance, double );
   vtkGetMacro( ButterflySubdivision, bool );
   vtkSetMacro( ButterflySubdivision, bool );
+  // Subdivision level of the butterfly subdivision: number of times the triangles are subdivided.
+  // Each level quadruples the number of triangles.
+  vtkGetMacro( NumberOfSubdivisions, int );
+  vtkSetMacro( NumberOfSubdivisions, int );
+  // If enabled then the points of the closed surface are stored in single precision (float),
+  // which halves the memory needed for the point coordinates.
+  vtkGetMacro( SinglePrecisionOutput, bool );
+  vtkSetMacro( SinglePrecisionOutput, bool );
+  vtkBooleanMacro( SinglePrecisionOutput, bool );
+  // If enabled then the Delaunay surface (without alpha filtering) is updated locally when points are added,
+  // moved or removed, and only the part of the smoothed surface around the changed points is subdivided again.
+  vtkGetMacro( IncrementalDelaunay, bool );
+  vtkSetMacro( IncrementalDelaunay, bool );
+  vtkBooleanMacro( IncrementalDelaunay, bool );
+  // If enabled then the output model is placed under the parent transform of the input node.
+  // The model is generated from the point positions in the coordinate system of the input node, so when
+  // only the transform changes (e.g., a tracked reference frame moves) the model does not have to be regenerated.
+  vtkGetMacro( FollowInputTransform, bool );
+  vtkSetMacro( FollowInputTransform, bool );
+  vtkBooleanMacro( FollowInputTransform, bool );
   vtkGetMacro( DelaunayAlpha, double );
   vtkSetMacro( DelaunayAlpha, double );
   vtkGetMacro( ConvexHull, bool );
   vtkSetMacro( ConvexHull, bool );
+  // Method of generating the closed surface (see SurfaceGenerationMethodType)
+  vtkGetMacro( SurfaceGenerationMethod, int );
+  vtkSetMacro( SurfaceGenerationMethod, int );
+  // Input points of a closed surface are decimated to approximately this many points. 0 means no decimation.
+  vtkGetMacro( DecimationTargetNumberOfPoints, int );
+  vtkSetMacro( DecimationTargetNumberOfPoints, int );
+  // Grid cell size (in mm) of the decimation. If 0 then it is computed from DecimationTargetNumberOfPoints.
+  vtkGetMacro( DecimationSpacing, double );
+  vtkSetMacro( DecimationSpacing, double );
 
 protected:
 
@@ -165,9 +285,13 @@ public:
   static const char* GetModelTypeAsString( int id );
   static const char* GetInterpolationTypeAsString( int id );
   static const char* GetPointParameterTypeAsString( int id );
+  static const char* GetQualityLevelAsString( int id );
+  static const char* GetSurfaceGenerationMethodAsString( int id );
   static int GetModelTypeFromString( const char* name );
   static int GetInterpolationTypeFromString( const char* name );
   static int GetPointParameterTypeFromString( const char* name );
+  static int GetQualityLevelFromString( const char* name );
+  static int GetSurfaceGenerationMethodFromString( const char* name );
 
   // DEPRECATED - Get the input node
   vtkMRMLMarkupsFiducialNode* GetMarkupsNode( );
@@ -187,18 +311,38 @@ private:
   int    PointParameterType;
   bool   AutoUpdateOutput;
   bool   CleanMarkups;
+  double CleanMarkupsTolerance;
   bool   ButterflySubdivision;
+  int    NumberOfSubdivisions;
+  bool   SinglePrecisionOutput;
+  bool   IncrementalDelaunay;
+  bool   FollowInputTransform;
   double DelaunayAlpha;
   bool   ConvexHull;
+  int    SurfaceGenerationMethod;
+  int    DecimationTargetNumberOfPoints;
+  double DecimationSpacing;
   double TubeRadius;
   int    TubeSegmentsBetweenControlPoints;
+  double TubeSamplingTolerance;
   int    TubeNumberOfSides;
   bool   TubeLoop;
+  bool   CenterlineOutput;
   bool   KochanekEndsCopyNearestDerivatives;
   double KochanekTension;
   double KochanekBias; 
   double KochanekContinuity;
   int    PolynomialOrder;
+  bool   IncrementalCurveUpdate;
+  bool   StreamingCurveUpdate;
+  int    StreamingMaximumNumberOfPoints;
+  double StreamingMaximumPointAge;
+  double MaximumUpdateRate;
+  bool   FinalUpdateOnInteractionEnd;
+  bool   AsynchronousUpdate;
+  int    QualityLevel;
+  int    InteractionQualityLevel;
+  bool   InputInteractionInProgress;
 };
 
 #endif
@@ -0,0 +1,794 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Benchmark of the model generation functions of the MarkupsToModel module.
+// Synthetic, reproducible point sets are converted to curves (all interpolation and point parameter types)
+// and closed surfaces (all option combinations), and the time spent in each stage is written as JSON.
+// The point arrangement analysis of the closed surfaces is also compared to the reference vtkOBBTree implementation.
+// The update modes of the logic that keep state between updates (asynchronous, incremental curve, streaming curve
+// and incremental Delaunay updates) are timed for an initial update followed by updates after single point changes.
+//
+// Usage: MarkupsToModelBenchmark [--max-points N] [--repetitions N] [--output file.json]
+
+// MarkupsToModel includes
+#include "vtkMRMLMarkupsToModelNode.h"
+#include "vtkSlicerMarkupsToModelClosedSurfaceGeneration.h"
+#include "vtkSlicerMarkupsToModelCurveGeneration.h"
+#include "vtkSlicerMarkupsToModelLogic.h"
+#include "vtkSlicerMarkupsToModelPointProcessing.h"
+#include "vtkSlicerMarkupsToModelSubdivisionFilter.h"
+#include "vtkSlicerMarkupsToModelTubeGeneration.h"
+
+// Slicer includes
+#include "vtkMRMLMarkupsFiducialNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+
+// vtk includes
+#include <vtkButterflySubdivisionFilter.h>
+#include <vtkCallbackCommand.h>
+#include <vtkCellArray.h>
+#include <vtkDataSetSurfaceFilter.h>
+#include <vtkDelaunay3D.h>
+#include <vtkDoubleArray.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkOBBTree.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtkTransform.h>
+#include <vtkTransformFilter.h>
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// constants within this file
+static const int BENCHMARK_RANDOM_SEED = 1;
+static const int BENCHMARK_MAXIMUM_NUMBER_OF_POINTS_DEFAULT = 100000;
+static const int BENCHMARK_REPETITIONS_DEFAULT = 3;
+// every Nth point of the point sets is duplicated, so that duplicate removal has some work to do
+static const int BENCHMARK_DUPLICATE_POINT_INTERVAL = 20;
+// the dense minimum spanning tree stores the full distance matrix, skip it for larger point sets
+static const int BENCHMARK_MAXIMUM_NUMBER_OF_POINTS_DENSE_MINIMUM_SPANNING_TREE = 2000;
+static const double BENCHMARK_DUPLICATE_POINT_TOLERANCE = 0.01;
+static const double BENCHMARK_TUBE_RADIUS = 1.0;
+static const int BENCHMARK_TUBE_NUMBER_OF_SIDES = 8;
+static const int BENCHMARK_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS = 5;
+static const double BENCHMARK_DELAUNAY_ALPHA = 20.0;
+static const int BENCHMARK_NUMBER_OF_SUBDIVISIONS = 3;
+// the point arrangement analysis is fast, it is repeated to get measurable times
+static const int BENCHMARK_POINT_ARRANGEMENT_ITERATIONS = 10;
+static const double BENCHMARK_COMPARE_TO_ZERO_TOLERANCE = 0.0001;
+// update modes of the logic, each is timed for an initial update and this many updates after changing one point
+static const char* BENCHMARK_UPDATE_MODES[] = { "asynchronous", "incrementalCurve", "streamingCurve", "incrementalDelaunay" };
+static const int BENCHMARK_NUMBER_OF_UPDATE_MODES = 4;
+static const int BENCHMARK_NUMBER_OF_UPDATES = 10;
+// the moved points are spread over the point set, each is moved by this distance (in mm)
+static const int BENCHMARK_MOVED_POINT_STRIDE = 7;
+static const double BENCHMARK_MOVED_POINT_DISTANCE = 1.0;
+
+//------------------------------------------------------------------------------
+// Durations of the stages of one model generation, in seconds
+class BenchmarkStageTimes
+{
+public:
+  void Add( const std::string& stageName, double seconds )
+  {
+    for ( size_t i = 0; i < this->Stages.size(); i++ )
+    {
+      if ( this->Stages[ i ].first == stageName )
+      {
+        this->Stages[ i ].second = seconds;
+        return;
+      }
+    }
+    this->Stages.push_back( std::make_pair( stageName, seconds ) );
+  }
+
+  // keep the minimum of each stage over the repetitions
+  void KeepMinimum( const BenchmarkStageTimes& other )
+  {
+    if ( this->Stages.empty() )
+    {
+      this->Stages = other.Stages;
+      return;
+    }
+    for ( size_t i = 0; i < this->Stages.size() && i < other.Stages.size(); i++ )
+    {
+      this->Stages[ i ].second = std::min( this->Stages[ i ].second, other.Stages[ i ].second );
+    }
+  }
+
+  std::vector< std::pair< std::string, double > > Stages;
+};
+
+//------------------------------------------------------------------------------
+// Measures the time elapsed since the last call
+class BenchmarkStopwatch
+{
+public:
+  BenchmarkStopwatch()
+  {
+    this->LastTime = vtkTimerLog::GetUniversalTime();
+  }
+  double Lap()
+  {
+    double currentTime = vtkTimerLog::GetUniversalTime();
+    double elapsedTime = currentTime - this->LastTime;
+    this->LastTime = currentTime;
+    return elapsedTime;
+  }
+private:
+  double LastTime;
+};
+
+//------------------------------------------------------------------------------
+// Create a point set of the given shape. Ordered point sets follow the shape, unordered ones are shuffled.
+//   line - points along a straight line
+//   spiral - planar spiral
+//   helix - non-planar helix
+//   ball - random points in a ball (only unordered)
+static void CreatePointSet( const std::string& shape, bool ordered, int numberOfPoints, vtkPoints* outputPoints )
+{
+  vtkSmartPointer< vtkMinimalStandardRandomSequence > random = vtkSmartPointer< vtkMinimalStandardRandomSequence >::New();
+  random->SetSeed( BENCHMARK_RANDOM_SEED );
+
+  std::vector< double > coordinates( 3 * numberOfPoints );
+  for ( int i = 0; i < numberOfPoints; i++ )
+  {
+    double* point = &( coordinates[ 3 * i ] );
+    if ( i % BENCHMARK_DUPLICATE_POINT_INTERVAL == BENCHMARK_DUPLICATE_POINT_INTERVAL - 1 )
+    {
+      // duplicate of the previous point
+      point[ 0 ] = point[ -3 ];
+      point[ 1 ] = point[ -2 ];
+      point[ 2 ] = point[ -1 ];
+      continue;
+    }
+    double t = i / (double)std::max( numberOfPoints - 1, 1 );
+    point[ 0 ] = 0.0;
+    point[ 1 ] = 0.0;
+    point[ 2 ] = 0.0;
+    if ( shape == "line" )
+    {
+      point[ 0 ] = 100.0 * t;
+      point[ 1 ] = 50.0 * t;
+      point[ 2 ] = 25.0 * t;
+    }
+    else if ( shape == "spiral" )
+    {
+      double angle = 10.0 * vtkMath::Pi() * t;
+      double radius = 5.0 + 45.0 * t;
+      point[ 0 ] = radius * cos( angle );
+      point[ 1 ] = radius * sin( angle );
+    }
+    else if ( shape == "helix" )
+    {
+      double angle = 10.0 * vtkMath::Pi() * t;
+      point[ 0 ] = 20.0 * cos( angle );
+      point[ 1 ] = 20.0 * sin( angle );
+      point[ 2 ] = 100.0 * t;
+    }
+    else // ball
+    {
+      do
+      {
+        for ( int d = 0; d < 3; d++ )
+        {
+          random->Next();
+          point[ d ] = random->GetRangeValue( -50.0, 50.0 );
+        }
+      } while ( vtkMath::Dot( point, point ) > 50.0 * 50.0 );
+    }
+  }
+
+  std::vector< int > order( numberOfPoints );
+  for ( int i = 0; i < numberOfPoints; i++ )
+  {
+    order[ i ] = i;
+  }
+  if ( !ordered )
+  {
+    // Fisher-Yates shuffle
+    for ( int i = numberOfPoints - 1; i > 0; i-- )
+    {
+      random->Next();
+      int j = std::min( static_cast< int >( random->GetValue() * ( i + 1 ) ), i );
+      std::swap( order[ i ], order[ j ] );
+    }
+  }
+
+  outputPoints->SetNumberOfPoints( numberOfPoints );
+  for ( int i = 0; i < numberOfPoints; i++ )
+  {
+    outputPoints->SetPoint( i, &( coordinates[ 3 * order[ i ] ] ) );
+  }
+}
+
+//------------------------------------------------------------------------------
+static void CreateMarkupsNode( vtkPoints* points, vtkMRMLMarkupsFiducialNode* markupsNode )
+{
+  markupsNode->RemoveAllMarkups();
+  for ( vtkIdType i = 0; i < points->GetNumberOfPoints(); i++ )
+  {
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    points->GetPoint( i, point );
+    markupsNode->AddFiducial( point[ 0 ], point[ 1 ], point[ 2 ] );
+  }
+}
+
+//------------------------------------------------------------------------------
+static BenchmarkStageTimes RunCurveBenchmark( vtkMRMLMarkupsFiducialNode* markupsNode, int interpolationType, int pointParameterType,
+  vtkPolyData* outputTubePolyData )
+{
+  BenchmarkStageTimes stageTimes;
+  vtkSmartPointer< vtkPoints > controlPoints = vtkSmartPointer< vtkPoints >::New();
+  vtkSmartPointer< vtkPolyData > curvePolyData = vtkSmartPointer< vtkPolyData >::New();
+  BenchmarkStopwatch stopwatch;
+
+  vtkSlicerMarkupsToModelLogic::MarkupsToPoints( markupsNode, controlPoints );
+  stageTimes.Add( "extraction", stopwatch.Lap() );
+
+  vtkSlicerMarkupsToModelPointProcessing::RemoveDuplicatePoints( controlPoints, BENCHMARK_DUPLICATE_POINT_TOLERANCE );
+  stageTimes.Add( "deduplication", stopwatch.Lap() );
+
+  // the curve is generated without tube (as a polyline) to time the interpolation separately from the tubing
+  switch ( interpolationType )
+  {
+    case vtkMRMLMarkupsToModelNode::Linear:
+      stageTimes.Add( "parameterization", 0.0 );
+      stopwatch.Lap();
+      vtkSlicerMarkupsToModelCurveGeneration::GeneratePiecewiseLinearCurveModel( controlPoints, curvePolyData,
+        0.0, BENCHMARK_TUBE_NUMBER_OF_SIDES, BENCHMARK_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS, false );
+      break;
+    case vtkMRMLMarkupsToModelNode::CardinalSpline:
+      stageTimes.Add( "parameterization", 0.0 );
+      stopwatch.Lap();
+      vtkSlicerMarkupsToModelCurveGeneration::GenerateCardinalSplineCurveModel( controlPoints, curvePolyData,
+        0.0, BENCHMARK_TUBE_NUMBER_OF_SIDES, BENCHMARK_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS, false );
+      break;
+    case vtkMRMLMarkupsToModelNode::KochanekSpline:
+      stageTimes.Add( "parameterization", 0.0 );
+      stopwatch.Lap();
+      vtkSlicerMarkupsToModelCurveGeneration::GenerateKochanekSplineCurveModel( controlPoints, curvePolyData,
+        0.0, BENCHMARK_TUBE_NUMBER_OF_SIDES, BENCHMARK_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS, false );
+      break;
+    case vtkMRMLMarkupsToModelNode::Polynomial:
+    {
+      vtkSmartPointer< vtkDoubleArray > pointParameters = vtkSmartPointer< vtkDoubleArray >::New();
+      switch ( pointParameterType )
+      {
+        case vtkMRMLMarkupsToModelNode::RawIndices:
+          vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromIndices( controlPoints, pointParameters );
+          break;
+        case vtkMRMLMarkupsToModelNode::MinimumSpanningTree:
+          vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSpanningTree( controlPoints, pointParameters );
+          break;
+        case vtkMRMLMarkupsToModelNode::MinimumSpanningTreeDense:
+          vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromDenseMinimumSpanningTree( controlPoints, pointParameters );
+          break;
+      }
+      stageTimes.Add( "parameterization", stopwatch.Lap() );
+      vtkSlicerMarkupsToModelCurveGeneration::GeneratePolynomialCurveModel( controlPoints, curvePolyData,
+        0.0, BENCHMARK_TUBE_NUMBER_OF_SIDES, BENCHMARK_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS, false,
+        vtkSlicerMarkupsToModelCurveGeneration::POLYNOMIAL_ORDER_DEFAULT, pointParameters );
+      break;
+    }
+  }
+  stageTimes.Add( "interpolation", stopwatch.Lap() );
+
+  if ( curvePolyData->GetPoints() != NULL )
+  {
+    vtkSlicerMarkupsToModelTubeGeneration::GenerateTubeModel( curvePolyData->GetPoints(), outputTubePolyData,
+      BENCHMARK_TUBE_RADIUS, BENCHMARK_TUBE_NUMBER_OF_SIDES );
+  }
+  stageTimes.Add( "tubing", stopwatch.Lap() );
+  return stageTimes;
+}
+
+//------------------------------------------------------------------------------
+static BenchmarkStageTimes RunClosedSurfaceBenchmark( vtkMRMLMarkupsFiducialNode* markupsNode, bool smoothing, bool forceConvex, double delaunayAlpha,
+  int surfaceGenerationMethod, bool timeFilters, vtkPolyData* outputPolyData )
+{
+  BenchmarkStageTimes stageTimes;
+  vtkSmartPointer< vtkPoints > controlPoints = vtkSmartPointer< vtkPoints >::New();
+  BenchmarkStopwatch stopwatch;
+
+  vtkSlicerMarkupsToModelLogic::MarkupsToPoints( markupsNode, controlPoints );
+  stageTimes.Add( "extraction", stopwatch.Lap() );
+
+  vtkSlicerMarkupsToModelPointProcessing::RemoveDuplicatePoints( controlPoints, BENCHMARK_DUPLICATE_POINT_TOLERANCE );
+  stageTimes.Add( "deduplication", stopwatch.Lap() );
+
+  vtkSlicerMarkupsToModelClosedSurfaceGeneration::GenerateClosedSurfaceModel( controlPoints, outputPolyData, delaunayAlpha, smoothing, forceConvex,
+    surfaceGenerationMethod );
+  stageTimes.Add( "generation", stopwatch.Lap() );
+
+  if ( !timeFilters )
+  {
+    return stageTimes;
+  }
+
+  // Run the filters of the non-planar closed surface pipeline separately to see how the generation time is distributed.
+  // Planar and linear point sets are extruded before triangulation, which is internal to the generation function.
+  vtkSmartPointer< vtkCellArray > inputCellArray = vtkSmartPointer< vtkCellArray >::New();
+  inputCellArray->InsertNextCell( controlPoints->GetNumberOfPoints() );
+  for ( vtkIdType i = 0; i < controlPoints->GetNumberOfPoints(); i++ )
+  {
+    inputCellArray->InsertCellPoint( i );
+  }
+  vtkSmartPointer< vtkPolyData > inputPolyData = vtkSmartPointer< vtkPolyData >::New();
+  inputPolyData->SetPoints( controlPoints );
+  inputPolyData->SetLines( inputCellArray );
+  stopwatch.Lap();
+
+  vtkSmartPointer< vtkDelaunay3D > delaunay = vtkSmartPointer< vtkDelaunay3D >::New();
+  delaunay->SetInputData( inputPolyData );
+  delaunay->SetAlpha( delaunayAlpha );
+  delaunay->AlphaTrisOff();
+  delaunay->AlphaLinesOff();
+  delaunay->AlphaVertsOff();
+  vtkSmartPointer< vtkDataSetSurfaceFilter > surfaceFilter = vtkSmartPointer< vtkDataSetSurfaceFilter >::New();
+  surfaceFilter->SetInputConnection( delaunay->GetOutputPort() );
+  surfaceFilter->Update();
+  stageTimes.Add( "delaunay", stopwatch.Lap() );
+
+  vtkPolyData* surfacePolyData = surfaceFilter->GetOutput();
+  vtkSmartPointer< vtkPolyDataNormals > orientation = vtkSmartPointer< vtkPolyDataNormals >::New();
+  orientation->SetInputData( surfacePolyData );
+  orientation->ComputePointNormalsOff();
+  orientation->ComputeCellNormalsOn();
+  orientation->SplittingOff();
+  orientation->Update();
+  stageTimes.Add( "orientation", stopwatch.Lap() );
+
+  vtkSmartPointer< vtkSlicerMarkupsToModelSubdivisionFilter > subdivisionFilter = vtkSmartPointer< vtkSlicerMarkupsToModelSubdivisionFilter >::New();
+  subdivisionFilter->SetInputConnection( orientation->GetOutputPort() );
+  subdivisionFilter->SetButterflyScheme( smoothing );
+  subdivisionFilter->SetNumberOfSubdivisions( smoothing ? BENCHMARK_NUMBER_OF_SUBDIVISIONS : 1 );
+  subdivisionFilter->Update();
+  stageTimes.Add( "subdivision and normals", stopwatch.Lap() );
+
+  // reference implementation: the VTK subdivision filter and normals filter
+  vtkSmartPointer< vtkButterflySubdivisionFilter > referenceSubdivisionFilter = vtkSmartPointer< vtkButterflySubdivisionFilter >::New();
+  if ( smoothing )
+  {
+    referenceSubdivisionFilter->SetInputData( surfacePolyData );
+    referenceSubdivisionFilter->SetNumberOfSubdivisions( BENCHMARK_NUMBER_OF_SUBDIVISIONS );
+    referenceSubdivisionFilter->Update();
+    surfacePolyData = referenceSubdivisionFilter->GetOutput();
+  }
+  stageTimes.Add( "reference subdivision", stopwatch.Lap() );
+
+  vtkSmartPointer< vtkPolyDataNormals > normals = vtkSmartPointer< vtkPolyDataNormals >::New();
+  normals->SetInputData( surfacePolyData );
+  normals->SetFeatureAngle( 100 );
+  normals->Update();
+  stageTimes.Add( "reference normals", stopwatch.Lap() );
+  return stageTimes;
+}
+
+//------------------------------------------------------------------------------
+// Time an update mode of the logic, which keeps state between the updates of the same parameter node:
+// an initial update, then updates after moving one point (or, for streaming, after appending one point).
+// The update modes are run through the logic and a scene, the same way as in the application.
+static BenchmarkStageTimes RunUpdateModeBenchmark( const std::string& updateMode, vtkPoints* points, vtkPolyData* outputPolyData )
+{
+  BenchmarkStageTimes stageTimes;
+  vtkSmartPointer< vtkMRMLScene > scene = vtkSmartPointer< vtkMRMLScene >::New();
+  vtkSmartPointer< vtkSlicerMarkupsToModelLogic > logic = vtkSmartPointer< vtkSlicerMarkupsToModelLogic >::New();
+  logic->SetMRMLScene( scene );
+  // there is no event loop, the results of background updates are published by WaitForPendingUpdates
+  vtkSmartPointer< vtkCallbackCommand > pendingUpdatesCallback = vtkSmartPointer< vtkCallbackCommand >::New();
+  logic->AddObserver( vtkSlicerMarkupsToModelLogic::PendingUpdatesEvent, pendingUpdatesCallback );
+
+  bool streaming = ( updateMode == "streamingCurve" );
+  int numberOfPoints = points->GetNumberOfPoints();
+  int numberOfInitialPoints = streaming ? std::max( numberOfPoints - BENCHMARK_NUMBER_OF_UPDATES, 2 ) : numberOfPoints;
+  vtkSmartPointer< vtkMRMLMarkupsFiducialNode > markupsNode = vtkSmartPointer< vtkMRMLMarkupsFiducialNode >::New();
+  scene->AddNode( markupsNode );
+  for ( int i = 0; i < numberOfInitialPoints; i++ )
+  {
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    points->GetPoint( i, point );
+    markupsNode->AddFiducial( point[ 0 ], point[ 1 ], point[ 2 ] );
+  }
+  vtkSmartPointer< vtkMRMLModelNode > modelNode = vtkSmartPointer< vtkMRMLModelNode >::New();
+  scene->AddNode( modelNode );
+
+  vtkSmartPointer< vtkMRMLMarkupsToModelNode > parameterNode = vtkSmartPointer< vtkMRMLMarkupsToModelNode >::New();
+  // the updates are requested explicitly, so that only the update itself is timed
+  parameterNode->SetAutoUpdateOutput( false );
+  parameterNode->SetModelType( vtkMRMLMarkupsToModelNode::Curve );
+  parameterNode->SetInterpolationType( vtkMRMLMarkupsToModelNode::CardinalSpline );
+  parameterNode->SetTubeRadius( BENCHMARK_TUBE_RADIUS );
+  parameterNode->SetTubeNumberOfSides( BENCHMARK_TUBE_NUMBER_OF_SIDES );
+  parameterNode->SetTubeSegmentsBetweenControlPoints( BENCHMARK_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS );
+  if ( updateMode == "asynchronous" )
+  {
+    parameterNode->SetAsynchronousUpdate( true );
+  }
+  else if ( updateMode == "incrementalCurve" )
+  {
+    parameterNode->SetIncrementalCurveUpdate( true );
+  }
+  else if ( streaming )
+  {
+    parameterNode->SetStreamingCurveUpdate( true );
+  }
+  else // incrementalDelaunay
+  {
+    parameterNode->SetModelType( vtkMRMLMarkupsToModelNode::ClosedSurface );
+    parameterNode->SetSurfaceGenerationMethod( vtkMRMLMarkupsToModelNode::DelaunaySurface );
+    parameterNode->SetButterflySubdivision( true );
+    parameterNode->SetIncrementalDelaunay( true );
+  }
+  scene->AddNode( parameterNode );
+  parameterNode->SetAndObserveInputNodeID( markupsNode->GetID() );
+  parameterNode->SetAndObserveOutputModelNodeID( modelNode->GetID() );
+
+  BenchmarkStopwatch stopwatch;
+  logic->UpdateOutputModel( parameterNode );
+  logic->WaitForPendingUpdates();
+  stageTimes.Add( "initial update", stopwatch.Lap() );
+
+  for ( int i = 0; i < BENCHMARK_NUMBER_OF_UPDATES; i++ )
+  {
+    if ( streaming && numberOfInitialPoints + i < numberOfPoints )
+    {
+      double point[ 3 ] = { 0.0, 0.0, 0.0 };
+      points->GetPoint( numberOfInitialPoints + i, point );
+      markupsNode->AddFiducial( point[ 0 ], point[ 1 ], point[ 2 ] );
+    }
+    else
+    {
+      int pointIndex = ( i * BENCHMARK_MOVED_POINT_STRIDE ) % markupsNode->GetNumberOfFiducials();
+      double point[ 3 ] = { 0.0, 0.0, 0.0 };
+      markupsNode->GetNthFiducialPosition( pointIndex, point );
+      point[ 0 ] += BENCHMARK_MOVED_POINT_DISTANCE;
+      markupsNode->SetNthFiducialPositionFromArray( pointIndex, point );
+    }
+    logic->UpdateOutputModel( parameterNode );
+    logic->WaitForPendingUpdates();
+  }
+  stageTimes.Add( "updates", stopwatch.Lap() );
+
+  if ( modelNode->GetPolyData() != NULL )
+  {
+    outputPolyData->ShallowCopy( modelNode->GetPolyData() );
+  }
+  else
+  {
+    outputPolyData->Initialize();
+  }
+  logic->SetMRMLScene( NULL );
+  return stageTimes;
+}
+
+//------------------------------------------------------------------------------
+// Reference point arrangement analysis: axes from vtkOBBTree, ranges of the points transformed by vtkTransformFilter
+static vtkSlicerMarkupsToModelClosedSurfaceGeneration::PointArrangement ComputeReferencePointArrangement( vtkPoints* points )
+{
+  vtkSmartPointer< vtkMatrix4x4 > boundingAxesToRasTransformMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  vtkSmartPointer< vtkOBBTree > obbTree = vtkSmartPointer< vtkOBBTree >::New();
+  double corner[ 3 ] = { 0.0, 0.0, 0.0 };
+  double axes[ 3 ][ 3 ] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+  double relativeAxisSizes[ 3 ] = { 0.0, 0.0, 0.0 };
+  obbTree->ComputeOBB( points, corner, axes[ 0 ], axes[ 1 ], axes[ 2 ], relativeAxisSizes );
+  if ( vtkMath::Norm( axes[ 0 ] ) >= BENCHMARK_COMPARE_TO_ZERO_TOLERANCE )
+  {
+    if ( vtkMath::Norm( axes[ 1 ] ) < BENCHMARK_COMPARE_TO_ZERO_TOLERANCE )
+    {
+      vtkMath::Perpendiculars( axes[ 0 ], axes[ 1 ], axes[ 2 ], 0.0 );
+    }
+    if ( vtkMath::Norm( axes[ 2 ] ) < BENCHMARK_COMPARE_TO_ZERO_TOLERANCE )
+    {
+      vtkMath::Cross( axes[ 0 ], axes[ 1 ], axes[ 2 ] );
+    }
+    for ( int column = 0; column < 3; column++ )
+    {
+      vtkMath::Normalize( axes[ column ] );
+      for ( int row = 0; row < 3; row++ )
+      {
+        boundingAxesToRasTransformMatrix->SetElement( row, column, axes[ column ][ row ] );
+      }
+    }
+  }
+
+  vtkSmartPointer< vtkTransform > transform = vtkSmartPointer< vtkTransform >::New();
+  transform->SetMatrix( boundingAxesToRasTransformMatrix );
+  transform->Inverse();
+  vtkSmartPointer< vtkPolyData > polyDataWithPoints = vtkSmartPointer< vtkPolyData >::New();
+  polyDataWithPoints->SetPoints( points );
+  vtkSmartPointer< vtkTransformFilter > transformFilter = vtkSmartPointer< vtkTransformFilter >::New();
+  transformFilter->SetTransform( transform );
+  transformFilter->SetInputData( polyDataWithPoints );
+  transformFilter->Update();
+  vtkPoints* transformedPoints = transformFilter->GetPolyDataOutput()->GetPoints();
+  transformedPoints->ComputeBounds();
+  double* bounds = transformedPoints->GetBounds();
+  double extentRanges[ 3 ] = { bounds[ 1 ] - bounds[ 0 ], bounds[ 3 ] - bounds[ 2 ], bounds[ 5 ] - bounds[ 4 ] };
+  return vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputePointArrangement( extentRanges );
+}
+
+//------------------------------------------------------------------------------
+// Time the point arrangement analysis and the reference implementation,
+// returns true if they classify the points the same way.
+static bool RunPointArrangementBenchmark( vtkPoints* points, double& referenceTime, double& time )
+{
+  BenchmarkStopwatch stopwatch;
+  vtkSlicerMarkupsToModelClosedSurfaceGeneration::PointArrangement referencePointArrangement =
+    vtkSlicerMarkupsToModelClosedSurfaceGeneration::POINT_ARRANGEMENT_LAST;
+  for ( int i = 0; i < BENCHMARK_POINT_ARRANGEMENT_ITERATIONS; i++ )
+  {
+    referencePointArrangement = ComputeReferencePointArrangement( points );
+  }
+  referenceTime = stopwatch.Lap() / BENCHMARK_POINT_ARRANGEMENT_ITERATIONS;
+
+  vtkSmartPointer< vtkMatrix4x4 > boundingAxesToRasTransformMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  double extentRanges[ 3 ] = { 0.0, 0.0, 0.0 };
+  vtkSlicerMarkupsToModelClosedSurfaceGeneration::PointArrangement pointArrangement =
+    vtkSlicerMarkupsToModelClosedSurfaceGeneration::POINT_ARRANGEMENT_LAST;
+  for ( int i = 0; i < BENCHMARK_POINT_ARRANGEMENT_ITERATIONS; i++ )
+  {
+    pointArrangement = vtkSlicerMarkupsToModelClosedSurfaceGeneration::ComputeBoundingAxesAndPointArrangement(
+      points, boundingAxesToRasTransformMatrix, extentRanges );
+  }
+  time = stopwatch.Lap() / BENCHMARK_POINT_ARRANGEMENT_ITERATIONS;
+  return pointArrangement == referencePointArrangement;
+}
+
+//------------------------------------------------------------------------------
+// the filter stages repeat a part of the generation and are not counted in the total
+static bool IsFilterStage( const std::string& stageName )
+{
+  const char* filterStageNames[] = { "delaunay", "orientation", "subdivision and normals", "reference subdivision", "reference normals" };
+  for ( size_t i = 0; i < sizeof( filterStageNames ) / sizeof( filterStageNames[ 0 ] ); i++ )
+  {
+    if ( stageName == filterStageNames[ i ] )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+static void WriteStageTimes( std::ostream& os, const BenchmarkStageTimes& stageTimes )
+{
+  os << "\"stages\": {";
+  double totalTime = 0.0;
+  for ( size_t i = 0; i < stageTimes.Stages.size(); i++ )
+  {
+    os << ( i > 0 ? ", " : "" ) << "\"" << stageTimes.Stages[ i ].first << "\": " << stageTimes.Stages[ i ].second;
+    if ( !IsFilterStage( stageTimes.Stages[ i ].first ) )
+    {
+      totalTime += stageTimes.Stages[ i ].second;
+    }
+  }
+  os << "}, \"total\": " << totalTime;
+}
+
+//------------------------------------------------------------------------------
+static void PrintUsage( const char* programName )
+{
+  std::cerr << "Usage: " << programName << " [--max-points N] [--repetitions N] [--output file.json]" << std::endl;
+}
+
+//------------------------------------------------------------------------------
+int main( int argc, char* argv[] )
+{
+  int maximumNumberOfPoints = BENCHMARK_MAXIMUM_NUMBER_OF_POINTS_DEFAULT;
+  int repetitions = BENCHMARK_REPETITIONS_DEFAULT;
+  std::string outputFileName;
+  for ( int i = 1; i < argc; i++ )
+  {
+    if ( strcmp( argv[ i ], "--max-points" ) == 0 && i + 1 < argc )
+    {
+      maximumNumberOfPoints = atoi( argv[ ++i ] );
+    }
+    else if ( strcmp( argv[ i ], "--repetitions" ) == 0 && i + 1 < argc )
+    {
+      repetitions = std::max( 1, atoi( argv[ ++i ] ) );
+    }
+    else if ( strcmp( argv[ i ], "--output" ) == 0 && i + 1 < argc )
+    {
+      outputFileName = argv[ ++i ];
+    }
+    else
+    {
+      PrintUsage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::ofstream outputFile;
+  if ( !outputFileName.empty() )
+  {
+    outputFile.open( outputFileName.c_str() );
+    if ( !outputFile.is_open() )
+    {
+      std::cerr << "Failed to open output file " << outputFileName << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream& os = outputFile.is_open() ? static_cast< std::ostream& >( outputFile ) : std::cout;
+  os.precision( 6 );
+
+  std::vector< int > pointCounts;
+  for ( int numberOfPoints = 10; numberOfPoints <= maximumNumberOfPoints; numberOfPoints *= 10 )
+  {
+    pointCounts.push_back( numberOfPoints );
+  }
+
+  const char* curveShapes[] = { "line", "spiral", "helix" };
+  const char* closedSurfaceShapes[] = { "line", "spiral", "ball" };
+  const bool orderings[] = { true, false };
+
+  vtkSmartPointer< vtkMRMLMarkupsFiducialNode > markupsNode = vtkSmartPointer< vtkMRMLMarkupsFiducialNode >::New();
+  vtkSmartPointer< vtkPoints > points = vtkSmartPointer< vtkPoints >::New();
+  vtkSmartPointer< vtkPolyData > outputPolyData = vtkSmartPointer< vtkPolyData >::New();
+
+  os << "{" << std::endl;
+  os << "  \"benchmark\": \"MarkupsToModel\"," << std::endl;
+  os << "  \"repetitions\": " << repetitions << "," << std::endl;
+  os << "  \"results\": [" << std::endl;
+  bool firstResult = true;
+
+  for ( size_t countIndex = 0; countIndex < pointCounts.size(); countIndex++ )
+  {
+    int numberOfPoints = pointCounts[ countIndex ];
+
+    // curves
+    for ( int shapeIndex = 0; shapeIndex < 3; shapeIndex++ )
+    {
+      for ( int orderingIndex = 0; orderingIndex < 2; orderingIndex++ )
+      {
+        CreatePointSet( curveShapes[ shapeIndex ], orderings[ orderingIndex ], numberOfPoints, points );
+        CreateMarkupsNode( points, markupsNode );
+        for ( int interpolationType = 0; interpolationType < vtkMRMLMarkupsToModelNode::InterpolationType_Last; interpolationType++ )
+        {
+          int numberOfPointParameterTypes = ( interpolationType == vtkMRMLMarkupsToModelNode::Polynomial ) ?
+            vtkMRMLMarkupsToModelNode::PointParameterType_Last : 1;
+          for ( int pointParameterType = 0; pointParameterType < numberOfPointParameterTypes; pointParameterType++ )
+          {
+            if ( pointParameterType == vtkMRMLMarkupsToModelNode::MinimumSpanningTreeDense
+              && numberOfPoints > BENCHMARK_MAXIMUM_NUMBER_OF_POINTS_DENSE_MINIMUM_SPANNING_TREE )
+            {
+              continue;
+            }
+            BenchmarkStageTimes stageTimes;
+            for ( int repetition = 0; repetition < repetitions; repetition++ )
+            {
+              stageTimes.KeepMinimum( RunCurveBenchmark( markupsNode, interpolationType, pointParameterType, outputPolyData ) );
+            }
+            os << ( firstResult ? "" : ",\n" ) << "    {\"modelType\": \"curve\", \"pointSet\": \"" << curveShapes[ shapeIndex ]
+              << "\", \"ordered\": " << ( orderings[ orderingIndex ] ? "true" : "false" )
+              << ", \"numberOfPoints\": " << numberOfPoints
+              << ", \"interpolationType\": \"" << vtkMRMLMarkupsToModelNode::GetInterpolationTypeAsString( interpolationType ) << "\"";
+            if ( interpolationType == vtkMRMLMarkupsToModelNode::Polynomial )
+            {
+              os << ", \"pointParameterType\": \"" << vtkMRMLMarkupsToModelNode::GetPointParameterTypeAsString( pointParameterType ) << "\"";
+            }
+            os << ", ";
+            WriteStageTimes( os, stageTimes );
+            os << ", \"outputNumberOfPoints\": " << outputPolyData->GetNumberOfPoints()
+              << ", \"outputNumberOfCells\": " << outputPolyData->GetNumberOfCells() << "}";
+            os.flush();
+            firstResult = false;
+          }
+        }
+      }
+    }
+
+    // closed surfaces (the point order does not matter)
+    for ( int shapeIndex = 0; shapeIndex < 3; shapeIndex++ )
+    {
+      std::string shape = closedSurfaceShapes[ shapeIndex ];
+      CreatePointSet( shape, shape != "ball", numberOfPoints, points );
+      CreateMarkupsNode( points, markupsNode );
+
+      double referenceTime = 0.0;
+      double time = 0.0;
+      bool samePointArrangement = RunPointArrangementBenchmark( points, referenceTime, time );
+      os << ( firstResult ? "" : ",\n" ) << "    {\"modelType\": \"pointArrangement\", \"pointSet\": \"" << shape
+        << "\", \"numberOfPoints\": " << numberOfPoints
+        << ", \"referenceTime\": " << referenceTime << ", \"time\": " << time
+        << ", \"samePointArrangement\": " << ( samePointArrangement ? "true" : "false" ) << "}";
+      os.flush();
+      firstResult = false;
+
+      for ( int optionIndex = 0; optionIndex < 8 * vtkMRMLMarkupsToModelNode::SurfaceGenerationMethod_Last; optionIndex++ )
+      {
+        bool smoothing = ( optionIndex & 1 ) != 0;
+        bool forceConvex = ( optionIndex & 2 ) != 0;
+        double delaunayAlpha = ( optionIndex & 4 ) != 0 ? BENCHMARK_DELAUNAY_ALPHA : 0.0;
+        int surfaceGenerationMethod = optionIndex / 8;
+        if ( forceConvex && !smoothing )
+        {
+          // force convex is only used with smoothing
+          continue;
+        }
+        if ( surfaceGenerationMethod != vtkMRMLMarkupsToModelNode::DelaunaySurface && delaunayAlpha != 0.0 )
+        {
+          // alpha is only used by Delaunay
+          continue;
+        }
+        if ( surfaceGenerationMethod == vtkMRMLMarkupsToModelNode::ImplicitSurface && smoothing )
+        {
+          // the implicit surface is not subdivided
+          continue;
+        }
+        // the filters are timed separately only for the Delaunay pipeline
+        bool timeFilters = ( shape == "ball" && surfaceGenerationMethod == vtkMRMLMarkupsToModelNode::DelaunaySurface );
+        BenchmarkStageTimes stageTimes;
+        for ( int repetition = 0; repetition < repetitions; repetition++ )
+        {
+          stageTimes.KeepMinimum( RunClosedSurfaceBenchmark( markupsNode, smoothing, forceConvex, delaunayAlpha, surfaceGenerationMethod,
+            timeFilters, outputPolyData ) );
+        }
+        os << ( firstResult ? "" : ",\n" ) << "    {\"modelType\": \"closedSurface\", \"pointSet\": \"" << shape
+          << "\", \"numberOfPoints\": " << numberOfPoints
+          << ", \"surfaceGenerationMethod\": \"" << vtkMRMLMarkupsToModelNode::GetSurfaceGenerationMethodAsString( surfaceGenerationMethod ) << "\""
+          << ", \"smoothing\": " << ( smoothing ? "true" : "false" )
+          << ", \"forceConvex\": " << ( forceConvex ? "true" : "false" )
+          << ", \"delaunayAlpha\": " << delaunayAlpha << ", ";
+        WriteStageTimes( os, stageTimes );
+        os << ", \"outputNumberOfPoints\": " << outputPolyData->GetNumberOfPoints()
+          << ", \"outputNumberOfCells\": " << outputPolyData->GetNumberOfCells() << "}";
+        os.flush();
+        firstResult = false;
+      }
+    }
+
+    // update modes of the logic
+    for ( int updateModeIndex = 0; updateModeIndex < BENCHMARK_NUMBER_OF_UPDATE_MODES; updateModeIndex++ )
+    {
+      std::string updateMode = BENCHMARK_UPDATE_MODES[ updateModeIndex ];
+      std::string shape = ( updateMode == "incrementalDelaunay" ) ? "ball" : "helix";
+      CreatePointSet( shape, shape != "ball", numberOfPoints, points );
+      BenchmarkStageTimes stageTimes;
+      for ( int repetition = 0; repetition < repetitions; repetition++ )
+      {
+        stageTimes.KeepMinimum( RunUpdateModeBenchmark( updateMode, points, outputPolyData ) );
+      }
+      os << ( firstResult ? "" : ",\n" ) << "    {\"modelType\": \"updateMode\", \"updateMode\": \"" << updateMode
+        << "\", \"pointSet\": \"" << shape << "\", \"numberOfPoints\": " << numberOfPoints
+        << ", \"numberOfUpdates\": " << BENCHMARK_NUMBER_OF_UPDATES << ", ";
+      WriteStageTimes( os, stageTimes );
+      os << ", \"outputNumberOfPoints\": " << outputPolyData->GetNumberOfPoints()
+        << ", \"outputNumberOfCells\": " << outputPolyData->GetNumberOfCells() << "}";
+      os.flush();
+      firstResult = false;
+    }
+  }
+
+  os << std::endl << "  ]" << std::endl << "}" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,338 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Checks the geometry cache of vtkSlicerMarkupsToModelLogic: updates through the logic must miss the cache
+// after any change of the control points or of a parameter that affects the geometry, and hit it when the
+// inputs are restored. Models stored with the same key but different inputs must not be returned,
+// and the least recently used models must be removed when the memory budget is exceeded.
+// The results of background (asynchronous) updates must be stored in the cache as well.
+
+// MarkupsToModel includes
+#include "vtkMRMLMarkupsToModelNode.h"
+#include "vtkSlicerMarkupsToModelGeometryCache.h"
+#include "vtkSlicerMarkupsToModelLogic.h"
+
+// Slicer includes
+#include "vtkMRMLMarkupsFiducialNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+
+// vtk includes
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// std includes
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+//------------------------------------------------------------------------------
+// constants within this file
+static const int TEST_NUMBER_OF_POINTS = 12;
+static const double TEST_HELIX_RADIUS = 20.0;
+static const double TEST_HELIX_PITCH = 4.0;
+static const double TEST_MOVED_POINT_DISTANCE = 2.5;
+static const int TEST_MOVED_POINT_INDEX = 5;
+
+//------------------------------------------------------------------------------
+// Update the output model through the logic and check whether the cache was hit
+static bool TestUpdate( const std::string& name, vtkSlicerMarkupsToModelLogic* logic, vtkMRMLMarkupsToModelNode* parameterNode,
+  bool expectedHit )
+{
+  vtkSlicerMarkupsToModelGeometryCache* cache = logic->GetGeometryCache();
+  unsigned long numberOfHits = cache->GetNumberOfHits();
+  unsigned long numberOfMisses = cache->GetNumberOfMisses();
+  logic->UpdateOutputModel( parameterNode );
+  bool hit = ( cache->GetNumberOfHits() == numberOfHits + 1 && cache->GetNumberOfMisses() == numberOfMisses );
+  bool miss = ( cache->GetNumberOfHits() == numberOfHits && cache->GetNumberOfMisses() == numberOfMisses + 1 );
+  if ( ( expectedHit && !hit ) || ( !expectedHit && !miss ) )
+  {
+    std::cerr << name << ": expected a cache " << ( expectedHit ? "hit" : "miss" ) << ", the number of hits changed from "
+      << numberOfHits << " to " << cache->GetNumberOfHits() << ", the number of misses from "
+      << numberOfMisses << " to " << cache->GetNumberOfMisses() << std::endl;
+    return false;
+  }
+  vtkMRMLModelNode* modelNode = parameterNode->GetOutputModelNode();
+  if ( modelNode == NULL || modelNode->GetPolyData() == NULL || modelNode->GetPolyData()->GetNumberOfPoints() == 0 )
+  {
+    std::cerr << name << ": no output model was generated" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Changes of the control points and of each parameter that affects the geometry must miss the cache
+static bool TestParameterSensitivity( vtkSlicerMarkupsToModelLogic* logic, vtkMRMLMarkupsToModelNode* parameterNode,
+  vtkMRMLMarkupsFiducialNode* markupsNode )
+{
+  bool success = true;
+
+  // curve
+  parameterNode->SetModelType( vtkMRMLMarkupsToModelNode::Curve );
+  parameterNode->SetInterpolationType( vtkMRMLMarkupsToModelNode::CardinalSpline );
+  success = TestUpdate( "curve initial update", logic, parameterNode, false ) && success;
+  success = TestUpdate( "curve repeated update", logic, parameterNode, true ) && success;
+
+  parameterNode->SetTubeNumberOfSides( parameterNode->GetTubeNumberOfSides() + 4 );
+  success = TestUpdate( "tube number of sides changed", logic, parameterNode, false ) && success;
+  parameterNode->SetTubeNumberOfSides( parameterNode->GetTubeNumberOfSides() - 4 );
+  success = TestUpdate( "tube number of sides restored", logic, parameterNode, true ) && success;
+
+  parameterNode->SetTubeSegmentsBetweenControlPoints( parameterNode->GetTubeSegmentsBetweenControlPoints() + 1 );
+  success = TestUpdate( "tube segments changed", logic, parameterNode, false ) && success;
+  parameterNode->SetTubeSegmentsBetweenControlPoints( parameterNode->GetTubeSegmentsBetweenControlPoints() - 1 );
+  success = TestUpdate( "tube segments restored", logic, parameterNode, true ) && success;
+
+  parameterNode->SetCenterlineOutput( true );
+  success = TestUpdate( "centerline output enabled", logic, parameterNode, false ) && success;
+  parameterNode->SetCenterlineOutput( false );
+  success = TestUpdate( "centerline output disabled", logic, parameterNode, true ) && success;
+
+  parameterNode->SetInterpolationType( vtkMRMLMarkupsToModelNode::Linear );
+  success = TestUpdate( "interpolation type changed", logic, parameterNode, false ) && success;
+  parameterNode->SetInterpolationType( vtkMRMLMarkupsToModelNode::CardinalSpline );
+  success = TestUpdate( "interpolation type restored", logic, parameterNode, true ) && success;
+
+  double point[ 3 ] = { 0.0, 0.0, 0.0 };
+  markupsNode->GetNthFiducialPosition( TEST_MOVED_POINT_INDEX, point );
+  point[ 2 ] += TEST_MOVED_POINT_DISTANCE;
+  markupsNode->SetNthFiducialPositionFromArray( TEST_MOVED_POINT_INDEX, point );
+  success = TestUpdate( "point moved", logic, parameterNode, false ) && success;
+  point[ 2 ] -= TEST_MOVED_POINT_DISTANCE;
+  markupsNode->SetNthFiducialPositionFromArray( TEST_MOVED_POINT_INDEX, point );
+  success = TestUpdate( "point moved back", logic, parameterNode, true ) && success;
+
+  // closed surface
+  parameterNode->SetModelType( vtkMRMLMarkupsToModelNode::ClosedSurface );
+  parameterNode->SetButterflySubdivision( true );
+  success = TestUpdate( "closed surface initial update", logic, parameterNode, false ) && success;
+  success = TestUpdate( "closed surface repeated update", logic, parameterNode, true ) && success;
+
+  parameterNode->SetNumberOfSubdivisions( parameterNode->GetNumberOfSubdivisions() - 1 );
+  success = TestUpdate( "number of subdivisions changed", logic, parameterNode, false ) && success;
+  parameterNode->SetNumberOfSubdivisions( parameterNode->GetNumberOfSubdivisions() + 1 );
+  success = TestUpdate( "number of subdivisions restored", logic, parameterNode, true ) && success;
+
+  int qualityLevel = parameterNode->GetQualityLevel();
+  parameterNode->SetQualityLevel( vtkMRMLMarkupsToModelNode::PreviewQuality );
+  success = TestUpdate( "preview quality", logic, parameterNode, false ) && success;
+  parameterNode->SetQualityLevel( qualityLevel );
+  success = TestUpdate( "quality level restored", logic, parameterNode, true ) && success;
+
+  parameterNode->SetSinglePrecisionOutput( !parameterNode->GetSinglePrecisionOutput() );
+  success = TestUpdate( "output precision changed", logic, parameterNode, false ) && success;
+  parameterNode->SetSinglePrecisionOutput( !parameterNode->GetSinglePrecisionOutput() );
+  success = TestUpdate( "output precision restored", logic, parameterNode, true ) && success;
+
+  parameterNode->SetConvexHull( !parameterNode->GetConvexHull() );
+  success = TestUpdate( "convex hull changed", logic, parameterNode, false ) && success;
+  parameterNode->SetConvexHull( !parameterNode->GetConvexHull() );
+  success = TestUpdate( "convex hull restored", logic, parameterNode, true ) && success;
+
+  return success;
+}
+
+//------------------------------------------------------------------------------
+// The output of a background update is stored when it is published, so the next identical update must hit the cache
+static bool TestAsynchronousUpdate( vtkSlicerMarkupsToModelLogic* logic, vtkMRMLMarkupsToModelNode* parameterNode )
+{
+  vtkSlicerMarkupsToModelGeometryCache* cache = logic->GetGeometryCache();
+  cache->Clear();
+  // there is no event loop, the results of background updates are published by WaitForPendingUpdates
+  vtkNew< vtkCallbackCommand > pendingUpdatesCallback;
+  unsigned long observerTag = logic->AddObserver( vtkSlicerMarkupsToModelLogic::PendingUpdatesEvent, pendingUpdatesCallback.GetPointer() );
+  parameterNode->SetModelType( vtkMRMLMarkupsToModelNode::Curve );
+  parameterNode->SetAsynchronousUpdate( true );
+
+  bool success = true;
+  unsigned long numberOfMisses = cache->GetNumberOfMisses();
+  logic->UpdateOutputModel( parameterNode );
+  logic->WaitForPendingUpdates();
+  if ( cache->GetNumberOfMisses() != numberOfMisses + 1 )
+  {
+    std::cerr << "asynchronous update: expected a cache miss, the number of misses changed from " << numberOfMisses
+      << " to " << cache->GetNumberOfMisses() << std::endl;
+    success = false;
+  }
+  if ( cache->GetNumberOfEntries() != 1 )
+  {
+    std::cerr << "asynchronous update: " << cache->GetNumberOfEntries() << " models are stored after the update, expected 1" << std::endl;
+    success = false;
+  }
+  success = TestUpdate( "asynchronous repeated update", logic, parameterNode, true ) && success;
+  logic->WaitForPendingUpdates();
+
+  parameterNode->SetAsynchronousUpdate( false );
+  logic->RemoveObserver( observerTag );
+  cache->Clear();
+  return success;
+}
+
+//------------------------------------------------------------------------------
+// A model stored with the same key must only be returned for the same control points and parameters
+static bool TestKeyCollision( vtkSlicerMarkupsToModelGeometryCache* cache, vtkMRMLMarkupsToModelNode* parameterNode,
+  vtkPolyData* polyData )
+{
+  const vtkTypeUInt64 key = 1;
+  vtkNew< vtkPoints > points;
+  points->InsertNextPoint( 0.0, 0.0, 0.0 );
+  points->InsertNextPoint( 1.0, 0.0, 0.0 );
+  vtkNew< vtkPoints > otherPoints;
+  otherPoints->InsertNextPoint( 0.0, 0.0, 0.0 );
+  otherPoints->InsertNextPoint( 0.0, 1.0, 0.0 );
+  vtkNew< vtkMRMLMarkupsToModelNode > otherParameterNode;
+  otherParameterNode->Copy( parameterNode );
+  otherParameterNode->SetTubeRadius( parameterNode->GetTubeRadius() * 2.0 );
+
+  cache->Clear();
+  cache->Insert( key, points.GetPointer(), parameterNode, polyData );
+  vtkNew< vtkPolyData > outputPolyData;
+  bool success = true;
+  if ( cache->Find( key, otherPoints.GetPointer(), parameterNode, outputPolyData.GetPointer() ) )
+  {
+    std::cerr << "key collision: a model was returned for different control points" << std::endl;
+    success = false;
+  }
+  if ( cache->Find( key, points.GetPointer(), otherParameterNode.GetPointer(), outputPolyData.GetPointer() ) )
+  {
+    std::cerr << "key collision: a model was returned for different parameters" << std::endl;
+    success = false;
+  }
+  if ( !cache->Find( key, points.GetPointer(), parameterNode, outputPolyData.GetPointer() )
+    || outputPolyData->GetNumberOfPoints() != polyData->GetNumberOfPoints() )
+  {
+    std::cerr << "key collision: the stored model was not returned for its own inputs" << std::endl;
+    success = false;
+  }
+  cache->Clear();
+  return success;
+}
+
+//------------------------------------------------------------------------------
+// The least recently used models are removed when the memory budget would be exceeded
+static bool TestLeastRecentlyUsedEviction( vtkSlicerMarkupsToModelGeometryCache* cache, vtkMRMLMarkupsToModelNode* parameterNode,
+  vtkPolyData* polyData )
+{
+  vtkNew< vtkPoints > points;
+  points->InsertNextPoint( 0.0, 0.0, 0.0 );
+  unsigned long memoryBudget = cache->GetMemoryBudget();
+
+  // measure the memory size of one entry
+  cache->Clear();
+  cache->Insert( 1, points.GetPointer(), parameterNode, polyData );
+  unsigned long entryMemorySize = cache->GetMemorySize();
+  if ( entryMemorySize == 0 )
+  {
+    std::cerr << "eviction: the memory size of the stored model is 0" << std::endl;
+    return false;
+  }
+
+  // room for two entries but not for three
+  cache->Clear();
+  cache->SetMemoryBudget( 2 * entryMemorySize + entryMemorySize / 2 );
+  cache->Insert( 1, points.GetPointer(), parameterNode, polyData );
+  cache->Insert( 2, points.GetPointer(), parameterNode, polyData );
+  vtkNew< vtkPolyData > outputPolyData;
+  bool success = true;
+  if ( !cache->Find( 1, points.GetPointer(), parameterNode, outputPolyData.GetPointer() ) )
+  {
+    std::cerr << "eviction: the first model was not found before the budget was exceeded" << std::endl;
+    success = false;
+  }
+  // the second model is the least recently used one now
+  cache->Insert( 3, points.GetPointer(), parameterNode, polyData );
+  if ( cache->GetNumberOfEntries() != 2 || cache->GetMemorySize() > cache->GetMemoryBudget() )
+  {
+    std::cerr << "eviction: " << cache->GetNumberOfEntries() << " models of " << cache->GetMemorySize()
+      << " KiB are stored, the memory budget is " << cache->GetMemoryBudget() << " KiB" << std::endl;
+    success = false;
+  }
+  if ( cache->Find( 2, points.GetPointer(), parameterNode, outputPolyData.GetPointer() ) )
+  {
+    std::cerr << "eviction: the least recently used model was not removed" << std::endl;
+    success = false;
+  }
+  if ( !cache->Find( 1, points.GetPointer(), parameterNode, outputPolyData.GetPointer() )
+    || !cache->Find( 3, points.GetPointer(), parameterNode, outputPolyData.GetPointer() ) )
+  {
+    std::cerr << "eviction: a recently used model was removed" << std::endl;
+    success = false;
+  }
+
+  // a model that is larger than the budget is not stored
+  cache->SetMemoryBudget( entryMemorySize / 2 );
+  if ( cache->GetNumberOfEntries() != 0 )
+  {
+    std::cerr << "eviction: models are kept after the memory budget was reduced below their size" << std::endl;
+    success = false;
+  }
+  if ( cache->CanStore( points.GetPointer(), polyData ) )
+  {
+    std::cerr << "eviction: a model larger than the memory budget is reported to fit" << std::endl;
+    success = false;
+  }
+  cache->Insert( 4, points.GetPointer(), parameterNode, polyData );
+  if ( cache->GetNumberOfEntries() != 0 )
+  {
+    std::cerr << "eviction: a model larger than the memory budget was stored" << std::endl;
+    success = false;
+  }
+
+  cache->SetMemoryBudget( memoryBudget );
+  cache->Clear();
+  return success;
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelGeometryCacheTest( int vtkNotUsed( argc ), char* vtkNotUsed( argv )[] )
+{
+  vtkNew< vtkMRMLScene > scene;
+  vtkNew< vtkSlicerMarkupsToModelLogic > logic;
+  logic->SetMRMLScene( scene.GetPointer() );
+
+  // helix, so that the points are not coplanar
+  vtkNew< vtkMRMLMarkupsFiducialNode > markupsNode;
+  scene->AddNode( markupsNode.GetPointer() );
+  for ( int i = 0; i < TEST_NUMBER_OF_POINTS; i++ )
+  {
+    double angle = 0.5 * i;
+    markupsNode->AddFiducial( TEST_HELIX_RADIUS * cos( angle ), TEST_HELIX_RADIUS * sin( angle ), TEST_HELIX_PITCH * i );
+  }
+  vtkNew< vtkMRMLModelNode > modelNode;
+  scene->AddNode( modelNode.GetPointer() );
+  vtkNew< vtkMRMLMarkupsToModelNode > parameterNode;
+  // the updates are requested explicitly, so that each one can be checked
+  parameterNode->SetAutoUpdateOutput( false );
+  scene->AddNode( parameterNode.GetPointer() );
+  parameterNode->SetAndObserveInputNodeID( markupsNode->GetID() );
+  parameterNode->SetAndObserveOutputModelNodeID( modelNode->GetID() );
+
+  bool success = TestParameterSensitivity( logic.GetPointer(), parameterNode.GetPointer(), markupsNode.GetPointer() );
+  success = TestAsynchronousUpdate( logic.GetPointer(), parameterNode.GetPointer() ) && success;
+
+  vtkNew< vtkPolyData > polyData;
+  polyData->DeepCopy( modelNode->GetPolyData() );
+  success = TestKeyCollision( logic->GetGeometryCache(), parameterNode.GetPointer(), polyData.GetPointer() ) && success;
+  success = TestLeastRecentlyUsedEviction( logic->GetGeometryCache(), parameterNode.GetPointer(), polyData.GetPointer() ) && success;
+
+  logic->SetMRMLScene( NULL );
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,245 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Compares the incremental curve model update (vtkSlicerMarkupsToModelCurveGeneration::UpdateCurveModelIncrementally)
+// with a full regeneration (vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel) after moving a single control point,
+// for each supported interpolation type, open and closed.
+
+// MarkupsToModel includes
+#include "vtkMRMLMarkupsToModelNode.h"
+#include "vtkSlicerMarkupsToModelCurveGeneration.h"
+#include "vtkSlicerMarkupsToModelLogic.h"
+
+// vtk includes
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+//------------------------------------------------------------------------------
+// constants within this file
+static const int TEST_NUMBER_OF_CONTROL_POINTS = 24;
+static const int TEST_MOVED_CONTROL_POINT_INDEX = 11;
+static const double TEST_CONTROL_POINT_DISPLACEMENT[ 3 ] = { 3.0, -2.0, 1.5 };
+static const double TEST_TUBE_RADIUS = 1.0;
+static const int TEST_TUBE_NUMBER_OF_SIDES = 8;
+static const int TEST_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS = 5;
+// the tube points are stored in single precision
+static const double TEST_EXACT_TOLERANCE = 0.001;
+// documented bound of the Cardinal spline deviation, relative to the displacement plus the largest control point distance
+static const double TEST_CARDINAL_SPLINE_RELATIVE_TOLERANCE = 0.002;
+
+//------------------------------------------------------------------------------
+// Control points along a helix, consecutive points are about 10mm apart
+static void CreateControlPoints( vtkPoints* controlPoints )
+{
+  controlPoints->Reset();
+  for ( int i = 0; i < TEST_NUMBER_OF_CONTROL_POINTS; i++ )
+  {
+    double angle = 0.5 * i;
+    controlPoints->InsertNextPoint( 20.0 * cos( angle ), 20.0 * sin( angle ), 4.0 * i );
+  }
+}
+
+//------------------------------------------------------------------------------
+static double GetMaximumControlPointDistance( vtkPoints* controlPoints, bool tubeLoop )
+{
+  int numberOfControlPoints = controlPoints->GetNumberOfPoints();
+  int numberOfSegments = tubeLoop ? numberOfControlPoints : numberOfControlPoints - 1;
+  double maximumDistance = 0.0;
+  for ( int i = 0; i < numberOfSegments; i++ )
+  {
+    double point0[ 3 ] = { 0.0, 0.0, 0.0 };
+    double point1[ 3 ] = { 0.0, 0.0, 0.0 };
+    controlPoints->GetPoint( i, point0 );
+    controlPoints->GetPoint( ( i + 1 ) % numberOfControlPoints, point1 );
+    maximumDistance = std::max( maximumDistance, sqrt( vtkMath::Distance2BetweenPoints( point0, point1 ) ) );
+  }
+  return maximumDistance;
+}
+
+//------------------------------------------------------------------------------
+// Largest distance of the tube vertices of testTube from the corresponding rings (circles) of referenceTube.
+// The tube frames of an incremental update may be rotated around the curve compared to a full regeneration,
+// so the vertices are compared to the circles and not to the vertices of the reference.
+// The largest distance between the ring centers (the curve points) is returned in maximumCenterDeviation.
+// Returns -1 if the tubes do not have the same number of rings.
+static double GetMaximumRingDeviation( vtkPolyData* testTube, vtkPolyData* referenceTube, int tubeNumberOfSides,
+  double& maximumCenterDeviation )
+{
+  maximumCenterDeviation = 0.0;
+  if ( testTube->GetPoints() == NULL || referenceTube->GetPoints() == NULL
+    || testTube->GetNumberOfPoints() != referenceTube->GetNumberOfPoints()
+    || referenceTube->GetNumberOfPoints() % tubeNumberOfSides != 0 )
+  {
+    return -1.0;
+  }
+
+  double maximumDeviation = 0.0;
+  vtkIdType numberOfRings = referenceTube->GetNumberOfPoints() / tubeNumberOfSides;
+  for ( vtkIdType ringIndex = 0; ringIndex < numberOfRings; ringIndex++ )
+  {
+    double referenceCenter[ 3 ] = { 0.0, 0.0, 0.0 };
+    double testCenter[ 3 ] = { 0.0, 0.0, 0.0 };
+    for ( int k = 0; k < tubeNumberOfSides; k++ )
+    {
+      double point[ 3 ] = { 0.0, 0.0, 0.0 };
+      referenceTube->GetPoint( ringIndex * tubeNumberOfSides + k, point );
+      vtkMath::Add( referenceCenter, point, referenceCenter );
+      testTube->GetPoint( ringIndex * tubeNumberOfSides + k, point );
+      vtkMath::Add( testCenter, point, testCenter );
+    }
+    vtkMath::MultiplyScalar( referenceCenter, 1.0 / tubeNumberOfSides );
+    vtkMath::MultiplyScalar( testCenter, 1.0 / tubeNumberOfSides );
+    maximumCenterDeviation = std::max( maximumCenterDeviation, sqrt( vtkMath::Distance2BetweenPoints( referenceCenter, testCenter ) ) );
+
+    // plane and radius of the reference ring
+    double referencePoint0[ 3 ] = { 0.0, 0.0, 0.0 };
+    double referencePoint1[ 3 ] = { 0.0, 0.0, 0.0 };
+    referenceTube->GetPoint( ringIndex * tubeNumberOfSides, referencePoint0 );
+    referenceTube->GetPoint( ringIndex * tubeNumberOfSides + 1, referencePoint1 );
+    vtkMath::Subtract( referencePoint0, referenceCenter, referencePoint0 );
+    vtkMath::Subtract( referencePoint1, referenceCenter, referencePoint1 );
+    double ringRadius = vtkMath::Norm( referencePoint0 );
+    double ringAxis[ 3 ] = { 0.0, 0.0, 0.0 };
+    vtkMath::Cross( referencePoint0, referencePoint1, ringAxis );
+    vtkMath::Normalize( ringAxis );
+
+    for ( int k = 0; k < tubeNumberOfSides; k++ )
+    {
+      double offset[ 3 ] = { 0.0, 0.0, 0.0 };
+      testTube->GetPoint( ringIndex * tubeNumberOfSides + k, offset );
+      vtkMath::Subtract( offset, referenceCenter, offset );
+      double axialDistance = vtkMath::Dot( offset, ringAxis );
+      double radialDistance = sqrt( std::max( 0.0, vtkMath::Dot( offset, offset ) - axialDistance * axialDistance ) );
+      double deviation = sqrt( axialDistance * axialDistance + ( radialDistance - ringRadius ) * ( radialDistance - ringRadius ) );
+      maximumDeviation = std::max( maximumDeviation, deviation );
+    }
+  }
+  return maximumDeviation;
+}
+
+//------------------------------------------------------------------------------
+static bool TestIncrementalCurve( int interpolationType, bool tubeLoop )
+{
+  std::string curveName = std::string( vtkMRMLMarkupsToModelNode::GetInterpolationTypeAsString( interpolationType ) )
+    + ( tubeLoop ? " loop" : " curve" );
+
+  vtkNew< vtkPoints > controlPoints;
+  CreateControlPoints( controlPoints.GetPointer() );
+
+  vtkNew< vtkSlicerMarkupsToModelCurveGeneration > curveGenerator;
+  vtkNew< vtkPolyData > incrementalTube;
+  if ( curveGenerator->UpdateCurveModelIncrementally( controlPoints.GetPointer(), incrementalTube.GetPointer(),
+    interpolationType, TEST_TUBE_RADIUS, TEST_TUBE_NUMBER_OF_SIDES, TEST_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS, tubeLoop,
+    0.0, 0.0, 0.0, false ) )
+  {
+    std::cerr << curveName << ": the first incremental update did not regenerate the curve" << std::endl;
+    return false;
+  }
+
+  double movedPoint[ 3 ] = { 0.0, 0.0, 0.0 };
+  controlPoints->GetPoint( TEST_MOVED_CONTROL_POINT_INDEX, movedPoint );
+  vtkMath::Add( movedPoint, TEST_CONTROL_POINT_DISPLACEMENT, movedPoint );
+  controlPoints->SetPoint( TEST_MOVED_CONTROL_POINT_INDEX, movedPoint );
+  if ( !curveGenerator->UpdateCurveModelIncrementally( controlPoints.GetPointer(), incrementalTube.GetPointer(),
+    interpolationType, TEST_TUBE_RADIUS, TEST_TUBE_NUMBER_OF_SIDES, TEST_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS, tubeLoop,
+    0.0, 0.0, 0.0, false ) )
+  {
+    std::cerr << curveName << ": moving a single control point did not patch the curve" << std::endl;
+    return false;
+  }
+
+  vtkNew< vtkPolyData > referenceTube;
+  vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel( controlPoints.GetPointer(), referenceTube.GetPointer(),
+    interpolationType, tubeLoop, TEST_TUBE_RADIUS, TEST_TUBE_NUMBER_OF_SIDES, TEST_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS, false );
+
+  double tolerance = TEST_EXACT_TOLERANCE;
+  double centerTolerance = TEST_EXACT_TOLERANCE;
+  if ( interpolationType == vtkMRMLMarkupsToModelNode::CardinalSpline )
+  {
+    centerTolerance = TEST_EXACT_TOLERANCE + TEST_CARDINAL_SPLINE_RELATIVE_TOLERANCE
+      * ( vtkMath::Norm( TEST_CONTROL_POINT_DISPLACEMENT ) + GetMaximumControlPointDistance( controlPoints.GetPointer(), tubeLoop ) );
+    // the tangents are computed from curve points that are more than a tube diameter apart,
+    // so the vertices deviate at most twice as much as the curve points
+    tolerance = 2.0 * centerTolerance;
+  }
+  double maximumCenterDeviation = 0.0;
+  double maximumDeviation = GetMaximumRingDeviation( incrementalTube.GetPointer(), referenceTube.GetPointer(),
+    TEST_TUBE_NUMBER_OF_SIDES, maximumCenterDeviation );
+  if ( maximumDeviation < 0.0 )
+  {
+    std::cerr << curveName << ": number of tube points is " << incrementalTube->GetNumberOfPoints()
+      << " after the incremental update, expected " << referenceTube->GetNumberOfPoints() << std::endl;
+    return false;
+  }
+  if ( maximumCenterDeviation > centerTolerance || maximumDeviation > tolerance )
+  {
+    std::cerr << curveName << ": incremental update deviates from the full regeneration, curve points by "
+      << maximumCenterDeviation << " (tolerance " << centerTolerance << "), tube points by "
+      << maximumDeviation << " (tolerance " << tolerance << ")" << std::endl;
+    return false;
+  }
+
+  // the output is regenerated if it was modified by someone else
+  incrementalTube->Modified();
+  controlPoints->SetPoint( TEST_MOVED_CONTROL_POINT_INDEX, movedPoint[ 0 ], movedPoint[ 1 ], movedPoint[ 2 ] + 1.0 );
+  if ( curveGenerator->UpdateCurveModelIncrementally( controlPoints.GetPointer(), incrementalTube.GetPointer(),
+    interpolationType, TEST_TUBE_RADIUS, TEST_TUBE_NUMBER_OF_SIDES, TEST_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS, tubeLoop,
+    0.0, 0.0, 0.0, false ) )
+  {
+    std::cerr << curveName << ": the curve was patched after the output was modified" << std::endl;
+    return false;
+  }
+  vtkSlicerMarkupsToModelLogic::UpdateOutputCurveModel( controlPoints.GetPointer(), referenceTube.GetPointer(),
+    interpolationType, tubeLoop, TEST_TUBE_RADIUS, TEST_TUBE_NUMBER_OF_SIDES, TEST_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS, false );
+  maximumDeviation = GetMaximumRingDeviation( incrementalTube.GetPointer(), referenceTube.GetPointer(),
+    TEST_TUBE_NUMBER_OF_SIDES, maximumCenterDeviation );
+  if ( maximumDeviation < 0.0 || maximumDeviation > TEST_EXACT_TOLERANCE )
+  {
+    std::cerr << curveName << ": regenerated curve deviates from the full regeneration by " << maximumDeviation << std::endl;
+    return false;
+  }
+
+  std::cout << curveName << ": maximum deviation of the patched curve " << maximumCenterDeviation << std::endl;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelIncrementalCurveTest( int vtkNotUsed( argc ), char* vtkNotUsed( argv )[] )
+{
+  const int interpolationTypes[] =
+  {
+    vtkMRMLMarkupsToModelNode::Linear,
+    vtkMRMLMarkupsToModelNode::CardinalSpline,
+    vtkMRMLMarkupsToModelNode::KochanekSpline
+  };
+  bool success = true;
+  for ( int i = 0; i < 3; i++ )
+  {
+    success = TestIncrementalCurve( interpolationTypes[ i ], false ) && success;
+    success = TestIncrementalCurve( interpolationTypes[ i ], true ) && success;
+  }
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,335 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Compares the closed surface that is updated with the incremental Delaunay surface
+// (vtkSlicerMarkupsToModelClosedSurfaceGeneration with IncrementalDelaunay enabled, kept between the steps)
+// with a full regeneration from all points after each step: adding a point, moving a point, deleting a vertex
+// of the hull, deleting an interior point, changing more than 25% of the points (the hull is computed again),
+// and points that are nearly coplanar with a face of the hull.
+
+// MarkupsToModel includes
+#include "vtkMRMLMarkupsToModelNode.h"
+#include "vtkSlicerMarkupsToModelClosedSurfaceGeneration.h"
+#include "vtkSlicerMarkupsToModelIncrementalSurface.h"
+#include "vtkSlicerMarkupsToModelUpdateStatistics.h"
+
+// vtk includes
+#include <vtkCellLocator.h>
+#include <vtkMath.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+//------------------------------------------------------------------------------
+// constants within this file
+static const int TEST_RANDOM_SEED = 1;
+static const int TEST_NUMBER_OF_SPHERE_POINTS = 40;
+static const int TEST_NUMBER_OF_INTERIOR_POINTS = 20;
+static const double TEST_SPHERE_RADIUS = 50.0;
+static const double TEST_INTERIOR_RADIUS = 20.0;
+static const double TEST_CUBE_HALF_SIZE = 50.0;
+static const int TEST_COPLANAR_GRID_SIZE = 5;
+// distance of the nearly coplanar points from the face of the hull
+static const double TEST_COPLANAR_OFFSET = 1e-9;
+// the surfaces are compared in mm, relative to their size of about 100mm
+static const double TEST_DISTANCE_TOLERANCE = 0.001;
+static const double TEST_RELATIVE_TOLERANCE = 1e-5;
+
+//------------------------------------------------------------------------------
+// Random points near a sphere (most of them are vertices of the hull) followed by random points well inside it.
+// The radius varies a little, because vtkDelaunay3D is not robust for points that are all on the same sphere.
+static void CreateSpherePoints( vtkPoints* points )
+{
+  vtkNew< vtkMinimalStandardRandomSequence > random;
+  random->SetSeed( TEST_RANDOM_SEED );
+  points->Reset();
+  for ( int i = 0; i < TEST_NUMBER_OF_SPHERE_POINTS + TEST_NUMBER_OF_INTERIOR_POINTS; i++ )
+  {
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    for ( int d = 0; d < 3; d++ )
+    {
+      random->Next();
+      point[ d ] = random->GetRangeValue( -1.0, 1.0 );
+    }
+    vtkMath::Normalize( point );
+    random->Next();
+    double radius = ( i < TEST_NUMBER_OF_SPHERE_POINTS ) ? random->GetRangeValue( 0.9 * TEST_SPHERE_RADIUS, TEST_SPHERE_RADIUS )
+      : random->GetRangeValue( 0.0, TEST_INTERIOR_RADIUS );
+    vtkMath::MultiplyScalar( point, radius );
+    points->InsertNextPoint( point );
+  }
+}
+
+//------------------------------------------------------------------------------
+// Corners of a cube and a grid of points that are alternately slightly above and below its top face
+static void CreateNearlyCoplanarPoints( vtkPoints* points )
+{
+  points->Reset();
+  for ( int corner = 0; corner < 8; corner++ )
+  {
+    points->InsertNextPoint( ( corner & 1 ) ? TEST_CUBE_HALF_SIZE : -TEST_CUBE_HALF_SIZE,
+      ( corner & 2 ) ? TEST_CUBE_HALF_SIZE : -TEST_CUBE_HALF_SIZE, ( corner & 4 ) ? TEST_CUBE_HALF_SIZE : -TEST_CUBE_HALF_SIZE );
+  }
+  double gridSpacing = 2.0 * TEST_CUBE_HALF_SIZE / ( TEST_COPLANAR_GRID_SIZE + 1 );
+  for ( int i = 1; i <= TEST_COPLANAR_GRID_SIZE; i++ )
+  {
+    for ( int j = 1; j <= TEST_COPLANAR_GRID_SIZE; j++ )
+    {
+      double offset = ( ( i + j ) % 2 == 0 ) ? TEST_COPLANAR_OFFSET : -TEST_COPLANAR_OFFSET;
+      points->InsertNextPoint( -TEST_CUBE_HALF_SIZE + i * gridSpacing, -TEST_CUBE_HALF_SIZE + j * gridSpacing, TEST_CUBE_HALF_SIZE + offset );
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Index of the first point that is a vertex of the hull, at or after firstPointIndex
+static int FindHullVertex( vtkPoints* points, vtkSlicerMarkupsToModelIncrementalSurface* hull, int firstPointIndex )
+{
+  vtkNew< vtkPolyData > hullPolyData;
+  hull->GetSurface( hullPolyData.GetPointer() );
+  for ( int i = firstPointIndex; i < points->GetNumberOfPoints(); i++ )
+  {
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    points->GetPoint( i, point );
+    for ( vtkIdType j = 0; j < hullPolyData->GetNumberOfPoints(); j++ )
+    {
+      double hullPoint[ 3 ] = { 0.0, 0.0, 0.0 };
+      hullPolyData->GetPoint( j, hullPoint );
+      if ( point[ 0 ] == hullPoint[ 0 ] && point[ 1 ] == hullPoint[ 1 ] && point[ 2 ] == hullPoint[ 2 ] )
+      {
+        return i;
+      }
+    }
+  }
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+// Largest distance of the points of a surface from another surface
+static double GetMaximumDistance( vtkPolyData* fromPolyData, vtkPolyData* toPolyData )
+{
+  vtkNew< vtkCellLocator > locator;
+  locator->SetDataSet( toPolyData );
+  locator->BuildLocator();
+  double maximumDistance2 = 0.0;
+  for ( vtkIdType i = 0; i < fromPolyData->GetNumberOfPoints(); i++ )
+  {
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    fromPolyData->GetPoint( i, point );
+    double closestPoint[ 3 ] = { 0.0, 0.0, 0.0 };
+    vtkIdType cellId = -1;
+    int subId = 0;
+    double distance2 = 0.0;
+    locator->FindClosestPoint( point, closestPoint, cellId, subId, distance2 );
+    maximumDistance2 = std::max( maximumDistance2, distance2 );
+  }
+  return sqrt( maximumDistance2 );
+}
+
+//------------------------------------------------------------------------------
+static bool HasStage( vtkSlicerMarkupsToModelUpdateStatistics* statistics, const std::string& stageName )
+{
+  for ( int i = 0; i < statistics->GetNumberOfStages(); i++ )
+  {
+    if ( stageName == statistics->GetStageName( i ) )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// Update the incremental surface and check it against a surface that is generated from all points.
+// expectedHullRebuilt is compared with a separate incremental hull that is updated with the same points (-1: not checked).
+static bool TestStep( const std::string& name, vtkPoints* points, bool smoothing,
+  vtkSlicerMarkupsToModelClosedSurfaceGeneration* incrementalGenerator, vtkSlicerMarkupsToModelIncrementalSurface* hull,
+  int expectedHullRebuilt )
+{
+  vtkNew< vtkPolyData > incrementalPolyData;
+  vtkNew< vtkSlicerMarkupsToModelUpdateStatistics > statistics;
+  if ( !incrementalGenerator->UpdateClosedSurfaceModel( points, incrementalPolyData.GetPointer(), 0.0, smoothing, false,
+    vtkMRMLMarkupsToModelNode::DelaunaySurface, statistics.GetPointer() ) )
+  {
+    std::cerr << name << ": the incremental update failed" << std::endl;
+    return false;
+  }
+  if ( !HasStage( statistics.GetPointer(), "incremental delaunay" ) )
+  {
+    std::cerr << name << ": the incremental Delaunay surface was not used" << std::endl;
+    return false;
+  }
+
+  hull->UpdatePoints( points );
+  if ( expectedHullRebuilt >= 0 && hull->GetHullRebuilt() != ( expectedHullRebuilt > 0 ) )
+  {
+    std::cerr << name << ": the hull was " << ( hull->GetHullRebuilt() ? "computed again" : "updated locally" )
+      << ", expected the opposite" << std::endl;
+    return false;
+  }
+
+  vtkNew< vtkSlicerMarkupsToModelClosedSurfaceGeneration > fullGenerator;
+  vtkNew< vtkPolyData > fullPolyData;
+  if ( !fullGenerator->UpdateClosedSurfaceModel( points, fullPolyData.GetPointer(), 0.0, smoothing, false ) )
+  {
+    std::cerr << name << ": the full regeneration failed" << std::endl;
+    return false;
+  }
+
+  double incrementalVolume = vtkSlicerMarkupsToModelClosedSurfaceGeneration::GetSurfaceVolume( incrementalPolyData.GetPointer() );
+  double fullVolume = vtkSlicerMarkupsToModelClosedSurfaceGeneration::GetSurfaceVolume( fullPolyData.GetPointer() );
+  double incrementalArea = vtkSlicerMarkupsToModelClosedSurfaceGeneration::GetSurfaceArea( incrementalPolyData.GetPointer() );
+  double fullArea = vtkSlicerMarkupsToModelClosedSurfaceGeneration::GetSurfaceArea( fullPolyData.GetPointer() );
+  if ( fullVolume <= 0.0 || fabs( incrementalVolume - fullVolume ) > TEST_RELATIVE_TOLERANCE * fullVolume
+    || fabs( incrementalArea - fullArea ) > TEST_RELATIVE_TOLERANCE * fullArea )
+  {
+    std::cerr << name << ": the incremental surface has volume " << incrementalVolume << " and area " << incrementalArea
+      << ", the regenerated surface has volume " << fullVolume << " and area " << fullArea << std::endl;
+    return false;
+  }
+  double distance = std::max( GetMaximumDistance( incrementalPolyData.GetPointer(), fullPolyData.GetPointer() ),
+    GetMaximumDistance( fullPolyData.GetPointer(), incrementalPolyData.GetPointer() ) );
+  if ( distance > TEST_DISTANCE_TOLERANCE )
+  {
+    std::cerr << name << ": the incremental surface is " << distance << "mm from the regenerated surface" << std::endl;
+    return false;
+  }
+  std::cout << name << ": " << incrementalPolyData->GetNumberOfPoints() << " points, volume " << incrementalVolume << std::endl;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static bool TestLocalChanges()
+{
+  vtkNew< vtkSlicerMarkupsToModelClosedSurfaceGeneration > incrementalGenerator;
+  incrementalGenerator->SetIncrementalDelaunay( true );
+  vtkNew< vtkSlicerMarkupsToModelIncrementalSurface > hull;
+  vtkNew< vtkPoints > points;
+  CreateSpherePoints( points.GetPointer() );
+  if ( !TestStep( "initial surface", points.GetPointer(), true, incrementalGenerator.GetPointer(), hull.GetPointer(), 1 ) )
+  {
+    return false;
+  }
+
+  points->InsertNextPoint( 1.5 * TEST_SPHERE_RADIUS, 0.0, 0.0 );
+  if ( !TestStep( "add a point", points.GetPointer(), true, incrementalGenerator.GetPointer(), hull.GetPointer(), 0 ) )
+  {
+    return false;
+  }
+
+  int movedPointIndex = FindHullVertex( points.GetPointer(), hull.GetPointer(), 0 );
+  if ( movedPointIndex < 0 )
+  {
+    std::cerr << "move a point: no vertex of the hull found" << std::endl;
+    return false;
+  }
+  double point[ 3 ] = { 0.0, 0.0, 0.0 };
+  points->GetPoint( movedPointIndex, point );
+  vtkMath::MultiplyScalar( point, 1.2 );
+  points->SetPoint( movedPointIndex, point );
+  if ( !TestStep( "move a point", points.GetPointer(), true, incrementalGenerator.GetPointer(), hull.GetPointer(), 0 ) )
+  {
+    return false;
+  }
+
+  // points are deleted by replacing them with the last point
+  int deletedPointIndex = FindHullVertex( points.GetPointer(), hull.GetPointer(), movedPointIndex + 1 );
+  if ( deletedPointIndex < 0 || deletedPointIndex >= TEST_NUMBER_OF_SPHERE_POINTS )
+  {
+    std::cerr << "delete a hull vertex: no vertex of the hull found" << std::endl;
+    return false;
+  }
+  vtkIdType lastPointIndex = points->GetNumberOfPoints() - 1;
+  points->SetPoint( deletedPointIndex, points->GetPoint( lastPointIndex ) );
+  points->SetNumberOfPoints( lastPointIndex );
+  if ( !TestStep( "delete a hull vertex", points.GetPointer(), true, incrementalGenerator.GetPointer(), hull.GetPointer(), 0 ) )
+  {
+    return false;
+  }
+
+  lastPointIndex = points->GetNumberOfPoints() - 1;
+  points->SetPoint( TEST_NUMBER_OF_SPHERE_POINTS, points->GetPoint( lastPointIndex ) );
+  points->SetNumberOfPoints( lastPointIndex );
+  if ( !TestStep( "delete an interior point", points.GetPointer(), true, incrementalGenerator.GetPointer(), hull.GetPointer(), 0 ) )
+  {
+    return false;
+  }
+
+  // more than 25% of the points are moved
+  int numberOfMovedPoints = points->GetNumberOfPoints() / 3;
+  for ( int i = 0; i < numberOfMovedPoints; i++ )
+  {
+    points->GetPoint( i, point );
+    vtkMath::MultiplyScalar( point, 1.1 );
+    points->SetPoint( i, point );
+  }
+  if ( !TestStep( "move a third of the points", points.GetPointer(), true, incrementalGenerator.GetPointer(), hull.GetPointer(), 1 ) )
+  {
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static bool TestNearlyCoplanarPoints()
+{
+  // the triangulation of the nearly flat face is ambiguous, so the surfaces are only comparable without smoothing
+  vtkNew< vtkSlicerMarkupsToModelClosedSurfaceGeneration > incrementalGenerator;
+  incrementalGenerator->SetIncrementalDelaunay( true );
+  vtkNew< vtkSlicerMarkupsToModelIncrementalSurface > hull;
+  vtkNew< vtkPoints > points;
+  CreateNearlyCoplanarPoints( points.GetPointer() );
+  if ( !TestStep( "nearly coplanar points", points.GetPointer(), false, incrementalGenerator.GetPointer(), hull.GetPointer(), -1 ) )
+  {
+    return false;
+  }
+
+  points->InsertNextPoint( 0.1, 0.2, TEST_CUBE_HALF_SIZE + TEST_COPLANAR_OFFSET );
+  if ( !TestStep( "add a nearly coplanar point", points.GetPointer(), false, incrementalGenerator.GetPointer(), hull.GetPointer(), -1 ) )
+  {
+    return false;
+  }
+
+  // a corner of the face is moved slightly, so that the grid points are on both sides of its plane
+  double point[ 3 ] = { 0.0, 0.0, 0.0 };
+  points->GetPoint( 7, point );
+  point[ 2 ] += 1000.0 * TEST_COPLANAR_OFFSET;
+  points->SetPoint( 7, point );
+  if ( !TestStep( "move a corner of the nearly coplanar face", points.GetPointer(), false, incrementalGenerator.GetPointer(),
+    hull.GetPointer(), -1 ) )
+  {
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelIncrementalSurfaceTest( int vtkNotUsed( argc ), char* vtkNotUsed( argv )[] )
+{
+  bool success = true;
+  success = TestLocalChanges() && success;
+  success = TestNearlyCoplanarPoints() && success;
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
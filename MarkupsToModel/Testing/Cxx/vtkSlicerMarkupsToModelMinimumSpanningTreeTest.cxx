@@ -0,0 +1,112 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Compares the total length of the sparse minimum spanning tree
+// (vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSpanningTree) with the dense
+// reference implementation, on random points and on clusters that are not connected by the nearest neighbor graph.
+
+// MarkupsToModel includes
+#include "vtkSlicerMarkupsToModelCurveGeneration.h"
+
+// vtk includes
+#include <vtkDoubleArray.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+
+// std includes
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+//------------------------------------------------------------------------------
+// constants within this file
+static const int TEST_RANDOM_SEED = 1;
+static const int TEST_NUMBER_OF_POINTS = 600;
+static const double TEST_RELATIVE_TOLERANCE = 1e-9;
+
+//------------------------------------------------------------------------------
+// Random points in numberOfClusters cubes of clusterSize, placed clusterDistance apart along a line
+static void CreatePoints( int numberOfClusters, double clusterSize, double clusterDistance, vtkPoints* outputPoints )
+{
+  vtkNew< vtkMinimalStandardRandomSequence > random;
+  random->SetSeed( TEST_RANDOM_SEED );
+  outputPoints->Reset();
+  for ( int i = 0; i < TEST_NUMBER_OF_POINTS; i++ )
+  {
+    int clusterIndex = i % numberOfClusters;
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    for ( int d = 0; d < 3; d++ )
+    {
+      random->Next();
+      point[ d ] = random->GetRangeValue( 0.0, clusterSize );
+    }
+    point[ 0 ] += clusterIndex * clusterDistance;
+    point[ 1 ] += ( clusterIndex % 3 ) * clusterDistance * 0.5;
+    outputPoints->InsertNextPoint( point );
+  }
+}
+
+//------------------------------------------------------------------------------
+static bool TestMinimumSpanningTreeLength( const std::string& name, vtkPoints* points )
+{
+  double treeLength = 0.0;
+  vtkNew< vtkDoubleArray > pointParameters;
+  vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromMinimumSpanningTree( points, pointParameters.GetPointer(),
+    NULL, &treeLength );
+
+  double denseTreeLength = 0.0;
+  vtkNew< vtkDoubleArray > densePointParameters;
+  vtkSlicerMarkupsToModelCurveGeneration::ComputePointParametersFromDenseMinimumSpanningTree( points, densePointParameters.GetPointer(),
+    NULL, &denseTreeLength );
+
+  if ( pointParameters->GetNumberOfTuples() != points->GetNumberOfPoints() )
+  {
+    std::cerr << name << ": " << pointParameters->GetNumberOfTuples() << " point parameters computed for "
+      << points->GetNumberOfPoints() << " points" << std::endl;
+    return false;
+  }
+  if ( denseTreeLength <= 0.0 || fabs( treeLength - denseTreeLength ) > TEST_RELATIVE_TOLERANCE * denseTreeLength )
+  {
+    std::cerr << name << ": minimum spanning tree length is " << treeLength
+      << ", the dense implementation computed " << denseTreeLength << std::endl;
+    return false;
+  }
+  std::cout << name << ": minimum spanning tree length " << treeLength << std::endl;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelMinimumSpanningTreeTest( int vtkNotUsed( argc ), char* vtkNotUsed( argv )[] )
+{
+  bool success = true;
+  vtkNew< vtkPoints > points;
+
+  CreatePoints( 1, 100.0, 0.0, points.GetPointer() );
+  success = TestMinimumSpanningTreeLength( "random", points.GetPointer() ) && success;
+
+  // each cluster has more points than the neighborhood size, so the nearest neighbor graph is not connected
+  CreatePoints( 8, 5.0, 100.0, points.GetPointer() );
+  success = TestMinimumSpanningTreeLength( "clustered", points.GetPointer() ) && success;
+
+  // many small clusters, some of them are connected by the nearest neighbor graph
+  CreatePoints( 120, 1.0, 7.0, points.GetPointer() );
+  success = TestMinimumSpanningTreeLength( "small clusters", points.GetPointer() ) && success;
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,243 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Appends control points one by one with the streaming curve update
+// (vtkSlicerMarkupsToModelCurveGeneration::UpdateCurveModelStreaming), with and without a retention limit,
+// and compares the number of points and cells and the position of the end caps after each step with
+// the tube that vtkSlicerMarkupsToModelTubeGeneration::GenerateTubeModel generates from the same points.
+
+// MarkupsToModel includes
+#include "vtkMRMLMarkupsToModelNode.h"
+#include "vtkSlicerMarkupsToModelCurveGeneration.h"
+#include "vtkSlicerMarkupsToModelTubeGeneration.h"
+
+// vtk includes
+#include <vtkCellArray.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+//------------------------------------------------------------------------------
+// constants within this file
+static const int TEST_NUMBER_OF_CONTROL_POINTS = 40;
+static const int TEST_MAXIMUM_NUMBER_OF_POINTS = 12;
+static const double TEST_TUBE_RADIUS = 1.0;
+static const int TEST_TUBE_NUMBER_OF_SIDES = 8;
+static const int TEST_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS = 5;
+// the tube points are stored in single precision
+static const double TEST_TOLERANCE = 0.001;
+
+//------------------------------------------------------------------------------
+// Control point i of a helix, consecutive points are about 10mm apart
+static void GetControlPoint( int i, double point[ 3 ] )
+{
+  double angle = 0.5 * i;
+  point[ 0 ] = 20.0 * cos( angle );
+  point[ 1 ] = 20.0 * sin( angle );
+  point[ 2 ] = 4.0 * i;
+}
+
+//------------------------------------------------------------------------------
+// Curve points of the linear interpolation of the control points, the same sampling as the streaming update uses
+static void CreateLinearCurvePoints( vtkPoints* controlPoints, vtkIdType firstControlPoint, vtkPoints* curvePoints )
+{
+  curvePoints->Reset();
+  vtkIdType numberOfControlPoints = controlPoints->GetNumberOfPoints();
+  for ( vtkIdType segment = firstControlPoint; segment + 1 < numberOfControlPoints; segment++ )
+  {
+    double point0[ 3 ] = { 0.0, 0.0, 0.0 };
+    double point1[ 3 ] = { 0.0, 0.0, 0.0 };
+    controlPoints->GetPoint( segment, point0 );
+    controlPoints->GetPoint( segment + 1, point1 );
+    for ( int i = 0; i < TEST_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS; i++ )
+    {
+      double interpolationParam = i / (double)TEST_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS;
+      curvePoints->InsertNextPoint(
+        ( 1.0 - interpolationParam ) * point0[ 0 ] + interpolationParam * point1[ 0 ],
+        ( 1.0 - interpolationParam ) * point0[ 1 ] + interpolationParam * point1[ 1 ],
+        ( 1.0 - interpolationParam ) * point0[ 2 ] + interpolationParam * point1[ 2 ] );
+    }
+  }
+  curvePoints->InsertNextPoint( controlPoints->GetPoint( numberOfControlPoints - 1 ) );
+}
+
+//------------------------------------------------------------------------------
+// Center of the points of a cap (the cell of the polys with the given index)
+static bool GetCapCenter( vtkPolyData* polyData, int capIndex, double center[ 3 ] )
+{
+  center[ 0 ] = center[ 1 ] = center[ 2 ] = 0.0;
+  vtkCellArray* polys = polyData->GetPolys();
+  if ( polys == NULL )
+  {
+    return false;
+  }
+  vtkIdType numberOfCellPoints = 0;
+  vtkIdType* cellPointIds = NULL;
+  int cellIndex = 0;
+  for ( polys->InitTraversal(); polys->GetNextCell( numberOfCellPoints, cellPointIds ); cellIndex++ )
+  {
+    if ( cellIndex != capIndex )
+    {
+      continue;
+    }
+    for ( vtkIdType i = 0; i < numberOfCellPoints; i++ )
+    {
+      double point[ 3 ] = { 0.0, 0.0, 0.0 };
+      polyData->GetPoint( cellPointIds[ i ], point );
+      vtkMath::Add( center, point, center );
+    }
+    if ( numberOfCellPoints > 0 )
+    {
+      vtkMath::MultiplyScalar( center, 1.0 / numberOfCellPoints );
+    }
+    return ( numberOfCellPoints > 0 );
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// Compare the streamed tube with the tube generated from the last numberOfKeptControlPoints input points
+static bool CompareWithGeneratedTube( const std::string& name, vtkPoints* controlPoints, vtkIdType numberOfKeptControlPoints,
+  vtkPolyData* streamedPolyData )
+{
+  vtkNew< vtkPoints > curvePoints;
+  CreateLinearCurvePoints( controlPoints, controlPoints->GetNumberOfPoints() - numberOfKeptControlPoints, curvePoints.GetPointer() );
+  vtkNew< vtkPolyData > generatedPolyData;
+  vtkSlicerMarkupsToModelTubeGeneration::GenerateTubeModel( curvePoints.GetPointer(), generatedPolyData.GetPointer(),
+    TEST_TUBE_RADIUS, TEST_TUBE_NUMBER_OF_SIDES );
+
+  if ( streamedPolyData->GetNumberOfPoints() != generatedPolyData->GetNumberOfPoints() )
+  {
+    std::cerr << name << ": the streamed tube has " << streamedPolyData->GetNumberOfPoints() << " points, the generated tube has "
+      << generatedPolyData->GetNumberOfPoints() << std::endl;
+    return false;
+  }
+  // the streamed tube has one strip between each pair of consecutive rings instead of one strip for each side
+  vtkIdType numberOfCurvePoints = curvePoints->GetNumberOfPoints();
+  if ( streamedPolyData->GetNumberOfStrips() != numberOfCurvePoints - 1
+    || streamedPolyData->GetNumberOfPolys() != generatedPolyData->GetNumberOfPolys() )
+  {
+    std::cerr << name << ": the streamed tube has " << streamedPolyData->GetNumberOfStrips() << " strips and "
+      << streamedPolyData->GetNumberOfPolys() << " caps, expected " << numberOfCurvePoints - 1 << " strips and "
+      << generatedPolyData->GetNumberOfPolys() << " caps" << std::endl;
+    return false;
+  }
+  for ( int capIndex = 0; capIndex < 2; capIndex++ )
+  {
+    double streamedCapCenter[ 3 ] = { 0.0, 0.0, 0.0 };
+    double generatedCapCenter[ 3 ] = { 0.0, 0.0, 0.0 };
+    if ( !GetCapCenter( streamedPolyData, capIndex, streamedCapCenter )
+      || !GetCapCenter( generatedPolyData.GetPointer(), capIndex, generatedCapCenter ) )
+    {
+      std::cerr << name << ": cap " << capIndex << " is missing" << std::endl;
+      return false;
+    }
+    double distance = sqrt( vtkMath::Distance2BetweenPoints( streamedCapCenter, generatedCapCenter ) );
+    if ( distance > TEST_TOLERANCE )
+    {
+      std::cerr << name << ": the center of cap " << capIndex << " is " << distance << "mm from the generated one" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static bool TestStreamingCurve( int interpolationType, int maximumNumberOfPoints )
+{
+  std::ostringstream testName;
+  testName << vtkMRMLMarkupsToModelNode::GetInterpolationTypeAsString( interpolationType )
+    << ( maximumNumberOfPoints > 0 ? " with retention limit" : " without retention limit" );
+
+  vtkNew< vtkSlicerMarkupsToModelCurveGeneration > curveGenerator;
+  vtkNew< vtkPoints > controlPoints;
+  vtkNew< vtkPolyData > outputPolyData;
+  for ( int i = 0; i < TEST_NUMBER_OF_CONTROL_POINTS; i++ )
+  {
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    GetControlPoint( i, point );
+    controlPoints->InsertNextPoint( point );
+    bool updatedInPlace = curveGenerator->UpdateCurveModelStreaming( controlPoints.GetPointer(), outputPolyData.GetPointer(),
+      interpolationType, TEST_TUBE_RADIUS, TEST_TUBE_NUMBER_OF_SIDES, TEST_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS,
+      0.0, 0.0, 0.0, false, 0.0, maximumNumberOfPoints, 0.0, static_cast< double >( i ) );
+
+    std::ostringstream stepName;
+    stepName << testName.str() << ", " << i + 1 << " points";
+    if ( i == 0 )
+    {
+      if ( updatedInPlace )
+      {
+        std::cerr << stepName.str() << ": the first update must generate the model" << std::endl;
+        return false;
+      }
+      continue;
+    }
+    if ( maximumNumberOfPoints <= 0 && !updatedInPlace )
+    {
+      std::cerr << stepName.str() << ": the model was regenerated instead of extended" << std::endl;
+      return false;
+    }
+
+    // the number of kept control points follows from the number of rings
+    vtkIdType numberOfRings = outputPolyData->GetNumberOfPoints() / TEST_TUBE_NUMBER_OF_SIDES;
+    vtkIdType numberOfKeptControlPoints = ( numberOfRings - 1 ) / TEST_TUBE_SEGMENTS_BETWEEN_CONTROL_POINTS + 1;
+    vtkIdType minimumNumberOfKeptControlPoints = i + 1;
+    vtkIdType maximumNumberOfKeptControlPoints = i + 1;
+    if ( maximumNumberOfPoints > 0 )
+    {
+      // old points are removed in batches of up to 25% of the limit
+      minimumNumberOfKeptControlPoints = std::min( minimumNumberOfKeptControlPoints, (vtkIdType)maximumNumberOfPoints );
+      maximumNumberOfKeptControlPoints = std::min( maximumNumberOfKeptControlPoints, (vtkIdType)( maximumNumberOfPoints * 5 / 4 ) );
+    }
+    if ( numberOfKeptControlPoints < minimumNumberOfKeptControlPoints || numberOfKeptControlPoints > maximumNumberOfKeptControlPoints )
+    {
+      std::cerr << stepName.str() << ": the model contains " << numberOfKeptControlPoints << " control points, expected "
+        << minimumNumberOfKeptControlPoints << " to " << maximumNumberOfKeptControlPoints << std::endl;
+      return false;
+    }
+    if ( !CompareWithGeneratedTube( stepName.str(), controlPoints.GetPointer(), numberOfKeptControlPoints, outputPolyData.GetPointer() ) )
+    {
+      return false;
+    }
+  }
+  std::cout << testName.str() << ": " << outputPolyData->GetNumberOfPoints() << " points, "
+    << outputPolyData->GetNumberOfStrips() << " strips" << std::endl;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerMarkupsToModelStreamingCurveTest( int vtkNotUsed( argc ), char* vtkNotUsed( argv )[] )
+{
+  bool success = true;
+  const int interpolationTypes[] = { vtkMRMLMarkupsToModelNode::Linear, vtkMRMLMarkupsToModelNode::CardinalSpline,
+    vtkMRMLMarkupsToModelNode::KochanekSpline };
+  for ( int i = 0; i < 3; i++ )
+  {
+    success = TestStreamingCurve( interpolationTypes[ i ], 0 ) && success;
+    success = TestStreamingCurve( interpolationTypes[ i ], TEST_MAXIMUM_NUMBER_OF_POINTS ) && success;
+  }
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
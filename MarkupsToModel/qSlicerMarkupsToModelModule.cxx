@@ -24,6 +24,12 @@
 #include "qSlicerCoreApplication.h"
 #include "qSlicerModuleManager.h"
 
+// Qt includes
+#include <QTimer>
+
+// interval of checking for deferred output model updates, the timer only runs while there are pending updates
+static const int PENDING_UPDATES_TIMER_INTERVAL_MSEC = 10;
+
 //-----------------------------------------------------------------------------
 #if (QT_VERSION < QT_VERSION_CHECK(5, 0, 0))
 #include <QtPlugin>
@@ -36,6 +42,8 @@ class qSlicerMarkupsToModelModulePrivate
 {
 public:
   qSlicerMarkupsToModelModulePrivate();
+
+  QTimer PendingUpdatesTimer;
 };
 
 //-----------------------------------------------------------------------------
@@ -122,6 +130,37 @@ void qSlicerMarkupsToModelModule::setup()
     markupsToModelLogic->MarkupsLogic = vtkSlicerMarkupsLogic::SafeDownCast( markupsModule->logic() );
   }
 
+  // perform the rate-limited output updates, the timer is started when the logic reports pending updates
+  Q_D(qSlicerMarkupsToModelModule);
+  d->PendingUpdatesTimer.setInterval( PENDING_UPDATES_TIMER_INTERVAL_MSEC );
+  connect( &d->PendingUpdatesTimer, SIGNAL( timeout() ), this, SLOT( processPendingUpdates() ) );
+  qvtkConnect( markupsToModelLogic, vtkSlicerMarkupsToModelLogic::PendingUpdatesEvent, this, SLOT( onPendingUpdates() ) );
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerMarkupsToModelModule::onPendingUpdates()
+{
+  Q_D(qSlicerMarkupsToModelModule);
+  // restarting an active timer would postpone the updates while changes keep arriving
+  if ( !d->PendingUpdatesTimer.isActive() )
+  {
+    d->PendingUpdatesTimer.start();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerMarkupsToModelModule::processPendingUpdates()
+{
+  Q_D(qSlicerMarkupsToModelModule);
+  vtkSlicerMarkupsToModelLogic* markupsToModelLogic = vtkSlicerMarkupsToModelLogic::SafeDownCast( this->logic() );
+  if ( markupsToModelLogic != NULL && markupsToModelLogic->HasPendingUpdates() )
+  {
+    markupsToModelLogic->ProcessPendingUpdates();
+  }
+  if ( markupsToModelLogic == NULL || !markupsToModelLogic->HasPendingUpdates() )
+  {
+    d->PendingUpdatesTimer.stop();
+  }
 }
 
 //-----------------------------------------------------------------------------
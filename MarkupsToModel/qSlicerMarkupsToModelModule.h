@@ -21,6 +21,9 @@
 // SlicerQt includes
 #include "qSlicerLoadableModule.h"
 
+// CTK includes
+#include <ctkVTKObject.h>
+
 #include "vtkSlicerConfigure.h" // For Slicer_HAVE_QT5
 
 #include "qSlicerMarkupsToModelModuleExport.h"
@@ -33,6 +36,7 @@ qSlicerMarkupsToModelModule
   : public qSlicerLoadableModule
 {
   Q_OBJECT
+  QVTK_OBJECT
 #ifdef Slicer_HAVE_QT5
   Q_PLUGIN_METADATA(IID "org.slicer.modules.loadable.qSlicerLoadableModule/1.0");
 #endif
@@ -54,6 +58,13 @@ public:
   virtual QStringList categories()const;
   virtual QStringList dependencies() const;
 
+protected slots:
+  /// Perform the deferred (rate-limited) output model updates, stop the timer when there are no more
+  void processPendingUpdates();
+
+  /// Start the timer of the deferred output model updates
+  void onPendingUpdates();
+
 protected:
 
   /// Initialize the module. Register the volumes reader/writer
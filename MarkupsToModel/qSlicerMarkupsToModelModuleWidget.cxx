@@ -36,7 +36,9 @@
 
 // module includes
 #include "vtkMRMLMarkupsToModelNode.h"
+#include "vtkSlicerMarkupsToModelGeometryCache.h"
 #include "vtkSlicerMarkupsToModelLogic.h"
+#include "vtkSlicerMarkupsToModelUpdateStatistics.h"
 
 //-----------------------------------------------------------------------------
 /// \ingroup Slicer_QtModules_ExtensionTemplate
@@ -98,6 +100,9 @@ void qSlicerMarkupsToModelModuleWidget::setup()
 
   this->setMRMLScene( d->logic()->GetMRMLScene() );
 
+  d->logic()->UpdateStatisticsEventEnabledOn();
+  qvtkConnect( d->logic(), vtkSlicerMarkupsToModelLogic::UpdateStatisticsEvent, this, SLOT( updateStatisticsLabel() ) );
+
   connect( d->ParameterNodeSelector, SIGNAL( currentNodeChanged( vtkMRMLNode* ) ), this, SLOT( onMarkupsToModelNodeSelectionChanged() ) );
   connect( d->ModelNodeSelector, SIGNAL( currentNodeChanged( vtkMRMLNode* ) ), this, SLOT( onOutputModelComboBoxSelectionChanged( vtkMRMLNode*) ) );
   connect( d->ModelNodeSelector, SIGNAL( nodeAddedByUser( vtkMRMLNode* ) ), this, SLOT( onOutputModelComboBoxNodeAdded( vtkMRMLNode* ) ) );
@@ -107,16 +112,26 @@ void qSlicerMarkupsToModelModuleWidget::setup()
   connect( d->UpdateButton, SIGNAL( checkBoxToggled( bool ) ), this, SLOT( onUpdateButtonCheckboxToggled( bool ) ) );
 
   connect(d->ButterflySubdivisionCheckBox, SIGNAL(toggled(bool)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->NumberOfSubdivisionsSpinBox, SIGNAL(valueChanged(int)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->SinglePrecisionOutputCheckBox, SIGNAL(toggled(bool)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->IncrementalDelaunayCheckBox, SIGNAL(toggled(bool)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->FollowInputTransformCheckBox, SIGNAL(toggled(bool)), this, SLOT(updateMRMLFromGUI()));
   connect(d->ConvexHullCheckBox, SIGNAL(toggled(bool)), this, SLOT(updateMRMLFromGUI()));
   connect(d->CleanMarkupsCheckBox, SIGNAL(toggled(bool)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->CleanMarkupsToleranceDoubleSpinBox, SIGNAL(valueChanged(double)), this, SLOT(updateMRMLFromGUI()));
 
   connect(d->ModeClosedSurfaceRadioButton, SIGNAL(clicked()), this, SLOT(updateMRMLFromGUI()));
   connect(d->ModeCurveRadioButton, SIGNAL(clicked()), this, SLOT(updateMRMLFromGUI()));
   connect(d->DelaunayAlphaDoubleSpinBox, SIGNAL(valueChanged(double)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->SurfaceGenerationMethodComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->DecimationTargetNumberOfPointsSpinBox, SIGNAL(valueChanged(int)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->DecimationSpacingDoubleSpinBox, SIGNAL(valueChanged(double)), this, SLOT(updateMRMLFromGUI()));
   connect(d->TubeRadiusDoubleSpinBox, SIGNAL(valueChanged(double)), this, SLOT(updateMRMLFromGUI()));
   connect(d->TubeSegmentsSpinBox, SIGNAL(valueChanged(double)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->TubeSamplingToleranceDoubleSpinBox, SIGNAL(valueChanged(double)), this, SLOT(updateMRMLFromGUI()));
   connect(d->TubeSidesSpinBox, SIGNAL(valueChanged(double)), this, SLOT(updateMRMLFromGUI()));
   connect(d->TubeLoopCheckBox, SIGNAL(clicked()), this, SLOT(updateMRMLFromGUI()));
+  connect(d->CenterlineOutputCheckBox, SIGNAL(toggled(bool)), this, SLOT(updateMRMLFromGUI()));
 
   connect(d->KochanekEndsCopyNearestDerivativesCheckBox, SIGNAL(clicked()), this, SLOT(updateMRMLFromGUI()));
   connect(d->KochanekBiasDoubleSpinBox, SIGNAL(valueChanged(double)), this, SLOT(updateMRMLFromGUI()));
@@ -124,7 +139,16 @@ void qSlicerMarkupsToModelModuleWidget::setup()
   connect(d->KochanekTensionDoubleSpinBox, SIGNAL(valueChanged(double)), this, SLOT(updateMRMLFromGUI()));
   connect(d->PointParameterRawIndicesRadioButton, SIGNAL(clicked()), this, SLOT(updateMRMLFromGUI()));
   connect(d->PointParameterMinimumSpanningTreeRadioButton, SIGNAL(clicked()), this, SLOT(updateMRMLFromGUI()));
+  connect(d->PointParameterMinimumSpanningTreeDenseRadioButton, SIGNAL(clicked()), this, SLOT(updateMRMLFromGUI()));
   connect(d->PolynomialOrderSpinBox, SIGNAL(valueChanged(double)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->IncrementalCurveUpdateCheckBox, SIGNAL(toggled(bool)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->StreamingCurveUpdateCheckBox, SIGNAL(toggled(bool)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->StreamingMaximumNumberOfPointsSpinBox, SIGNAL(valueChanged(int)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->StreamingMaximumPointAgeDoubleSpinBox, SIGNAL(valueChanged(double)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->MaximumUpdateRateDoubleSpinBox, SIGNAL(valueChanged(double)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->FinalUpdateOnInteractionEndCheckBox, SIGNAL(toggled(bool)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->AsynchronousUpdateCheckBox, SIGNAL(toggled(bool)), this, SLOT(updateMRMLFromGUI()));
+  connect(d->InteractionPreviewCheckBox, SIGNAL(toggled(bool)), this, SLOT(updateMRMLFromGUI()));
 
   connect(d->ModelOpacitySlider, SIGNAL(valueChanged(double)), this, SLOT(updateMRMLFromGUI()));
   connect(d->ModelColorSelector, SIGNAL(clicked()), this, SLOT(updateMRMLFromGUI()));
@@ -340,14 +364,29 @@ void qSlicerMarkupsToModelModuleWidget::updateMRMLFromGUI()
   markupsToModelModuleNode->SetAutoUpdateOutput(d->UpdateButton->isChecked());
 
   markupsToModelModuleNode->SetCleanMarkups(d->CleanMarkupsCheckBox->isChecked());
+  markupsToModelModuleNode->SetCleanMarkupsTolerance(d->CleanMarkupsToleranceDoubleSpinBox->value());
+  markupsToModelModuleNode->SetMaximumUpdateRate(d->MaximumUpdateRateDoubleSpinBox->value());
+  markupsToModelModuleNode->SetFinalUpdateOnInteractionEnd(d->FinalUpdateOnInteractionEndCheckBox->isChecked());
+  markupsToModelModuleNode->SetAsynchronousUpdate(d->AsynchronousUpdateCheckBox->isChecked());
+  markupsToModelModuleNode->SetInteractionQualityLevel(d->InteractionPreviewCheckBox->isChecked()
+    ? vtkMRMLMarkupsToModelNode::PreviewQuality : vtkMRMLMarkupsToModelNode::FullQuality);
   markupsToModelModuleNode->SetDelaunayAlpha(d->DelaunayAlphaDoubleSpinBox->value());
   markupsToModelModuleNode->SetConvexHull(d->ConvexHullCheckBox->isChecked());
   markupsToModelModuleNode->SetButterflySubdivision(d->ButterflySubdivisionCheckBox->isChecked());
+  markupsToModelModuleNode->SetNumberOfSubdivisions(d->NumberOfSubdivisionsSpinBox->value());
+  markupsToModelModuleNode->SetSinglePrecisionOutput(d->SinglePrecisionOutputCheckBox->isChecked());
+  markupsToModelModuleNode->SetIncrementalDelaunay(d->IncrementalDelaunayCheckBox->isChecked());
+  markupsToModelModuleNode->SetFollowInputTransform(d->FollowInputTransformCheckBox->isChecked());
+  markupsToModelModuleNode->SetSurfaceGenerationMethod(d->SurfaceGenerationMethodComboBox->currentIndex());
+  markupsToModelModuleNode->SetDecimationTargetNumberOfPoints(d->DecimationTargetNumberOfPointsSpinBox->value());
+  markupsToModelModuleNode->SetDecimationSpacing(d->DecimationSpacingDoubleSpinBox->value());
 
   markupsToModelModuleNode->SetTubeRadius(d->TubeRadiusDoubleSpinBox->value());
   markupsToModelModuleNode->SetTubeSegmentsBetweenControlPoints(d->TubeSegmentsSpinBox->value());
+  markupsToModelModuleNode->SetTubeSamplingTolerance(d->TubeSamplingToleranceDoubleSpinBox->value());
   markupsToModelModuleNode->SetTubeNumberOfSides(d->TubeSidesSpinBox->value());
   markupsToModelModuleNode->SetTubeLoop(d->TubeLoopCheckBox->isChecked());
+  markupsToModelModuleNode->SetCenterlineOutput(d->CenterlineOutputCheckBox->isChecked());
   if (d->LinearInterpolationRadioButton->isChecked())
   {
     markupsToModelModuleNode->SetInterpolationType(vtkMRMLMarkupsToModelNode::Linear);
@@ -368,6 +407,10 @@ void qSlicerMarkupsToModelModuleWidget::updateMRMLFromGUI()
   markupsToModelModuleNode->SetKochanekBias(d->KochanekBiasDoubleSpinBox->value());
   markupsToModelModuleNode->SetKochanekContinuity(d->KochanekContinuityDoubleSpinBox->value());
   markupsToModelModuleNode->SetKochanekTension(d->KochanekTensionDoubleSpinBox->value());
+  markupsToModelModuleNode->SetIncrementalCurveUpdate(d->IncrementalCurveUpdateCheckBox->isChecked());
+  markupsToModelModuleNode->SetStreamingCurveUpdate(d->StreamingCurveUpdateCheckBox->isChecked());
+  markupsToModelModuleNode->SetStreamingMaximumNumberOfPoints(d->StreamingMaximumNumberOfPointsSpinBox->value());
+  markupsToModelModuleNode->SetStreamingMaximumPointAge(d->StreamingMaximumPointAgeDoubleSpinBox->value());
   if (d->PointParameterRawIndicesRadioButton->isChecked())
   {
     markupsToModelModuleNode->SetPointParameterType(vtkMRMLMarkupsToModelNode::RawIndices);
@@ -376,6 +419,10 @@ void qSlicerMarkupsToModelModuleWidget::updateMRMLFromGUI()
   {
     markupsToModelModuleNode->SetPointParameterType(vtkMRMLMarkupsToModelNode::MinimumSpanningTree);
   }
+  else if (d->PointParameterMinimumSpanningTreeDenseRadioButton->isChecked())
+  {
+    markupsToModelModuleNode->SetPointParameterType(vtkMRMLMarkupsToModelNode::MinimumSpanningTreeDense);
+  }
   markupsToModelModuleNode->SetPolynomialOrder(d->PolynomialOrderSpinBox->value());
 
   markupsToModelModuleNode->EndModify(markupsToModelModuleNodeWasModified);
@@ -464,15 +511,30 @@ void qSlicerMarkupsToModelModuleWidget::updateGUIFromMRML()
 
   // Advanced options
   d->CleanMarkupsCheckBox->setChecked(markupsToModelNode->GetCleanMarkups());
+  d->CleanMarkupsToleranceDoubleSpinBox->setValue(markupsToModelNode->GetCleanMarkupsTolerance());
+  d->CleanMarkupsToleranceDoubleSpinBox->setEnabled(markupsToModelNode->GetCleanMarkups());
+  d->MaximumUpdateRateDoubleSpinBox->setValue(markupsToModelNode->GetMaximumUpdateRate());
+  d->FinalUpdateOnInteractionEndCheckBox->setChecked(markupsToModelNode->GetFinalUpdateOnInteractionEnd());
+  d->AsynchronousUpdateCheckBox->setChecked(markupsToModelNode->GetAsynchronousUpdate());
+  d->InteractionPreviewCheckBox->setChecked(markupsToModelNode->GetInteractionQualityLevel() == vtkMRMLMarkupsToModelNode::PreviewQuality);
   // closed surface
   d->ButterflySubdivisionCheckBox->setChecked(markupsToModelNode->GetButterflySubdivision());
+  d->NumberOfSubdivisionsSpinBox->setValue(markupsToModelNode->GetNumberOfSubdivisions());
+  d->SinglePrecisionOutputCheckBox->setChecked(markupsToModelNode->GetSinglePrecisionOutput());
+  d->IncrementalDelaunayCheckBox->setChecked(markupsToModelNode->GetIncrementalDelaunay());
+  d->FollowInputTransformCheckBox->setChecked(markupsToModelNode->GetFollowInputTransform());
   d->DelaunayAlphaDoubleSpinBox->setValue(markupsToModelNode->GetDelaunayAlpha());
   d->ConvexHullCheckBox->setChecked(markupsToModelNode->GetConvexHull());
+  d->SurfaceGenerationMethodComboBox->setCurrentIndex(markupsToModelNode->GetSurfaceGenerationMethod());
+  d->DecimationTargetNumberOfPointsSpinBox->setValue(markupsToModelNode->GetDecimationTargetNumberOfPoints());
+  d->DecimationSpacingDoubleSpinBox->setValue(markupsToModelNode->GetDecimationSpacing());
   // curve
   d->TubeRadiusDoubleSpinBox->setValue(markupsToModelNode->GetTubeRadius());
   d->TubeSidesSpinBox->setValue(markupsToModelNode->GetTubeNumberOfSides());
   d->TubeSegmentsSpinBox->setValue(markupsToModelNode->GetTubeSegmentsBetweenControlPoints());
+  d->TubeSamplingToleranceDoubleSpinBox->setValue(markupsToModelNode->GetTubeSamplingTolerance());
   d->TubeLoopCheckBox->setChecked(markupsToModelNode->GetTubeLoop());
+  d->CenterlineOutputCheckBox->setChecked(markupsToModelNode->GetCenterlineOutput());
   switch (markupsToModelNode->GetInterpolationType())
   {
   case vtkMRMLMarkupsToModelNode::Linear: d->LinearInterpolationRadioButton->setChecked(1); break;
@@ -484,10 +546,15 @@ void qSlicerMarkupsToModelModuleWidget::updateGUIFromMRML()
   d->KochanekBiasDoubleSpinBox->setValue(markupsToModelNode->GetKochanekBias());
   d->KochanekContinuityDoubleSpinBox->setValue(markupsToModelNode->GetKochanekContinuity());
   d->KochanekTensionDoubleSpinBox->setValue(markupsToModelNode->GetKochanekTension());
+  d->IncrementalCurveUpdateCheckBox->setChecked(markupsToModelNode->GetIncrementalCurveUpdate());
+  d->StreamingCurveUpdateCheckBox->setChecked(markupsToModelNode->GetStreamingCurveUpdate());
+  d->StreamingMaximumNumberOfPointsSpinBox->setValue(markupsToModelNode->GetStreamingMaximumNumberOfPoints());
+  d->StreamingMaximumPointAgeDoubleSpinBox->setValue(markupsToModelNode->GetStreamingMaximumPointAge());
   switch (markupsToModelNode->GetPointParameterType())
   {
   case vtkMRMLMarkupsToModelNode::RawIndices: d->PointParameterRawIndicesRadioButton->setChecked(1); break;
   case vtkMRMLMarkupsToModelNode::MinimumSpanningTree: d->PointParameterMinimumSpanningTreeRadioButton->setChecked(1); break;
+  case vtkMRMLMarkupsToModelNode::MinimumSpanningTreeDense: d->PointParameterMinimumSpanningTreeDenseRadioButton->setChecked(1); break;
   }
   d->PolynomialOrderSpinBox->setValue(markupsToModelNode->GetPolynomialOrder());
 
@@ -544,17 +611,34 @@ void qSlicerMarkupsToModelModuleWidget::updateGUIFromMRML()
   bool isCurve = d->ModeCurveRadioButton->isChecked();
   bool isPolynomial = d->PolynomialInterpolationRadioButton->isChecked();
   bool isKochanek = d->KochanekInterpolationRadioButton->isChecked();
+  bool isDelaunay = ( d->SurfaceGenerationMethodComboBox->currentIndex() == vtkMRMLMarkupsToModelNode::DelaunaySurface );
+  bool isImplicit = ( d->SurfaceGenerationMethodComboBox->currentIndex() == vtkMRMLMarkupsToModelNode::ImplicitSurface );
   bool isInputMarkups = ( vtkMRMLMarkupsFiducialNode::SafeDownCast( inputNode ) != NULL );
   
   d->InputMarkupsPlaceWidget->setVisible( isInputMarkups );
   d->MarkupsTextScaleSlider->setVisible( isInputMarkups );
 
-  d->ButterflySubdivisionLabel->setVisible( isSurface );
-  d->ButterflySubdivisionCheckBox->setVisible( isSurface );
-  d->DelaunayAlphaLabel->setVisible( isSurface );
-  d->DelaunayAlphaDoubleSpinBox->setVisible( isSurface );
-  d->ConvexHullLabel->setVisible( isSurface );
-  d->ConvexHullCheckBox->setVisible( isSurface );
+  d->SurfaceGenerationMethodLabel->setVisible( isSurface );
+  d->SurfaceGenerationMethodComboBox->setVisible( isSurface );
+  d->DecimationTargetNumberOfPointsLabel->setVisible( isSurface );
+  d->DecimationTargetNumberOfPointsSpinBox->setVisible( isSurface );
+  d->DecimationSpacingLabel->setVisible( isSurface );
+  d->DecimationSpacingDoubleSpinBox->setVisible( isSurface );
+  d->ButterflySubdivisionLabel->setVisible( isSurface && !isImplicit );
+  d->ButterflySubdivisionCheckBox->setVisible( isSurface && !isImplicit );
+  bool isSmoothing = d->ButterflySubdivisionCheckBox->isChecked();
+  d->NumberOfSubdivisionsLabel->setVisible( isSurface && !isImplicit && isSmoothing );
+  d->NumberOfSubdivisionsSpinBox->setVisible( isSurface && !isImplicit && isSmoothing );
+  d->SinglePrecisionOutputLabel->setVisible( isSurface );
+  d->SinglePrecisionOutputCheckBox->setVisible( isSurface );
+  d->IncrementalDelaunayLabel->setVisible( isSurface && isDelaunay );
+  d->IncrementalDelaunayCheckBox->setVisible( isSurface && isDelaunay );
+  d->DelaunayAlphaLabel->setVisible( isSurface && isDelaunay );
+  d->DelaunayAlphaDoubleSpinBox->setVisible( isSurface && isDelaunay );
+  d->ConvexHullLabel->setVisible( isSurface && !isImplicit );
+  d->ConvexHullCheckBox->setVisible( isSurface && !isImplicit );
+  d->InteractionPreviewLabel->setVisible( isSurface );
+  d->InteractionPreviewCheckBox->setVisible( isSurface );
 
   d->InterpolationGroupBox->setVisible( isCurve );
   d->InterpolationLabel->setVisible( isCurve );
@@ -562,11 +646,16 @@ void qSlicerMarkupsToModelModuleWidget::updateGUIFromMRML()
   d->TubeRadiusDoubleSpinBox->setVisible( isCurve );
   d->TubeSidesLabel->setVisible( isCurve );
   d->TubeSidesSpinBox->setVisible( isCurve );
-  d->TubeSegmentsLabel->setVisible( isCurve );
-  d->TubeSegmentsSpinBox->setVisible( isCurve );
+  bool isAdaptiveSampling = ( d->TubeSamplingToleranceDoubleSpinBox->value() > 0.0 );
+  d->TubeSegmentsLabel->setVisible( isCurve && !isAdaptiveSampling );
+  d->TubeSegmentsSpinBox->setVisible( isCurve && !isAdaptiveSampling );
+  d->TubeSamplingToleranceLabel->setVisible( isCurve );
+  d->TubeSamplingToleranceDoubleSpinBox->setVisible( isCurve );
 
   d->TubeLoopLabel->setVisible( isCurve && !isPolynomial );
   d->TubeLoopCheckBox->setVisible( isCurve && !isPolynomial );
+  d->CenterlineOutputLabel->setVisible( isCurve );
+  d->CenterlineOutputCheckBox->setVisible( isCurve );
 
   d->KochanekEndsCopyNearestDerivativesLabel->setVisible( isCurve && isKochanek );
   d->KochanekEndsCopyNearestDerivativesCheckBox->setVisible( isCurve && isKochanek );
@@ -581,12 +670,58 @@ void qSlicerMarkupsToModelModuleWidget::updateGUIFromMRML()
   d->PointParameterGroupBox->setVisible( isCurve && isPolynomial );
   d->PointParameterRawIndicesRadioButton->setVisible( isCurve && isPolynomial );
   d->PointParameterMinimumSpanningTreeRadioButton->setVisible( isCurve && isPolynomial );
+  d->PointParameterMinimumSpanningTreeDenseRadioButton->setVisible( isCurve && isPolynomial );
   d->PolynomialOrderLabel->setVisible( isCurve && isPolynomial );
   d->PolynomialOrderSpinBox->setVisible( isCurve && isPolynomial );
 
+  d->IncrementalCurveUpdateLabel->setVisible( isCurve && !isPolynomial );
+  d->IncrementalCurveUpdateCheckBox->setVisible( isCurve && !isPolynomial );
+  bool isStreaming = d->StreamingCurveUpdateCheckBox->isChecked();
+  d->StreamingCurveUpdateLabel->setVisible( isCurve && !isPolynomial );
+  d->StreamingCurveUpdateCheckBox->setVisible( isCurve && !isPolynomial );
+  d->StreamingMaximumNumberOfPointsLabel->setVisible( isCurve && !isPolynomial && isStreaming );
+  d->StreamingMaximumNumberOfPointsSpinBox->setVisible( isCurve && !isPolynomial && isStreaming );
+  d->StreamingMaximumPointAgeLabel->setVisible( isCurve && !isPolynomial && isStreaming );
+  d->StreamingMaximumPointAgeDoubleSpinBox->setVisible( isCurve && !isPolynomial && isStreaming );
+
+  this->updateStatisticsLabel();
+
   this->blockAllSignals( false );
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerMarkupsToModelModuleWidget::updateStatisticsLabel()
+{
+  Q_D(qSlicerMarkupsToModelModuleWidget);
+
+  vtkMRMLMarkupsToModelNode* markupsToModelNode = vtkMRMLMarkupsToModelNode::SafeDownCast( d->ParameterNodeSelector->currentNode() );
+  vtkSlicerMarkupsToModelUpdateStatistics* statistics = NULL;
+  if ( markupsToModelNode != NULL )
+  {
+    statistics = d->logic()->GetUpdateStatistics( markupsToModelNode );
+  }
+  if ( statistics == NULL || statistics->GetNumberOfStages() == 0 )
+  {
+    d->UpdateStatisticsValueLabel->setText( "-" );
+    d->UpdateStatisticsValueLabel->setToolTip( "" );
+    return;
+  }
+
+  // the size of the output model is the size reported by the last stage
+  int lastStageIndex = statistics->GetNumberOfStages() - 1;
+  d->UpdateStatisticsValueLabel->setText( QString( "%1 ms, %2 points, %3 cells, %4 KiB" )
+    .arg( statistics->GetTotalDuration() * 1000.0, 0, 'f', 1 )
+    .arg( statistics->GetStageNumberOfPoints( lastStageIndex ) )
+    .arg( statistics->GetStageNumberOfCells( lastStageIndex ) )
+    .arg( statistics->GetStageMemorySize( lastStageIndex ) ) );
+  vtkSlicerMarkupsToModelGeometryCache* geometryCache = d->logic()->GetGeometryCache();
+  d->UpdateStatisticsValueLabel->setToolTip( QString::fromStdString( statistics->GetStagesAsString() )
+    + QString( "\nGeometry cache: %1 models, %2 KiB, %3% hit rate" )
+    .arg( geometryCache->GetNumberOfEntries() )
+    .arg( geometryCache->GetMemorySize() )
+    .arg( geometryCache->GetHitRate() * 100.0, 0, 'f', 0 ) );
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerMarkupsToModelModuleWidget::blockAllSignals(bool block)
 {
@@ -602,14 +737,28 @@ void qSlicerMarkupsToModelModuleWidget::blockAllSignals(bool block)
 
   // advanced options
   d->CleanMarkupsCheckBox->blockSignals(block);
+  d->CleanMarkupsToleranceDoubleSpinBox->blockSignals(block);
+  d->MaximumUpdateRateDoubleSpinBox->blockSignals(block);
+  d->FinalUpdateOnInteractionEndCheckBox->blockSignals(block);
+  d->AsynchronousUpdateCheckBox->blockSignals(block);
+  d->InteractionPreviewCheckBox->blockSignals(block);
   // closed surface options
   d->ButterflySubdivisionCheckBox->blockSignals(block);
+  d->NumberOfSubdivisionsSpinBox->blockSignals(block);
+  d->SinglePrecisionOutputCheckBox->blockSignals(block);
+  d->IncrementalDelaunayCheckBox->blockSignals(block);
+  d->FollowInputTransformCheckBox->blockSignals(block);
   d->DelaunayAlphaDoubleSpinBox->blockSignals(block);
   d->ConvexHullCheckBox->blockSignals(block);
+  d->SurfaceGenerationMethodComboBox->blockSignals(block);
+  d->DecimationTargetNumberOfPointsSpinBox->blockSignals(block);
+  d->DecimationSpacingDoubleSpinBox->blockSignals(block);
   // curve options
   d->TubeSidesSpinBox->blockSignals(block);
   d->TubeRadiusDoubleSpinBox->blockSignals(block);
   d->TubeSegmentsSpinBox->blockSignals(block);
+  d->TubeSamplingToleranceDoubleSpinBox->blockSignals(block);
+  d->CenterlineOutputCheckBox->blockSignals(block);
   d->LinearInterpolationRadioButton->blockSignals(block);
   d->CardinalInterpolationRadioButton->blockSignals(block);
   d->KochanekInterpolationRadioButton->blockSignals(block);
@@ -619,7 +768,12 @@ void qSlicerMarkupsToModelModuleWidget::blockAllSignals(bool block)
   d->KochanekTensionDoubleSpinBox->blockSignals(block);
   d->PointParameterRawIndicesRadioButton->blockSignals(block);
   d->PointParameterMinimumSpanningTreeRadioButton->blockSignals(block);
+  d->PointParameterMinimumSpanningTreeDenseRadioButton->blockSignals(block);
   d->PolynomialOrderSpinBox->blockSignals(block);
+  d->IncrementalCurveUpdateCheckBox->blockSignals(block);
+  d->StreamingCurveUpdateCheckBox->blockSignals(block);
+  d->StreamingMaximumNumberOfPointsSpinBox->blockSignals(block);
+  d->StreamingMaximumPointAgeDoubleSpinBox->blockSignals(block);
 
   // display options
   d->ModelVisiblityButton->blockSignals(block);
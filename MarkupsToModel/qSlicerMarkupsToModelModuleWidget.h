@@ -63,6 +63,8 @@ protected slots:
 
   void updateGUIFromMRML();
 
+  void updateStatisticsLabel();
+
   void blockAllSignals(bool block);
   void enableAllWidgets(bool enable);
 